@@ -0,0 +1,621 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// End-to-end benchmark of the ctrace CLI and server on a generated corpus.
+//
+// Generates N C translation units of controllable size and call depth plus their
+// compile_commands.json, then runs every scenario (mode x tool set) a few times and prints
+// one JSON document: wall time, CPU time and peak RSS of the ctrace process (children
+// included), and the per-phase totals of its trace. Documents from two commits can be
+// compared with --baseline.
+//
+// Usage: ctrace_bench [--ctrace <path>] [--work-dir <dir>] [--files <n>] [--functions <n>]
+//                     [--depth <n>] [--repetitions <n>] [--tools <t1,t2;t3>]
+//                     [--modes cli,server] [--async] [--label <text>] [--baseline <json>]
+//                     [--output <json>]
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace
+{
+    using json = nlohmann::json;
+
+    struct Options
+    {
+        std::string ctrace = CTRACE_BENCH_DEFAULT_BINARY;
+        std::filesystem::path workDir = std::filesystem::temp_directory_path() / "ctrace-bench";
+        std::size_t files = 32;
+        std::size_t functions = 16;
+        std::size_t depth = 8;
+        std::size_t repetitions = 3;
+        /// Tool sets, one scenario each; tools of a set run together.
+        std::vector<std::vector<std::string>> toolSets = {
+            {"cppcheck"},
+            {"flawfinder"},
+            {"tscancode"},
+            {"ctrace_stack_analyzer"},
+            {"cppcheck", "flawfinder", "tscancode", "ctrace_stack_analyzer"}};
+        std::vector<std::string> modes = {"cli", "server"};
+        bool async = false;
+        std::string label;
+        std::string baseline;
+        std::string output;
+    };
+
+    /// One measured run of the ctrace process (CLI) or one request (server).
+    struct Sample
+    {
+        double wallMs = 0;
+        double userMs = 0;
+        double systemMs = 0;
+        long peakRssKib = 0;
+        int exitCode = 0;
+        json phases = json::object(); ///< phase -> {count, total_ms}
+    };
+
+    std::vector<std::string> split(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator))
+        {
+            if (!part.empty())
+            {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+
+    std::string join(const std::vector<std::string>& parts, const char* separator)
+    {
+        std::string joined;
+        for (const auto& part : parts)
+        {
+            if (!joined.empty())
+            {
+                joined += separator;
+            }
+            joined += part;
+        }
+        return joined;
+    }
+
+    double toMs(const timeval& value)
+    {
+        return static_cast<double>(value.tv_sec) * 1000.0 +
+               static_cast<double>(value.tv_usec) / 1000.0;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Corpus
+    // ---------------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes one translation unit: `functions` call chains of `depth` frames each, every
+     * frame with its own stack buffer, ending in a leaf with the usual unsafe string calls.
+     */
+    std::size_t writeTranslationUnit(const std::filesystem::path& path, std::size_t unit,
+                                     std::size_t functions, std::size_t depth)
+    {
+        std::ostringstream out;
+        out << "// Generated by ctrace_bench; do not edit.\n"
+               "#include <stdio.h>\n"
+               "#include <string.h>\n\n";
+        for (std::size_t f = 0; f < functions; ++f)
+        {
+            const std::string prefix = "tu" + std::to_string(unit) + "_f" + std::to_string(f);
+            out << "static int " << prefix << "_leaf(const char* input, int n)\n"
+                << "{\n"
+                << "    char buffer[32];\n"
+                << "    strcpy(buffer, input);\n"
+                << "    if (n > 3)\n"
+                << "    {\n"
+                << "        sprintf(buffer, \"%d\", n);\n"
+                << "    }\n"
+                << "    return (int)strlen(buffer) + buffer[n % 32];\n"
+                << "}\n\n";
+            for (std::size_t level = depth; level-- > 0;)
+            {
+                const std::string callee = level + 1 == depth
+                                               ? prefix + "_leaf"
+                                               : prefix + "_d" + std::to_string(level + 1);
+                out << (level == 0 ? "int " : "static int ") << prefix << "_d" << level
+                    << "(const char* input, int n)\n"
+                    << "{\n"
+                    << "    int frame[" << 16 * (level + 1) << "];\n"
+                    << "    int total = 0;\n"
+                    << "    for (int i = 0; i < " << 16 * (level + 1) << "; ++i)\n"
+                    << "    {\n"
+                    << "        frame[i] = i * n;\n"
+                    << "        total += frame[i];\n"
+                    << "    }\n"
+                    << "    return total + " << callee << "(input, n + 1);\n"
+                    << "}\n\n";
+            }
+        }
+        if (unit == 0)
+        {
+            out << "int main(int argc, char** argv)\n{\n    int total = 0;\n";
+            for (std::size_t f = 0; f < functions; ++f)
+            {
+                out << "    total += tu0_f" << f << "_d0(argc > 1 ? argv[1] : \"\", argc);\n";
+            }
+            out << "    printf(\"%d\\n\", total);\n    return 0;\n}\n";
+        }
+
+        const std::string content = out.str();
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+        return content.size();
+    }
+
+    json generateCorpus(const Options& options, const std::filesystem::path& dir)
+    {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+
+        std::size_t bytes = 0;
+        json compdb = json::array();
+        for (std::size_t unit = 0; unit < options.files; ++unit)
+        {
+            const auto file = dir / ("tu" + std::to_string(unit) + ".c");
+            bytes += writeTranslationUnit(file, unit, options.functions, options.depth);
+            compdb.push_back({{"directory", dir.string()},
+                              {"file", file.string()},
+                              {"arguments", {"cc", "-c", file.string(), "-o", file.string() + ".o"}}});
+        }
+        std::ofstream(dir / "compile_commands.json") << compdb.dump(2) << "\n";
+
+        return {{"files", options.files},
+                {"functions_per_file", options.functions},
+                {"call_depth", options.depth},
+                {"bytes", bytes}};
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Processes
+    // ---------------------------------------------------------------------------------------
+
+    pid_t spawnProcess(const std::vector<std::string>& args, const std::filesystem::path& log)
+    {
+        std::vector<char*> argv;
+        for (const auto& arg : args)
+        {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, log.c_str(),
+                                         O_WRONLY | O_CREAT | O_APPEND, 0644);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+        pid_t pid = -1;
+        const int status = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (status != 0)
+        {
+            throw std::runtime_error("Cannot start '" + args.front() +
+                                     "': " + std::strerror(status));
+        }
+        return pid;
+    }
+
+    /// Reaps @p pid and fills CPU time and peak RSS; ru_* include reaped grandchildren.
+    void waitProcess(pid_t pid, Sample& sample)
+    {
+        int status = 0;
+        rusage usage{};
+        while (wait4(pid, &status, 0, &usage) == -1 && errno == EINTR)
+        {
+        }
+        sample.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        sample.userMs = toMs(usage.ru_utime);
+        sample.systemMs = toMs(usage.ru_stime);
+        sample.peakRssKib = usage.ru_maxrss;
+    }
+
+    void addPhase(json& phases, const std::string& name, double count, double totalMs)
+    {
+        auto& phase = phases[name];
+        if (!phase.is_object())
+        {
+            phase = {{"count", 0.0}, {"total_ms", 0.0}};
+        }
+        phase["count"] = phase["count"].get<double>() + count;
+        phase["total_ms"] = phase["total_ms"].get<double>() + totalMs;
+    }
+
+    /// Sums the spans of a `--trace-out` file per category.
+    json phasesFromTrace(const std::filesystem::path& path)
+    {
+        json phases = json::object();
+        std::ifstream in(path);
+        const json trace = json::parse(in, nullptr, false);
+        if (trace.is_discarded() || !trace.contains("traceEvents"))
+        {
+            return phases;
+        }
+        for (const auto& event : trace["traceEvents"])
+        {
+            addPhase(phases, event.value("cat", std::string("unknown")), 1,
+                     event.value("dur", 0.0) / 1000.0);
+        }
+        return phases;
+    }
+
+    unsigned short freePort()
+    {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+            throw std::runtime_error("Cannot find a free port");
+        }
+        ::close(fd);
+        return ntohs(address.sin_port);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Scenarios
+    // ---------------------------------------------------------------------------------------
+
+    std::vector<Sample> runCli(const Options& options, const std::filesystem::path& corpus,
+                               const std::vector<std::string>& tools)
+    {
+        std::vector<Sample> samples;
+        for (std::size_t rep = 0; rep < options.repetitions; ++rep)
+        {
+            const auto tracePath = options.workDir / "cli-trace.json";
+            std::filesystem::remove(tracePath);
+            std::vector<std::string> args = {options.ctrace,
+                                             "--compile-commands",
+                                             (corpus / "compile_commands.json").string(),
+                                             "--invoke",
+                                             join(tools, ","),
+                                             "--trace-out",
+                                             tracePath.string()};
+            if (options.async)
+            {
+                args.emplace_back("--async");
+            }
+
+            Sample sample;
+            const auto start = std::chrono::steady_clock::now();
+            waitProcess(spawnProcess(args, options.workDir / "cli.log"), sample);
+            sample.wallMs = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+            sample.phases = phasesFromTrace(tracePath);
+            samples.push_back(std::move(sample));
+        }
+        return samples;
+    }
+
+    /**
+     * @brief Starts one server per scenario and sends it `repetitions` run_analysis requests.
+     *
+     * Wall time and phases are per request; CPU time and peak RSS cover the whole server
+     * process and are divided over the requests.
+     */
+    std::vector<Sample> runServer(const Options& options, const std::filesystem::path& corpus,
+                                  const std::vector<std::string>& tools)
+    {
+        const unsigned short port = freePort();
+        const std::string token = "ctrace-bench";
+        const pid_t server =
+            spawnProcess({options.ctrace, "--ipc", "serve", "--serve-host", "127.0.0.1",
+                          "--serve-port", std::to_string(port), "--shutdown-token", token},
+                         options.workDir / "server.log");
+
+        httplib::Client client("127.0.0.1", port);
+        client.set_read_timeout(std::chrono::hours(1));
+        bool ready = false;
+        for (int attempt = 0; attempt < 200 && !ready; ++attempt)
+        {
+            const auto response = client.Options("/api");
+            ready = response && response->status == 200;
+            if (!ready)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+
+        std::vector<Sample> samples;
+        if (ready)
+        {
+            const json request = {
+                {"proto", "coretrace-1.0"},
+                {"id", 1},
+                {"type", "request"},
+                {"method", "run_analysis"},
+                {"params",
+                 {{"compile_commands", (corpus / "compile_commands.json").string()},
+                  {"invoke", tools},
+                  {"async", options.async}}}};
+            const std::string body = request.dump();
+            for (std::size_t rep = 0; rep < options.repetitions; ++rep)
+            {
+                Sample sample;
+                const auto start = std::chrono::steady_clock::now();
+                const auto response = client.Post("/api", body, "application/json");
+                sample.wallMs = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+                const json reply = response ? json::parse(response->body, nullptr, false) : json();
+                const bool ok = reply.is_object() && reply.value("status", "") == "ok";
+                sample.exitCode = ok ? 0 : 1;
+                if (ok && reply.contains("result") && reply["result"].contains("trace"))
+                {
+                    sample.phases = reply["result"]["trace"].value("phases", json::object());
+                }
+                samples.push_back(std::move(sample));
+            }
+        }
+
+        httplib::Headers headers = {{"Authorization", "Bearer " + token}};
+        if (!ready || !client.Post("/shutdown", headers, "", "application/json"))
+        {
+            ::kill(server, SIGTERM);
+        }
+        Sample process;
+        waitProcess(server, process);
+        if (!ready)
+        {
+            throw std::runtime_error("Server did not start; see " +
+                                     (options.workDir / "server.log").string());
+        }
+        const double share = 1.0 / static_cast<double>(samples.size());
+        for (auto& sample : samples)
+        {
+            sample.userMs = process.userMs * share;
+            sample.systemMs = process.systemMs * share;
+            sample.peakRssKib = process.peakRssKib;
+        }
+        return samples;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Report
+    // ---------------------------------------------------------------------------------------
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        const std::size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+
+    json summarize(const std::string& mode, const std::vector<std::string>& tools,
+                   const std::vector<Sample>& samples)
+    {
+        std::vector<double> wall;
+        std::vector<double> user;
+        std::vector<double> system;
+        long peakRss = 0;
+        json exitCodes = json::array();
+        json phases = json::object();
+        for (const auto& sample : samples)
+        {
+            wall.push_back(sample.wallMs);
+            user.push_back(sample.userMs);
+            system.push_back(sample.systemMs);
+            peakRss = std::max(peakRss, sample.peakRssKib);
+            exitCodes.push_back(sample.exitCode);
+            for (const auto& [name, total] : sample.phases.items())
+            {
+                addPhase(phases, name, total.value("count", 0.0), total.value("total_ms", 0.0));
+            }
+        }
+        // Phases are reported per run.
+        const double runs = samples.empty() ? 1.0 : static_cast<double>(samples.size());
+        for (auto& [name, phase] : phases.items())
+        {
+            phase["count"] = phase["count"].get<double>() / runs;
+            phase["total_ms"] = phase["total_ms"].get<double>() / runs;
+        }
+
+        return {{"name", mode + "/" + join(tools, "+")},
+                {"mode", mode},
+                {"tools", tools},
+                {"repetitions", samples.size()},
+                {"wall_ms",
+                 {{"min", wall.empty() ? 0.0 : *std::min_element(wall.begin(), wall.end())},
+                  {"median", median(wall)},
+                  {"max", wall.empty() ? 0.0 : *std::max_element(wall.begin(), wall.end())}}},
+                {"cpu_ms", {{"user", median(user)}, {"system", median(system)}}},
+                {"peak_rss_kib", peakRss},
+                {"exit_codes", exitCodes},
+                {"phases", phases}};
+    }
+
+    /// Adds `baseline` figures and relative changes to results also present in @p path.
+    void compareWithBaseline(json& report, const std::string& path)
+    {
+        std::ifstream in(path);
+        const json baseline = json::parse(in, nullptr, false);
+        if (baseline.is_discarded() || !baseline.contains("results"))
+        {
+            throw std::runtime_error("Cannot read baseline '" + path + "'");
+        }
+        for (auto& result : report["results"])
+        {
+            for (const auto& previous : baseline["results"])
+            {
+                if (previous.value("name", "") != result["name"].get<std::string>())
+                {
+                    continue;
+                }
+                const auto change = [](double before, double after)
+                { return before > 0 ? (after - before) / before : 0.0; };
+                const double wallBefore = previous["wall_ms"].value("median", 0.0);
+                const double rssBefore = previous.value("peak_rss_kib", 0.0);
+                result["baseline"] = {
+                    {"label", baseline.value("label", "")},
+                    {"wall_ms_median", wallBefore},
+                    {"peak_rss_kib", rssBefore},
+                    {"wall_change", change(wallBefore, result["wall_ms"]["median"].get<double>())},
+                    {"peak_rss_change",
+                     change(rssBefore, result["peak_rss_kib"].get<double>())}};
+            }
+        }
+        report["baseline"] = path;
+    }
+
+    Options parseOptions(int argc, char* argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::runtime_error("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            const auto count = [&]() -> std::size_t
+            {
+                const std::size_t parsed = std::strtoull(value().c_str(), nullptr, 10);
+                if (parsed == 0)
+                {
+                    throw std::runtime_error(arg + " expects a positive integer");
+                }
+                return parsed;
+            };
+
+            if (arg == "--ctrace")
+                options.ctrace = value();
+            else if (arg == "--work-dir")
+                options.workDir = value();
+            else if (arg == "--files")
+                options.files = count();
+            else if (arg == "--functions")
+                options.functions = count();
+            else if (arg == "--depth")
+                options.depth = count();
+            else if (arg == "--repetitions")
+                options.repetitions = count();
+            else if (arg == "--tools")
+            {
+                options.toolSets.clear();
+                for (const auto& set : split(value(), ';'))
+                {
+                    options.toolSets.push_back(split(set, ','));
+                }
+            }
+            else if (arg == "--modes")
+                options.modes = split(value(), ',');
+            else if (arg == "--async")
+                options.async = true;
+            else if (arg == "--label")
+                options.label = value();
+            else if (arg == "--baseline")
+                options.baseline = value();
+            else if (arg == "--output")
+                options.output = value();
+            else
+                throw std::runtime_error("Unknown option " + arg);
+        }
+        for (const auto& mode : options.modes)
+        {
+            if (mode != "cli" && mode != "server")
+            {
+                throw std::runtime_error("Unknown mode '" + mode + "' (cli or server)");
+            }
+        }
+        return options;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        Options options = parseOptions(argc, argv);
+        options.ctrace = std::filesystem::absolute(options.ctrace).string();
+        std::filesystem::create_directories(options.workDir);
+        options.workDir = std::filesystem::canonical(options.workDir);
+
+        const auto corpusDir = options.workDir / "corpus";
+        json report = {{"schema", "ctrace-bench-1"},
+                       {"label", options.label},
+                       {"ctrace", options.ctrace},
+                       {"async", options.async},
+                       {"hardware_threads", std::thread::hardware_concurrency()},
+                       {"corpus", generateCorpus(options, corpusDir)},
+                       {"results", json::array()}};
+
+        for (const auto& mode : options.modes)
+        {
+            for (const auto& tools : options.toolSets)
+            {
+                std::cerr << "ctrace_bench: " << mode << " " << join(tools, "+") << std::endl;
+                const auto samples = mode == "cli" ? runCli(options, corpusDir, tools)
+                                                   : runServer(options, corpusDir, tools);
+                report["results"].push_back(summarize(mode, tools, samples));
+            }
+        }
+
+        if (!options.baseline.empty())
+        {
+            compareWithBaseline(report, options.baseline);
+        }
+
+        if (options.output.empty())
+        {
+            std::cout << report.dump(2) << std::endl;
+        }
+        else
+        {
+            std::ofstream(options.output) << report.dump(2) << "\n";
+        }
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ctrace_bench: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,374 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Google Benchmark microbenchmarks for the helpers that run before and after every analysis:
+// argument splitting, language detection, mangling, input resolution, config loading,
+// tscancode SARIF conversion and server request parsing.
+//
+// Inputs are generated once per size under the system temp directory.
+//
+// Usage: ctrace_hot_paths_bench [--benchmark_filter=<regex>] [--benchmark_format=json]
+
+#include "App/Files.hpp"
+#include "App/ToolConfig.hpp"
+#include "Process/Ipc/RequestParams.hpp"
+#include "Process/Tools/AnalysisTools.hpp"
+#include "Process/Tools/TscancodeParser.hpp"
+#include "ctrace_tools/languageType.hpp"
+#include "ctrace_tools/mangle.hpp"
+#include "ctrace_tools/strings.hpp"
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+    using json = nlohmann::json;
+
+    const std::filesystem::path& benchDir()
+    {
+        static const std::filesystem::path dir = []
+        {
+            auto path = std::filesystem::temp_directory_path() /
+                        ("ctrace-hot-paths-bench-" + std::to_string(::getpid()));
+            std::filesystem::create_directories(path);
+            return path;
+        }();
+        return dir;
+    }
+
+    /// Realistic source paths: nested directories and the extensions found in compdbs.
+    std::string sourcePath(std::size_t index)
+    {
+        static constexpr const char* kExtensions[] = {".cpp", ".cc", ".c", ".cxx", ".hpp", ".h"};
+        return "/work/project/src/module" + std::to_string(index % 97) + "/sub" +
+               std::to_string(index % 13) + "/file_" + std::to_string(index) +
+               kExtensions[index % std::size(kExtensions)];
+    }
+
+    /// compile_commands.json with @p entries entries, written once per size.
+    std::string compileDatabase(std::size_t entries)
+    {
+        static std::mutex mutex;
+        static std::map<std::size_t, std::string> paths;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& path = paths[entries];
+        if (!path.empty())
+        {
+            return path;
+        }
+
+        const auto dir = benchDir() / ("compdb-" + std::to_string(entries));
+        std::filesystem::create_directories(dir);
+        std::ofstream out(dir / "compile_commands.json");
+        out << "[\n";
+        for (std::size_t i = 0; i < entries; ++i)
+        {
+            const std::string file = sourcePath(i);
+            out << (i == 0 ? "" : ",\n") << "  {\n"
+                << "    \"directory\": \"/work/project/build\",\n"
+                << "    \"command\": \"/usr/bin/c++ -DNDEBUG -I/work/project/include "
+                   "-isystem /work/project/_deps/fmt/include -O2 -std=c++20 -o "
+                << file << ".o -c " << file << "\",\n"
+                << "    \"file\": \"" << file << "\"\n"
+                << "  }";
+        }
+        out << "\n]\n";
+        path = (dir / "compile_commands.json").string();
+        return path;
+    }
+
+    /// tscancode output of roughly @p bytes: diagnostics mixed with progress lines.
+    const std::string& tscancodeLog(std::size_t bytes)
+    {
+        static std::mutex mutex;
+        static std::map<std::size_t, std::string> logs;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& log = logs[bytes];
+        if (!log.empty())
+        {
+            return log;
+        }
+
+        static constexpr const char* kSeverities[] = {"Warning", "Information", "Error"};
+        log.reserve(bytes + 256);
+        for (std::size_t i = 0; log.size() < bytes; ++i)
+        {
+            if (i % 8 == 0)
+            {
+                log += "Checking " + sourcePath(i) + "...\n";
+                continue;
+            }
+            log += "[" + sourcePath(i) + ":" + std::to_string(10 + i % 2000) + "]: (" +
+                   kSeverities[i % std::size(kSeverities)] +
+                   ") Possible null pointer dereference: ptr_" + std::to_string(i) + "\n";
+        }
+        return log;
+    }
+
+    /// Exposes the SARIF conversion, which is an implementation detail of execute().
+    class TscancodeSarif : public ctrace::TscancodeToolImplementation
+    {
+      public:
+        using ctrace::TscancodeToolImplementation::sarifFormat;
+    };
+
+    void BM_SplitByComma(benchmark::State& state)
+    {
+        std::string input;
+        for (std::int64_t i = 0; i < state.range(0); ++i)
+        {
+            input += (i == 0 ? "" : ",") + sourcePath(static_cast<std::size_t>(i));
+        }
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ctrace_tools::strings::splitByComma(input));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(input.size()));
+    }
+    BENCHMARK(BM_SplitByComma)->Arg(16)->Arg(1000)->Arg(100000);
+
+    void BM_DetectLanguage(benchmark::State& state)
+    {
+        std::vector<std::string> files;
+        for (std::int64_t i = 0; i < state.range(0); ++i)
+        {
+            files.push_back(sourcePath(static_cast<std::size_t>(i)));
+        }
+        for (auto _ : state)
+        {
+            for (const auto& file : files)
+            {
+                benchmark::DoNotOptimize(ctrace_tools::detectLanguage(file));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_DetectLanguage)->Arg(100000);
+
+    void BM_MangleFunction(benchmark::State& state)
+    {
+        const std::vector<std::string> params = {"int", "const char*", "std::string",
+                                                 "double", "unsigned long"};
+        const std::vector<std::string> paramTypes(
+            params.begin(), params.begin() + static_cast<std::ptrdiff_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ctrace_tools::mangle::mangleFunction(
+                "ctrace::analysis", "processFile", paramTypes));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_MangleFunction)->DenseRange(0, 5);
+
+    /// Compile database given as an input file: always parsed.
+    void BM_ResolveSourceFilesManifest(benchmark::State& state)
+    {
+        ctrace::ProgramConfig config;
+        config.addFile(compileDatabase(static_cast<std::size_t>(state.range(0))));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ctrace::resolveSourceFiles(config));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ResolveSourceFilesManifest)
+        ->Arg(1000)
+        ->Arg(100000)
+        ->Unit(benchmark::kMillisecond);
+
+    /// Compile database given with --compile-commands: served from its binary index once warm.
+    void BM_ResolveSourceFilesCompileCommands(benchmark::State& state)
+    {
+        ctrace::ProgramConfig config;
+        config.global.compile_commands = compileDatabase(static_cast<std::size_t>(state.range(0)));
+        benchmark::DoNotOptimize(ctrace::resolveSourceFiles(config)); // Builds the index.
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ctrace::resolveSourceFiles(config));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ResolveSourceFilesCompileCommands)
+        ->Arg(1000)
+        ->Arg(100000)
+        ->Unit(benchmark::kMillisecond);
+
+    void BM_ApplyToolConfigFile(benchmark::State& state)
+    {
+        const std::string path = CTRACE_BENCH_SOURCE_DIR "/config/tool-config.json";
+        for (auto _ : state)
+        {
+            ctrace::ProgramConfig config;
+            std::string error;
+            if (!ctrace::applyToolConfigFile(config, path, error))
+            {
+                state.SkipWithError(error.c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(config);
+        }
+    }
+    BENCHMARK(BM_ApplyToolConfigFile)->Unit(benchmark::kMicrosecond);
+
+    /// The std::regex line matching that the tscancode parser replaced, kept as a baseline.
+    void BM_TscancodeParseRegex(benchmark::State& state)
+    {
+        const std::string& log = tscancodeLog(static_cast<std::size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            const std::regex diagnosticRegex(R"(\[(.*):(\d+)\]: \((\w+)\) (.*))");
+            std::istringstream stream(log);
+            std::string line;
+            std::size_t count = 0;
+            while (std::getline(stream, line))
+            {
+                std::smatch match;
+                if (std::regex_match(line, match, diagnosticRegex))
+                {
+                    benchmark::DoNotOptimize(std::stoi(match[2]));
+                    ++count;
+                }
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(log.size()));
+    }
+    BENCHMARK(BM_TscancodeParseRegex)
+        ->Arg(1 << 20)
+        ->Arg(50 << 20)
+        ->Unit(benchmark::kMillisecond);
+
+    void BM_TscancodeParse(benchmark::State& state)
+    {
+        const std::string& log = tscancodeLog(static_cast<std::size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ctrace::tscancode::for_each_diagnostic(
+                log, [](const ctrace::tscancode::Diagnostic& diagnostic)
+                { benchmark::DoNotOptimize(diagnostic.line); }));
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(log.size()));
+    }
+    BENCHMARK(BM_TscancodeParse)->Arg(1 << 20)->Arg(50 << 20)->Unit(benchmark::kMillisecond);
+
+    void BM_TscancodeSarifFormat(benchmark::State& state)
+    {
+        const std::string& log = tscancodeLog(static_cast<std::size_t>(state.range(0)));
+        const TscancodeSarif tool;
+        for (auto _ : state)
+        {
+            // One merged report per iteration, as in a run; written out with the results.
+            ctrace::SarifReport report(benchDir() / "tscancode.sarif");
+            const ctrace::report::Context ctx{&report, "tscancode"};
+            const ctrace::report::ScopedContext scoped(&ctx);
+            benchmark::DoNotOptimize(tool.sarifFormat(log));
+            std::string error;
+            if (!report.write(error))
+            {
+                state.SkipWithError(error.c_str());
+                break;
+            }
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(log.size()));
+    }
+    BENCHMARK(BM_TscancodeSarifFormat)
+        ->Arg(1 << 20)
+        ->Arg(50 << 20)
+        ->Unit(benchmark::kMillisecond);
+
+    void BM_SarifReportMerge(benchmark::State& state)
+    {
+        // Four tools flagging the same lines: write() merges them down to range(0) findings.
+        static constexpr const char* kTools[] = {"cppcheck", "ctrace_stack_analyzer", "flawfinder",
+                                                 "tscancode"};
+        const auto findings = static_cast<std::uint64_t>(state.range(0));
+        ctrace::SarifReport report(benchDir() / "merged.sarif");
+        for (const char* tool : kTools)
+        {
+            const std::string rule = std::string(tool) + ".NullPointer";
+            for (std::uint64_t i = 0; i < findings; ++i)
+            {
+                const std::string file = sourcePath(static_cast<std::size_t>(i % 1000));
+                const std::string message = std::string(tool) + " finding " + std::to_string(i);
+                (void)report.addResult(tool, ctrace::SarifResult{rule, "warning", message, file,
+                                                                 i / 1000 + 1});
+            }
+        }
+        for (auto _ : state)
+        {
+            std::string error;
+            ctrace::SarifReport::Summary summary;
+            if (!report.write(error, &summary))
+            {
+                state.SkipWithError(error.c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(summary);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0) *
+                                static_cast<std::int64_t>(std::size(kTools)));
+    }
+    BENCHMARK(BM_SarifReportMerge)->Arg(1000)->Arg(50000)->Unit(benchmark::kMillisecond);
+
+    void BM_ApiConfigFromParams(benchmark::State& state)
+    {
+        json inputs = json::array();
+        for (std::int64_t i = 0; i < state.range(0); ++i)
+        {
+            inputs.push_back(sourcePath(static_cast<std::size_t>(i)));
+        }
+        const json params = {{"input", inputs},
+                             {"entry_points", {"main"}},
+                             {"static_analysis", true},
+                             {"invoke", {"cppcheck", "flawfinder", "ctrace_stack_analyzer"}},
+                             {"sarif_format", true},
+                             {"report_file", "ctrace-report.txt"},
+                             {"output_file", "ctrace.out"},
+                             {"ipc", "serve"},
+                             {"async", true},
+                             {"verbose", false},
+                             {"smt", "on"},
+                             {"smt_timeout_ms", 50U},
+                             {"stack_limit", 8388608U}};
+        for (auto _ : state)
+        {
+            ctrace::ProgramConfig config;
+            ctrace::ipc::ParseError error;
+            if (!ctrace::ipc::buildConfigFromParams(params, config, error))
+            {
+                state.SkipWithError((error.code + ": " + error.message).c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(config);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ApiConfigFromParams)->Arg(1)->Arg(1000)->Arg(10000);
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    std::error_code ec;
+    std::filesystem::remove_all(benchDir(), ec);
+    return 0;
+}
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: Apache-2.0
+//
+// Compares the work-stealing ThreadPool against the previous single-queue
+// design (one std::queue behind one mutex/condition variable).
+//
+// Usage: ctrace_thread_pool_bench [tasks] [threads] [work_iterations]
+
+#include "Process/ThreadPool.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    class SingleQueueThreadPool
+    {
+      public:
+        explicit SingleQueueThreadPool(std::size_t numThreads)
+        {
+            if (numThreads == 0)
+            {
+                numThreads = 1;
+            }
+            workers.reserve(numThreads);
+            for (std::size_t i = 0; i < numThreads; ++i)
+            {
+                workers.emplace_back(
+                    [this]
+                    {
+                        while (true)
+                        {
+                            std::function<void()> task;
+                            {
+                                std::unique_lock<std::mutex> lock(queueMutex);
+                                condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                                if (stopping && tasks.empty())
+                                    return;
+                                task = std::move(tasks.front());
+                                tasks.pop();
+                            }
+                            task();
+                        }
+                    });
+            }
+        }
+
+        ~SingleQueueThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                stopping = true;
+            }
+            condition.notify_all();
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        template <typename F>
+        auto enqueue(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using return_type = std::invoke_result_t<std::decay_t<F>>;
+            auto task = std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(f));
+            std::future<return_type> res = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (stopping)
+                    throw std::runtime_error("Enqueue on stopped ThreadPool");
+                tasks.emplace([task]() { (*task)(); });
+            }
+            condition.notify_one();
+            return res;
+        }
+
+      private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex queueMutex;
+        std::condition_variable condition;
+        bool stopping = false;
+    };
+
+    std::uint64_t spin(std::uint64_t iterations, std::uint64_t seed)
+    {
+        std::uint64_t x = seed | 1U;
+        for (std::uint64_t i = 0; i < iterations; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        return x;
+    }
+
+    template <typename Pool>
+    double runFlat(std::size_t threads, std::size_t tasks, std::uint64_t work)
+    {
+        Pool pool(threads);
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::future<std::uint64_t>> results;
+        results.reserve(tasks);
+        for (std::size_t i = 0; i < tasks; ++i)
+        {
+            results.push_back(pool.enqueue([i, work] { return spin(work, i); }));
+        }
+        std::uint64_t sink = 0;
+        for (auto& result : results)
+        {
+            sink ^= result.get();
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (sink == 42)
+        {
+            std::cerr << "";
+        }
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    template <typename Pool>
+    double runFanOut(std::size_t threads, std::size_t tasks, std::uint64_t work)
+    {
+        Pool pool(threads);
+        const auto start = std::chrono::steady_clock::now();
+
+        // Each root task submits its own children from inside the pool, which
+        // is where per-worker deques pay off. Roots block on their children, so
+        // only half of the workers may hold a root.
+        const std::size_t roots = threads / 2;
+        const std::size_t childrenPerRoot = tasks / roots;
+        std::vector<std::future<std::uint64_t>> results;
+        results.reserve(roots);
+        for (std::size_t r = 0; r < roots; ++r)
+        {
+            results.push_back(pool.enqueue(
+                [&pool, r, childrenPerRoot, work]
+                {
+                    std::vector<std::future<std::uint64_t>> children;
+                    children.reserve(childrenPerRoot);
+                    for (std::size_t c = 0; c < childrenPerRoot; ++c)
+                    {
+                        children.push_back(pool.enqueue([r, c, work] { return spin(work, r + c); }));
+                    }
+                    std::uint64_t acc = 0;
+                    for (auto& child : children)
+                    {
+                        acc ^= child.get();
+                    }
+                    return acc;
+                }));
+        }
+        std::uint64_t sink = 0;
+        for (auto& result : results)
+        {
+            sink ^= result.get();
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (sink == 42)
+        {
+            std::cerr << "";
+        }
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    template <typename Fn> double bestOf(int repetitions, Fn&& fn)
+    {
+        double best = 0.0;
+        for (int i = 0; i < repetitions; ++i)
+        {
+            const double current = fn();
+            if (i == 0 || current < best)
+            {
+                best = current;
+            }
+        }
+        return best;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                   : std::thread::hardware_concurrency();
+    const std::uint64_t work = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64;
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+
+    constexpr int kRepetitions = 5;
+    const double flatSingle =
+        bestOf(kRepetitions, [&] { return runFlat<SingleQueueThreadPool>(threads, tasks, work); });
+    const double flatStealing =
+        bestOf(kRepetitions, [&] { return runFlat<ThreadPool>(threads, tasks, work); });
+
+    const std::size_t fanOutThreads = threads < 2 ? 2 : threads;
+    const double fanOutSingle = bestOf(
+        kRepetitions, [&] { return runFanOut<SingleQueueThreadPool>(fanOutThreads, tasks, work); });
+    const double fanOutStealing =
+        bestOf(kRepetitions, [&] { return runFanOut<ThreadPool>(fanOutThreads, tasks, work); });
+
+    std::cout << "{\n"
+              << "  \"tasks\": " << tasks << ",\n"
+              << "  \"threads\": " << threads << ",\n"
+              << "  \"work_iterations\": " << work << ",\n"
+              << "  \"flat_ms\": {\"single_queue\": " << flatSingle
+              << ", \"work_stealing\": " << flatStealing << "},\n"
+              << "  \"fan_out_ms\": {\"single_queue\": " << fanOutSingle
+              << ", \"work_stealing\": " << fanOutStealing << "}\n"
+              << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,19 @@
+# SPDX-License-Identifier: Apache-2.0
+find_package(benchmark QUIET)
+
+if(NOT benchmark_FOUND)
+    include(FetchContent)
+
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+    FetchContent_Declare(
+        googlebenchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG v1.8.3
+        EXCLUDE_FROM_ALL
+    )
+
+    FetchContent_MakeAvailable(googlebenchmark)
+endif()
@@ -4,7 +4,7 @@ include(FetchContent)
 FetchContent_Declare(
     cpp_httplib
     GIT_REPOSITORY https://github.com/yhirose/cpp-httplib.git
-    GIT_TAG v0.14.3
+    GIT_TAG v0.18.1
     EXCLUDE_FROM_ALL
 )
 
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef APP_COMPILE_DATABASE_HPP
+#define APP_COMPILE_DATABASE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief One entry of compile_commands.json.
+     */
+    struct CompileCommand
+    {
+        std::string file;                   ///< Absolute, normalized source path.
+        std::string directory;              ///< Working directory of the compiler invocation.
+        std::vector<std::string> arguments; ///< Compiler invocation, one argument per element.
+        std::string output;                 ///< Object file path when known (absolute).
+    };
+
+    class CompileDatabaseIndex;
+
+    /**
+     * @brief A compile_commands.json file, indexed by source path.
+     *
+     * Backed by the file's CompileDatabaseIndex; commands are materialized on lookup.
+     */
+    class CompileDatabase
+    {
+      public:
+        /**
+         * @brief Loads a compilation database.
+         *
+         * @param path compile_commands.json, or a directory containing one.
+         * @param error Set to a human-readable reason when loading fails.
+         * @return The database, or std::nullopt on error.
+         */
+        CT_NODISCARD static std::optional<CompileDatabase> load(const std::string& path,
+                                                                std::string& error);
+
+        /**
+         * @brief Returns the command compiling @p file, or nullptr if the file is not listed.
+         *
+         * When a file appears several times, the first entry wins. Safe to call from several
+         * threads; the returned command lives as long as the database.
+         */
+        CT_NODISCARD const CompileCommand* find(const std::string& file) const;
+
+        CT_NODISCARD std::size_t size() const noexcept;
+
+      private:
+        struct Materialized
+        {
+            std::mutex mutex;
+            std::unordered_map<std::size_t, std::unique_ptr<CompileCommand>> commands;
+        };
+
+        std::shared_ptr<const CompileDatabaseIndex> m_index;
+        std::unordered_map<std::string_view, std::size_t> m_indexByFile; ///< Views into m_index.
+        std::unique_ptr<Materialized> m_materialized = std::make_unique<Materialized>();
+    };
+
+    /**
+     * @brief Parses compile_commands.json @p content; the index is built from the result.
+     *
+     * Uses the streaming manifest parser (see parseManifest()), without building a JSON
+     * document of the whole database.
+     *
+     * @param compdbPath Path of the database, used to resolve relative directories.
+     * @param selfContained Set to false when some entry is not a `{"file": ...}` object or
+     *        its path depends on where the database lives (no absolute directory or file).
+     */
+    CT_NODISCARD std::optional<std::vector<CompileCommand>>
+    parseCompileDatabase(std::string_view content, const std::filesystem::path& compdbPath,
+                         std::string& error, bool& selfContained);
+
+    /**
+     * @brief Makes @p path absolute and lexically normal, the key format of CompileDatabase.
+     */
+    CT_NODISCARD std::string normalizeSourcePath(const std::string& path);
+
+    /**
+     * @brief Splits a compile_commands "command" string into arguments (POSIX shell quoting).
+     */
+    CT_NODISCARD std::vector<std::string> splitCommandLine(std::string_view command);
+
+    /**
+     * @brief Extracts the prerequisites of the first rule of a Makefile-style depfile.
+     *
+     * Relative paths are resolved against @p baseDir. The returned paths are normalized.
+     */
+    CT_NODISCARD std::vector<std::string> parseDepfile(std::string_view content,
+                                                       const std::filesystem::path& baseDir);
+
+    /**
+     * @brief Returns the headers and sources @p command depends on, read from its depfile.
+     *
+     * The depfile is the `-MF` argument, or the object file with a `.d` extension when the
+     * command uses `-MD`/`-MMD`. Returns std::nullopt when no depfile is available, e.g.
+     * before the first build.
+     */
+    CT_NODISCARD std::optional<std::vector<std::string>>
+    readDepfileDependencies(const CompileCommand& command);
+} // namespace ctrace
+
+#endif // APP_COMPILE_DATABASE_HPP
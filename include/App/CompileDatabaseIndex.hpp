@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef APP_COMPILE_DATABASE_INDEX_HPP
+#define APP_COMPILE_DATABASE_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "App/CompileDatabase.hpp"
+#include "App/MappedFile.hpp"
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief Compact binary form of a compile_commands.json, kept next to it.
+     *
+     * Holds, per entry, the normalized file, the interned directory, output and argument
+     * strings and the `_deps` classification. `<database>.ctrace-index` is memory-mapped when
+     * it matches the database (size and mtime, or content hash after a touch) and rebuilt
+     * otherwise. When it cannot be written, the freshly built index is used from memory.
+     */
+    class CompileDatabaseIndex
+    {
+      public:
+        static constexpr std::string_view kFileSuffix = ".ctrace-index";
+
+        /**
+         * @brief Opens the index of @p path, building it if missing or stale.
+         *
+         * @param path compile_commands.json, or a directory containing one.
+         * @param error Set to a human-readable reason on failure.
+         * @return nullptr when the database cannot be read or parsed.
+         */
+        CT_NODISCARD static std::shared_ptr<const CompileDatabaseIndex>
+        open(const std::string& path, std::string& error);
+
+        CT_NODISCARD std::size_t size() const noexcept
+        {
+            return m_entryCount;
+        }
+
+        /// Absolute, normalized source path (the CompileDatabase key).
+        CT_NODISCARD std::string_view file(std::size_t entry) const;
+        CT_NODISCARD std::string_view directory(std::size_t entry) const;
+        CT_NODISCARD std::string_view output(std::size_t entry) const;
+        CT_NODISCARD std::size_t argumentCount(std::size_t entry) const;
+        CT_NODISCARD std::string_view argument(std::size_t entry, std::size_t position) const;
+
+        /// True when the file lies under a `_deps` directory (FetchContent dependencies).
+        CT_NODISCARD bool isDependency(std::size_t entry) const;
+
+        /**
+         * @brief True when every database entry is a `{"file": ...}` object whose path does
+         * not depend on the database location, so `file()` lists every source it names.
+         */
+        CT_NODISCARD bool selfContained() const noexcept;
+
+        CT_NODISCARD CompileCommand command(std::size_t entry) const;
+
+      private:
+        struct Header;
+        struct StringRef;
+        struct Entry;
+
+        CompileDatabaseIndex() = default;
+
+        CT_NODISCARD bool attach(std::string_view bytes);
+        CT_NODISCARD std::string_view string(const StringRef& ref) const;
+        CT_NODISCARD const Entry& entry(std::size_t index) const;
+
+        MappedFile m_file;
+        std::string m_buffer; ///< Index bytes when they could not be written to disk.
+        const Header* m_header = nullptr;
+        const Entry* m_entries = nullptr;
+        const StringRef* m_arguments = nullptr;
+        const char* m_strings = nullptr;
+        std::size_t m_entryCount = 0;
+    };
+} // namespace ctrace
+
+#endif // APP_COMPILE_DATABASE_INDEX_HPP
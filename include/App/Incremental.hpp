@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef APP_INCREMENTAL_HPP
+#define APP_INCREMENTAL_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Config/config.hpp"
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief True when `--changed-since` or `--changed-files` narrows the analysis.
+     */
+    CT_NODISCARD bool isIncrementalRun(const ProgramConfig& config);
+
+    /**
+     * @brief Lists the changed paths (absolute, normalized) of an incremental run.
+     *
+     * Combines `changed_files` with `git diff --name-only <changed_since>` and the untracked
+     * files of the work tree.
+     *
+     * @return The changed paths, or std::nullopt with @p error set when git fails.
+     */
+    CT_NODISCARD std::optional<std::vector<std::string>>
+    collectChangedPaths(const ProgramConfig& config, std::string& error);
+
+    /**
+     * @brief Keeps the source files affected by @p changedPaths.
+     *
+     * A file is affected when it changed itself or when one of the headers listed in its
+     * depfile (found through compile_commands.json) changed. Files without a depfile are
+     * kept whenever a header changed, since their includes are unknown.
+     *
+     * @param sourceFiles Output of resolveSourceFiles(), in analysis order.
+     * @return The affected subset of @p sourceFiles, in the same order.
+     */
+    CT_NODISCARD std::vector<std::string>
+    selectAffectedSources(const ProgramConfig& config, const std::vector<std::string>& sourceFiles,
+                          const std::vector<std::string>& changedPaths);
+} // namespace ctrace
+
+#endif // APP_INCREMENTAL_HPP
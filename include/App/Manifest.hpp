@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef APP_MANIFEST_HPP
+#define APP_MANIFEST_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /// Below this many entries per thread, normalizing in parallel is not worth a thread.
+    constexpr std::size_t kMinManifestEntriesPerWorker = 2048;
+
+    /// What parseManifest() collects.
+    enum class ManifestMode
+    {
+        Sources,        ///< Source paths of every accepted manifest shape.
+        CompileCommands ///< Whole `{"file": ...}` items of a root array, as in a compile database.
+    };
+
+    /**
+     * @brief A source path listed by a manifest, before normalization.
+     *
+     * `directory` is only set for compile_commands-style `{"file", "directory"}` items. The
+     * command fields are only collected in ManifestMode::CompileCommands.
+     */
+    struct ManifestEntry
+    {
+        std::string candidate;
+        std::optional<std::string> directory;
+        std::optional<std::vector<std::string>> arguments; ///< String elements only.
+        std::optional<std::string> command;
+        std::optional<std::string> output;
+    };
+
+    /**
+     * @brief The parts of a JSON manifest that name source files.
+     *
+     * Mirrors the accepted shapes: a root array, one of the root arrays `files`,
+     * `sources` or `compile_commands`, or a root `file`/`src_file`/`path` string.
+     */
+    struct ManifestContents
+    {
+        std::optional<std::vector<ManifestEntry>> rootArray;
+        std::optional<std::vector<ManifestEntry>> files;
+        std::optional<std::vector<ManifestEntry>> sources;
+        std::optional<std::vector<ManifestEntry>> compileCommands;
+        std::optional<std::string> rootFile;
+        std::optional<std::string> rootSrcFile;
+        std::optional<std::string> rootPath;
+        std::size_t skippedItems = 0; ///< Entry-array items that named no source.
+    };
+
+    /**
+     * @brief Parses the JSON manifest @p text (an optional UTF-8 BOM is skipped) into
+     * @p contents.
+     *
+     * Only the fields @p mode needs are decoded; other values are validated and skipped. In
+     * ManifestMode::Sources, items of an entry array are path strings or objects with a
+     * `file` (and optional `directory`), `src_file` or `path` string, tried in that order.
+     * In ManifestMode::CompileCommands, only `{"file": ...}` objects of a root array are
+     * entries, with their `directory`, `arguments`, `command` and `output`. A repeated key
+     * replaces the earlier value.
+     *
+     * @return false when @p text is not valid JSON; @p contents is then unspecified.
+     */
+    CT_NODISCARD bool parseManifest(std::string_view text, ManifestContents& contents,
+                                    ManifestMode mode = ManifestMode::Sources);
+
+    /**
+     * @brief Resolves @p entries against their `directory`, or @p manifestDir, and
+     * normalizes them lexically, splitting large manifests across threads.
+     *
+     * @param skipDependencies Drops entries under a `_deps` directory.
+     * @param maxWorkers Thread limit; 0 uses the hardware concurrency.
+     * @return One path per entry, in the same order; empty for skipped entries.
+     */
+    CT_NODISCARD std::vector<std::string>
+    resolveManifestEntries(const std::vector<ManifestEntry>& entries,
+                           const std::filesystem::path& manifestDir, bool skipDependencies,
+                           std::size_t maxWorkers = 0);
+} // namespace ctrace
+
+#endif // APP_MANIFEST_HPP
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef APP_MAPPED_FILE_HPP
+#define APP_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+     *
+     * Large inputs (compile databases) are parsed straight from the page cache instead of
+     * being copied into a string first. Falls back to reading the file on other platforms.
+     */
+    class MappedFile
+    {
+      public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @return false when @p path cannot be opened or read.
+         */
+        CT_NODISCARD bool open(const std::filesystem::path& path);
+
+        CT_NODISCARD std::string_view contents() const noexcept
+        {
+            return {m_data, m_size};
+        }
+
+      private:
+        void reset() noexcept;
+
+        const char* m_data = nullptr;
+        std::size_t m_size = 0;
+        bool m_mapped = false;
+        std::string m_fallback; ///< Contents when the file could not be mapped.
+    };
+} // namespace ctrace
+
+#endif // APP_MAPPED_FILE_HPP
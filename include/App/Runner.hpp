@@ -5,8 +5,16 @@
 #include "Config/config.hpp"
 #include "attributes.hpp"
 
+#include <optional>
+
 namespace ctrace
 {
+    /**
+     * @brief Runs an internal worker invocation (e.g. one stack analyzer shard).
+     *
+     * @return The worker exit code, or std::nullopt when argv is a regular invocation.
+     */
+    CT_NODISCARD std::optional<int> run_worker_mode(int argc, char* argv[]);
     CT_NODISCARD int run_server(const ProgramConfig& config);
     CT_NODISCARD int run_cli_analysis(const ProgramConfig& config);
 } // namespace ctrace
@@ -15,6 +15,7 @@
 #include "ArgumentParser/ArgumentParserFactory.hpp"
 #include "App/SupportedTools.hpp"
 #include "App/Version.hpp"
+#include "Process/ExecutionControl.hpp"
 #include "ctrace_tools/strings.hpp"
 #include "ctrace_defs/types.hpp"
 
@@ -31,13 +32,16 @@ Options:
   --help                   Displays this help message.
   --version                Displays build version information.
   --verbose                Enables detailed (verbose) output.
-  --sarif-format           Generates a report in SARIF format.
+  --sarif-format           Writes one SARIF report merging all tools to the report file.
   --report-file <path>     Specifies the path to the report file (default: ctrace-report.txt).
+  --sarif-baseline <file>  Marks SARIF results found in this earlier report as unchanged.
   --output-file <path>     Specifies the output file for the analysed binary (default: ctrace.out).
   --entry-points <names>   Sets the entry points for analysis (default: main). Accepts a comma-separated list.
   --config <path>          Loads settings from a JSON config file.
   --compile-commands <path> Path to compile_commands.json for tools that support it.
   --include-compdb-deps    Includes dependency entries (e.g. _deps) when auto-loading files from compile_commands.json.
+  --changed-since <rev>    Analyses only the files affected by changes since a git revision.
+  --changed-files <list>   Analyses only the files affected by these changed files (comma-separated, @file for a list).
   --analysis-profile <p>   Stack analyzer profile: fast|full.
   --smt <on|off>           Enables/disables SMT refinement in stack analyzer.
   --smt-backend <name>     Primary SMT backend (e.g. z3, interval).
@@ -60,7 +64,13 @@ Options:
   --ipc-path <path>        Specifies the IPC path (default: /tmp/coretrace_ipc).
   --serve-host <host>      HTTP server host when --ipc=serve.
   --serve-port <port>      HTTP server port when --ipc=serve.
+  --serve-workers <n>      Analysis workers shared by server requests (0 = one per core).
+  --serve-max-analyses <n> Analyses run at once by the server (0 = one per worker).
+  --serve-max-queued <n>   Analyses waiting for a slot before requests get 429.
   --async                  Enables asynchronous execution.
+  --result-cache-dir <dir> Reuses tool results for unchanged inputs from this directory.
+  --runtime-history <file> Records tool runtimes to run the longest work first.
+  --trace-out <file>       Writes a Chrome trace of the run's phases to this file.
   --shutdown-token <tok>   Token required for POST /shutdown (server mode).
   --shutdown-timeout-ms <ms> Graceful shutdown timeout in ms (0 = wait indefinitely).
 
@@ -124,18 +134,30 @@ namespace ctrace
         std::string ipcPath = "/tmp/coretrace_ipc"; ///< Path for IPC communication.
         std::string serverHost = "127.0.0.1";       ///< Host for server IPC (if applicable).
         int serverPort = 8080;                      ///< Port for server IPC (if applicable).
+        int serverWorkerThreads = 0; ///< Shared server worker pool size (0 = one per core).
+        int serverMaxConcurrentAnalyses = 0; ///< Analyses admitted at once (0 = one per worker).
+        int serverMaxQueuedAnalyses = 32;    ///< Analyses waiting for admission before 429.
         std::string shutdownToken;                  ///< Token required for POST /shutdown.
         int shutdownTimeoutMs = 0; ///< Shutdown timeout in milliseconds (0 = wait indefinitely).
+        std::string result_cache_dir; ///< Persistent tool result cache (empty = disabled).
+        std::string runtime_history;  ///< Per-(tool, file) runtime store for scheduling.
+        std::string trace_out;        ///< Chrome trace JSON of the CLI run (empty = disabled).
+        process::ResourceLimits default_tool_limits; ///< Limits for external tools.
+        std::unordered_map<std::string, process::ResourceLimits>
+            tool_limits; ///< Per-tool limits (defaults already applied).
 
         std::vector<std::string> specificTools; ///< List of specific tools to invoke.
 
         std::string entry_points = "";                 ///< Entry points for analysis.
         std::string report_file = "ctrace-report.txt"; ///< Path to the report file.
+        std::string sarif_baseline; ///< Earlier SARIF report to compare with (empty = none).
         std::string output_file = "ctrace.out";        ///< Path to the output file.
         std::string config_file;                       ///< Path to the JSON config file.
         std::string compile_commands;                  ///< Path to compile_commands.json.
         bool include_compdb_deps =
             false; ///< Includes dependency entries from compile_commands.json auto-discovery.
+        std::string changed_since;              ///< Git revision for incremental runs.
+        std::vector<std::string> changed_files; ///< Changed paths for incremental runs.
         std::string analysis_profile;       ///< Stack analyzer analysis profile (fast|full).
         std::string smt;                    ///< SMT enable switch (on|off).
         std::string smt_backend;            ///< SMT primary backend.
@@ -162,6 +184,7 @@ namespace ctrace
         std::optional<bool>
             stack_analyzer_uninitialized_cross_tu; ///< Override uninitialized cross-TU toggle.
         std::string stack_analyzer_jobs;     ///< Analyzer jobs value ("auto" or positive integer).
+        uint32_t stack_analyzer_shards = 1;  ///< Parallel analyzer shards (0 = one per core).
         std::string stack_analyzer_base_dir; ///< Base directory for SARIF URI normalization.
         std::string stack_analyzer_dump_ir;  ///< Dump LLVM IR path (file/dir).
         std::string
@@ -233,6 +256,8 @@ namespace ctrace
             { config.global.hasSarifFormat = true; };
             commands["--report-file"] = [this](const std::string& value)
             { config.global.report_file = value; };
+            commands["--sarif-baseline"] = [this](const std::string& value)
+            { config.global.sarif_baseline = value; };
             commands["--output-file"] = [this](const std::string& value)
             { config.global.output_file = value; };
             commands["--async"] = [this](const std::string&)
@@ -270,6 +295,15 @@ namespace ctrace
             { config.global.compile_commands = value; };
             commands["--include-compdb-deps"] = [this](const std::string&)
             { config.global.include_compdb_deps = true; };
+            commands["--changed-since"] = [this](const std::string& value)
+            { config.global.changed_since = value; };
+            commands["--changed-files"] = [this](const std::string& value)
+            {
+                for (const auto part : ctrace_tools::strings::splitByComma(value))
+                {
+                    config.global.changed_files.emplace_back(part);
+                }
+            };
             commands["--analysis-profile"] = [this](const std::string& value)
             { config.global.analysis_profile = value; };
             commands["--smt"] = [this](const std::string& value) { config.global.smt = value; };
@@ -358,6 +392,12 @@ namespace ctrace
             };
             commands["--ipc-path"] = [this](const std::string& value)
             { config.global.ipcPath = value; };
+            commands["--result-cache-dir"] = [this](const std::string& value)
+            { config.global.result_cache_dir = value; };
+            commands["--runtime-history"] = [this](const std::string& value)
+            { config.global.runtime_history = value; };
+            commands["--trace-out"] = [this](const std::string& value)
+            { config.global.trace_out = value; };
             commands["--serve-host"] = [this](const std::string& value)
             {
                 config.global.serverHost = value;
@@ -370,6 +410,30 @@ namespace ctrace
                 coretrace::log(coretrace::Level::Debug, "Server port set to {}",
                                config.global.serverPort);
             };
+            commands["--serve-workers"] = [this](const std::string& value)
+            {
+                config.global.serverWorkerThreads = std::stoi(value);
+                if (config.global.serverWorkerThreads < 0)
+                {
+                    config.global.serverWorkerThreads = 0;
+                }
+            };
+            commands["--serve-max-analyses"] = [this](const std::string& value)
+            {
+                config.global.serverMaxConcurrentAnalyses = std::stoi(value);
+                if (config.global.serverMaxConcurrentAnalyses < 0)
+                {
+                    config.global.serverMaxConcurrentAnalyses = 0;
+                }
+            };
+            commands["--serve-max-queued"] = [this](const std::string& value)
+            {
+                config.global.serverMaxQueuedAnalyses = std::stoi(value);
+                if (config.global.serverMaxQueuedAnalyses < 0)
+                {
+                    config.global.serverMaxQueuedAnalyses = 0;
+                }
+            };
             commands["--shutdown-token"] = [this](const std::string& value)
             { config.global.shutdownToken = value; };
             commands["--shutdown-timeout-ms"] = [this](const std::string& value)
@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef CONSOLE_WRITER_HPP
+#define CONSOLE_WRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ctrace
+{
+    namespace Thread
+    {
+        namespace Output
+        {
+            /**
+             * @brief Writes console lines from a dedicated thread in batches.
+             *
+             * Producers push lines into a bounded MPSC ring (Vyukov's sequence-per-slot
+             * queue) without taking a lock. The writer thread appends them to a batch and
+             * writes it when it reaches `kFlushBytes`, when `kFlushInterval` has passed since
+             * its first line, or on `flush()`. Lines from one thread keep their order, and so
+             * do lines of one tool invocation.
+             */
+            class ConsoleWriter
+            {
+              public:
+                static constexpr std::size_t kCapacity = 4096; ///< Ring slots, a power of two.
+                static constexpr std::size_t kFlushBytes = 64 * 1024;
+                static constexpr std::chrono::milliseconds kFlushInterval{20};
+
+                enum class Target : std::uint8_t
+                {
+                    Stdout,
+                    Stderr
+                };
+
+                static ConsoleWriter& instance()
+                {
+                    static ConsoleWriter writer;
+                    return writer;
+                }
+
+                ConsoleWriter(const ConsoleWriter&) = delete;
+                ConsoleWriter& operator=(const ConsoleWriter&) = delete;
+
+                ~ConsoleWriter()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stopping_ = true;
+                    }
+                    wake_.notify_one();
+                    if (thread_.joinable())
+                    {
+                        thread_.join();
+                    }
+                }
+
+                /// Queues @p line (without its newline); blocks only while the ring is full.
+                void write(Target target, std::string line)
+                {
+                    std::size_t position = enqueue_pos_.load(std::memory_order_relaxed);
+                    unsigned spins = 0;
+                    while (true)
+                    {
+                        Slot& slot = slots_[position & (kCapacity - 1)];
+                        const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+                        const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                                          static_cast<std::ptrdiff_t>(position);
+                        if (diff == 0)
+                        {
+                            if (enqueue_pos_.compare_exchange_weak(position, position + 1,
+                                                                   std::memory_order_relaxed))
+                            {
+                                slot.target = target;
+                                slot.line = std::move(line);
+                                // seq_cst pairs with the writer's idle check (see below).
+                                slot.seq.store(position + 1, std::memory_order_seq_cst);
+                                break;
+                            }
+                        }
+                        else if (diff < 0)
+                        {
+                            // Full: make sure the writer is awake, then let it catch up.
+                            wake_writer();
+                            if (++spins > 64)
+                            {
+                                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                            }
+                            else
+                            {
+                                std::this_thread::yield();
+                            }
+                            position = enqueue_pos_.load(std::memory_order_relaxed);
+                        }
+                        else
+                        {
+                            position = enqueue_pos_.load(std::memory_order_relaxed);
+                        }
+                    }
+
+                    // Either the writer sees the published slot before sleeping, or we see it
+                    // idle here and wake it.
+                    if (writer_idle_.load(std::memory_order_seq_cst))
+                    {
+                        wake_writer();
+                    }
+                }
+
+                /**
+                 * @brief Returns once every line queued before the call has been written and
+                 * the streams flushed.
+                 */
+                void flush()
+                {
+                    const std::size_t target = enqueue_pos_.load(std::memory_order_acquire);
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    flush_requested_ = true;
+                    wake_.notify_one();
+                    written_cv_.wait(lock, [this, target] { return written_ >= target; });
+                }
+
+              private:
+                struct Slot
+                {
+                    std::atomic<std::size_t> seq{0};
+                    Target target = Target::Stdout;
+                    std::string line;
+                };
+
+                ConsoleWriter() : slots_(std::make_unique<Slot[]>(kCapacity))
+                {
+                    for (std::size_t i = 0; i < kCapacity; ++i)
+                    {
+                        slots_[i].seq.store(i, std::memory_order_relaxed);
+                    }
+                    thread_ = std::thread([this] { run(); });
+                }
+
+                void wake_writer()
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    wake_.notify_one();
+                }
+
+                /// Consumer side: only the writer thread dequeues.
+                bool dequeue(Target& target, std::string& line)
+                {
+                    Slot& slot = slots_[dequeue_pos_ & (kCapacity - 1)];
+                    if (slot.seq.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+                    {
+                        return false;
+                    }
+                    target = slot.target;
+                    line = std::move(slot.line);
+                    slot.line.clear();
+                    slot.seq.store(dequeue_pos_ + kCapacity, std::memory_order_release);
+                    ++dequeue_pos_;
+                    return true;
+                }
+
+                /// Adds a dequeued line to the batch.
+                void add_line(Target target, const std::string& line)
+                {
+                    // Switching streams writes what came before, so stdout and stderr lines
+                    // keep their relative order.
+                    if (!batch_.empty() && target != batch_target_)
+                    {
+                        write_batch();
+                    }
+                    if (batch_.empty())
+                    {
+                        batch_started_ = std::chrono::steady_clock::now();
+                    }
+                    batch_target_ = target;
+                    batch_.append(line);
+                    batch_.push_back('\n');
+                    batched_upto_ = dequeue_pos_;
+                }
+
+                void write_batch()
+                {
+                    if (!batch_.empty())
+                    {
+                        std::ostream& stream =
+                            batch_target_ == Target::Stderr ? std::cerr : std::cout;
+                        stream.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+                        stream.flush();
+                        batch_.clear();
+                    }
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    written_ = batched_upto_;
+                    written_cv_.notify_all();
+                }
+
+                void run()
+                {
+                    Target target = Target::Stdout;
+                    std::string line;
+                    while (true)
+                    {
+                        while (dequeue(target, line))
+                        {
+                            add_line(target, line);
+                            if (batch_.size() >= kFlushBytes)
+                            {
+                                write_batch();
+                            }
+                        }
+
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        const bool flush_now = flush_requested_ || stopping_;
+                        const bool done = stopping_;
+                        flush_requested_ = false;
+                        const bool due = !batch_.empty() && std::chrono::steady_clock::now() -
+                                                                    batch_started_ >=
+                                                                kFlushInterval;
+                        if (flush_now || due)
+                        {
+                            lock.unlock();
+                            // Lines queued while checking are written by this pass too.
+                            while (dequeue(target, line))
+                            {
+                                add_line(target, line);
+                            }
+                            write_batch();
+                            if (done)
+                            {
+                                return;
+                            }
+                            continue;
+                        }
+
+                        if (batch_.empty())
+                        {
+                            // Nothing pending: sleep until a producer wakes us.
+                            writer_idle_.store(true, std::memory_order_seq_cst);
+                            if (!has_pending())
+                            {
+                                wake_.wait_for(lock, kFlushInterval * 50);
+                            }
+                            writer_idle_.store(false, std::memory_order_relaxed);
+                        }
+                        else
+                        {
+                            // A batch is pending: producers need not wake us before it is due.
+                            wake_.wait_until(lock, batch_started_ + kFlushInterval);
+                        }
+                    }
+                }
+
+                bool has_pending() const
+                {
+                    const Slot& slot = slots_[dequeue_pos_ & (kCapacity - 1)];
+                    return slot.seq.load(std::memory_order_seq_cst) == dequeue_pos_ + 1 ||
+                           flush_requested_ || stopping_;
+                }
+
+                std::unique_ptr<Slot[]> slots_;
+                alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+                alignas(64) std::size_t dequeue_pos_ = 0; ///< Writer thread only.
+                std::atomic<bool> writer_idle_{false};
+
+                std::mutex mutex_;
+                std::condition_variable wake_;
+                std::condition_variable written_cv_;
+                bool flush_requested_ = false;
+                bool stopping_ = false;
+                std::size_t written_ = 0; ///< Lines dequeued and written (guarded by mutex_).
+
+                // Writer thread only.
+                std::string batch_;
+                Target batch_target_ = Target::Stdout;
+                std::chrono::steady_clock::time_point batch_started_;
+                std::size_t batched_upto_ = 0; ///< Dequeue position of the last batched line.
+                std::thread thread_;
+            };
+
+            /**
+             * @brief Waits until console lines queued so far are on the terminal.
+             */
+            inline void flush_console()
+            {
+                ConsoleWriter::instance().flush();
+            }
+        } // namespace Output
+    } // namespace Thread
+} // namespace ctrace
+
+#endif // CONSOLE_WRITER_HPP
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef EXECUTION_CONTROL_HPP
+#define EXECUTION_CONTROL_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace ctrace::process
+{
+    /**
+     * @brief Resource limits for one external tool process (0 = no limit).
+     */
+    struct ResourceLimits
+    {
+        std::uint64_t timeout_ms = 0;  ///< Wall-clock limit, enforced by killing the child.
+        std::uint64_t max_rss_mb = 0;  ///< Resident memory limit, sampled while the child runs.
+        std::uint64_t cpu_seconds = 0; ///< CPU time limit (RLIMIT_CPU).
+
+        [[nodiscard]] bool empty() const
+        {
+            return timeout_ms == 0 && max_rss_mb == 0 && cpu_seconds == 0;
+        }
+    };
+
+    /**
+     * @brief Shared stop flag for one analysis (server shutdown, client disconnect, cancel).
+     *
+     * An optional probe is polled by `cancelled()`, e.g. to notice a closed HTTP connection
+     * without a dedicated watcher thread.
+     */
+    class CancellationToken
+    {
+      public:
+        CancellationToken() = default;
+        explicit CancellationToken(std::function<bool()> probe) : probe_(std::move(probe)) {}
+
+        void cancel()
+        {
+            cancelled_.store(true, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool cancelled() const
+        {
+            if (cancelled_.load(std::memory_order_acquire))
+            {
+                return true;
+            }
+            if (probe_ && probe_())
+            {
+                cancelled_.store(true, std::memory_order_release);
+                return true;
+            }
+            return false;
+        }
+
+      private:
+        std::function<bool()> probe_;
+        mutable std::atomic<bool> cancelled_{false};
+    };
+
+    /**
+     * @brief Limits and cancellation applied to processes launched by the current tool job.
+     */
+    struct ExecutionControl
+    {
+        ResourceLimits limits;
+        std::shared_ptr<const CancellationToken> cancellation;
+        /// Largest peak RSS (KiB) among the processes reaped under this control.
+        mutable std::atomic<std::uint64_t> peak_rss_kib{0};
+
+        void record_peak_rss(const rusage& usage) const
+        {
+#if defined(__APPLE__)
+            const auto kib = static_cast<std::uint64_t>(usage.ru_maxrss) / 1024; // bytes
+#else
+            const auto kib = static_cast<std::uint64_t>(usage.ru_maxrss);
+#endif
+            std::uint64_t current = peak_rss_kib.load(std::memory_order_relaxed);
+            while (kib > current &&
+                   !peak_rss_kib.compare_exchange_weak(current, kib, std::memory_order_relaxed))
+            {
+            }
+        }
+    };
+
+    inline thread_local const ExecutionControl* current_control = nullptr;
+
+    /**
+     * @brief Sets RLIMIT_CPU on the already started child @p pid; the kernel then sends
+     * SIGXCPU past `cpu_seconds` and SIGKILL one second later.
+     *
+     * For children started with posix_spawn, which has no pre-exec hook.
+     * @return true when a limit was applied (Linux only).
+     */
+    inline bool apply_cpu_limit(pid_t pid, const ResourceLimits& limits)
+    {
+#if defined(__linux__)
+        if (limits.cpu_seconds == 0)
+        {
+            return false;
+        }
+        rlimit cpu{};
+        cpu.rlim_cur = static_cast<rlim_t>(limits.cpu_seconds);
+        cpu.rlim_max = static_cast<rlim_t>(limits.cpu_seconds + 1);
+        return prlimit(pid, RLIMIT_CPU, &cpu, nullptr) == 0;
+#else
+        (void)pid;
+        (void)limits;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Process groups led by running tool children.
+     *
+     * A child in its own group no longer receives the terminal's SIGINT, so the handler of
+     * forward_interrupts() kills the registered groups instead. Lock-free slots, so that the
+     * handler can walk them.
+     */
+    namespace process_groups
+    {
+        inline constexpr std::size_t kCapacity = 256;
+        inline std::array<std::atomic<pid_t>, kCapacity> slots{};
+
+        /// Registers the group of @p leader; a no-op when every slot is taken.
+        inline void add(pid_t leader)
+        {
+            for (auto& slot : slots)
+            {
+                pid_t expected = 0;
+                if (slot.compare_exchange_strong(expected, leader))
+                {
+                    return;
+                }
+            }
+        }
+
+        /// Unregisters the group of @p leader, once the leader has been reaped.
+        inline void remove(pid_t leader)
+        {
+            for (auto& slot : slots)
+            {
+                pid_t expected = leader;
+                if (slot.compare_exchange_strong(expected, 0))
+                {
+                    return;
+                }
+            }
+        }
+
+        /// Sends @p signal to every registered group. Async-signal-safe.
+        inline void signal_all(int signal)
+        {
+            for (const auto& slot : slots)
+            {
+                if (const pid_t leader = slot.load(); leader > 0)
+                {
+                    kill(-leader, signal);
+                }
+            }
+        }
+    } // namespace process_groups
+
+    /**
+     * @brief Makes SIGINT and SIGTERM reach the tool children that lead their own process
+     * group, then terminates this process by the same signal as before.
+     *
+     * For the CLI; the server stops its analyses through their CancellationToken instead.
+     */
+    inline void forward_interrupts()
+    {
+        struct sigaction action{};
+        action.sa_handler = [](int signal)
+        {
+            process_groups::signal_all(signal);
+            struct sigaction fallback{};
+            fallback.sa_handler = SIG_DFL;
+            sigemptyset(&fallback.sa_mask);
+            sigaction(signal, &fallback, nullptr);
+            raise(signal);
+        };
+        sigemptyset(&action.sa_mask);
+        for (const int signal : {SIGINT, SIGTERM})
+        {
+            struct sigaction previous{};
+            // A signal ignored by the parent shell (nohup, background job) stays ignored.
+            if (sigaction(signal, nullptr, &previous) == 0 && previous.sa_handler != SIG_IGN)
+            {
+                sigaction(signal, &action, nullptr);
+            }
+        }
+    }
+
+    /**
+     * @brief Installs @p control for processes started on this thread, like `ScopedCapture`.
+     */
+    class ScopedExecutionControl
+    {
+      public:
+        explicit ScopedExecutionControl(const ExecutionControl* control)
+            : previous_(current_control)
+        {
+            current_control = control;
+        }
+
+        ~ScopedExecutionControl()
+        {
+            current_control = previous_;
+        }
+
+        ScopedExecutionControl(const ScopedExecutionControl&) = delete;
+        ScopedExecutionControl& operator=(const ScopedExecutionControl&) = delete;
+
+      private:
+        const ExecutionControl* previous_;
+    };
+
+    /**
+     * @brief Decides when a running child must be killed.
+     *
+     * Checked from the output drain loop every `kTick`. Memory is the resident size of the
+     * child's process group, which the child leads whenever limits apply, so that wrappers
+     * (ikos, shell scripts) are charged for the processes doing the work. It is sampled from
+     * /proc, so `max_rss_mb` is only enforced on Linux.
+     */
+    class ChildWatchdog
+    {
+      public:
+        static constexpr std::chrono::milliseconds kTick{100};
+
+        ChildWatchdog(pid_t pid, const ExecutionControl* control)
+            : pid_(pid), start_(std::chrono::steady_clock::now())
+        {
+            if (control != nullptr)
+            {
+                limits_ = control->limits;
+                cancellation_ = control->cancellation;
+            }
+        }
+
+        /// True when the drain loop needs to wake up periodically.
+        [[nodiscard]] bool active() const
+        {
+            return limits_.timeout_ms != 0 || limits_.max_rss_mb != 0 || cancellation_;
+        }
+
+        /**
+         * @return true once the child must be stopped; `reason()` then says why.
+         */
+        bool expired()
+        {
+            if (cancellation_ && cancellation_->cancelled())
+            {
+                reason_ = "cancelled";
+                return true;
+            }
+            if (limits_.timeout_ms != 0 &&
+                std::chrono::steady_clock::now() - start_ >=
+                    std::chrono::milliseconds(limits_.timeout_ms))
+            {
+                reason_ = "timed out after " + std::to_string(limits_.timeout_ms) + " ms";
+                return true;
+            }
+            if (limits_.max_rss_mb != 0)
+            {
+                const std::uint64_t rssMb = residentMegabytes();
+                if (rssMb > limits_.max_rss_mb)
+                {
+                    reason_ = "exceeded max_rss_mb (" + std::to_string(rssMb) + " > " +
+                              std::to_string(limits_.max_rss_mb) + " MB)";
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] const std::string& reason() const
+        {
+            return reason_;
+        }
+
+      private:
+        [[nodiscard]] std::uint64_t residentMegabytes() const
+        {
+#if defined(__linux__)
+            std::uint64_t residentPages = 0;
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it("/proc", ec), end; !ec && it != end;
+                 it.increment(ec))
+            {
+                const std::string name = it->path().filename().string();
+                if (name.find_first_not_of("0123456789") == std::string::npos)
+                {
+                    residentPages += groupResidentPages(it->path() / "stat");
+                }
+            }
+            static const long pageSize = sysconf(_SC_PAGESIZE);
+            return residentPages * static_cast<std::uint64_t>(pageSize) / (1024 * 1024);
+#else
+            return 0;
+#endif
+        }
+
+        /**
+         * @brief Resident pages of the process described by @p statPath (/proc/<pid>/stat),
+         * or 0 when it is not in the child's process group or has exited meanwhile.
+         */
+        [[nodiscard]] std::uint64_t groupResidentPages(const std::filesystem::path& statPath) const
+        {
+            std::ifstream in(statPath);
+            std::string line;
+            if (!std::getline(in, line))
+            {
+                return 0;
+            }
+            // The command name may hold spaces and parentheses: fields start after the last ')'.
+            const auto nameEnd = line.rfind(')');
+            if (nameEnd == std::string::npos)
+            {
+                return 0;
+            }
+            std::istringstream fields(line.substr(nameEnd + 1));
+            std::string state;
+            long long parent = 0;
+            long long group = 0;
+            if (!(fields >> state >> parent >> group) || group != static_cast<long long>(pid_))
+            {
+                return 0;
+            }
+            // rss is field 24 of stat(5); pgrp, field 5, was the last one read.
+            std::string skipped;
+            for (int field = 6; field < 24 && fields >> skipped; ++field)
+            {
+            }
+            std::uint64_t rss = 0;
+            return fields >> rss ? rss : 0;
+        }
+
+        pid_t pid_;
+        std::chrono::steady_clock::time_point start_;
+        ResourceLimits limits_;
+        std::shared_ptr<const CancellationToken> cancellation_;
+        std::string reason_;
+    };
+} // namespace ctrace::process
+
+#endif // EXECUTION_CONTROL_HPP
@@ -3,15 +3,21 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
-#include <initializer_list>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <random>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "httplib.h"         // cpp-httplib (header-only)
@@ -19,9 +25,11 @@
 
 #include "Config/config.hpp"
 #include "App/Files.hpp"
-#include "App/ToolConfig.hpp"
+#include "App/Incremental.hpp"
+#include "Process/ExecutionControl.hpp"
+#include "Process/Ipc/RequestParams.hpp"
 #include "Process/Tools/ToolsInvoker.hpp"
-#include "ctrace_tools/strings.hpp"
+#include "Process/Trace.hpp"
 #include "coretrace/logger.hpp"
 
 using json = nlohmann::json;
@@ -63,413 +71,658 @@ class ConsoleLogger : public ILogger
 };
 
 // ============================================================================
-// API / Contrôleur : gestion du protocole JSON-RPC-like
+// Contrôle d'admission
 // ============================================================================
 
-class ApiHandler
+/**
+ * @brief Bounds how many analyses run at once and how many may wait for a slot.
+ *
+ * Waiting analyses are admitted interactive-first, then in arrival order. When the wait queue
+ * is full, `reserve()` fails and the caller answers 429 with `retry_after_seconds()`.
+ */
+class AdmissionController
 {
   public:
-    explicit ApiHandler(ILogger& logger) : logger_(logger) {}
+    enum class Priority
+    {
+        Interactive,
+        Batch
+    };
 
-    json handle_request(const json& request)
+    struct Limits
     {
-        log_request(logger_, request);
+        std::size_t max_active = 0; ///< 0 = unlimited (no queueing); see ApiHandler.
+        std::size_t max_queued = 32;
+    };
 
-        json response;
-        response["proto"] = request.value("proto", std::string("coretrace-1.0"));
-        response["id"] = request.value("id", 0);
-        response["type"] = "response";
+    /**
+     * @brief A place in the queue, then a running slot; released on destruction.
+     */
+    class Ticket
+    {
+      public:
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
 
-        std::string method = request.value("method", "");
-        json params = request.value("params", json::object());
+        ~Ticket()
+        {
+            controller_.release(*this);
+        }
 
-        if (method == "run_analysis")
+        /**
+         * @brief Blocks until the analysis may start.
+         * @return false when @p cancellation was cancelled first; the queue place is then
+         *         given up when the ticket is destroyed.
+         */
+        bool wait(const ctrace::process::CancellationToken* cancellation = nullptr)
         {
-            return handle_run_analysis(response, params);
+            return controller_.wait_admitted(*this, cancellation);
         }
 
-        // Méthode inconnue
-        response["status"] = "error";
-        response["error"] = {{"code", "UnknownMethod"}, {"message", "Unknown method: " + method}};
-        return response;
-    }
+      private:
+        friend class AdmissionController;
 
-  private:
-    struct ParseError
-    {
-        std::string code;
-        std::string message;
+        Ticket(AdmissionController& controller, std::uint64_t seq, Priority priority,
+               bool admitted)
+            : controller_(controller), seq_(seq), priority_(priority), admitted_(admitted)
+        {
+        }
+
+        AdmissionController& controller_;
+        std::uint64_t seq_;
+        Priority priority_;
+        bool admitted_;
+        std::chrono::steady_clock::time_point started_{};
     };
 
-    struct BoolField
+    explicit AdmissionController(Limits limits) : limits_(limits) {}
+
+    /**
+     * @brief Takes a running slot if one is free, else a queue place.
+     * @return nullptr when the queue is full.
+     */
+    std::unique_ptr<Ticket> reserve(Priority priority)
     {
-        const char* key;
-        bool* target;
-    };
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::uint64_t seq = next_seq_++;
+        if (limits_.max_active == 0 || (active_ < limits_.max_active && queued_locked() == 0))
+        {
+            ++active_;
+            std::unique_ptr<Ticket> ticket(new Ticket(*this, seq, priority, true));
+            ticket->started_ = std::chrono::steady_clock::now();
+            return ticket;
+        }
+        if (queued_locked() >= limits_.max_queued)
+        {
+            ++rejected_;
+            return nullptr;
+        }
+        queue_for(priority).push_back(seq);
+        return std::unique_ptr<Ticket>(new Ticket(*this, seq, priority, false));
+    }
 
-    struct StringField
+    /**
+     * @brief Seconds a rejected client should wait: the queue ahead of it, drained at the
+     * observed average analysis duration.
+     */
+    unsigned retry_after_seconds() const
     {
-        const char* key;
-        std::string* target;
-    };
+        std::lock_guard<std::mutex> lock(mutex_);
+        const double slots = static_cast<double>(std::max<std::size_t>(limits_.max_active, 1));
+        const double waves = static_cast<double>(queued_locked() + 1) / slots;
+        const double seconds = std::ceil(waves * average_seconds_);
+        return static_cast<unsigned>(std::clamp(seconds, 1.0, 300.0));
+    }
 
-    struct Uint64Field
+    /// Makes waiting tickets check their cancellation token now (e.g. after cancel_all()).
+    void wake_waiters()
     {
-        const char* key;
-        uint64_t* target;
-    };
+        cv_.notify_all();
+    }
 
-    ILogger& logger_;
+    json stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {{"active", active_},
+                {"queued_interactive", interactive_.size()},
+                {"queued_batch", batch_.size()},
+                {"rejected", rejected_},
+                {"max_active", limits_.max_active},
+                {"max_queued", limits_.max_queued}};
+    }
 
-    static void log_request(ILogger& logger, const json& request)
+  private:
+    /// Weight of the latest run in the average duration used for Retry-After.
+    static constexpr double kDurationSmoothing = 0.2;
+
+    std::deque<std::uint64_t>& queue_for(Priority priority)
     {
-        logger.info("Incoming request: " + request.dump());
+        return priority == Priority::Interactive ? interactive_ : batch_;
     }
 
-    static bool read_bool(const json& params, const char* key, bool& out, ParseError& err)
+    std::size_t queued_locked() const
     {
-        const auto it = params.find(key);
-        if (it == params.end() || it->is_null())
-        {
-            return true;
-        }
-        if (!it->is_boolean())
-        {
-            err = {"InvalidParams", std::string("Expected boolean for '") + key + "'."};
-            return false;
-        }
-        out = it->get<bool>();
-        return true;
+        return interactive_.size() + batch_.size();
     }
 
-    static bool read_string(const json& params, const char* key, std::string& out, ParseError& err)
+    bool is_next_locked(const Ticket& ticket) const
     {
-        const auto it = params.find(key);
-        if (it == params.end() || it->is_null())
+        if (active_ >= limits_.max_active)
         {
-            return true;
+            return false;
         }
-        if (!it->is_string())
+        if (!interactive_.empty())
         {
-            err = {"InvalidParams", std::string("Expected string for '") + key + "'."};
-            return false;
+            return interactive_.front() == ticket.seq_;
         }
-        out = it->get<std::string>();
-        return true;
+        return !batch_.empty() && batch_.front() == ticket.seq_;
     }
 
-    static bool read_uint64(const json& params, const char* key, uint64_t& out, ParseError& err)
+    bool wait_admitted(Ticket& ticket, const ctrace::process::CancellationToken* cancellation)
     {
-        const auto it = params.find(key);
-        if (it == params.end() || it->is_null())
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (ticket.admitted_)
         {
             return true;
         }
-        if (!it->is_number_unsigned())
+        while (!is_next_locked(ticket))
         {
-            err = {"InvalidParams", std::string("Expected unsigned integer for '") + key + "'."};
-            return false;
+            if (cancellation == nullptr)
+            {
+                cv_.wait(lock);
+                continue;
+            }
+            // A client disconnect is only seen by polling the token, like the tool watchdog.
+            lock.unlock();
+            const bool cancelled = cancellation->cancelled();
+            lock.lock();
+            if (cancelled)
+            {
+                return false;
+            }
+            cv_.wait_for(lock, ctrace::process::ChildWatchdog::kTick);
         }
-        out = it->get<uint64_t>();
+        queue_for(ticket.priority_).pop_front();
+        ++active_;
+        ticket.admitted_ = true;
+        ticket.started_ = std::chrono::steady_clock::now();
+        // The next waiter may fit too (several slots can free up at once).
+        cv_.notify_all();
         return true;
     }
 
-    static bool read_string_list(const json& params, const char* key, std::vector<std::string>& out,
-                                 ParseError& err)
+    void release(const Ticket& ticket)
     {
-        const auto it = params.find(key);
-        if (it == params.end() || it->is_null())
-        {
-            return true;
-        }
-
-        if (it->is_string())
         {
-            const std::string raw = it->get<std::string>();
-            const auto parts = ctrace_tools::strings::splitByComma(raw);
-            for (const auto part : parts)
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ticket.admitted_)
             {
-                if (!part.empty())
+                --active_;
+                const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - ticket.started_;
+                if (has_samples_)
+                {
+                    average_seconds_ += kDurationSmoothing * (elapsed.count() - average_seconds_);
+                }
+                else
                 {
-                    out.emplace_back(part);
+                    average_seconds_ = elapsed.count();
+                    has_samples_ = true;
                 }
             }
-            return true;
+            else
+            {
+                auto& queue = queue_for(ticket.priority_);
+                queue.erase(std::remove(queue.begin(), queue.end(), ticket.seq_), queue.end());
+            }
         }
+        cv_.notify_all();
+    }
+
+    const Limits limits_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::uint64_t> interactive_;
+    std::deque<std::uint64_t> batch_;
+    std::size_t active_ = 0;
+    std::uint64_t next_seq_ = 0;
+    std::uint64_t rejected_ = 0;
+    double average_seconds_ = 1.0;
+    bool has_samples_ = false;
+};
+
+// ============================================================================
+// Jobs asynchrones (submit_analysis / job_status / job_result)
+// ============================================================================
+
+/**
+ * @brief State and event log of one `submit_analysis` job.
+ *
+ * Events (tool output lines, tool completions and the final state) get increasing `seq`
+ * numbers, so an event stream can resume from any point and several clients can follow the
+ * same job. Only the last kMaxEvents are kept; a reader behind them gets a `truncated` event.
+ */
+class AnalysisJob
+{
+  public:
+    /// Bounds the memory of the retained jobs, whose output may be long.
+    static constexpr std::size_t kMaxEvents = 2048;
+
+    enum class State
+    {
+        Queued,
+        Running,
+        Succeeded,
+        Failed
+    };
+
+    explicit AnalysisJob(std::string id)
+        : id_(std::move(id)), submitted_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~AnalysisJob()
+    {
+        join();
+    }
+
+    AnalysisJob(const AnalysisJob&) = delete;
+    AnalysisJob& operator=(const AnalysisJob&) = delete;
 
-        if (!it->is_array())
+    const std::string& id() const
+    {
+        return id_;
+    }
+
+    void attach_runner(std::thread runner)
+    {
+        runner_ = std::move(runner);
+    }
+
+    /// Token checked by the job's tool runs; `cancel_job` and server shutdown trip it.
+    const std::shared_ptr<ctrace::process::CancellationToken>& cancellation() const
+    {
+        return cancellation_;
+    }
+
+    void join()
+    {
+        if (!runner_.joinable())
         {
-            err = {"InvalidParams", std::string("Expected array or string for '") + key + "'."};
-            return false;
+            return;
         }
-
-        for (const auto& item : *it)
+        if (runner_.get_id() == std::this_thread::get_id())
         {
-            if (!item.is_string())
-            {
-                err = {"InvalidParams",
-                       std::string("Expected string values in '") + key + "' array."};
-                return false;
-            }
-            const std::string value = item.get<std::string>();
-            if (!value.empty())
-            {
-                out.emplace_back(value);
-            }
+            runner_.detach();
+            return;
         }
-        return true;
+        runner_.join();
     }
 
-    static bool apply_bool_fields(const json& params, ParseError& err,
-                                  std::initializer_list<BoolField> fields)
+    void mark_running()
     {
-        for (const auto& field : fields)
-        {
-            if (!read_bool(params, field.key, *field.target, err))
-            {
-                return false;
-            }
-        }
-        return true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = State::Running;
+        started_ = std::chrono::steady_clock::now();
     }
 
-    static bool apply_string_fields(const json& params, ParseError& err,
-                                    std::initializer_list<StringField> fields)
+    void append_event(json event)
     {
-        for (const auto& field : fields)
         {
-            if (!read_string(params, field.key, *field.target, err))
-            {
-                return false;
-            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            push_event_locked(std::move(event));
         }
-        return true;
+        cv_.notify_all();
     }
 
-    static bool apply_uint64_fields(const json& params, ParseError& err,
-                                    std::initializer_list<Uint64Field> fields)
+    void record_tool_completed(const std::string& tool, const std::vector<std::string>& files,
+                               const ctrace::DiagnosticSummary& summary)
     {
-        for (const auto& field : fields)
         {
-            if (!read_uint64(params, field.key, *field.target, err))
-            {
-                return false;
-            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++tools_completed_;
+            summary_.info += summary.info;
+            summary_.warning += summary.warning;
+            summary_.error += summary.error;
+            push_event_locked({{"type", "tool_completed"},
+                               {"tool", tool},
+                               {"files", files},
+                               {"diagnostics_summary",
+                                {{"info", summary.info},
+                                 {"warning", summary.warning},
+                                 {"error", summary.error}}}});
         }
-        return true;
+        cv_.notify_all();
     }
 
-    template <typename ApplyFn>
-    static bool apply_list_param(const json& params, const char* key, ParseError& err,
-                                 ApplyFn&& apply)
+    void succeed(json result)
     {
-        std::vector<std::string> values;
-        if (!read_string_list(params, key, values, err))
-        {
-            return false;
-        }
-        if (!values.empty())
-        {
-            apply(values);
-        }
-        return true;
+        finish(State::Succeeded, std::move(result), json());
+    }
+
+    void fail(const std::string& code, const std::string& message)
+    {
+        finish(State::Failed, json(), {{"code", code}, {"message", message}});
+    }
+
+    bool finished() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return is_finished(state_);
     }
 
-    static std::string join_with_comma(const std::vector<std::string>& items)
+    json status() const
     {
-        std::string joined;
-        for (size_t i = 0; i < items.size(); ++i)
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto end = is_finished(state_) ? finished_ : std::chrono::steady_clock::now();
+        json status = {{"job_id", id_},
+                       {"state", state_name(state_)},
+                       {"elapsed_ms", std::chrono::duration_cast<std::chrono::milliseconds>(
+                                          end - submitted_)
+                                          .count()},
+                       {"events", first_seq_ + events_.size()},
+                       {"tools_completed", tools_completed_},
+                       {"diagnostics_summary",
+                        {{"info", summary_.info},
+                         {"warning", summary_.warning},
+                         {"error", summary_.error}}}};
+        if (state_ == State::Failed)
         {
-            if (i > 0)
-            {
-                joined.push_back(',');
-            }
-            joined.append(items[i]);
+            status["error"] = error_;
         }
-        return joined;
+        return status;
     }
 
-    static bool apply_async_field(const json& params, ctrace::ProgramConfig& config,
-                                  ParseError& err)
+    /**
+     * @brief Copies the final outcome once the job is finished.
+     * @return false while the job is still queued or running.
+     */
+    bool outcome(State& state, json& result, json& error) const
     {
-        bool async_enabled = false;
-        if (!read_bool(params, "async", async_enabled, err))
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!is_finished(state_))
         {
             return false;
         }
-        config.global.hasAsync = async_enabled ? std::launch::async : std::launch::deferred;
+        state = state_;
+        result = result_;
+        error = error_;
         return true;
     }
 
-    static bool apply_ipc_field(const json& params, ctrace::ProgramConfig& config, ParseError& err)
+    /**
+     * @brief Waits up to @p timeout for events from seq @p cursor and appends them to @p out.
+     *
+     * Events already dropped are replaced by one `truncated` event, whose `seq` is that of
+     * the last dropped one.
+     * @return true once every event has been delivered and no more will come.
+     */
+    bool wait_events(std::size_t cursor, std::chrono::milliseconds timeout,
+                     std::vector<json>& out) const
     {
-        std::string ipc_value;
-
-        if (!read_string(params, "ipc", ipc_value, err))
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [&]
+                     { return first_seq_ + events_.size() > cursor || is_finished(state_); });
+        if (cursor < first_seq_)
         {
-            return false;
+            out.push_back({{"type", "truncated"},
+                           {"dropped", first_seq_ - cursor},
+                           {"seq", first_seq_ - 1}});
+            cursor = first_seq_;
         }
-        if (ipc_value.empty())
+        for (std::size_t i = cursor - first_seq_; i < events_.size(); ++i)
         {
-            return true;
-        }
-        if (ipc_value == "serv" || ipc_value == "server")
-        {
-            ipc_value = "serve";
+            out.push_back(events_[i]);
         }
+        return is_finished(state_);
+    }
 
-        const auto& ipc_list = ctrace_defs::IPC_TYPES;
-        if (std::find(ipc_list.begin(), ipc_list.end(), ipc_value) == ipc_list.end())
-        {
-            err = {"InvalidParams", "Invalid IPC type: '" + ipc_value +
-                                        "'. Available IPC types: [" + join_with_comma(ipc_list) +
-                                        "]"};
-            return false;
-        }
-        if (ipc_value == "serve")
+    static const char* state_name(State state)
+    {
+        switch (state)
         {
-            config.global.ipc = "standardIO";
-            return true;
+        case State::Queued:
+            return "queued";
+        case State::Running:
+            return "running";
+        case State::Succeeded:
+            return "succeeded";
+        case State::Failed:
+            return "failed";
         }
+        return "unknown";
+    }
 
-        config.global.ipc = ipc_value;
-        return true;
+  private:
+    static bool is_finished(State state)
+    {
+        return state == State::Succeeded || state == State::Failed;
     }
 
-    static bool build_config_from_params(const json& params, ctrace::ProgramConfig& config,
-                                         ParseError& err)
+    void push_event_locked(json event)
     {
-        if (!params.is_object())
+        event["seq"] = first_seq_ + events_.size();
+        events_.push_back(std::move(event));
+        if (events_.size() > kMaxEvents)
         {
-            err = {"InvalidParams", "Params must be a JSON object."};
-            return false;
+            events_.pop_front();
+            ++first_seq_;
         }
+    }
 
-        if (!apply_bool_fields(params, err,
-                               {
-                                   {"verbose", &config.global.verbose},
-                                   {"quiet", &config.global.quiet},
-                                   {"demangle", &config.global.demangle},
-                                   {"sarif_format", &config.global.hasSarifFormat},
-                                   {"static_analysis", &config.global.hasStaticAnalysis},
-                                   {"dynamic_analysis", &config.global.hasDynamicAnalysis},
-                                   {"include_compdb_deps", &config.global.include_compdb_deps},
-                                   {"timing", &config.global.timing},
-                               }))
+    void finish(State state, json result, json error)
+    {
         {
-            return false;
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_ = state;
+            result_ = std::move(result);
+            error_ = std::move(error);
+            finished_ = std::chrono::steady_clock::now();
+
+            json done = {{"type", "done"}, {"state", state_name(state_)}};
+            if (state_ == State::Failed)
+            {
+                done["error"] = error_;
+            }
+            push_event_locked(std::move(done));
         }
-        if (!apply_async_field(params, config, err))
+        cv_.notify_all();
+    }
+
+    const std::string id_;
+    std::thread runner_;
+    std::shared_ptr<ctrace::process::CancellationToken> cancellation_ =
+        std::make_shared<ctrace::process::CancellationToken>();
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cv_;
+    State state_ = State::Queued;
+    std::chrono::steady_clock::time_point submitted_;
+    std::chrono::steady_clock::time_point started_;
+    std::chrono::steady_clock::time_point finished_;
+    std::deque<json> events_;
+    std::size_t first_seq_ = 0; ///< seq of events_.front(); the earlier ones were dropped.
+    std::size_t tools_completed_ = 0;
+    ctrace::DiagnosticSummary summary_{};
+    json result_;
+    json error_;
+};
+
+// ============================================================================
+// API / Contrôleur : gestion du protocole JSON-RPC-like
+// ============================================================================
+
+class ApiHandler
+{
+  public:
+    /**
+     * @param worker_threads Size of the pool shared by every request (0 = one per core).
+     *        Workers are started here, once, and stay warm for the server's lifetime.
+     * @param admission Limits on analyses running or waiting at once, across `run_analysis`
+     *        requests and `submit_analysis` jobs. `max_active == 0` means one per worker:
+     *        every admitted or queued job holds a driver thread, so the server never runs
+     *        unbounded.
+     */
+    explicit ApiHandler(ILogger& logger, std::string result_cache_dir = {},
+                        std::string runtime_history = {}, std::size_t worker_threads = 0,
+                        AdmissionController::Limits admission = {})
+        : logger_(logger), result_cache_dir_(std::move(result_cache_dir)),
+          runtime_history_(std::move(runtime_history)),
+          worker_threads_(resolve_worker_count(worker_threads)),
+          worker_pool_(std::make_shared<ThreadPool>(worker_threads_)),
+          admission_(resolve_admission(admission, worker_threads_))
+    {
+        logger_.info("Analysis worker pool started with " + std::to_string(worker_threads_) +
+                     " workers.");
+    }
+
+    ~ApiHandler()
+    {
+        // Jobs still running are cancelled and joined before the worker pool goes away.
+        cancel_all();
+        std::vector<std::shared_ptr<AnalysisJob>> jobs;
         {
-            return false;
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            for (const auto& [_, job] : jobs_)
+            {
+                jobs.push_back(job);
+            }
         }
-        std::string configPath;
-        if (!read_string(params, "config", configPath, err))
+        for (const auto& job : jobs)
         {
-            return false;
+            job->join();
         }
-        if (!configPath.empty())
+    }
+
+    ApiHandler(const ApiHandler&) = delete;
+    ApiHandler& operator=(const ApiHandler&) = delete;
+
+    /**
+     * @brief Looks up a job created by `submit_analysis`; nullptr when unknown or evicted.
+     */
+    std::shared_ptr<AnalysisJob> find_job(const std::string& job_id) const
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        const auto it = jobs_.find(job_id);
+        return it == jobs_.end() ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Cancels every running analysis: jobs not started yet are skipped and running
+     *        external tools are killed.
+     */
+    void cancel_all()
+    {
+        std::vector<std::shared_ptr<ctrace::process::CancellationToken>> tokens;
         {
-            std::string toolConfigError;
-            if (!ctrace::applyToolConfigFile(config, configPath, toolConfigError))
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            for (const auto& [_, job] : jobs_)
             {
-                err = {"InvalidParams", "Failed to load config: " + toolConfigError};
-                return false;
+                tokens.push_back(job->cancellation());
             }
-            config.global.config_file = configPath;
-        }
-        if (!apply_string_fields(
-                params, err,
+            for (const auto& weak : active_requests_)
+            {
+                if (auto token = weak.lock())
                 {
-                    {"report_file", &config.global.report_file},
-                    {"output_file", &config.global.output_file},
-                    {"config", &config.global.config_file},
-                    {"compile_commands", &config.global.compile_commands},
-                    {"analysis_profile", &config.global.analysis_profile},
-                    {"smt", &config.global.smt},
-                    {"smt_backend", &config.global.smt_backend},
-                    {"smt_secondary_backend", &config.global.smt_secondary_backend},
-                    {"smt_mode", &config.global.smt_mode},
-                    {"resource_model", &config.global.resource_model},
-                    {"escape_model", &config.global.escape_model},
-                    {"buffer_model", &config.global.buffer_model},
-                    {"stack_analyzer_mode", &config.global.stack_analyzer_mode},
-                    {"stack_analyzer_output_format", &config.global.stack_analyzer_output_format},
-                    {"ipc_path", &config.global.ipcPath},
-                }))
-        {
-            return false;
+                    tokens.push_back(std::move(token));
+                }
+            }
         }
-        uint64_t smt_timeout = config.global.smt_timeout_ms;
-        uint64_t smt_budget = config.global.smt_budget_nodes;
-        uint64_t stack_limit = config.global.stack_limit;
-        if (!apply_uint64_fields(params, err,
-                                 {
-                                     {"smt_timeout_ms", &smt_timeout},
-                                     {"smt_budget_nodes", &smt_budget},
-                                     {"stack_limit", &stack_limit},
-                                 }))
+        for (const auto& token : tokens)
         {
-            return false;
+            token->cancel();
         }
-        if (smt_timeout > std::numeric_limits<uint32_t>::max())
+        admission_.wake_waiters();
+    }
+
+    /**
+     * @param client_gone Polled while a synchronous `run_analysis` runs; returning true
+     *        (e.g. the HTTP client disconnected) cancels the analysis.
+     */
+    json handle_request(const json& request, std::function<bool()> client_gone = {})
+    {
+        log_request(logger_, request);
+
+        json response;
+        response["proto"] = request.value("proto", std::string("coretrace-1.0"));
+        response["id"] = request.value("id", 0);
+        response["type"] = "response";
+
+        std::string method = request.value("method", "");
+        json params = request.value("params", json::object());
+
+        if (method == "run_analysis")
         {
-            err = {"InvalidParams", "smt_timeout_ms is too large."};
-            return false;
+            return handle_run_analysis(response, params, std::move(client_gone));
         }
-        config.global.smt_timeout_ms = static_cast<uint32_t>(smt_timeout);
-        config.global.smt_budget_nodes = smt_budget;
-        config.global.stack_limit = stack_limit;
-        if (!apply_list_param(params, "entry_points", err,
-                              [&](const std::vector<std::string>& values)
-                              { config.global.entry_points = join_with_comma(values); }))
+        if (method == "submit_analysis")
         {
-            return false;
+            return handle_submit_analysis(response, params);
         }
-        if (!apply_list_param(params, "invoke", err,
-                              [&](const std::vector<std::string>& values)
-                              {
-                                  config.global.hasInvokedSpecificTools = true;
-                                  config.global.specificTools = values;
-                              }))
+        if (method == "job_status")
         {
-            return false;
+            return handle_job_status(response, params);
         }
-        if (!apply_list_param(params, "smt_rules", err, [&](const std::vector<std::string>& values)
-                              { config.global.smt_rules = values; }))
+        if (method == "job_result")
         {
-            return false;
+            return handle_job_result(response, params);
         }
-        if (!apply_list_param(params, "stack_analyzer_extra_args", err,
-                              [&](const std::vector<std::string>& values)
-                              { config.global.stack_analyzer_extra_args = values; }))
+        if (method == "cancel_job")
         {
-            return false;
+            return handle_cancel_job(response, params);
         }
-        if (!apply_list_param(params, "input", err,
-                              [&](const std::vector<std::string>& values)
-                              {
-                                  for (const auto& file : values)
-                                  {
-                                      if (!file.empty())
-                                      {
-                                          config.addFile(file);
-                                      }
-                                  }
-                              }))
+
+        // Méthode inconnue
+        response["status"] = "error";
+        response["error"] = {{"code", "UnknownMethod"}, {"message", "Unknown method: " + method}};
+        return response;
+    }
+
+  private:
+    /// Finished jobs kept for job_status/job_result; older ones are evicted first.
+    static constexpr std::size_t kMaxRetainedJobs = 256;
+
+    using ParseError = ctrace::ipc::ParseError;
+
+    ILogger& logger_;
+    std::string result_cache_dir_;
+    std::string runtime_history_;
+    std::size_t worker_threads_;
+    std::shared_ptr<ThreadPool> worker_pool_;
+    AdmissionController admission_;
+    mutable std::mutex jobs_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<AnalysisJob>> jobs_;
+    std::deque<std::string> job_order_;
+    /// Tokens of synchronous run_analysis requests in progress (guarded by jobs_mutex_).
+    std::vector<std::weak_ptr<ctrace::process::CancellationToken>> active_requests_;
+    std::uint64_t job_counter_ = 0;
+    std::mt19937_64 job_id_rng_{std::random_device{}()};
+
+    static void log_request(ILogger& logger, const json& request)
+    {
+        logger.info("Incoming request: " + request.dump());
+    }
+
+    static std::size_t resolve_worker_count(std::size_t requested)
+    {
+        if (requested != 0)
         {
-            return false;
+            return requested;
         }
-        if (!apply_ipc_field(params, config, err))
+        const unsigned int threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 1 : threads;
+    }
+
+    static AdmissionController::Limits resolve_admission(AdmissionController::Limits limits,
+                                                         std::size_t worker_threads)
+    {
+        if (limits.max_active == 0)
         {
-            return false;
+            limits.max_active = worker_threads;
         }
-
-        return true;
+        return limits;
     }
 
-    static bool run_analysis(const ctrace::ProgramConfig& config, ILogger& logger, json& result,
-                             ParseError& err)
+    static bool check_analysis_selected(const ctrace::ProgramConfig& config, ParseError& err)
     {
         if (!config.global.hasStaticAnalysis && !config.global.hasDynamicAnalysis &&
             !config.global.hasInvokedSpecificTools)
@@ -478,19 +731,66 @@ class ApiHandler
                    "Enable static_analysis, dynamic_analysis, or invoke tools."};
             return false;
         }
+        return true;
+    }
 
-        unsigned int threads = std::thread::hardware_concurrency();
-        if (threads == 0)
+    /**
+     * @brief Returns the message as JSON when a tool printed a JSON document, else as text.
+     */
+    static json output_message(const std::string& message)
+    {
+        const auto first_non_space = message.find_first_not_of(" \t\n\r");
+        if (first_non_space != std::string::npos &&
+            (message[first_non_space] == '{' || message[first_non_space] == '['))
         {
-            threads = 1;
+            json parsed = json::parse(message, nullptr, false);
+            if (!parsed.is_discarded())
+            {
+                return parsed;
+            }
         }
-        if (threads > 255)
+        return message;
+    }
+
+    /**
+     * @param job When set, output lines and tool completions are also published as job
+     *        events while the analysis runs.
+     */
+    static bool
+    run_analysis(const ctrace::ProgramConfig& config, ILogger& logger,
+                 const std::shared_ptr<ThreadPool>& pool, std::size_t pool_size, json& result,
+                 ParseError& err,
+                 const std::shared_ptr<const ctrace::process::CancellationToken>& cancellation,
+                 AnalysisJob* job = nullptr)
+    {
+        if (!check_analysis_selected(config, err))
         {
-            threads = 255;
+            return false;
         }
-        const uint8_t pool_size = static_cast<uint8_t>(threads);
+
+        // Per-request state (config, capture, tool instances) stays in the invoker; the tool
+        // jobs themselves run on the server's shared pool.
         auto output_capture = std::make_shared<ctrace::Thread::Output::CaptureBuffer>();
-        ctrace::ToolInvoker invoker(config, pool_size, config.global.hasAsync, output_capture);
+        ctrace::ToolInvoker invoker(config, pool_size, config.global.hasAsync, output_capture,
+                                    pool);
+        invoker.setCancellationToken(cancellation);
+        // Concurrent requests share report_file: the merged SARIF report goes in the result.
+        invoker.keepReportInMemory();
+        if (job != nullptr)
+        {
+            output_capture->setListener(
+                [job](const std::string& tool, const ctrace::Thread::Output::CapturedLine& line)
+                {
+                    job->append_event({{"type", "output"},
+                                       {"tool", tool},
+                                       {"stream", line.stream},
+                                       {"message", output_message(line.message)}});
+                });
+            invoker.setToolCompletedCallback(
+                [job](const std::string& tool, const std::vector<std::string>& files,
+                      const ctrace::DiagnosticSummary& summary)
+                { job->record_tool_completed(tool, files, summary); });
+        }
         const auto sourceFiles = ctrace::resolveSourceFiles(config);
 
         if (config.global.verbose)
@@ -515,6 +815,24 @@ class ApiHandler
             }
         }
 
+        const bool resolvedAny = !validSourceFiles.empty();
+        if (ctrace::isIncrementalRun(config) && resolvedAny)
+        {
+            std::string changedError;
+            const auto changedPaths = ctrace::collectChangedPaths(config, changedError);
+            if (!changedPaths)
+            {
+                err = {"InvalidParams", changedError};
+                return false;
+            }
+            auto affected =
+                ctrace::selectAffectedSources(config, validSourceFiles, *changedPaths);
+            result["incremental"] = {{"changed_paths", changedPaths->size()},
+                                     {"resolved_files", validSourceFiles.size()}};
+            invoker.setWholeProgramFiles(std::move(validSourceFiles));
+            validSourceFiles = std::move(affected);
+        }
+
         const size_t processed = validSourceFiles.size();
         if (processed > 0)
         {
@@ -531,13 +849,23 @@ class ApiHandler
                 invoker.runSpecificTools(config.global.specificTools, validSourceFiles);
             }
         }
+        else if (resolvedAny)
+        {
+            // Nothing affected by the incremental selection: still answer with a report.
+            invoker.publishEmptyReport();
+        }
 
-        if (processed == 0)
+        if (!resolvedAny)
         {
             err = {"MissingInput",
                    "Input files are required for analysis (or provide --compile-commands)."};
             return false;
         }
+        if (cancellation && cancellation->cancelled())
+        {
+            err = {"Cancelled", "Analysis was cancelled."};
+            return false;
+        }
 
         logger.info("Analysis completed for " + std::to_string(processed) + " file(s).");
 
@@ -546,7 +874,10 @@ class ApiHandler
         result["dynamic_analysis"] = config.global.hasDynamicAnalysis;
         result["invoked_tools"] = config.global.specificTools;
         result["sarif_format"] = config.global.hasSarifFormat;
-        result["report_file"] = config.global.report_file;
+        // With SARIF, no file is written: the merged report is result["sarif_report"].
+        result["report_file"] =
+            config.global.hasSarifFormat ? json(nullptr) : json(config.global.report_file);
+        result["sarif_baseline"] = config.global.sarif_baseline;
         result["config"] = config.global.config_file;
         result["include_compdb_deps"] = config.global.include_compdb_deps;
         result["resource_model"] = config.global.resource_model;
@@ -565,10 +896,34 @@ class ApiHandler
         result["stack_analyzer_mode"] = config.global.stack_analyzer_mode;
         result["stack_analyzer_output_format"] = config.global.stack_analyzer_output_format;
         result["stack_analyzer_extra_args"] = config.global.stack_analyzer_extra_args;
-        const auto diagnosticsSummaryTotal = invoker.diagnosticsSummaryTotal();
-        result["diagnostics_summary_total"] = {{"info", diagnosticsSummaryTotal.info},
-                                               {"warning", diagnosticsSummaryTotal.warning},
-                                               {"error", diagnosticsSummaryTotal.error}};
+        const auto reportSummary = invoker.reportSummary();
+        if (reportSummary)
+        {
+            // Count each merged finding once, as the report does, not once per tool.
+            result["diagnostics_summary_total"] = {{"info", reportSummary->notes},
+                                                   {"warning", reportSummary->warnings},
+                                                   {"error", reportSummary->errors}};
+        }
+        else
+        {
+            const auto diagnosticsSummaryTotal = invoker.diagnosticsSummaryTotal();
+            result["diagnostics_summary_total"] = {{"info", diagnosticsSummaryTotal.info},
+                                                   {"warning", diagnosticsSummaryTotal.warning},
+                                                   {"error", diagnosticsSummaryTotal.error}};
+        }
+        if (reportSummary)
+        {
+            result["sarif_summary"] = {{"results", reportSummary->results},
+                                       {"unique", reportSummary->unique},
+                                       {"error", reportSummary->errors},
+                                       {"warning", reportSummary->warnings},
+                                       {"note", reportSummary->notes},
+                                       {"new", reportSummary->fresh}};
+        }
+        if (const auto reportDocument = invoker.reportDocument())
+        {
+            result["sarif_report"] = json::parse(*reportDocument, nullptr, false);
+        }
         if (output_capture)
         {
             json outputs = json::object();
@@ -576,31 +931,11 @@ class ApiHandler
             for (const auto& [tool, lines] : snapshot)
             {
                 json entries = json::array();
-                for (const auto& line : lines)
+                for (const auto* line : lines)
                 {
                     json entry;
-                    entry["stream"] = line.stream;
-
-                    const auto& message = line.message;
-                    const auto first_non_space = message.find_first_not_of(" \t\n\r");
-                    if (first_non_space != std::string::npos &&
-                        (message[first_non_space] == '{' || message[first_non_space] == '['))
-                    {
-                        json parsed = json::parse(message, nullptr, false);
-                        if (!parsed.is_discarded())
-                        {
-                            entry["message"] = parsed;
-                        }
-                        else
-                        {
-                            entry["message"] = message;
-                        }
-                    }
-                    else
-                    {
-                        entry["message"] = message;
-                    }
-
+                    entry["stream"] = line->stream;
+                    entry["message"] = output_message(line->message);
                     entries.push_back(entry);
                 }
                 outputs[tool] = entries;
@@ -610,30 +945,364 @@ class ApiHandler
         return true;
     }
 
-    json handle_run_analysis(json& baseResponse, const json& params)
+    /**
+     * @brief Per-phase span counts and total milliseconds of one request, for `result.trace`.
+     *
+     * Totals of concurrent phases (tool, queue_wait, ...) add up across threads and can exceed
+     * the request's `run` time.
+     */
+    static json trace_summary(const ctrace::trace::Recorder& recorder)
+    {
+        json phases = json::object();
+        const auto totals = recorder.totals();
+        for (std::size_t i = 0; i < totals.size(); ++i)
+        {
+            if (totals[i].count == 0)
+            {
+                continue;
+            }
+            const auto phase = static_cast<ctrace::trace::Phase>(i);
+            phases[std::string(ctrace::trace::phase_name(phase))] = {
+                {"count", totals[i].count},
+                {"total_ms", static_cast<double>(totals[i].total_ns) / 1e6}};
+        }
+        return {{"phases", phases}};
+    }
+
+    static json error_response(json& baseResponse, const std::string& code,
+                               const std::string& message)
+    {
+        baseResponse["status"] = "error";
+        baseResponse["error"] = {{"code", code}, {"message", message}};
+        return baseResponse;
+    }
+
+    /**
+     * @brief Reads `priority` ("interactive" or "batch"). Without it, single-file analyses
+     * are interactive and anything larger is batch.
+     */
+    static bool read_priority(const json& params, const ctrace::ProgramConfig& config,
+                              AdmissionController::Priority& priority, ParseError& err)
     {
+        std::string value;
+        if (!ctrace::ipc::readStringParam(params, "priority", value, err))
+        {
+            return false;
+        }
+        if (value.empty())
+        {
+            const bool single_file =
+                config.files.size() == 1 && config.global.compile_commands.empty();
+            priority = single_file ? AdmissionController::Priority::Interactive
+                                   : AdmissionController::Priority::Batch;
+            return true;
+        }
+        if (value == "interactive")
+        {
+            priority = AdmissionController::Priority::Interactive;
+            return true;
+        }
+        if (value == "batch")
+        {
+            priority = AdmissionController::Priority::Batch;
+            return true;
+        }
+        err = {"InvalidParams", "priority must be 'interactive' or 'batch'."};
+        return false;
+    }
+
+    json overloaded_response(json& baseResponse)
+    {
+        const unsigned retry_after = admission_.retry_after_seconds();
+        logger_.error("Analysis rejected, server overloaded: " + admission_.stats().dump());
+        baseResponse["status"] = "error";
+        baseResponse["error"] = {{"code", "Overloaded"},
+                                 {"message", "Too many analyses running or queued."},
+                                 {"retry_after_s", retry_after}};
+        return baseResponse;
+    }
+
+    bool prepare_config(const json& params, ctrace::ProgramConfig& config, ParseError& err) const
+    {
+        if (!ctrace::ipc::buildConfigFromParams(params, config, err))
+        {
+            return false;
+        }
+        // The server owns its cache and runtime history; every request shares them.
+        if (!result_cache_dir_.empty())
+        {
+            config.global.result_cache_dir = result_cache_dir_;
+        }
+        if (!runtime_history_.empty())
+        {
+            config.global.runtime_history = runtime_history_;
+        }
+        return true;
+    }
+
+    json handle_run_analysis(json& baseResponse, const json& params,
+                             std::function<bool()> client_gone)
+    {
+        ctrace::trace::Recorder recorder;
+        const ctrace::trace::ScopedRecorder tracing(&recorder);
         ctrace::ProgramConfig config;
         ParseError err;
 
-        if (!build_config_from_params(params, config, err))
+        AdmissionController::Priority priority = AdmissionController::Priority::Batch;
+        if (!prepare_config(params, config, err) || !read_priority(params, config, priority, err))
+        {
+            return error_response(baseResponse, err.code, err.message);
+        }
+
+        // Registered before queueing, so that a disconnect or shutdown also ends the wait.
+        const auto cancellation =
+            std::make_shared<ctrace::process::CancellationToken>(std::move(client_gone));
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            std::erase_if(active_requests_, [](const auto& weak) { return weak.expired(); });
+            active_requests_.push_back(cancellation);
+        }
+        const auto ticket = admission_.reserve(priority);
+        if (!ticket)
+        {
+            return overloaded_response(baseResponse);
+        }
+        {
+            const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::QueueWait, "admission");
+            if (!ticket->wait(cancellation.get()))
+            {
+                return error_response(baseResponse, "Cancelled",
+                                      "Analysis was cancelled before it started.");
+            }
+        }
+
+        json result;
+        bool ok = false;
+        {
+            const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::Run, "run_analysis");
+            ok = run_analysis(config, logger_, worker_pool_, worker_threads_, result, err,
+                              cancellation);
+        }
+        if (!ok)
         {
             baseResponse["status"] = "error";
             baseResponse["error"] = {{"code", err.code}, {"message", err.message}};
             return baseResponse;
         }
 
+        result["trace"] = trace_summary(recorder);
+        baseResponse["status"] = "ok";
+        baseResponse["result"] = result;
+        return baseResponse;
+    }
+
+    json handle_submit_analysis(json& baseResponse, const json& params)
+    {
+        // Config loading happens here; the rest of the job records from its driver thread.
+        auto recorder = std::make_shared<ctrace::trace::Recorder>();
+        std::optional<ctrace::trace::ScopedRecorder> tracing(std::in_place, recorder.get());
+        ctrace::ProgramConfig config;
+        ParseError err;
+
+        // Parameter errors are reported synchronously; analysis errors fail the job.
+        AdmissionController::Priority priority = AdmissionController::Priority::Batch;
+        if (!prepare_config(params, config, err) || !check_analysis_selected(config, err) ||
+            !read_priority(params, config, priority, err))
+        {
+            return error_response(baseResponse, err.code, err.message);
+        }
+        // The queue place is taken now so that overload is reported to the submitter.
+        auto ticket = admission_.reserve(priority);
+        if (!ticket)
+        {
+            return overloaded_response(baseResponse);
+        }
+        tracing.reset();
+
+        auto job = std::make_shared<AnalysisJob>(next_job_id());
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            jobs_.emplace(job->id(), job);
+            job_order_.push_back(job->id());
+        }
+        evict_finished_jobs();
+
+        // Each job gets a driver thread that waits on the shared pool, so neither httplib's
+        // request threads nor pool workers block on a whole analysis.
+        job->attach_runner(std::thread(
+            [this, job, config = std::move(config), ticket = std::move(ticket), recorder]
+            {
+                const ctrace::trace::ScopedRecorder tracing(recorder.get());
+                {
+                    const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::QueueWait,
+                                                         "admission");
+                    (void)ticket->wait(job->cancellation().get());
+                }
+                if (job->cancellation()->cancelled())
+                {
+                    job->fail("Cancelled", "Job was cancelled before it started.");
+                    return;
+                }
+                job->mark_running();
+                json result;
+                ParseError runError;
+                try
+                {
+                    bool ok = false;
+                    {
+                        const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::Run,
+                                                             "run_analysis");
+                        ok = run_analysis(config, logger_, worker_pool_, worker_threads_, result,
+                                          runError, job->cancellation(), job.get());
+                    }
+                    if (ok)
+                    {
+                        result["trace"] = trace_summary(*recorder);
+                        job->succeed(std::move(result));
+                    }
+                    else
+                    {
+                        job->fail(runError.code, runError.message);
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    logger_.error("Job " + job->id() + " failed: " + e.what());
+                    job->fail("AnalysisFailed", e.what());
+                }
+            }));
+
+        logger_.info("Submitted analysis job " + job->id());
+        baseResponse["status"] = "ok";
+        baseResponse["result"] = {{"job_id", job->id()},
+                                  {"state", "queued"},
+                                  {"events", "/api/jobs/" + job->id() + "/events"}};
+        return baseResponse;
+    }
+
+    std::shared_ptr<AnalysisJob> job_from_params(const json& params, ParseError& err) const
+    {
+        const auto it = params.find("job_id");
+        if (it == params.end() || !it->is_string())
+        {
+            err = {"InvalidParams", "job_id must be a string."};
+            return nullptr;
+        }
+        auto job = find_job(it->get<std::string>());
+        if (!job)
+        {
+            err = {"UnknownJob", "Unknown job: " + it->get<std::string>()};
+        }
+        return job;
+    }
+
+    json handle_job_status(json& baseResponse, const json& params)
+    {
+        ParseError err;
+        const auto job = job_from_params(params, err);
+        if (!job)
+        {
+            return error_response(baseResponse, err.code, err.message);
+        }
+        baseResponse["status"] = "ok";
+        baseResponse["result"] = job->status();
+        return baseResponse;
+    }
+
+    json handle_cancel_job(json& baseResponse, const json& params)
+    {
+        ParseError err;
+        const auto job = job_from_params(params, err);
+        if (!job)
+        {
+            return error_response(baseResponse, err.code, err.message);
+        }
+        if (!job->finished())
+        {
+            job->cancellation()->cancel();
+            admission_.wake_waiters();
+            logger_.info("Cancellation requested for job " + job->id());
+        }
+        baseResponse["status"] = "ok";
+        baseResponse["result"] = job->status();
+        return baseResponse;
+    }
+
+    json handle_job_result(json& baseResponse, const json& params)
+    {
+        ParseError err;
+        const auto job = job_from_params(params, err);
+        if (!job)
+        {
+            return error_response(baseResponse, err.code, err.message);
+        }
+
+        AnalysisJob::State state = AnalysisJob::State::Queued;
         json result;
-        if (!run_analysis(config, logger_, result, err))
+        json error;
+        if (!job->outcome(state, result, error))
+        {
+            return error_response(baseResponse, "JobNotFinished",
+                                  "Job " + job->id() + " is still " +
+                                      job->status().value("state", std::string("running")) +
+                                      ".");
+        }
+        if (state == AnalysisJob::State::Failed)
         {
             baseResponse["status"] = "error";
-            baseResponse["error"] = {{"code", err.code}, {"message", err.message}};
+            baseResponse["error"] = error;
             return baseResponse;
         }
-
         baseResponse["status"] = "ok";
         baseResponse["result"] = result;
         return baseResponse;
     }
+
+    std::string next_job_id()
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        static constexpr char kDigits[] = "0123456789abcdef";
+        // The random part keeps ids from being guessed across clients.
+        std::uint64_t token = job_id_rng_();
+        std::string suffix;
+        for (int i = 0; i < 12; ++i, token >>= 4)
+        {
+            suffix.push_back(kDigits[token & 0xF]);
+        }
+        return "job-" + std::to_string(++job_counter_) + "-" + suffix;
+    }
+
+    void evict_finished_jobs()
+    {
+        std::vector<std::shared_ptr<AnalysisJob>> evicted;
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            std::size_t excess = job_order_.size() > kMaxRetainedJobs
+                                     ? job_order_.size() - kMaxRetainedJobs
+                                     : 0;
+            for (auto it = job_order_.begin(); it != job_order_.end() && excess > 0;)
+            {
+                const auto job_it = jobs_.find(*it);
+                if (job_it != jobs_.end() && !job_it->second->finished())
+                {
+                    ++it;
+                    continue;
+                }
+                if (job_it != jobs_.end())
+                {
+                    evicted.push_back(job_it->second);
+                    jobs_.erase(job_it);
+                }
+                it = job_order_.erase(it);
+                --excess;
+            }
+        }
+        // Joined outside the lock; finished runners exit right away.
+        for (const auto& job : evicted)
+        {
+            job->join();
+        }
+    }
 };
 
 // ============================================================================
@@ -674,6 +1343,14 @@ class HttpServer
                          handle_post_api(req, res);
                      });
 
+        // Job event stream: NDJSON, or SSE when the client accepts text/event-stream.
+        server_.Get(R"(/api/jobs/([A-Za-z0-9-]+)/events)",
+                    [this](const httplib::Request& req, httplib::Response& res)
+                    {
+                        set_cors(res);
+                        handle_get_job_events(req, res);
+                    });
+
         // Shutdown endpoint
         server_.Options("/shutdown",
                         [this](const httplib::Request&, httplib::Response& res)
@@ -702,6 +1379,9 @@ class HttpServer
     }
 
   private:
+    /// How long an idle event stream waits before re-checking for shutdown.
+    static constexpr std::chrono::milliseconds kEventPollInterval{1000};
+
     struct InFlightGuard
     {
         explicit InFlightGuard(HttpServer& server) : server_(server)
@@ -737,7 +1417,7 @@ class HttpServer
     static void set_cors(httplib::Response& res)
     {
         res.set_header("Access-Control-Allow-Origin", "*");
-        res.set_header("Access-Control-Allow-Methods", "POST, OPTIONS");
+        res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
     }
 
@@ -811,7 +1491,8 @@ class HttpServer
         {
             if (!shutdown_cv_.wait_for(lock, shutdown_timeout_, done))
             {
-                logger_.error("[SERVER] Shutdown timeout exceeded. Forcing exit.");
+                logger_.error("[SERVER] Shutdown timeout exceeded. Cancelling analyses.");
+                apiHandler_.cancel_all();
             }
         }
         else
@@ -833,6 +1514,14 @@ class HttpServer
         flush_logs();
     }
 
+    /**
+     * @brief Returns a check for a client that went away.
+     */
+    static std::function<bool()> connection_probe(const httplib::Request& req)
+    {
+        return [&req] { return req.is_connection_closed(); };
+    }
+
     void handle_post_api(const httplib::Request& req, httplib::Response& res)
     {
         if (is_shutting_down())
@@ -852,9 +1541,23 @@ class HttpServer
         try
         {
             json request = json::parse(req.body);
-            json response = apiHandler_.handle_request(request);
+            json response = apiHandler_.handle_request(request, connection_probe(req));
 
             res.status = 200;
+            const json* error = response.contains("error") ? &response["error"] : nullptr;
+            const std::string code =
+                error != nullptr ? error->value("code", std::string()) : std::string();
+            if (code == "Overloaded")
+            {
+                res.status = 429;
+                res.set_header("Retry-After",
+                               std::to_string(error->value("retry_after_s", 1U)));
+            }
+            else if (code == "Cancelled")
+            {
+                // Cancelled by shutdown, or because the client went away (nginx's 499).
+                res.status = is_shutting_down() ? 503 : 499;
+            }
             res.set_content(response.dump(), "application/json");
         }
         catch (const std::exception& e)
@@ -872,6 +1575,93 @@ class HttpServer
         }
     }
 
+    static std::size_t parse_event_cursor(const std::string& value)
+    {
+        std::size_t cursor = 0;
+        for (const char c : value)
+        {
+            if (c < '0' || c > '9' || cursor > std::numeric_limits<std::size_t>::max() / 10)
+            {
+                return 0;
+            }
+            cursor = cursor * 10 + static_cast<std::size_t>(c - '0');
+        }
+        return cursor;
+    }
+
+    void handle_get_job_events(const httplib::Request& req, httplib::Response& res)
+    {
+        const std::string job_id = req.matches[1];
+        auto job = apiHandler_.find_job(job_id);
+        if (!job)
+        {
+            json err;
+            err["status"] = "error";
+            err["error"] = {{"code", "UnknownJob"}, {"message", "Unknown job: " + job_id}};
+            res.status = 404;
+            res.set_content(err.dump(), "application/json");
+            return;
+        }
+
+        const bool sse =
+            req.get_header_value("Accept").find("text/event-stream") != std::string::npos;
+
+        // Resume point: ?from=<seq>, or the SSE Last-Event-ID of a reconnecting client.
+        std::size_t cursor = 0;
+        if (req.has_param("from"))
+        {
+            cursor = parse_event_cursor(req.get_param_value("from"));
+        }
+        else if (sse && req.has_header("Last-Event-ID"))
+        {
+            cursor = parse_event_cursor(req.get_header_value("Last-Event-ID")) + 1;
+        }
+
+        if (sse)
+        {
+            res.set_header("Cache-Control", "no-cache");
+        }
+        res.set_chunked_content_provider(
+            sse ? "text/event-stream" : "application/x-ndjson",
+            [this, job, cursor, sse](std::size_t, httplib::DataSink& sink) mutable
+            {
+                std::vector<json> events;
+                const bool complete = job->wait_events(cursor, kEventPollInterval, events);
+                for (const auto& event : events)
+                {
+                    std::string chunk;
+                    if (sse)
+                    {
+                        chunk = "id: " + std::to_string(event.value("seq", cursor)) +
+                                "\nevent: " + event.value("type", std::string("message")) +
+                                "\ndata: " + event.dump() + "\n\n";
+                    }
+                    else
+                    {
+                        chunk = event.dump() + "\n";
+                    }
+                    if (!sink.write(chunk.data(), chunk.size()))
+                    {
+                        return false;
+                    }
+                    cursor = event.value("seq", cursor) + 1;
+                }
+
+                if (complete || is_shutting_down())
+                {
+                    sink.done();
+                    return true;
+                }
+                if (events.empty() && sse)
+                {
+                    // Comment line: keeps proxies from closing an idle stream.
+                    static constexpr char kKeepAlive[] = ": keep-alive\n\n";
+                    return sink.write(kKeepAlive, sizeof(kKeepAlive) - 1);
+                }
+                return true;
+            });
+    }
+
     void handle_post_shutdown(const httplib::Request& req, httplib::Response& res)
     {
         if (!is_authorized_shutdown(req))
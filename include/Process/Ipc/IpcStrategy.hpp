@@ -2,6 +2,7 @@
 #ifndef IPC_STRATEGY_HPP
 #define IPC_STRATEGY_HPP
 
+#include <mutex>
 #include <regex>
 
 #include "../ProcessFactory.hpp"
@@ -39,6 +40,7 @@ class UnixSocketStrategy : public IpcStrategy
   private:
     int sock;
     std::string path;
+    std::mutex writeMutex; // tools running in parallel share the socket
 
   public:
     UnixSocketStrategy(const std::string& socketPath) : path(socketPath), sock(-1)
@@ -63,6 +65,7 @@ class UnixSocketStrategy : public IpcStrategy
     }
     void write(const std::string& data) override
     {
+        std::lock_guard<std::mutex> lock(writeMutex);
         if (sock == -1)
         {
             throw ctrace::ipc::SocketError(std::string("Socket is not connected: ") +
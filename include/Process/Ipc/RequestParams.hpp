@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef PROCESS_IPC_REQUEST_PARAMS_HPP
+#define PROCESS_IPC_REQUEST_PARAMS_HPP
+
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "Config/config.hpp"
+#include "attributes.hpp"
+
+namespace ctrace::ipc
+{
+    /// Why a server request was rejected: an API error code and a message.
+    struct ParseError
+    {
+        std::string code;
+        std::string message;
+    };
+
+    /**
+     * @brief Builds the config of a `run_analysis` or `submit_analysis` request from its
+     * `params`, without running anything.
+     *
+     * @return false with @p err set when the params are invalid.
+     */
+    CT_NODISCARD bool buildConfigFromParams(const nlohmann::json& params, ProgramConfig& config,
+                                            ParseError& err);
+
+    /**
+     * @brief Reads the optional string @p key of @p params into @p out; absent and null
+     * values leave @p out unchanged.
+     *
+     * @return false with @p err set when the value is not a string.
+     */
+    CT_NODISCARD bool readStringParam(const nlohmann::json& params, const char* key,
+                                      std::string& out, ParseError& err);
+} // namespace ctrace::ipc
+
+#endif // PROCESS_IPC_REQUEST_PARAMS_HPP
@@ -4,12 +4,19 @@
 #include <iostream>
 #include <unistd.h>
 #include <sys/wait.h>
-#include <fcntl.h>
-#include <cstdio>
+#include <cerrno>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
+#include <signal.h>
+#include <sys/resource.h>
+#include "ExecutionControl.hpp"
+#include "OutputPipe.hpp"
 #include "Process.hpp"
 #include "ThreadProcess.hpp"
+#include "Trace.hpp"
 #include <mutex>
+#include <optional>
 #include <iostream>
 
 class UnixProcess : public Process
@@ -31,55 +38,123 @@ class UnixProcess : public Process
     {
         ctrace::Thread::Output::cout("Running Unix/Linux process");
 
-        char log_template[] = "/tmp/ctrace_process_log_XXXXXX";
-        int logFd = mkstemp(log_template);
-        if (logFd == -1)
+        // Built before fork(): the child of a multithreaded parent must not allocate.
+        std::vector<char*> execArgs;
+        execArgs.push_back(const_cast<char*>(m_command.c_str()));
+        for (auto& arg : m_arguments)
         {
-            throw std::runtime_error("Failed to create log file");
+            execArgs.push_back(const_cast<char*>(arg.c_str()));
         }
-        log_path_ = log_template;
+        execArgs.push_back(nullptr);
 
+        const ctrace::process::ExecutionControl* control = ctrace::process::current_control;
+        const bool ownGroup =
+            control != nullptr && (!control->limits.empty() || control->cancellation);
+        rlimit cpuLimit{};
+        const bool limitCpu = control != nullptr && control->limits.cpu_seconds != 0;
+        if (limitCpu)
+        {
+            cpuLimit.rlim_cur = static_cast<rlim_t>(control->limits.cpu_seconds);
+            cpuLimit.rlim_max = static_cast<rlim_t>(control->limits.cpu_seconds + 1);
+        }
+
+        int pipeFds[2];
+        if (!ctrace::process::openOutputPipe(pipeFds))
+        {
+            throw std::runtime_error("Failed to create output pipe: " +
+                                     std::string(strerror(errno)));
+        }
+
+        std::optional<ctrace::trace::ScopedSpan> spawnSpan(std::in_place,
+                                                           ctrace::trace::Phase::Spawn, m_command);
         pid_t pid = fork();
         if (pid == -1)
         {
-            close(logFd);
+            close(pipeFds[0]);
+            close(pipeFds[1]);
             throw std::runtime_error("Failed to fork process");
         }
 
         if (pid == 0)
         {
-            std::vector<char*> execArgs;
-            execArgs.push_back(const_cast<char*>(m_command.c_str()));
-            for (auto& arg : m_arguments)
+            dup2(pipeFds[1], STDOUT_FILENO);
+            if (capture_stderr_)
             {
-                execArgs.push_back(const_cast<char*>(arg.c_str()));
+                dup2(pipeFds[1], STDERR_FILENO);
+            }
+            close(pipeFds[0]);
+            close(pipeFds[1]);
+            if (ownGroup)
+            {
+                setpgid(0, 0);
+            }
+            if (limitCpu)
+            {
+                setrlimit(RLIMIT_CPU, &cpuLimit);
             }
-            execArgs.push_back(nullptr);
-
-            dup2(logFd, STDOUT_FILENO);
-            dup2(logFd, STDERR_FILENO);
-            close(logFd);
 
             execvp(m_command.c_str(), execArgs.data());
             _exit(EXIT_FAILURE);
         }
-        else
+
+        close(pipeFds[1]);
+        if (ownGroup)
         {
-            close(logFd);
-            int status;
-            waitpid(pid, &status, 0);
-            captureLogs();
+            setpgid(pid, pid); // Also set in the child; whichever runs first wins.
+            ctrace::process::process_groups::add(pid);
+        }
+        spawnSpan.reset();
+        ctrace::process::ChildWatchdog watchdog(pid, control);
+        const ctrace::trace::ScopedSpan captureSpan(ctrace::trace::Phase::Capture, m_command);
+        std::string abortReason;
+        try
+        {
+            const bool finished = ctrace::process::drainOutputPipe(
+                pipeFds[0], [this](const char* data, std::size_t size)
+                { appendOutput(data, size); }, [&watchdog] { return watchdog.expired(); },
+                watchdog.active() ? static_cast<int>(ctrace::process::ChildWatchdog::kTick.count())
+                                  : -1);
+            if (!finished)
+            {
+                abortReason = watchdog.reason();
+                kill(ownGroup ? -pid : pid, SIGKILL);
+            }
+        }
+        catch (...)
+        {
+            kill(ownGroup ? -pid : pid, SIGKILL);
+            close(pipeFds[0]);
+            waitpid(pid, nullptr, 0);
+            ctrace::process::process_groups::remove(pid);
+            throw;
+        }
+        close(pipeFds[0]);
+
+        int status = 0;
+        rusage usage{};
+        while (wait4(pid, &status, 0, &usage) == -1 && errno == EINTR)
+        {
+        }
+        ctrace::process::process_groups::remove(pid);
+        exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        if (control != nullptr)
+        {
+            control->record_peak_rss(usage);
+        }
+        if (abortReason.empty() && limitCpu && WIFSIGNALED(status) &&
+            (WTERMSIG(status) == SIGXCPU || WTERMSIG(status) == SIGKILL))
+        {
+            abortReason = "exceeded cpu_seconds";
+        }
+        if (!abortReason.empty())
+        {
+            throw std::runtime_error(m_command + " " + abortReason);
         }
     }
 
     void cleanup() override
     {
         ctrace::Thread::Output::cout("Cleaning up Unix/Linux process");
-        if (!log_path_.empty())
-        {
-            unlink(log_path_.c_str());
-            log_path_.clear();
-        }
     }
 
     void prepareArguments() override
@@ -91,31 +166,9 @@ class UnixProcess : public Process
 
     void captureLogs() override
     {
-        ctrace::Thread::Output::cout("Capturing logs from process file");
-        if (log_path_.empty())
-        {
-            return;
-        }
-        FILE* logFile = fopen(log_path_.c_str(), "r");
-        if (!logFile)
-        {
-            throw std::runtime_error("Failed to open log file");
-        }
-
-        char buffer[1024];
-        logOutput.clear();
-        while (fgets(buffer, sizeof(buffer), logFile))
-        {
-            logOutput += buffer;
-        }
-        fclose(logFile);
-        unlink(log_path_.c_str());
-        log_path_.clear();
-
-        // std::cout << "Logs captured: " << logOutput << "\n";
+        // Output is streamed into logOutput while the child runs.
     }
 
   private:
     std::string m_command;
-    std::string log_path_;
 };
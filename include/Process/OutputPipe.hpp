@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ctrace::process
+{
+    /// Read size per wakeup; verbose tools fill the pipe quickly.
+    inline constexpr std::size_t kOutputChunkSize = 64 * 1024;
+
+    /**
+     * @brief Opens the pipe a child writes its stdout/stderr into.
+     *
+     * Both ends are close-on-exec so that children spawned concurrently by other threads do
+     * not inherit them (an inherited write end would delay EOF until that child exits).
+     */
+    inline bool openOutputPipe(int (&fds)[2])
+    {
+#if defined(__linux__)
+        return pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (pipe(fds) != 0)
+        {
+            return false;
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Reads @p fd until EOF, handing each chunk to @p sink as it arrives.
+     *
+     * With @p tickMs >= 0, @p stop is also polled at least every @p tickMs milliseconds.
+     * @return false when @p stop asked to abort before EOF.
+     * @throws std::runtime_error when poll() or read() fails: the output would be truncated,
+     *         so callers kill the child instead of reporting a success.
+     */
+    template <typename Sink, typename Stop>
+    bool drainOutputPipe(int fd, Sink&& sink, Stop&& stop, int tickMs)
+    {
+        std::vector<char> chunk(kOutputChunkSize);
+        pollfd pfd{fd, POLLIN, 0};
+        const auto tick = std::chrono::milliseconds(tickMs);
+        auto nextCheck = std::chrono::steady_clock::now() + tick;
+        while (true)
+        {
+            const int ready = poll(&pfd, 1, tickMs);
+            if (ready == -1 && errno != EINTR)
+            {
+                throw std::runtime_error("Failed to poll child output: " +
+                                         std::string(std::strerror(errno)));
+            }
+            // Checked on a schedule rather than per read, so chatty children stay cheap.
+            if (tickMs >= 0 && std::chrono::steady_clock::now() >= nextCheck)
+            {
+                if (stop())
+                {
+                    return false;
+                }
+                nextCheck = std::chrono::steady_clock::now() + tick;
+            }
+            if (ready <= 0)
+            {
+                continue;
+            }
+            const ssize_t bytesRead = read(fd, chunk.data(), chunk.size());
+            if (bytesRead > 0)
+            {
+                sink(chunk.data(), static_cast<std::size_t>(bytesRead));
+                continue;
+            }
+            if (bytesRead == -1)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                {
+                    continue;
+                }
+                throw std::runtime_error("Failed to read child output: " +
+                                         std::string(std::strerror(errno)));
+            }
+            break; // EOF: every copy of the write end is closed.
+        }
+        return true;
+    }
+
+    template <typename Sink> void drainOutputPipe(int fd, Sink&& sink)
+    {
+        drainOutputPipe(fd, std::forward<Sink>(sink), [] { return false; }, -1);
+    }
+} // namespace ctrace::process
@@ -2,23 +2,55 @@
 #ifndef PROCESS_HPP
 #define PROCESS_HPP
 
+#include <cstddef>
+#include <functional>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
 class Process
 {
   public:
+    /// Receives each complete output line (without its newline) as the child produces it.
+    using LineHandler = std::function<void(std::string_view line)>;
+
     virtual ~Process() = default;
 
     void execute(void)
     {
+        logOutput.clear();
+        pending_line_start_ = 0;
         prepare();
         run();
         cleanup();
+        flushPendingLine();
+    }
+
+    /**
+     * @brief Streams output lines to @p handler while the process runs.
+     *
+     * `logOutput` still receives the full output. The handler runs on the thread that called
+     * `execute()`.
+     */
+    void setLineHandler(LineHandler handler)
+    {
+        line_handler_ = std::move(handler);
+    }
+
+    /**
+     * @brief Leaves the child's stderr on ours instead of capturing it into `logOutput`.
+     *
+     * For commands whose stdout is parsed, so that warnings cannot be mistaken for data.
+     */
+    void setCaptureStderr(bool capture)
+    {
+        capture_stderr_ = capture;
     }
 
     std::string logOutput;
+    int exitCode = -1; ///< Exit status of the last run, -1 if it did not exit normally.
 
   protected:
     virtual void prepare() = 0;
@@ -28,8 +60,46 @@ class Process
     virtual void prepareArguments() = 0;
     virtual void captureLogs() = 0;
 
+    /**
+     * @brief Appends child output to `logOutput` and hands completed lines to the handler.
+     */
+    void appendOutput(const char* data, std::size_t size)
+    {
+        logOutput.append(data, size);
+        if (!line_handler_)
+        {
+            return;
+        }
+        std::size_t newline;
+        while ((newline = logOutput.find('\n', pending_line_start_)) != std::string::npos)
+        {
+            std::string_view line(logOutput.data() + pending_line_start_,
+                                  newline - pending_line_start_);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+            line_handler_(line);
+            pending_line_start_ = newline + 1;
+        }
+    }
+
     std::vector<std::string> m_arguments;
     std::stringstream log_buffer;
+    bool capture_stderr_ = true;
+
+  private:
+    void flushPendingLine()
+    {
+        if (line_handler_ && pending_line_start_ < logOutput.size())
+        {
+            line_handler_(std::string_view(logOutput).substr(pending_line_start_));
+        }
+        pending_line_start_ = logOutput.size();
+    }
+
+    LineHandler line_handler_;
+    std::size_t pending_line_start_ = 0; ///< Start of the line not yet handed to the handler.
 };
 
 #endif // PROCESS_HPP
@@ -31,7 +31,8 @@ class ProcessFactory
          * @return A `std::unique_ptr<Process>` pointing to the created process instance.
          *
          * @note The method uses preprocessor directives to select the appropriate
-         *       implementation for Windows, Linux, or macOS.
+         *       implementation for Windows, Linux, or macOS. Linux uses posix_spawn; macOS
+         *       keeps the fork-based `UnixProcess`.
          */
     static std::unique_ptr<Process> createProcess(const std::string& command,
                                                   const std::vector<std::string>& args = {})
@@ -41,7 +42,8 @@ class ProcessFactory
         return std::make_unique<WindowsProcess>(command, args);
 #elif defined(__linux__)
         ctrace::Thread::Output::cout("Creating Linux process for command: " + command);
-        return std::make_unique<UnixProcess>(command, args);
+        // posix_spawn (vfork-style clone in glibc): launch cost does not grow with our RSS.
+        return std::make_unique<UnixProcessWithPosixSpawn>(command, args);
 #elif defined(__APPLE__)
         ctrace::Thread::Output::cout("Creating macOS process for command: " + command);
         // return std::make_unique<UnixProcessWithPosixSpawn>(command, args); // doesn't work with tscancode
@@ -0,0 +1,384 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+namespace ctrace::detail
+{
+    /**
+     * @brief Chase-Lev work-stealing deque.
+     *
+     * The owning worker pushes and pops at the bottom without taking any lock;
+     * other workers steal from the top with a single CAS. The ring grows on
+     * demand and retired rings are kept alive until the deque is destroyed so
+     * that a concurrent thief never reads freed memory.
+     *
+     * Memory orderings follow "Correct and Efficient Work-Stealing for Weak
+     * Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+     */
+    template <typename T> class WorkStealingDeque
+    {
+      public:
+        explicit WorkStealingDeque(std::int64_t capacity = 256)
+        {
+            auto ring = std::make_unique<Ring>(capacity);
+            ring_.store(ring.get(), std::memory_order_relaxed);
+            rings_.push_back(std::move(ring));
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Owner thread only.
+        void push(T* item)
+        {
+            const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t top = top_.load(std::memory_order_acquire);
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+
+            if (bottom - top > ring->capacity - 1)
+            {
+                auto grown = ring->grow(top, bottom);
+                ring = grown.get();
+                rings_.push_back(std::move(grown));
+                ring_.store(ring, std::memory_order_release);
+            }
+
+            ring->put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // Owner thread only.
+        T* pop()
+        {
+            const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = ring->get(bottom);
+            if (top == bottom)
+            {
+                // Last element: race against thieves for it.
+                if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Any thread.
+        T* steal()
+        {
+            std::int64_t top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+            {
+                return nullptr;
+            }
+
+            Ring* ring = ring_.load(std::memory_order_acquire);
+            T* item = ring->get(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return item;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t top = top_.load(std::memory_order_relaxed);
+            return bottom <= top;
+        }
+
+      private:
+        struct Ring
+        {
+            explicit Ring(std::int64_t cap)
+                : capacity(cap), mask(cap - 1), slots(new std::atomic<T*>[cap])
+            {
+            }
+
+            [[nodiscard]] T* get(std::int64_t index) const
+            {
+                return slots[index & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t index, T* item)
+            {
+                slots[index & mask].store(item, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] std::unique_ptr<Ring> grow(std::int64_t top, std::int64_t bottom) const
+            {
+                auto grown = std::make_unique<Ring>(capacity * 2);
+                for (std::int64_t i = top; i < bottom; ++i)
+                {
+                    grown->put(i, get(i));
+                }
+                return grown;
+            }
+
+            std::int64_t capacity;
+            std::int64_t mask;
+            std::unique_ptr<std::atomic<T*>[]> slots;
+        };
+
+        alignas(64) std::atomic<std::int64_t> top_{0};
+        alignas(64) std::atomic<std::int64_t> bottom_{0};
+        std::atomic<Ring*> ring_{nullptr};
+        std::vector<std::unique_ptr<Ring>> rings_; // owner-only; keeps retired rings alive
+    };
+} // namespace ctrace::detail
+
+/**
+ * @brief Work-stealing thread pool.
+ *
+ * Each worker owns a lock-free deque. Tasks submitted from a worker go to that
+ * worker's deque; tasks submitted from outside the pool go to a shared
+ * injection queue that idle workers drain in batches. A worker that runs dry
+ * steals from a randomly chosen peer before going to sleep.
+ */
+class ThreadPool
+{
+  public:
+    explicit ThreadPool(std::size_t numThreads)
+    {
+        if (numThreads == 0)
+        {
+            numThreads = 1;
+        }
+
+        queues.reserve(numThreads);
+        for (std::size_t i = 0; i < numThreads; ++i)
+        {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        workers.reserve(numThreads);
+        for (std::size_t i = 0; i < numThreads; ++i)
+        {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            stopping.store(true, std::memory_order_seq_cst);
+        }
+        idleCondition.notify_all();
+        for (auto& worker : workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    template <typename F> auto enqueue(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using return_type = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(f));
+
+        std::future<return_type> res = task->get_future();
+        if (stopping.load(std::memory_order_acquire))
+        {
+            throw std::runtime_error("Enqueue on stopped ThreadPool");
+        }
+        submit(std::make_unique<Task>([task]() { (*task)(); }));
+        return res;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return workers.size();
+    }
+
+  private:
+    using Task = std::function<void()>;
+
+    struct WorkerQueue
+    {
+        ctrace::detail::WorkStealingDeque<Task> deque;
+    };
+
+    void submit(std::unique_ptr<Task> task)
+    {
+        pending.fetch_add(1, std::memory_order_seq_cst);
+
+        if (currentPool == this)
+        {
+            queues[currentIndex]->deque.push(task.release());
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(injectionMutex);
+            injected.push_back(task.release());
+        }
+
+        if (idle.load(std::memory_order_seq_cst) > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+            }
+            idleCondition.notify_one();
+        }
+    }
+
+    Task* takeInjected(std::size_t index)
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (injected.empty())
+        {
+            return nullptr;
+        }
+
+        Task* task = injected.front();
+        injected.pop_front();
+
+        // Move a fair share into our own deque so peers can steal it without
+        // touching the injection lock again.
+        std::size_t share = injected.size() / queues.size();
+        auto& local = queues[index]->deque;
+        while (share-- > 0 && !injected.empty())
+        {
+            local.push(injected.front());
+            injected.pop_front();
+        }
+        return task;
+    }
+
+    Task* stealFromPeers(std::size_t index, std::minstd_rand& rng)
+    {
+        const std::size_t count = queues.size();
+        if (count < 2)
+        {
+            return nullptr;
+        }
+
+        const std::size_t start = rng() % count;
+        for (std::size_t offset = 0; offset < count; ++offset)
+        {
+            const std::size_t victim = (start + offset) % count;
+            if (victim == index)
+            {
+                continue;
+            }
+            if (Task* task = queues[victim]->deque.steal())
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    Task* findTask(std::size_t index, std::minstd_rand& rng)
+    {
+        if (Task* task = queues[index]->deque.pop())
+        {
+            return task;
+        }
+        if (Task* task = takeInjected(index))
+        {
+            return task;
+        }
+        return stealFromPeers(index, rng);
+    }
+
+    void workerLoop(std::size_t index)
+    {
+        currentPool = this;
+        currentIndex = index;
+        std::minstd_rand rng(static_cast<std::minstd_rand::result_type>(index + 1));
+
+        while (true)
+        {
+            if (Task* raw = findTask(index, rng))
+            {
+                pending.fetch_sub(1, std::memory_order_seq_cst);
+                std::unique_ptr<Task> task(raw);
+                (*task)();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idle.fetch_add(1, std::memory_order_seq_cst);
+            idleCondition.wait(lock,
+                               [this]
+                               {
+                                   return stopping.load(std::memory_order_seq_cst) ||
+                                          pending.load(std::memory_order_seq_cst) > 0;
+                               });
+            idle.fetch_sub(1, std::memory_order_seq_cst);
+            if (stopping.load(std::memory_order_seq_cst) &&
+                pending.load(std::memory_order_seq_cst) == 0)
+            {
+                return;
+            }
+        }
+    }
+
+#if defined(__cpp_lib_jthread) && (__cpp_lib_jthread >= 201911L)
+    using WorkerThread = std::jthread;
+#else
+    using WorkerThread = std::thread;
+#endif
+
+    inline static thread_local ThreadPool* currentPool = nullptr;
+    inline static thread_local std::size_t currentIndex = 0;
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<WorkerThread> workers;
+
+    std::mutex injectionMutex;
+    std::deque<Task*> injected;
+
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<std::size_t> idle{0};
+    std::atomic<bool> stopping{false};
+};
+
+#endif // THREAD_POOL_HPP
@@ -2,13 +2,22 @@
 #ifndef THREAD_PROCESS_HPP
 #define THREAD_PROCESS_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
-#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "ConsoleWriter.hpp"
+
 namespace ctrace
 {
     namespace Thread
@@ -21,25 +30,215 @@ namespace ctrace
                 std::string message;
             };
 
+            /**
+             * @brief Tool output collected during one analysis.
+             *
+             * Every writer thread appends to its own shard of append-only chunks, so `append`
+             * takes no lock and moves the message in. Published lines never move or change
+             * until the buffer is destroyed, which lets `snapshot()` hand out pointers to them
+             * instead of copies.
+             */
             class CaptureBuffer
             {
+                struct Entry
+                {
+                    CapturedLine line;
+                    const std::string* tool = nullptr;
+                    std::uint64_t seq = 0;
+                };
+
+                static constexpr std::size_t kChunkLines = 256;
+
+                struct Chunk
+                {
+                    std::array<Entry, kChunkLines> entries;
+                    std::atomic<std::size_t> size{0};
+                    std::atomic<Chunk*> next{nullptr};
+                };
+
+                /// Written by one thread only; readers see entries below each chunk's `size`.
+                struct Shard
+                {
+                    std::thread::id owner;
+                    std::unique_ptr<Chunk> head = std::make_unique<Chunk>();
+                    Chunk* tail = head.get();
+                    std::vector<std::unique_ptr<Chunk>> chunks; ///< Owns the chunks after head.
+                    std::vector<std::unique_ptr<std::string>> tools;
+                    const std::string* last_tool = nullptr;
+                    Shard* next = nullptr;
+                };
+
               public:
-                void append(const std::string& tool, const std::string& stream,
-                            const std::string& message)
+                /// Called for every appended line, on the appending thread (server job streaming).
+                using Listener = std::function<void(const std::string& tool,
+                                                    const CapturedLine& line)>;
+
+                /// Lines per tool, in append order. Pointers stay valid while the buffer lives.
+                using Snapshot =
+                    std::unordered_map<std::string, std::vector<const CapturedLine*>>;
+
+                CaptureBuffer() = default;
+                CaptureBuffer(const CaptureBuffer&) = delete;
+                CaptureBuffer& operator=(const CaptureBuffer&) = delete;
+
+                ~CaptureBuffer()
+                {
+                    Shard* shard = shards_.load(std::memory_order_acquire);
+                    while (shard != nullptr)
+                    {
+                        delete std::exchange(shard, shard->next);
+                    }
+                }
+
+                void append(const std::string& tool, std::string stream, std::string message)
+                {
+                    Shard& shard = local_shard();
+                    Chunk* chunk = shard.tail;
+                    std::size_t slot = chunk->size.load(std::memory_order_relaxed);
+                    if (slot == kChunkLines)
+                    {
+                        auto fresh = std::make_unique<Chunk>();
+                        chunk->next.store(fresh.get(), std::memory_order_release);
+                        chunk = fresh.get();
+                        shard.chunks.push_back(std::move(fresh));
+                        shard.tail = chunk;
+                        slot = 0;
+                    }
+
+                    Entry& entry = chunk->entries[slot];
+                    entry.line.stream = std::move(stream);
+                    entry.line.message = std::move(message);
+                    entry.tool = intern_tool(shard, tool);
+                    entry.seq = next_seq_.fetch_add(1, std::memory_order_relaxed);
+                    chunk->size.store(slot + 1, std::memory_order_release);
+
+                    if (listener_)
+                    {
+                        listener_(*entry.tool, entry.line);
+                    }
+                }
+
+                /**
+                 * @brief Installs @p listener. Set it before output starts: it is read without
+                 * a lock by the appending threads.
+                 */
+                void setListener(Listener listener)
                 {
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    lines_[tool].push_back({stream, message});
+                    listener_ = std::move(listener);
                 }
 
-                std::unordered_map<std::string, std::vector<CapturedLine>> snapshot() const
+                /**
+                 * @brief Returns the lines published so far, grouped by tool, without copying
+                 * them. Safe to call while other threads append.
+                 */
+                Snapshot snapshot() const
                 {
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    return lines_;
+                    std::vector<const Entry*> entries;
+                    for (const Shard* shard = shards_.load(std::memory_order_acquire);
+                         shard != nullptr; shard = shard->next)
+                    {
+                        for (const Chunk* chunk = shard->head.get(); chunk != nullptr;
+                             chunk = chunk->next.load(std::memory_order_acquire))
+                        {
+                            const std::size_t size = chunk->size.load(std::memory_order_acquire);
+                            for (std::size_t i = 0; i < size; ++i)
+                            {
+                                entries.push_back(&chunk->entries[i]);
+                            }
+                        }
+                    }
+                    std::sort(entries.begin(), entries.end(),
+                              [](const Entry* a, const Entry* b) { return a->seq < b->seq; });
+
+                    Snapshot lines;
+                    for (const Entry* entry : entries)
+                    {
+                        lines[*entry->tool].push_back(&entry->line);
+                    }
+                    return lines;
                 }
 
               private:
-                mutable std::mutex mutex_;
-                std::unordered_map<std::string, std::vector<CapturedLine>> lines_;
+                /**
+                 * @brief Finds or registers the calling thread's shard.
+                 *
+                 * Each thread caches its last (buffer, shard) pair; buffer ids are never reused,
+                 * so a stale cache entry cannot match a new buffer at the same address.
+                 */
+                Shard& local_shard()
+                {
+                    struct Cached
+                    {
+                        std::uint64_t buffer_id = 0;
+                        Shard* shard = nullptr;
+                    };
+                    thread_local Cached cached;
+                    if (cached.buffer_id == id_)
+                    {
+                        return *cached.shard;
+                    }
+
+                    const auto self = std::this_thread::get_id();
+                    Shard* shard = shards_.load(std::memory_order_acquire);
+                    while (shard != nullptr && shard->owner != self)
+                    {
+                        shard = shard->next;
+                    }
+                    if (shard == nullptr)
+                    {
+                        shard = new Shard();
+                        shard->owner = self;
+                        shard->next = shards_.load(std::memory_order_relaxed);
+                        while (!shards_.compare_exchange_weak(shard->next, shard,
+                                                              std::memory_order_release,
+                                                              std::memory_order_relaxed))
+                        {
+                        }
+                    }
+                    cached = {id_, shard};
+                    return *shard;
+                }
+
+                /// Tool names are stored once per shard; a worker usually repeats the last one.
+                static const std::string* intern_tool(Shard& shard, const std::string& tool)
+                {
+                    if (shard.last_tool != nullptr && *shard.last_tool == tool)
+                    {
+                        return shard.last_tool;
+                    }
+                    for (const auto& known : shard.tools)
+                    {
+                        if (*known == tool)
+                        {
+                            return shard.last_tool = known.get();
+                        }
+                    }
+                    shard.tools.push_back(std::make_unique<std::string>(tool));
+                    return shard.last_tool = shard.tools.back().get();
+                }
+
+                static std::uint64_t next_buffer_id()
+                {
+                    static std::atomic<std::uint64_t> counter{0};
+                    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+                }
+
+                const std::uint64_t id_ = next_buffer_id();
+                std::atomic<Shard*> shards_{nullptr};
+                std::atomic<std::uint64_t> next_seq_{0};
+                Listener listener_;
+            };
+
+            /**
+             * @brief One tool output line as emitted by a single invocation.
+             *
+             * `mirrored` is false for lines that only went to the capture buffer.
+             */
+            struct RecordedLine
+            {
+                std::string stream;
+                std::string message;
+                bool mirrored = true;
             };
 
             struct CaptureContext
@@ -47,9 +246,9 @@ namespace ctrace
                 std::shared_ptr<CaptureBuffer> buffer;
                 std::string tool;
                 bool mirror_to_console = true;
+                std::vector<RecordedLine>* record = nullptr; ///< Per-invocation output copy.
             };
 
-            inline std::mutex cout_mutex;
             inline thread_local const CaptureContext* capture_context = nullptr;
 
             class ScopedCapture
@@ -77,40 +276,80 @@ namespace ctrace
                 bool active_;
             };
 
-            static void emit_line(const std::string& stream, const std::string& message,
-                                  std::ostream& target, bool capture_line)
+            /**
+             * @brief Routes one line to the recorder, the capture buffer and the console.
+             *
+             * @p message is taken by value and moved into its last consumer, so a temporary
+             * line reaches the buffer or the console without a copy. A line that is both
+             * captured and mirrored, or recorded for the result cache, is copied once per
+             * extra consumer.
+             */
+            static void emit_line(const std::string& stream, std::string message,
+                                  ConsoleWriter::Target target, bool capture_line)
             {
                 const CaptureContext* ctx = capture_context;
-                if (capture_line && ctx && ctx->buffer)
+                if (capture_line && ctx)
                 {
-                    ctx->buffer->append(ctx->tool, stream, message);
-                    if (!ctx->mirror_to_console)
+                    if (ctx->record)
                     {
-                        return;
+                        ctx->record->push_back({stream, message, true});
+                    }
+                    if (ctx->buffer)
+                    {
+                        if (!ctx->mirror_to_console)
+                        {
+                            ctx->buffer->append(ctx->tool, stream, std::move(message));
+                            return;
+                        }
+                        ctx->buffer->append(ctx->tool, stream, message);
                     }
                 }
-                std::lock_guard<std::mutex> lock(cout_mutex);
-                target << message << std::endl;
+                ConsoleWriter::instance().write(target, std::move(message));
             }
 
-            static void cout(const std::string& message)
+            static void cout(std::string message)
             {
-                emit_line("stdout", message, std::cout, false);
+                emit_line("stdout", std::move(message), ConsoleWriter::Target::Stdout, false);
             }
 
-            static void cerr(const std::string& message)
+            static void cerr(std::string message)
             {
-                emit_line("stderr", message, std::cerr, false);
+                emit_line("stderr", std::move(message), ConsoleWriter::Target::Stderr, false);
             }
 
-            static void tool_out(const std::string& message)
+            static void tool_out(std::string message)
             {
-                emit_line("stdout", message, std::cout, true);
+                emit_line("stdout", std::move(message), ConsoleWriter::Target::Stdout, true);
             }
 
-            static void tool_err(const std::string& message)
+            static void tool_err(std::string message)
             {
-                emit_line("stderr", message, std::cerr, true);
+                emit_line("stderr", std::move(message), ConsoleWriter::Target::Stderr, true);
+            }
+
+            /**
+             * @brief Hands tool output to the capture buffer without printing it.
+             */
+            static void tool_capture_only(const std::string& stream, std::string message)
+            {
+                const CaptureContext* ctx = capture_context;
+                if (!ctx || message.empty())
+                {
+                    return;
+                }
+                if (ctx->record)
+                {
+                    if (!ctx->buffer)
+                    {
+                        ctx->record->push_back({stream, std::move(message), false});
+                        return;
+                    }
+                    ctx->record->push_back({stream, message, false});
+                }
+                if (ctx->buffer)
+                {
+                    ctx->buffer->append(ctx->tool, stream, std::move(message));
+                }
             }
         } // namespace Output
     } // namespace Thread
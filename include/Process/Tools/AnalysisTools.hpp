@@ -2,7 +2,13 @@
 #ifndef ANALYSIS_TOOLS_HPP
 #define ANALYSIS_TOOLS_HPP
 
-#include <regex>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <system_error>
 
 // #include "IAnalysisTools.hpp"
 #include "AnalysisToolsBase.hpp"
@@ -93,11 +99,23 @@ namespace ctrace
             std::string entry_points = config.global.entry_points;
             std::string report_file = config.global.report_file;
 
+            // Each invocation gets its own database and report so that several files can be
+            // analyzed at once; only publishing the report to the shared path is serialized.
+            const std::string scratch = scratchPath();
+            const std::string outputDb = scratch + ".db";
+            const std::string scratchReport = scratch + ".report";
+            // With a merged SARIF report, report_file is written by the invoker.
+            const bool toMergedReport = report::active();
+
             try
             {
                 std::vector<std::string> argsProcess;
 
-                if (config.global.hasSarifFormat)
+                if (toMergedReport)
+                {
+                    argsProcess.push_back("--format=sarif");
+                }
+                else if (config.global.hasSarifFormat)
                 {
                     argsProcess.push_back("--format=text");
                 }
@@ -129,25 +147,95 @@ namespace ctrace
                     arg += entryPoint.getEntryPointNameCCMode();
                     argsProcess.push_back(arg);
                 }
-                argsProcess.push_back("--report-file=" + report_file);
+                argsProcess.push_back("--output-db=" + outputDb);
+                argsProcess.push_back("--report-file=" + scratchReport);
                 argsProcess.push_back(src_file);
 
                 auto process = ProcessFactory::createProcess(
-                    "./ikos/src/ikos-build/bin/ikos", argsProcess); // ou "cmd.exe" pour Windows
+                    kExecutable, argsProcess); // ou "cmd.exe" pour Windows
                 // std::this_thread::sleep_for(std::chrono::seconds(5));
+                streamToolOutput(*process);
                 process->execute();
-                ctrace::Thread::Output::tool_out(process->logOutput);
+                if (toMergedReport)
+                {
+                    reportScratchSarif(scratchReport);
+                }
+                else
+                {
+                    publishReport(scratchReport, report_file);
+                }
             }
             catch (const std::exception& e)
             {
                 ctrace::Thread::Output::tool_err("Error: " + std::string(e.what()));
                 // return 1;
             }
+
+            std::error_code ec;
+            std::filesystem::remove(outputDb, ec);
+            std::filesystem::remove(scratchReport, ec);
+        }
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
         }
         std::string name() const override
         {
             return "ikos";
         }
+        [[nodiscard]] std::string version() const override
+        {
+            return executableFingerprint(kExecutable);
+        }
+
+      private:
+        static constexpr const char* kExecutable = "./ikos/src/ikos-build/bin/ikos";
+
+        static std::string scratchPath()
+        {
+            static std::atomic<std::uint64_t> counter{0};
+            const auto id = counter.fetch_add(1, std::memory_order_relaxed);
+            const auto path = std::filesystem::temp_directory_path() /
+                              ("ctrace-ikos-" + std::to_string(::getpid()) + "-" +
+                               std::to_string(id));
+            return path.string();
+        }
+
+        static void reportScratchSarif(const std::string& scratchReport)
+        {
+            std::ifstream in(scratchReport, std::ios::binary);
+            if (!in.is_open())
+            {
+                return;
+            }
+            std::ostringstream document;
+            document << in.rdbuf();
+            reportSarifDocument(document.str());
+        }
+
+        static void publishReport(const std::string& scratchReport, const std::string& reportFile)
+        {
+            if (reportFile.empty())
+            {
+                return;
+            }
+
+            static std::mutex reportMutex;
+            std::lock_guard<std::mutex> lock(reportMutex);
+
+            std::error_code ec;
+            if (!std::filesystem::exists(scratchReport, ec))
+            {
+                return;
+            }
+            std::filesystem::copy_file(scratchReport, reportFile,
+                                       std::filesystem::copy_options::overwrite_existing, ec);
+            if (ec)
+            {
+                ctrace::Thread::Output::tool_err("Error: unable to write IKOS report to " +
+                                                 reportFile + ": " + ec.message());
+            }
+        }
     };
 
     class StackAnalyzerToolImplementation : public AnalysisToolBase
@@ -162,6 +250,24 @@ namespace ctrace
                           ctrace::ProgramConfig config) const override;
         [[nodiscard]] DiagnosticSummary lastDiagnosticsSummary() const override;
         std::string name() const override;
+        [[nodiscard]] std::string version() const override;
+        [[nodiscard]] bool needsWholeProgram(const ctrace::ProgramConfig& config) const override;
+
+        /**
+         * @brief First argument selecting the worker mode used for sharded runs.
+         *
+         * `ctrace --stack-analyzer-worker <analyzer args...>` runs the analyzer once on its
+         * own stdout/stderr and exits with the analyzer exit code.
+         */
+        static constexpr std::string_view kWorkerFlag = "--stack-analyzer-worker";
+
+        /**
+         * @brief Runs the analyzer in the current process for a worker invocation.
+         *
+         * @param analyzerArgs Analyzer arguments, without the program name and worker flag.
+         * @return The process exit code.
+         */
+        static int runWorker(const std::vector<std::string>& analyzerArgs);
 
       private:
         mutable DiagnosticSummary m_lastDiagnosticsSummary{};
@@ -182,7 +288,7 @@ namespace ctrace
             {
                 std::vector<std::string> argsProcess;
                 // = {"flawfinder.py", "-F", "-c", "-C", "-D", "main.c"};
-                argsProcess.push_back("./flawfinder/src/flawfinder-build/flawfinder.py");
+                argsProcess.push_back(kScript);
                 // argsProcess.push_back("-F");
                 argsProcess.push_back("-c");
                 argsProcess.push_back("-C");
@@ -194,15 +300,32 @@ namespace ctrace
                 argsProcess.push_back(src_file);
                 auto process = ProcessFactory::createProcess(
                     "python3", argsProcess); // or "cmd.exe" for Windows
-                process->execute();
-
-                if (config.global.ipc == "standardIO")
+                const bool toConsole = config.global.ipc == "standardIO";
+                if (!has_sarif_format)
                 {
-                    ctrace::Thread::Output::tool_out(process->logOutput);
+                    if (toConsole)
+                    {
+                        streamToolOutput(*process);
+                    }
+                    else
+                    {
+                        process->setLineHandler([this](std::string_view line)
+                                                { ipc->write(std::string(line) + "\n"); });
+                    }
                 }
-                else
+                process->execute();
+
+                if (has_sarif_format)
                 {
-                    ipc->write(process->logOutput);
+                    if (toConsole)
+                    {
+                        ctrace::Thread::Output::tool_out(process->logOutput);
+                    }
+                    else
+                    {
+                        ipc->write(process->logOutput);
+                    }
+                    reportSarifDocument(process->logOutput);
                 }
             }
             catch (const std::exception& e)
@@ -211,21 +334,42 @@ namespace ctrace
                 return;
             }
         }
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
+        }
         std::string name() const override
         {
             return "flawfinder";
         }
+        [[nodiscard]] std::string version() const override
+        {
+            return executableFingerprint(kScript);
+        }
+
+      private:
+        static constexpr const char* kScript = "./flawfinder/src/flawfinder-build/flawfinder.py";
     };
 
     class TscancodeToolImplementation : public AnalysisToolBase
     {
       public:
         void execute(const std::string& file, ProgramConfig config) const override;
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
+        }
         std::string name() const override;
+        [[nodiscard]] std::string version() const override;
 
       protected:
-        std::string_view severityToLevel(const std::string& severity) const;
-        json sarifFormat(const std::string& buffer, const std::string& outputFile) const;
+        std::string_view severityToLevel(std::string_view severity) const;
+        /**
+         * @brief Converts tscancode's text diagnostics and adds them to the merged report.
+         *
+         * @return The number of diagnostics found in @p buffer.
+         */
+        std::size_t sarifFormat(const std::string& buffer) const;
         json jsonFormat(const std::string& buffer, const std::string& outputFile) const;
     };
 
@@ -251,9 +395,17 @@ namespace ctrace
                 argsProcess.push_back(src_file);
 
                 auto process = ProcessFactory::createProcess(
-                    "/opt/homebrew/bin/cppcheck", argsProcess); // ou "cmd.exe" pour Windows
+                    kExecutable, argsProcess); // ou "cmd.exe" pour Windows
+                if (!has_sarif_format)
+                {
+                    streamToolOutput(*process);
+                }
                 process->execute();
-                ctrace::Thread::Output::tool_out(process->logOutput);
+                if (has_sarif_format)
+                {
+                    ctrace::Thread::Output::tool_out(process->logOutput);
+                    reportSarifDocument(process->logOutput);
+                }
             }
             catch (const std::exception& e)
             {
@@ -261,10 +413,21 @@ namespace ctrace
                 return;
             }
         }
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
+        }
         std::string name() const override
         {
             return "ikos";
         }
+        [[nodiscard]] std::string version() const override
+        {
+            return executableFingerprint(kExecutable);
+        }
+
+      private:
+        static constexpr const char* kExecutable = "/opt/homebrew/bin/cppcheck";
     };
 
     // Outils dynamiques
@@ -275,6 +438,10 @@ namespace ctrace
         {
             ctrace::Thread::Output::cout("Running dyn_tools_1 on " + file);
         }
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
+        }
         std::string name() const override
         {
             return "dyn_tools_1";
@@ -288,6 +455,10 @@ namespace ctrace
         {
             ctrace::Thread::Output::cout("Running dyn_tools_2 on " + file);
         }
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
+        }
         std::string name() const override
         {
             return "dyn_tools_2";
@@ -301,6 +472,10 @@ namespace ctrace
         {
             ctrace::Thread::Output::cout("Running dyn_tools_3 on " + file);
         }
+        [[nodiscard]] bool isReentrant() const override
+        {
+            return true;
+        }
         std::string name() const override
         {
             return "dyn_tools_3";
@@ -1,6 +1,12 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "IAnalysisTools.hpp"
 #include "../Ipc/IpcStrategy.hpp"
+#include "SarifReport.hpp"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
 
 namespace ctrace
 {
@@ -10,6 +16,54 @@ namespace ctrace
       protected:
         std::shared_ptr<IpcStrategy> ipc;
 
+        /**
+         * @brief Version string for a tool identified by its executable or script.
+         *
+         * Uses the path, size and modification time, so reinstalling the tool invalidates its
+         * cached results. Returns an empty string when the file does not exist.
+         */
+        static std::string executableFingerprint(const std::string& path)
+        {
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(path, ec);
+            if (ec)
+            {
+                return {};
+            }
+            const auto mtime = std::filesystem::last_write_time(path, ec);
+            if (ec)
+            {
+                return {};
+            }
+            return path + "@" + std::to_string(size) + ":" +
+                   std::to_string(mtime.time_since_epoch().count());
+        }
+
+        /**
+         * @brief Forwards each line of @p process output as tool output while it runs.
+         *
+         * Used for text output; whole documents (SARIF) are still emitted in one piece once
+         * the process exits so they stay parseable.
+         */
+        static void streamToolOutput(Process& process)
+        {
+            process.setLineHandler([](std::string_view line)
+                                   { ctrace::Thread::Output::tool_out(std::string(line)); });
+        }
+
+        /**
+         * @brief Adds a SARIF document produced by the tool to the merged report, if the run
+         * has one. A malformed document is reported as a tool error.
+         */
+        static void reportSarifDocument(std::string_view document)
+        {
+            std::string error;
+            if (!report::add_document(document, error))
+            {
+                ctrace::Thread::Output::tool_err("Error: " + error);
+            }
+        }
+
       public:
         void setIpcStrategy(std::shared_ptr<IpcStrategy> strategy) override
         {
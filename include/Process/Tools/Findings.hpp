@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef FINDINGS_HPP
+#define FINDINGS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief Tool-independent view of one diagnostic: what the merged report compares to find
+     * the same problem reported twice, and what it fingerprints across runs.
+     */
+    struct Finding
+    {
+        std::string file; ///< Normalized path (see findings::normalizePath); empty when unknown.
+        std::uint64_t line = 0; ///< 1-based; 0 when the diagnostic has no region.
+        std::uint64_t column = 0;
+        std::uint32_t cwe = 0;          ///< CWE id; 0 when the tool gave none.
+        std::string rule;               ///< Tool rule id: the category when there is no CWE.
+        std::string level;              ///< SARIF level.
+        std::uint64_t message_hash = 0; ///< Hash of the normalized message.
+    };
+
+    namespace findings
+    {
+        /// 64-bit FNV-1a: stable across platforms and releases, unlike std::hash.
+        CT_NODISCARD constexpr std::uint64_t hash(std::string_view text,
+                                                  std::uint64_t seed = 14695981039346656037ULL)
+        {
+            std::uint64_t value = seed;
+            for (const char c : text)
+            {
+                value ^= static_cast<unsigned char>(c);
+                value *= 1099511628211ULL;
+            }
+            return value;
+        }
+
+        /**
+         * @brief Turns a SARIF URI or tool path into the form findings are compared on: no
+         * `file://` scheme, `/` separators, lexically normal, and relative to @p base (an
+         * absolute, normal, generic path) when it lies below it, so that fingerprints do not
+         * depend on the checkout location.
+         */
+        CT_NODISCARD std::string normalizePath(std::string_view uri, std::string_view base);
+
+        /**
+         * @brief Lowercases ASCII, replaces digit runs by `#` and collapses whitespace, so
+         * that messages differing only by sizes, offsets or spacing compare equal.
+         */
+        CT_NODISCARD std::string normalizeMessage(std::string_view message);
+
+        /// hash(normalizeMessage(message)), without building the string.
+        CT_NODISCARD std::uint64_t messageHash(std::string_view message);
+
+        /**
+         * @brief First CWE id mentioned in @p text (`CWE-120`, `cwe_120`, `"cwe": 120`,
+         * `external/cwe/cwe-120`, ...), case-insensitively; 0 when there is none.
+         */
+        CT_NODISCARD std::uint32_t extractCwe(std::string_view text);
+
+        /**
+         * @brief Hash of the category named by the rule id @p rule, comparable across tools:
+         * its last `.`-separated part, lowercased, letters and digits only, so `nullPointer`
+         * and `tsc.null_pointer` agree. 0 when that is empty or only a severity
+         * (`coretrace.Warning`), which says nothing about the problem.
+         */
+        CT_NODISCARD std::uint64_t ruleCategory(std::string_view rule);
+
+        /**
+         * @brief Stable identity of @p finding across runs, for baseline suppression.
+         *
+         * Covers the file, rule and normalized message but not the line, so unrelated edits
+         * above a finding keep its fingerprint.
+         */
+        CT_NODISCARD std::uint64_t fingerprint(const Finding& finding);
+
+        /// @p fingerprint as 16 lowercase hex digits.
+        CT_NODISCARD std::string toHex(std::uint64_t fingerprint);
+    } // namespace findings
+
+    /**
+     * @brief Groups equivalent findings reported by several tools, in O(1) expected time
+     * per finding.
+     *
+     * Findings are bucketed by (file, line). A finding joins the first group of its bucket
+     * that it is compatible with, otherwise it starts a new one. Compatible means:
+     *  - both have the same CWE, or at least one has none and their rule categories
+     *    (findings::ruleCategory) are equal; the group then takes the CWE. A finding that
+     *    matches on neither starts its own group, keeping its rule and message;
+     *  - a tool already in the group only joins it again with the very same rule and
+     *    message: distinct diagnostics of one tool on one line are never merged;
+     *  - without a line, only identical findings merge.
+     * Columns are ignored: tools disagree on them for the same problem.
+     */
+    class FindingIndex
+    {
+      public:
+        /// What the index keeps of a finding.
+        struct Key
+        {
+            std::uint64_t file = 0;     ///< findings::hash of the normalized path.
+            std::uint64_t line = 0;
+            std::uint64_t identity = 0; ///< Rule and normalized message.
+            std::uint64_t category = 0; ///< findings::ruleCategory of the rule.
+            std::uint32_t cwe = 0;
+            std::uint32_t source = 0; ///< Caller-defined tool index.
+        };
+
+        CT_NODISCARD static Key keyOf(const Finding& finding, std::uint32_t source);
+
+        /// Prepares for @p findings findings, avoiding rehashes.
+        void reserve(std::size_t findings);
+
+        /// Adds @p key and returns the index of its group.
+        std::size_t add(const Key& key);
+
+        CT_NODISCARD std::size_t groupCount() const
+        {
+            return m_groups.size();
+        }
+
+        /// Distinct sources of group @p group, in order of first appearance.
+        CT_NODISCARD std::vector<std::uint32_t> sources(std::size_t group) const;
+
+        /// True when more than one source reported group @p group.
+        CT_NODISCARD bool shared(std::size_t group) const
+        {
+            return m_groups[group].shared;
+        }
+
+      private:
+        using Member = std::pair<std::uint32_t, std::uint64_t>; ///< Source and identity.
+
+        /// Most groups have a single member, kept inline; the others go to `more`.
+        struct Group
+        {
+            std::uint64_t category = 0; ///< Of the first member.
+            std::uint32_t cwe = 0;
+            bool shared = false;
+            std::size_t next = kNone; ///< Next group of the same location.
+            Member first;
+            std::vector<Member> more; ///< Distinct from each other and from `first`.
+        };
+
+        static constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+        struct LocationHash
+        {
+            std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& key) const
+            {
+                return static_cast<std::size_t>(key.first ^ (key.second * 0x9e3779b97f4a7c15ULL));
+            }
+        };
+
+        CT_NODISCARD bool compatible(const Group& group, const Key& key) const;
+
+        std::vector<Group> m_groups;
+        /// First group of each location; the others are chained through Group::next.
+        std::unordered_map<std::pair<std::uint64_t, std::uint64_t>, std::size_t, LocationHash>
+            m_buckets;
+    };
+} // namespace ctrace
+
+#endif // FINDINGS_HPP
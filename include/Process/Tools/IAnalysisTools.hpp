@@ -60,6 +60,31 @@ namespace ctrace
             return false;
         }
 
+        /**
+             * @brief Indicates whether execute() may run concurrently on the same instance.
+             *
+             * Reentrant tools are invoked in parallel on different files; non-reentrant
+             * tools are serialized by the invoker. Tools that keep per-run state in the
+             * instance or touch process-wide resources must keep the default.
+             */
+        [[nodiscard]] virtual bool isReentrant() const
+        {
+            return false;
+        }
+
+        /**
+             * @brief Indicates whether results on a file depend on the other project files.
+             *
+             * Incremental runs narrow the analyzed files to the changed ones; batch tools
+             * returning true still receive every resolved file so that cross-TU results stay
+             * correct.
+             */
+        [[nodiscard]] virtual bool
+        needsWholeProgram([[maybe_unused]] const ctrace::ProgramConfig& config) const
+        {
+            return false;
+        }
+
         /**
              * @brief Executes the analysis tool on multiple files in one run.
              *
@@ -97,6 +122,19 @@ namespace ctrace
              */
         virtual std::string name() const = 0;
 
+        /**
+             * @brief Identifies the tool build that produced a result.
+             *
+             * Part of the result cache key, so cached results are dropped when the tool
+             * changes. Tools returning an empty string are never cached.
+             *
+             * @return A `std::string` that changes whenever the tool output may change.
+             */
+        [[nodiscard]] virtual std::string version() const
+        {
+            return {};
+        }
+
         /**
              * @brief Sets the IPC strategy for the analysis tool.
              * This method allows the tool to communicate results or data
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "App/CompileDatabase.hpp"
+#include "Config/config.hpp"
+#include "IAnalysisTools.hpp"
+#include "Process/ThreadProcess.hpp"
+#include "SarifReport.hpp"
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief Output, diagnostics summary and SARIF report contribution of one tool
+     * invocation, as stored in the cache.
+     */
+    struct CachedToolResult
+    {
+        std::vector<ctrace::Thread::Output::RecordedLine> lines;
+        DiagnosticSummary summary;
+        SarifFragment report;
+    };
+
+    /**
+     * @brief Persistent, content-addressed cache of tool results (`--result-cache-dir`).
+     *
+     * A key hashes the contents of the analyzed files and of the headers listed in their
+     * depfiles, their compile_commands.json flags, the tool name and version, and the
+     * GlobalConfig fields the tool reads. Files without a depfile are not cached, since a
+     * header edit could not invalidate them. Entries are written atomically, so several
+     * ctrace processes may share one directory.
+     */
+    class ResultCache
+    {
+      public:
+        /**
+         * @param directory Cache root; created on the first store.
+         * @param config Effective configuration of the run.
+         */
+        ResultCache(std::string directory, const ProgramConfig& config);
+
+        /**
+         * @brief Computes the cache key of @p tool applied to @p files.
+         *
+         * @return A hex digest, or an empty string when the invocation cannot be cached
+         *         (unreadable input, no depfile, unversioned tool, or side-effect outputs).
+         */
+        CT_NODISCARD std::string key(const IAnalysisTool& tool,
+                                     const std::vector<std::string>& files) const;
+
+        /**
+         * @brief Reads the entry stored under @p key; corrupt entries count as misses.
+         */
+        CT_NODISCARD std::optional<CachedToolResult> load(const std::string& key) const;
+
+        /**
+         * @brief Stores @p result under @p key. Failures are logged and otherwise ignored.
+         */
+        void store(const std::string& key, const CachedToolResult& result) const;
+
+      private:
+        CT_NODISCARD std::filesystem::path entryPath(const std::string& key) const;
+
+        /**
+         * @brief Content digest of @p path, memoized for the lifetime of the cache.
+         */
+        CT_NODISCARD std::optional<std::string> fileDigest(const std::string& path) const;
+
+        std::filesystem::path m_directory;
+        std::string m_commonConfig;
+        std::string m_stackAnalyzerConfig;
+        /// Tools that write side files (report_file, IR dumps) in this configuration.
+        std::vector<std::string> m_uncacheableTools;
+        mutable std::atomic<bool> m_reportedMissingDepfile{false};
+        std::optional<CompileDatabase> m_compileDatabase;
+        mutable std::mutex m_digestMutex;
+        mutable std::unordered_map<std::string, std::optional<std::string>> m_digests;
+    };
+} // namespace ctrace
+
+#endif // RESULT_CACHE_HPP
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef RUNTIME_HISTORY_HPP
+#define RUNTIME_HISTORY_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Config/config.hpp"
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief Measured cost of one tool run on one file.
+     */
+    struct RuntimeSample
+    {
+        double wall_ms = 0;             ///< Wall-clock time of the tool on the file.
+        std::uint64_t peak_rss_kib = 0; ///< Peak resident memory of the tool's processes.
+    };
+
+    /**
+     * @brief Small persistent store of per-(tool, file) runtimes, used to schedule the
+     * longest work first.
+     *
+     * Samples are smoothed across runs. Files without history are estimated from their size
+     * and the tool's observed milliseconds per byte, or from their size alone for a tool that
+     * has no history yet; estimates are only compared between jobs, so the unit does not
+     * matter. The store is a text file rewritten atomically by `save()`; concurrent ctrace
+     * processes do not merge their samples, the last one to save wins.
+     */
+    class RuntimeHistory
+    {
+      public:
+        /**
+         * @brief Returns the history stored at @p path, shared by every caller in this
+         * process; loaded on first use.
+         */
+        CT_NODISCARD static std::shared_ptr<RuntimeHistory> open(const std::string& path);
+
+        /**
+         * @brief History of the run: `runtime_history`, else `<result_cache_dir>/runtime-history`.
+         *
+         * @return nullptr when neither is configured.
+         */
+        CT_NODISCARD static std::shared_ptr<RuntimeHistory> forConfig(const ProgramConfig& config);
+
+        explicit RuntimeHistory(std::filesystem::path path);
+
+        CT_NODISCARD std::optional<RuntimeSample> lookup(const std::string& tool,
+                                                         const std::string& file) const;
+
+        /**
+         * @brief Expected cost of @p tool on @p file, comparable across the tool's files.
+         */
+        CT_NODISCARD double estimate(const std::string& tool, const std::string& file) const;
+
+        void record(const std::string& tool, const std::string& file, const RuntimeSample& sample);
+
+        /**
+         * @brief Writes the store if it changed since the last load or save. Failures are
+         * logged and otherwise ignored.
+         */
+        void save();
+
+      private:
+        struct Entry
+        {
+            RuntimeSample sample;
+            std::uint64_t size_bytes = 0; ///< File size when the sample was taken.
+        };
+
+        /// Sums over the tool's entries, for the milliseconds-per-byte estimate.
+        struct ToolTotals
+        {
+            double wall_ms = 0;
+            double size_bytes = 0;
+        };
+
+        static std::string entryKey(const std::string& tool, const std::string& file);
+        void load();
+        void addTotals(const std::string& tool, const Entry& entry, double sign);
+
+        std::filesystem::path m_path;
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries; ///< Keyed by tool '\t' file.
+        std::unordered_map<std::string, ToolTotals> m_totals;
+        bool m_dirty = false;
+    };
+} // namespace ctrace
+
+#endif // RUNTIME_HISTORY_HPP
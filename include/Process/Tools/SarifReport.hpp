@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef SARIF_REPORT_HPP
+#define SARIF_REPORT_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Process/Tools/Findings.hpp"
+#include "attributes.hpp"
+
+namespace ctrace
+{
+    /**
+     * @brief One diagnostic, as handed to the report by a tool that parses its own output.
+     */
+    struct SarifResult
+    {
+        std::string_view rule_id;
+        std::string_view level; ///< SARIF level: error, warning, note or none.
+        std::string_view message;
+        std::string_view uri;        ///< File of the diagnostic; no location when empty.
+        std::uint64_t start_line = 0; ///< 1-based; no region when 0.
+        std::uint64_t start_column = 0;
+    };
+
+    /**
+     * @brief What one tool job added to its run, serialized, so that the result cache can
+     * replay it.
+     */
+    struct SarifFragment
+    {
+        std::string driver; ///< Serialized `toolComponent`, when the job set it.
+        std::vector<std::string> rules;
+        std::vector<std::string> results;
+    };
+
+    /**
+     * @brief Streaming sink of the merged SARIF 2.1.0 report: one `run` per tool.
+     *
+     * Results are serialized as they arrive and appended to a spool file per run, so the
+     * report never exists as a DOM; only rule descriptors and a fixed-size key per result stay
+     * in memory. Each result is stamped with a stable fingerprint in
+     * `partialFingerprints["ctrace/v1"]` (see findings::fingerprint).
+     *
+     * `write()` merges equivalent findings across tools with a FindingIndex: the first run
+     * (in tool name order) that reported a finding keeps it, listing the other tools in
+     * `properties["ctrace/alsoReportedBy"]`, and the copies are dropped. It then stitches the
+     * spools into the final document and publishes it atomically. Runs are written in tool
+     * name order, results in arrival order. All members are thread-safe.
+     */
+    class SarifReport
+    {
+      public:
+        static constexpr std::string_view kSchemaUri =
+            "https://json.schemastore.org/sarif-2.1.0.json";
+        static constexpr std::string_view kFingerprintKey = "ctrace/v1";
+
+        /// What write() kept of the results added so far.
+        struct Summary
+        {
+            std::size_t results = 0; ///< Added by the tools.
+            std::size_t unique = 0;  ///< Written, once equivalent findings are merged.
+            std::size_t errors = 0;  ///< Levels of the unique results; none counts as note.
+            std::size_t warnings = 0;
+            std::size_t notes = 0;
+            std::size_t fresh = 0; ///< Unique results absent from the baseline.
+        };
+
+        /**
+         * @param base Directory result paths are made relative to before fingerprinting;
+         * the current directory when empty.
+         */
+        explicit SarifReport(std::filesystem::path path, std::filesystem::path base = {});
+        ~SarifReport();
+
+        SarifReport(const SarifReport&) = delete;
+        SarifReport& operator=(const SarifReport&) = delete;
+
+        CT_NODISCARD const std::filesystem::path& path() const
+        {
+            return m_path;
+        }
+
+        /**
+         * @brief Creates the run of @p tool, so that it is reported even without results.
+         */
+        void addRun(const std::string& tool);
+
+        /**
+         * @brief Sets the run's driver (a serialized `toolComponent` without `rules`). The
+         * first driver given for a tool wins; until then the driver only names the tool.
+         */
+        void setDriver(const std::string& tool, std::string driver);
+
+        /// Adds a serialized `reportingDescriptor`; ids already known to the run are ignored.
+        void addRule(const std::string& tool, std::string_view id, std::string rule);
+
+        /**
+         * @brief Appends a serialized `result` object to the run's spool.
+         *
+         * @return The result as stored, with its fingerprint; empty when @p result is not a
+         * JSON object, which is dropped.
+         */
+        std::string addResult(const std::string& tool, std::string_view result);
+
+        /// Same as above, without parsing: the fast path of tools that parse their output.
+        std::string addResult(const std::string& tool, const SarifResult& result);
+
+        /**
+         * @brief Feeds the runs of a SARIF document produced by @p tool itself.
+         *
+         * Results are forwarded one at a time while the document is parsed; they are never
+         * held together in memory. What the run gains is also appended to @p record.
+         */
+        CT_NODISCARD bool addDocument(const std::string& tool, std::string_view document,
+                                      std::string& error, SarifFragment* record = nullptr);
+
+        /// Adds a fragment recorded by an earlier run of the same job (result cache replay).
+        void replay(const std::string& tool, const SarifFragment& fragment);
+
+        /**
+         * @brief Loads the fingerprints of a report written by an earlier run. Every written
+         * result then gets a `baselineState`: `unchanged` when the baseline holds its
+         * fingerprint (each baseline entry matches once), `new` otherwise.
+         */
+        CT_NODISCARD bool loadBaseline(const std::filesystem::path& path, std::string& error);
+
+        CT_NODISCARD std::size_t resultCount() const;
+        CT_NODISCARD std::size_t runCount() const;
+
+        /**
+         * @brief Writes the merged document to path(). The report can still grow and be
+         * written again afterwards.
+         *
+         * Merging is O(n) in the number of results; only results that gain annotations are
+         * parsed again.
+         */
+        CT_NODISCARD bool write(std::string& error, Summary* summary = nullptr) const;
+
+        /// Writes the merged document to @p out instead of path(), e.g. to keep it in memory.
+        CT_NODISCARD bool write(std::ostream& out, std::string& error,
+                                Summary* summary = nullptr) const;
+
+        CT_NODISCARD static std::string serializeResult(const SarifResult& result);
+        CT_NODISCARD static std::string serializeRule(std::string_view id, std::string_view name,
+                                                      std::string_view description);
+
+      private:
+        /// What the report keeps in memory of each spooled result.
+        struct Entry
+        {
+            FindingIndex::Key key;
+            std::uint64_t fingerprint = 0;
+            std::uint8_t level = 0; ///< 0 none, 1 note, 2 warning, 3 error.
+        };
+
+        struct Run
+        {
+            mutable std::mutex mutex;
+            std::string driver;
+            bool hasToolDriver = false;
+            std::vector<std::string> rules;
+            std::unordered_set<std::string> ruleIds;
+            std::unordered_map<std::string, std::uint32_t> ruleCwes;
+            std::filesystem::path spoolPath;
+            std::ofstream spool; ///< One serialized result per line, comma-separated.
+            std::vector<Entry> entries;
+        };
+
+        Run& run(const std::string& tool);
+
+        /// Spools @p result; the caller holds the run's mutex.
+        static void append(Run& target, std::string_view result, const Finding& finding,
+                           std::uint64_t fingerprint);
+
+        std::filesystem::path m_path;
+        std::string m_base; ///< Generic form of the base directory.
+        mutable std::mutex m_mutex;
+        std::map<std::string, std::unique_ptr<Run>> m_runs;
+        std::unordered_map<std::uint64_t, std::size_t> m_baseline; ///< Fingerprint -> count.
+        bool m_hasBaseline = false;
+    };
+
+    namespace report
+    {
+        /**
+         * @brief Run that the tool executing on this thread reports to.
+         */
+        struct Context
+        {
+            SarifReport* report = nullptr;
+            std::string tool;
+            SarifFragment* record = nullptr; ///< Per-invocation copy for the result cache.
+        };
+
+        inline thread_local const Context* current_context = nullptr;
+
+        /**
+         * @brief Installs @p ctx for the calling thread, like `ScopedCapture`.
+         */
+        class ScopedContext
+        {
+          public:
+            explicit ScopedContext(const Context* ctx) : m_previous(current_context)
+            {
+                current_context = ctx;
+            }
+
+            ~ScopedContext()
+            {
+                current_context = m_previous;
+            }
+
+            ScopedContext(const ScopedContext&) = delete;
+            ScopedContext& operator=(const ScopedContext&) = delete;
+
+          private:
+            const Context* m_previous;
+        };
+
+        /// True when results given to this thread end up in a merged report.
+        CT_NODISCARD inline bool active()
+        {
+            return current_context != nullptr && current_context->report != nullptr;
+        }
+
+        // The functions below do nothing unless active().
+        void add_rule(std::string_view id, std::string_view name, std::string_view description);
+        void add_result(const SarifResult& result);
+        CT_NODISCARD bool add_document(std::string_view document, std::string& error);
+    } // namespace report
+} // namespace ctrace
+
+#endif // SARIF_REPORT_HPP
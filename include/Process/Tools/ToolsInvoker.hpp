@@ -4,117 +4,56 @@
 
 #include "AnalysisTools.hpp"
 #include "Process/Ipc/IpcStrategy.hpp"
+#include "Process/ThreadPool.hpp"
+#include "Process/Trace.hpp"
+#include "ResultCache.hpp"
+#include "RuntimeHistory.hpp"
+#include "SarifReport.hpp"
 
 #include <coretrace/logger.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <exception>
+#include <filesystem>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
-#include <stdexcept>
+#include <numeric>
+#include <optional>
+#include <sstream>
 #include <string>
-#include <thread>
-#include <type_traits>
+#include <system_error>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
-#if __has_include(<version>)
-#include <version>
-#endif
-
-class ThreadPool
-{
-  public:
-    explicit ThreadPool(std::size_t numThreads) : stopping(false)
-    {
-        if (numThreads == 0)
-        {
-            numThreads = 1;
-        }
-
-        workers.reserve(numThreads);
-        for (size_t i = 0; i < numThreads; ++i)
-        {
-            workers.emplace_back(
-                [this]
-                {
-                    while (true)
-                    {
-                        std::function<void()> task;
-                        {
-                            std::unique_lock<std::mutex> lock(queueMutex);
-                            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
-                            if (stopping && tasks.empty())
-                                return;
-                            task = std::move(tasks.front());
-                            tasks.pop();
-                        }
-                        task();
-                    }
-                });
-        }
-    }
-
-    ~ThreadPool()
-    {
-        {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            stopping = true;
-        }
-        condition.notify_all();
-        for (auto& worker : workers)
-        {
-            if (worker.joinable())
-            {
-                worker.join();
-            }
-        }
-    }
-
-    template <typename F> auto enqueue(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
-    {
-        using return_type = std::invoke_result_t<std::decay_t<F>>;
-        auto task = std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(f));
-
-        std::future<return_type> res = task->get_future();
-        {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            if (stopping)
-                throw std::runtime_error("Enqueue on stopped ThreadPool");
-            tasks.emplace([task]() { (*task)(); });
-        }
-        condition.notify_one();
-        return res;
-    }
-
-  private:
-#if defined(__cpp_lib_jthread) && (__cpp_lib_jthread >= 201911L)
-    using WorkerThread = std::jthread;
-#else
-    using WorkerThread = std::thread;
-#endif
-    std::vector<WorkerThread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queueMutex;
-    std::condition_variable condition;
-    bool stopping;
-};
-
 namespace ctrace
 {
     class ToolInvoker
     {
       public:
+        /// Invoked from the executing thread each time a tool finishes a job.
+        using ToolCompletedCallback =
+            std::function<void(const std::string& tool, const std::vector<std::string>& files,
+                               const DiagnosticSummary& summary)>;
+
+        /**
+         * @param shared_pool Long-lived pool to run jobs on instead of creating one (server
+         *        mode). With a shared pool, sequential runs also execute on the pool, as one
+         *        ordered chain, so that the pool bounds the total analysis concurrency.
+         */
         ToolInvoker(ctrace::ProgramConfig config, std::size_t nbThreadPool, std::launch policy,
-                    std::shared_ptr<ctrace::Thread::Output::CaptureBuffer> output_capture = nullptr)
+                    std::shared_ptr<ctrace::Thread::Output::CaptureBuffer> output_capture = nullptr,
+                    std::shared_ptr<ThreadPool> shared_pool = nullptr)
             : m_config(std::move(config)), m_nbThreadPool(nbThreadPool == 0 ? 1 : nbThreadPool),
-              m_policy(policy), m_output_capture(output_capture)
+              m_policy(policy), m_output_capture(output_capture),
+              m_threadPool(std::move(shared_pool)), m_poolIsShared(m_threadPool != nullptr)
         {
             coretrace::log(coretrace::Level::Debug, "Initializing ToolInvoker...\n");
 
@@ -146,13 +85,49 @@ namespace ctrace
                 }
             }
 
-            if (m_policy == std::launch::async)
+            if (m_poolIsShared)
             {
-                m_threadPool = std::make_unique<ThreadPool>(m_nbThreadPool);
+                coretrace::log(coretrace::Level::Debug, "ToolInvoker using the shared pool.\n");
+            }
+            else if (m_policy == std::launch::async)
+            {
+                m_threadPool = std::make_shared<ThreadPool>(m_nbThreadPool);
                 coretrace::log(coretrace::Level::Debug,
                                "ToolInvoker thread pool enabled with {} workers.\n",
                                m_nbThreadPool);
             }
+
+            if (!m_config.global.result_cache_dir.empty())
+            {
+                // Cached runs are replayed through the console/capture path only.
+                if (m_ipc)
+                {
+                    coretrace::log(coretrace::Level::Warn,
+                                   "Result cache disabled: IPC '{}' output cannot be replayed.\n",
+                                   m_config.global.ipc);
+                }
+                else
+                {
+                    m_resultCache =
+                        std::make_unique<ResultCache>(m_config.global.result_cache_dir, m_config);
+                    coretrace::log(coretrace::Level::Debug, "Result cache directory: {}\n",
+                                   m_config.global.result_cache_dir);
+                }
+            }
+
+            m_history = RuntimeHistory::forConfig(m_config);
+
+            if (m_config.global.hasSarifFormat && !m_config.global.report_file.empty())
+            {
+                // Every tool of the run feeds one merged SARIF document.
+                m_report = std::make_unique<SarifReport>(m_config.global.report_file);
+                std::string error;
+                if (!m_config.global.sarif_baseline.empty() &&
+                    !m_report->loadBaseline(m_config.global.sarif_baseline, error))
+                {
+                    coretrace::log(coretrace::Level::Warn, "{}; baseline ignored.\n", error);
+                }
+            }
         }
 
         // Execute all static analysis tools
@@ -189,6 +164,46 @@ namespace ctrace
             runToolList(deduplicateToolNames(tool_names), files);
         }
 
+        /**
+         * @brief Full project file list for tools that need whole-program context.
+         *
+         * Set by incremental runs: the file lists passed to run*Tools() then only hold the
+         * files affected by the changes, and batch tools whose needsWholeProgram() is true
+         * analyze these files instead.
+         */
+        void setWholeProgramFiles(std::vector<std::string> files)
+        {
+            m_wholeProgramFiles = std::move(files);
+        }
+
+        /**
+         * @brief Reports each finished job (tool and files), e.g. for progress streaming.
+         *
+         * The callback may run concurrently from several workers.
+         */
+        void setToolCompletedCallback(ToolCompletedCallback callback)
+        {
+            m_toolCompleted = std::move(callback);
+        }
+
+        /**
+         * @brief Stops the run when @p token is cancelled: jobs not yet started are skipped and
+         * running external tools are killed.
+         */
+        void setCancellationToken(std::shared_ptr<const process::CancellationToken> token)
+        {
+            m_cancellation = std::move(token);
+        }
+
+        /**
+         * @brief Keeps the merged SARIF report in memory instead of writing report_file, for
+         * runs that share their config with concurrent ones (server mode). See reportDocument().
+         */
+        void keepReportInMemory()
+        {
+            m_reportInMemory = true;
+        }
+
         [[nodiscard]] DiagnosticSummary diagnosticsSummaryTotal() const
         {
             std::lock_guard<std::mutex> lock(m_diagnosticsSummaryMutex);
@@ -204,135 +219,219 @@ namespace ctrace
             return total;
         }
 
-      private:
-        void registerTool(const std::string& name, std::unique_ptr<IAnalysisTool> tool)
+        /**
+         * @brief Counts of the last merged SARIF report written, where findings reported by
+         * several tools count once, unlike diagnosticsSummaryTotal().
+         */
+        [[nodiscard]] std::optional<SarifReport::Summary> reportSummary() const
         {
-            toolLocks[name] = std::make_shared<std::mutex>();
-            tools[name] = std::move(tool);
+            std::lock_guard<std::mutex> lock(m_diagnosticsSummaryMutex);
+            return m_reportSummary;
         }
 
-        void executeTool(const std::string& tool_name, const std::string& file)
+        /// The last merged SARIF report, when it is kept in memory.
+        [[nodiscard]] std::optional<std::string> reportDocument() const
         {
-            ctrace::Thread::Output::CaptureContext ctx{m_output_capture, tool_name, true};
-            ctrace::Thread::Output::ScopedCapture capture(m_output_capture ? &ctx : nullptr);
+            std::lock_guard<std::mutex> lock(m_diagnosticsSummaryMutex);
+            return m_reportDocument;
+        }
 
-            auto tool_it = tools.find(tool_name);
-            if (tool_it == tools.end())
-            {
-                ctrace::Thread::Output::cerr("\033[31mUnknown tool: " + tool_name + "\033[0m");
-                return;
-            }
+        /**
+         * @brief Publishes the report of a run that analyzes no file (e.g. an incremental run
+         * with nothing affected), so that consumers still find one, without results.
+         */
+        void publishEmptyReport()
+        {
+            publishReport();
+        }
 
-            auto lock_it = toolLocks.find(tool_name);
-            if (lock_it != toolLocks.end() && lock_it->second)
+      private:
+        void registerTool(const std::string& name, std::unique_ptr<IAnalysisTool> tool)
+        {
+            // Reentrant tools guard their own shared state; only the others need a lock.
+            if (!tool->isReentrant())
             {
-                std::lock_guard<std::mutex> lock(*lock_it->second);
-                tool_it->second->execute(file, m_config);
-                recordDiagnosticsSummary(tool_name, *tool_it->second);
-                return;
+                toolLocks[name] = std::make_shared<std::mutex>();
             }
-
-            tool_it->second->execute(file, m_config);
-            recordDiagnosticsSummary(tool_name, *tool_it->second);
+            tools[name] = std::move(tool);
         }
 
-        void executeBatchTool(const std::string& tool_name, const std::vector<std::string>& files)
+        void executeTool(const std::string& tool_name, const std::vector<std::string>& files,
+                         bool batch)
         {
             if (files.empty())
             {
                 return;
             }
 
-            ctrace::Thread::Output::CaptureContext ctx{m_output_capture, tool_name, true};
-            ctrace::Thread::Output::ScopedCapture capture(m_output_capture ? &ctx : nullptr);
-
             auto tool_it = tools.find(tool_name);
             if (tool_it == tools.end())
             {
                 ctrace::Thread::Output::cerr("\033[31mUnknown tool: " + tool_name + "\033[0m");
                 return;
             }
+            IAnalysisTool& tool = *tool_it->second;
 
-            auto lock_it = toolLocks.find(tool_name);
-            if (lock_it != toolLocks.end() && lock_it->second)
+            if (m_cancellation && m_cancellation->cancelled())
             {
-                std::lock_guard<std::mutex> lock(*lock_it->second);
-                tool_it->second->executeBatch(files, m_config);
-                recordDiagnosticsSummary(tool_name, *tool_it->second);
+                coretrace::log(coretrace::Level::Warn, coretrace::Module(tool_name),
+                               "Analysis cancelled, skipping\n");
                 return;
             }
 
-            tool_it->second->executeBatch(files, m_config);
-            recordDiagnosticsSummary(tool_name, *tool_it->second);
-        }
-
-        void runToolList(const std::vector<std::string>& tool_names, const std::string& file)
-        {
-            if (tool_names.empty())
+            const std::string cacheKey = m_resultCache ? m_resultCache->key(tool, files) : "";
+            if (!cacheKey.empty())
             {
-                return;
-            }
-
-            if (m_policy != std::launch::async || !m_threadPool || tool_names.size() == 1)
-            {
-                for (const auto& tool_name : tool_names)
+                if (auto cached = m_resultCache->load(cacheKey))
                 {
-                    executeTool(tool_name, file);
+                    replayCachedResult(tool_name, *cached);
+                    notifyToolCompleted(tool_name, files, cached->summary);
+                    return;
                 }
-                return;
             }
 
-            const auto containsExclusiveCaptureTool =
-                std::any_of(tool_names.begin(), tool_names.end(), [](const std::string& tool_name)
-                            { return requiresExclusiveProcessCapture(tool_name); });
-
-            if (containsExclusiveCaptureTool)
+            std::vector<ctrace::Thread::Output::RecordedLine> recorded;
+            ctrace::Thread::Output::CaptureContext ctx{m_output_capture, tool_name, true,
+                                                       cacheKey.empty() ? nullptr : &recorded};
+            ctrace::Thread::Output::ScopedCapture capture(
+                (m_output_capture || !cacheKey.empty()) ? &ctx : nullptr);
+            SarifFragment recordedReport;
+            const report::Context reportCtx{m_report.get(), tool_name,
+                                            cacheKey.empty() ? nullptr : &recordedReport};
+            report::ScopedContext scopedReport(m_report ? &reportCtx : nullptr);
+            if (m_report)
             {
-                std::vector<std::future<void>> parallelResults;
-                parallelResults.reserve(tool_names.size());
+                m_report->addRun(tool_name);
+            }
+            const trace::ScopedSpan span(trace::Phase::Tool, tool_name,
+                                         batch ? std::string_view("batch") : files.front());
+            const process::ExecutionControl control{toolLimits(tool_name), m_cancellation};
+            process::ScopedExecutionControl scopedControl(&control);
 
-                for (const auto& tool_name : tool_names)
+            DiagnosticSummary summary;
+            std::chrono::steady_clock::duration elapsed{};
+            {
+                std::unique_lock<std::mutex> lock;
+                auto lock_it = toolLocks.find(tool_name);
+                if (lock_it != toolLocks.end() && lock_it->second)
                 {
-                    if (requiresExclusiveProcessCapture(tool_name))
-                    {
-                        continue;
-                    }
-
-                    parallelResults.push_back(m_threadPool->enqueue(
-                        [this, tool_name, file] { executeTool(tool_name, file); }));
+                    lock = std::unique_lock<std::mutex>(*lock_it->second);
                 }
 
-                for (auto& result : parallelResults)
+                const auto started = std::chrono::steady_clock::now();
+                if (batch)
                 {
-                    result.get();
+                    tool.executeBatch(files, m_config);
                 }
-
-                for (const auto& tool_name : tool_names)
+                else
                 {
-                    if (!requiresExclusiveProcessCapture(tool_name))
-                    {
-                        continue;
-                    }
-                    executeTool(tool_name, file);
+                    tool.execute(files.front(), m_config);
                 }
-                return;
+                elapsed = std::chrono::steady_clock::now() - started;
+                summary = tool.lastDiagnosticsSummary();
             }
+            recordDiagnosticsSummary(tool_name, summary);
 
-            std::vector<std::future<void>> results;
-            results.reserve(tool_names.size());
+            // Batch tools split their time across files themselves (see planShards).
+            if (m_history && !batch && !(m_cancellation && m_cancellation->cancelled()))
+            {
+                m_history->record(
+                    tool_name, files.front(),
+                    RuntimeSample{std::chrono::duration<double, std::milli>(elapsed).count(),
+                                  control.peak_rss_kib.load(std::memory_order_relaxed)});
+            }
 
-            for (const auto& tool_name : tool_names)
+            if (!cacheKey.empty() && !reportedError(recorded))
             {
-                results.push_back(m_threadPool->enqueue([this, tool_name, file]
-                                                        { executeTool(tool_name, file); }));
+                m_resultCache->store(cacheKey, CachedToolResult{std::move(recorded), summary,
+                                                                std::move(recordedReport)});
             }
+            notifyToolCompleted(tool_name, files, summary);
+        }
 
-            for (auto& result : results)
+        [[nodiscard]] process::ResourceLimits toolLimits(const std::string& tool_name) const
+        {
+            const auto it = m_config.global.tool_limits.find(tool_name);
+            return it != m_config.global.tool_limits.end() ? it->second
+                                                            : m_config.global.default_tool_limits;
+        }
+
+        void notifyToolCompleted(const std::string& tool_name,
+                                 const std::vector<std::string>& files,
+                                 const DiagnosticSummary& summary) const
+        {
+            if (m_toolCompleted)
             {
-                result.get();
+                m_toolCompleted(tool_name, files, summary);
             }
         }
 
+        void replayCachedResult(const std::string& tool_name, const CachedToolResult& cached)
+        {
+            ctrace::Thread::Output::CaptureContext ctx{m_output_capture, tool_name, true};
+            ctrace::Thread::Output::ScopedCapture capture(m_output_capture ? &ctx : nullptr);
+
+            coretrace::log(coretrace::Level::Info, coretrace::Module(tool_name),
+                           "Result cache hit, skipping analysis\n");
+            for (const auto& line : cached.lines)
+            {
+                if (!line.mirrored)
+                {
+                    ctrace::Thread::Output::tool_capture_only(line.stream, line.message);
+                }
+                else if (line.stream == "stderr")
+                {
+                    ctrace::Thread::Output::tool_err(line.message);
+                }
+                else
+                {
+                    ctrace::Thread::Output::tool_out(line.message);
+                }
+            }
+            if (m_report)
+            {
+                m_report->replay(tool_name, cached.report);
+            }
+            recordDiagnosticsSummary(tool_name, cached.summary);
+        }
+
+        /**
+         * @brief Tools report failures on their error stream; such runs are not cached.
+         */
+        static bool reportedError(const std::vector<ctrace::Thread::Output::RecordedLine>& lines)
+        {
+            return std::any_of(lines.begin(), lines.end(),
+                               [](const ctrace::Thread::Output::RecordedLine& line)
+                               { return line.mirrored && line.stream == "stderr"; });
+        }
+
+        /**
+         * @brief One node of the analysis job graph: a tool applied to one file, or a batch
+         * tool applied to every file at once.
+         */
+        struct ToolJob
+        {
+            std::string tool;
+            std::vector<std::string> files;
+            bool batch = false;
+            double cost = 0; ///< RuntimeHistory estimate; only compared between jobs.
+        };
+
+        /**
+         * @brief Shared completion state for one runJobGraph() call.
+         */
+        struct JobGraphState
+        {
+            std::vector<std::vector<ToolJob>> chains;
+            std::atomic<std::size_t> nextChain{0};
+            trace::Recorder* trace = nullptr; ///< Recorder of the thread running the graph.
+            std::chrono::steady_clock::time_point submitted;
+            std::mutex mutex;
+            std::condition_variable done;
+            std::size_t remainingLanes = 0;
+            std::exception_ptr firstError;
+        };
+
         void runToolList(const std::vector<std::string>& tool_names,
                          const std::vector<std::string>& files)
         {
@@ -373,17 +472,275 @@ namespace ctrace
                 ctrace::Thread::Output::cerr("\033[31mUnknown tool: " + tool_name + "\033[0m");
             }
 
+            // Build the whole (tool x file) graph up front so the pool never idles at a file
+            // boundary.
+            std::vector<ToolJob> jobs;
+            jobs.reserve(batchTools.size() + perFileTools.size() * files.size());
             for (const auto& file : files)
             {
-                runToolList(perFileTools, file);
+                for (const auto& tool_name : perFileTools)
+                {
+                    jobs.push_back(ToolJob{tool_name, {file}, false});
+                }
+            }
+            for (const auto& tool_name : batchTools)
+            {
+                const bool wholeProgram = !m_wholeProgramFiles.empty() &&
+                                          tools.at(tool_name)->needsWholeProgram(m_config);
+                jobs.push_back(
+                    ToolJob{tool_name, wholeProgram ? m_wholeProgramFiles : files, true});
             }
 
-            for (const auto& tool_name : batchTools)
+            runJobGraph(std::move(jobs));
+            // Tool output is on the console before the caller prints its own summary.
+            ctrace::Thread::Output::flush_console();
+            if (m_history)
+            {
+                m_history->save();
+            }
+            publishReport();
+        }
+
+        /**
+         * @brief Writes the merged SARIF report, or keeps it in memory. It holds the results of
+         * every tool list run so far, so a later list rewrites it with its own results added.
+         */
+        void publishReport()
+        {
+            if (!m_report)
+            {
+                return;
+            }
+
+            const std::string path = m_reportInMemory ? "<memory>" : m_report->path().string();
+            const trace::ScopedSpan span(trace::Phase::ReportWrite, "sarif", path);
+            std::string error;
+            SarifReport::Summary summary;
+            std::ostringstream document;
+            const bool written = m_reportInMemory ? m_report->write(document, error, &summary)
+                                                  : m_report->write(error, &summary);
+            if (!written)
+            {
+                coretrace::log(coretrace::Level::Error, "{}\n", error);
+                return;
+            }
+            coretrace::log(coretrace::Level::Info,
+                           "SARIF report written to '{}' ({} unique finding(s) of {} result(s) "
+                           "from {} tool(s))\n",
+                           path, summary.unique, summary.results, m_report->runCount());
+            if (!m_config.global.sarif_baseline.empty())
+            {
+                coretrace::log(coretrace::Level::Info, "{} finding(s) not in baseline '{}'\n",
+                               summary.fresh, m_config.global.sarif_baseline);
+            }
+            std::lock_guard<std::mutex> lock(m_diagnosticsSummaryMutex);
+            m_reportSummary = summary;
+            if (m_reportInMemory)
+            {
+                m_reportDocument = std::move(document).str();
+            }
+        }
+
+        void runJob(const ToolJob& job)
+        {
+            executeTool(job.tool, job.files, job.batch);
+        }
+
+        /**
+         * @brief Runs every job of the graph, serializing only jobs that conflict.
+         *
+         * Jobs sharing a conflict key form a chain that runs in submission order. Chains are
+         * handed out longest first (LPT) to at most one lane per pool worker, so a large file
+         * starts early instead of running alone at the end of the run.
+         */
+        void runJobGraph(std::vector<ToolJob> jobs)
+        {
+            if (jobs.empty())
+            {
+                return;
+            }
+
+            if (!m_threadPool || (!m_poolIsShared && jobs.size() == 1))
+            {
+                for (const auto& job : jobs)
+                {
+                    runJob(job);
+                }
+                return;
+            }
+
+            auto state = std::make_shared<JobGraphState>();
+            auto& chains = state->chains;
+            if (m_policy != std::launch::async)
+            {
+                // Sequential run on a shared pool: one chain keeps the legacy order.
+                chains.push_back(std::move(jobs));
+                jobs.clear();
+            }
+            else
+            {
+                estimateCosts(jobs);
+            }
+
+            std::unordered_map<std::string, std::size_t> chainByKey;
+            for (auto& job : jobs)
+            {
+                const std::string key = conflictKey(job.tool);
+                if (key.empty())
+                {
+                    chains.emplace_back().push_back(std::move(job));
+                    continue;
+                }
+
+                const auto [it, inserted] = chainByKey.emplace(key, chains.size());
+                if (inserted)
+                {
+                    chains.emplace_back();
+                }
+                chains[it->second].push_back(std::move(job));
+            }
+
+            if (m_policy == std::launch::async)
+            {
+                // Batch jobs are the longest nodes of the graph: start them first.
+                const auto chainCost = [](const std::vector<ToolJob>& chain)
+                {
+                    return std::accumulate(chain.begin(), chain.end(), 0.0,
+                                           [](double total, const ToolJob& job)
+                                           { return total + job.cost; });
+                };
+                std::vector<std::pair<double, std::size_t>> order;
+                order.reserve(chains.size());
+                for (std::size_t i = 0; i < chains.size(); ++i)
+                {
+                    order.emplace_back(chainCost(chains[i]), i);
+                }
+                std::stable_sort(order.begin(), order.end(),
+                                 [&chains](const auto& lhs, const auto& rhs)
+                                 {
+                                     const bool lhsBatch = chains[lhs.second].front().batch;
+                                     const bool rhsBatch = chains[rhs.second].front().batch;
+                                     if (lhsBatch != rhsBatch)
+                                     {
+                                         return lhsBatch;
+                                     }
+                                     return lhs.first > rhs.first;
+                                 });
+                std::vector<std::vector<ToolJob>> sorted;
+                sorted.reserve(chains.size());
+                for (const auto& [cost, index] : order)
+                {
+                    sorted.push_back(std::move(chains[index]));
+                }
+                chains = std::move(sorted);
+            }
+
+            const std::size_t lanes = std::min(chains.size(), m_threadPool->size());
+            state->remainingLanes = lanes;
+            state->trace = trace::current();
+            state->submitted = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < lanes; ++i)
+            {
+                (void)m_threadPool->enqueue([this, state] { runLane(*state); });
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->done.wait(lock, [&state] { return state->remainingLanes == 0; });
+            }
+
+            if (state->firstError)
+            {
+                std::rethrow_exception(state->firstError);
+            }
+        }
+
+        /**
+         * @brief Runs chains in the graph's order until none is left.
+         *
+         * Lanes claim whole chains from a shared cursor instead of enqueuing one task per
+         * job: the pool's deques would otherwise reorder the jobs and undo the LPT order.
+         */
+        void runLane(JobGraphState& state)
+        {
+            const trace::ScopedRecorder scopedTrace(state.trace);
+            while (true)
+            {
+                const std::size_t chain = state.nextChain.fetch_add(1, std::memory_order_relaxed);
+                if (chain >= state.chains.size())
+                {
+                    break;
+                }
+                for (const auto& job : state.chains[chain])
+                {
+                    if (state.trace)
+                    {
+                        state.trace->record(trace::Phase::QueueWait, job.tool,
+                                            job.batch ? std::string_view("batch")
+                                                      : std::string_view(job.files.front()),
+                                            state.submitted, std::chrono::steady_clock::now());
+                    }
+                    try
+                    {
+                        runJob(job);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(state.mutex);
+                        if (!state.firstError)
+                        {
+                            state.firstError = std::current_exception();
+                        }
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (--state.remainingLanes == 0)
+            {
+                state.done.notify_all();
+            }
+        }
+
+        /**
+         * @brief Fills ToolJob::cost from the runtime history, or from file sizes without one.
+         */
+        void estimateCosts(std::vector<ToolJob>& jobs) const
+        {
+            for (auto& job : jobs)
             {
-                executeBatchTool(tool_name, files);
+                job.cost = 0;
+                for (const auto& file : job.files)
+                {
+                    if (m_history)
+                    {
+                        job.cost += m_history->estimate(job.tool, file);
+                        continue;
+                    }
+                    std::error_code ec;
+                    const auto size = std::filesystem::file_size(file, ec);
+                    job.cost += ec ? 1.0 : static_cast<double>(std::max<std::uintmax_t>(size, 1));
+                }
             }
         }
 
+        /**
+         * @brief Jobs with the same non-empty key must not overlap.
+         *
+         * Reentrant tools have no key, so one tool runs on several files at once. Jobs of a
+         * non-reentrant tool are chained instead of blocking pool workers on its toolLocks
+         * entry.
+         */
+        [[nodiscard]] std::string conflictKey(const std::string& tool_name) const
+        {
+            const auto tool_it = tools.find(tool_name);
+            if (tool_it != tools.end() && tool_it->second->isReentrant())
+            {
+                return {};
+            }
+            return tool_name;
+        }
+
         static std::vector<std::string>
         deduplicateToolNames(const std::vector<std::string>& tool_names)
         {
@@ -404,14 +761,9 @@ namespace ctrace
             return deduped;
         }
 
-        static bool requiresExclusiveProcessCapture(const std::string& tool_name)
-        {
-            return tool_name == "ctrace_stack_analyzer";
-        }
-
-        void recordDiagnosticsSummary(const std::string& tool_name, const IAnalysisTool& tool)
+        void recordDiagnosticsSummary(const std::string& tool_name,
+                                      const DiagnosticSummary& summary)
         {
-            const auto summary = tool.lastDiagnosticsSummary();
             coretrace::log(coretrace::Level::Info, coretrace::Module(tool_name),
                            "Diagnostics summary: info={}, warning={}, error={}\n", summary.info,
                            summary.warning, summary.error);
@@ -432,9 +784,19 @@ namespace ctrace
         std::launch m_policy;
         std::shared_ptr<IpcStrategy> m_ipc;
         std::shared_ptr<ctrace::Thread::Output::CaptureBuffer> m_output_capture;
-        std::unique_ptr<ThreadPool> m_threadPool;
+        std::shared_ptr<ThreadPool> m_threadPool;
+        bool m_poolIsShared = false;
+        std::unique_ptr<ResultCache> m_resultCache;
+        std::shared_ptr<RuntimeHistory> m_history;
+        std::unique_ptr<SarifReport> m_report;
+        bool m_reportInMemory = false;
+        std::vector<std::string> m_wholeProgramFiles;
+        ToolCompletedCallback m_toolCompleted;
+        std::shared_ptr<const process::CancellationToken> m_cancellation;
         mutable std::mutex m_diagnosticsSummaryMutex;
         std::unordered_map<std::string, DiagnosticSummary> m_diagnosticsSummaryByTool;
+        std::optional<SarifReport::Summary> m_reportSummary;
+        std::optional<std::string> m_reportDocument;
     };
 } // namespace ctrace
 
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef TSCANCODE_PARSER_HPP
+#define TSCANCODE_PARSER_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+namespace ctrace::tscancode
+{
+    /**
+     * @brief One `[file:line]: (severity) message` line of tscancode output. The views point
+     * into the parsed buffer.
+     */
+    struct Diagnostic
+    {
+        std::string_view file;
+        std::uint64_t line = 0;
+        std::string_view severity;
+        std::string_view message;
+    };
+
+    namespace detail
+    {
+        [[nodiscard]] constexpr bool is_word_char(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '_';
+        }
+
+        /**
+         * @brief Parses the line assuming its `]: (` separator starts at @p separator.
+         */
+        [[nodiscard]] inline std::optional<Diagnostic> parse_at(std::string_view line,
+                                                                std::size_t separator)
+        {
+            // Before the separator: "[<file>:<digits>".
+            const std::string_view location = line.substr(1, separator - 1);
+            const std::size_t colon = location.rfind(':');
+            if (colon == std::string_view::npos || colon + 1 == location.size())
+            {
+                return std::nullopt;
+            }
+            const std::string_view digits = location.substr(colon + 1);
+            Diagnostic diagnostic;
+            const auto [end, ec] =
+                std::from_chars(digits.data(), digits.data() + digits.size(), diagnostic.line);
+            if (ec != std::errc() || end != digits.data() + digits.size())
+            {
+                return std::nullopt;
+            }
+            diagnostic.file = location.substr(0, colon);
+
+            // After it: "<word>) <message>".
+            std::size_t pos = separator + 4;
+            const std::size_t severity_start = pos;
+            while (pos < line.size() && is_word_char(line[pos]))
+            {
+                ++pos;
+            }
+            if (pos == severity_start || line.size() - pos < 2 || line[pos] != ')' ||
+                line[pos + 1] != ' ')
+            {
+                return std::nullopt;
+            }
+            diagnostic.severity = line.substr(severity_start, pos - severity_start);
+            diagnostic.message = line.substr(pos + 2);
+            return diagnostic;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Parses one line (without its newline); the result views into @p line.
+     *
+     * Accepts exactly what the ECMAScript regex `\[(.*):(\d+)\]: \((\w+)\) (.*)` matches,
+     * including its greedy file: when the message itself contains `]: (`, the last separator
+     * that yields a valid diagnostic wins. Like `.`, no part may contain a line terminator.
+     */
+    [[nodiscard]] inline std::optional<Diagnostic> parse_line(std::string_view line)
+    {
+        if (line.empty() || line.front() != '[' ||
+            std::memchr(line.data(), '\n', line.size()) != nullptr ||
+            std::memchr(line.data(), '\r', line.size()) != nullptr)
+        {
+            return std::nullopt;
+        }
+
+        // Candidates are tried from the right; each one starts at a ']'.
+        constexpr std::string_view kSeparator = "]: (";
+        for (std::size_t separator = line.rfind(']'); separator != std::string_view::npos &&
+                                                      separator > 0;
+             separator = line.rfind(']', separator - 1))
+        {
+            if (line.compare(separator, kSeparator.size(), kSeparator) != 0)
+            {
+                continue;
+            }
+            if (auto diagnostic = detail::parse_at(line, separator))
+            {
+                return diagnostic;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Calls @p on_diagnostic for every diagnostic line of @p output, without copying
+     * the buffer. Lines may end with `\n` or `\r\n`.
+     *
+     * @return The number of diagnostics.
+     */
+    template <typename Callback>
+    std::size_t for_each_diagnostic(std::string_view output, Callback&& on_diagnostic)
+    {
+        std::size_t count = 0;
+        while (!output.empty())
+        {
+            const void* newline = std::memchr(output.data(), '\n', output.size());
+            const std::size_t length =
+                newline != nullptr
+                    ? static_cast<std::size_t>(static_cast<const char*>(newline) - output.data())
+                    : output.size();
+            std::string_view line = output.substr(0, length);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+            if (auto diagnostic = parse_line(line))
+            {
+                on_diagnostic(*diagnostic);
+                ++count;
+            }
+            output.remove_prefix(newline != nullptr ? length + 1 : length);
+        }
+        return count;
+    }
+} // namespace ctrace::tscancode
+
+#endif // TSCANCODE_PARSER_HPP
@@ -0,0 +1,322 @@
+// SPDX-License-Identifier: Apache-2.0
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace ctrace::trace
+{
+    /**
+     * @brief What a span measures; also the Chrome trace category.
+     */
+    enum class Phase : std::uint8_t
+    {
+        Run,          ///< A whole CLI run or server analysis request.
+        ConfigLoad,   ///< applyToolConfigFile().
+        ResolveFiles, ///< resolveSourceFiles().
+        QueueWait,    ///< A tool job waiting for a worker after its graph was submitted.
+        Tool,         ///< One tool job, from the invoker's point of view.
+        Spawn,        ///< Starting an external process.
+        Capture,      ///< Draining a child's output until it exits.
+        Parse,        ///< Turning tool output into diagnostics or structured reports.
+        ReportWrite,  ///< Writing a report file.
+        Count
+    };
+
+    inline constexpr std::size_t kPhaseCount = static_cast<std::size_t>(Phase::Count);
+
+    [[nodiscard]] constexpr std::string_view phase_name(Phase phase)
+    {
+        constexpr std::array<std::string_view, kPhaseCount> names = {
+            "run",   "config_load", "resolve_files", "queue_wait", "tool",
+            "spawn", "capture",     "parse",         "report_write"};
+        return names[static_cast<std::size_t>(phase)];
+    }
+
+    /**
+     * @brief Small, stable id of the calling thread (Chrome trace `tid`).
+     */
+    inline std::uint32_t thread_index()
+    {
+        static std::atomic<std::uint32_t> next{1};
+        thread_local const std::uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    struct Span
+    {
+        Phase phase = Phase::Run;
+        std::string name;
+        std::string detail;
+        std::uint64_t start_ns = 0; ///< Since the recorder was created.
+        std::uint64_t duration_ns = 0;
+        std::uint32_t thread = 0;
+    };
+
+    struct PhaseTotal
+    {
+        std::uint64_t count = 0;
+        std::uint64_t total_ns = 0;
+    };
+
+    /**
+     * @brief Collects the spans of one CLI run or one server request.
+     *
+     * Per-phase totals are exact; individual spans are kept up to `kMaxSpans` for the Chrome
+     * trace export. Spans are coarse (one per job, process or phase), so a mutex is enough.
+     */
+    class Recorder
+    {
+      public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t kMaxSpans = 1U << 20;
+
+        Recorder() : origin_(Clock::now()) {}
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        void record(Phase phase, std::string_view name, std::string_view detail,
+                    Clock::time_point start, Clock::time_point end)
+        {
+            const auto duration = end > start ? end - start : Clock::duration::zero();
+            const auto duration_ns = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+            auto& total = totals_[static_cast<std::size_t>(phase)];
+            total.count.fetch_add(1, std::memory_order_relaxed);
+            total.total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+
+            const auto start_ns = start > origin_
+                                      ? static_cast<std::uint64_t>(
+                                            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                start - origin_)
+                                                .count())
+                                      : 0;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (spans_.size() >= kMaxSpans)
+            {
+                ++dropped_;
+                return;
+            }
+            spans_.push_back(Span{phase, std::string(name), std::string(detail), start_ns,
+                                  duration_ns, thread_index()});
+        }
+
+        [[nodiscard]] std::array<PhaseTotal, kPhaseCount> totals() const
+        {
+            std::array<PhaseTotal, kPhaseCount> result{};
+            for (std::size_t i = 0; i < kPhaseCount; ++i)
+            {
+                result[i].count = totals_[i].count.load(std::memory_order_relaxed);
+                result[i].total_ns = totals_[i].total_ns.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        [[nodiscard]] std::vector<Span> spans() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return spans_;
+        }
+
+        /**
+         * @brief Writes the spans in Chrome's trace event format (chrome://tracing, Perfetto).
+         */
+        [[nodiscard]] bool write_chrome_trace(const std::string& path, std::string& error) const
+        {
+            std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            const int pid = current_process_id();
+            bool first = true;
+            std::size_t dropped = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                dropped = dropped_;
+                for (const auto& span : spans_)
+                {
+                    out.append(first ? "\n" : ",\n");
+                    first = false;
+                    out.append("{\"ph\":\"X\",\"cat\":\"");
+                    out.append(phase_name(span.phase));
+                    out.append("\",\"name\":");
+                    append_json_string(out, span.name.empty() ? phase_name(span.phase)
+                                                              : std::string_view(span.name));
+                    out.append(",\"pid\":" + std::to_string(pid));
+                    out.append(",\"tid\":" + std::to_string(span.thread));
+                    append_micros(out, ",\"ts\":", span.start_ns);
+                    append_micros(out, ",\"dur\":", span.duration_ns);
+                    if (!span.detail.empty())
+                    {
+                        out.append(",\"args\":{\"detail\":");
+                        append_json_string(out, span.detail);
+                        out.push_back('}');
+                    }
+                    out.push_back('}');
+                }
+            }
+            out.append("\n],\"otherData\":{\"dropped_spans\":" + std::to_string(dropped) + "}}\n");
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << out;
+            if (!file)
+            {
+                error = "Unable to write trace file '" + path + "'";
+                return false;
+            }
+            return true;
+        }
+
+      private:
+        struct AtomicTotal
+        {
+            std::atomic<std::uint64_t> count{0};
+            std::atomic<std::uint64_t> total_ns{0};
+        };
+
+        static int current_process_id()
+        {
+#if !defined(_WIN32)
+            return static_cast<int>(::getpid());
+#else
+            return _getpid();
+#endif
+        }
+
+        static void append_micros(std::string& out, std::string_view key, std::uint64_t ns)
+        {
+            out.append(key);
+            out.append(std::to_string(ns / 1000));
+            out.push_back('.');
+            const auto fraction = std::to_string(ns % 1000);
+            out.append(3 - fraction.size(), '0');
+            out.append(fraction);
+        }
+
+        static void append_json_string(std::string& out, std::string_view value)
+        {
+            out.push_back('"');
+            for (const char c : value)
+            {
+                switch (c)
+                {
+                case '"':
+                    out.append("\\\"");
+                    break;
+                case '\\':
+                    out.append("\\\\");
+                    break;
+                case '\n':
+                    out.append("\\n");
+                    break;
+                case '\t':
+                    out.append("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out.append(escaped);
+                    }
+                    else
+                    {
+                        out.push_back(c);
+                    }
+                }
+            }
+            out.push_back('"');
+        }
+
+        const Clock::time_point origin_;
+        std::array<AtomicTotal, kPhaseCount> totals_{};
+        mutable std::mutex mutex_;
+        std::vector<Span> spans_;
+        std::size_t dropped_ = 0;
+    };
+
+    /// Recorder receiving the spans of this thread, or nullptr when tracing is off.
+    inline thread_local Recorder* current_recorder = nullptr;
+
+    [[nodiscard]] inline Recorder* current()
+    {
+        return current_recorder;
+    }
+
+    /**
+     * @brief Installs @p recorder for spans opened on this thread, like `ScopedCapture`.
+     */
+    class ScopedRecorder
+    {
+      public:
+        explicit ScopedRecorder(Recorder* recorder) : previous_(current_recorder)
+        {
+            current_recorder = recorder;
+        }
+
+        ~ScopedRecorder()
+        {
+            current_recorder = previous_;
+        }
+
+        ScopedRecorder(const ScopedRecorder&) = delete;
+        ScopedRecorder& operator=(const ScopedRecorder&) = delete;
+
+      private:
+        Recorder* previous_;
+    };
+
+    /**
+     * @brief Times the enclosing scope. Without a recorder on the thread it only costs a
+     * thread-local load: no clock read and no copy of the name.
+     */
+    class ScopedSpan
+    {
+      public:
+        explicit ScopedSpan(Phase phase, std::string_view name = {}, std::string_view detail = {})
+            : recorder_(current_recorder), phase_(phase)
+        {
+            if (recorder_ != nullptr)
+            {
+                name_ = name;
+                detail_ = detail;
+                start_ = Recorder::Clock::now();
+            }
+        }
+
+        ~ScopedSpan()
+        {
+            if (recorder_ != nullptr)
+            {
+                recorder_->record(phase_, name_, detail_, start_, Recorder::Clock::now());
+            }
+        }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+      private:
+        Recorder* recorder_;
+        Phase phase_;
+        std::string name_;
+        std::string detail_;
+        Recorder::Clock::time_point start_;
+    };
+} // namespace ctrace::trace
+
+#endif // TRACE_HPP
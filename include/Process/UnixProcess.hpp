@@ -2,97 +2,154 @@
 #pragma once
 
 #include <spawn.h>
+#include <signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
+#include <mutex>
 #include <stdexcept>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <unordered_map>
+#include "ExecutionControl.hpp"
+#include "OutputPipe.hpp"
 #include "Process.hpp"
+#include "Trace.hpp"
 
 extern char** environ;
 
+/**
+ * @brief Launches commands with posix_spawn.
+ *
+ * glibc implements posix_spawn with clone(CLONE_VM | CLONE_VFORK), so the launch cost does
+ * not grow with the parent's RSS the way fork() does once the linked-in stack analyzer has
+ * built a large LLVM heap. Resolved executables are cached per (command, PATH).
+ */
 class UnixProcessWithPosixSpawn : public Process
 {
   public:
     UnixProcessWithPosixSpawn(const std::string& command, std::vector<std::string> args)
-        : command_(command), pid_(0), log_fd_(-1), resolved_path_("")
+        : command_(command), resolved_path_(""), pid_(0)
     {
         additional_args_ = args;
     }
 
     ~UnixProcessWithPosixSpawn() override
     {
-        if (log_fd_ != -1)
+        // Reaps the child when run() was left by an exception (e.g. a failing line handler).
+        if (pid_ > 0)
         {
-            close(log_fd_);
+            killChild();
+            waitpid(pid_, nullptr, 0);
+            ctrace::process::process_groups::remove(pid_);
         }
     }
 
   protected:
     void prepare() override
     {
-        resolveCommandPath();
-        checkPermissions();
+        resolved_path_ = resolveCommandPath(command_);
         prepareArguments();
-        setupLogging();
     }
 
     void run() override
     {
-        posix_spawn_file_actions_t file_actions;
-        posix_spawnattr_t attr;
-
-        if (posix_spawn_file_actions_init(&file_actions) != 0)
-        {
-            throw std::runtime_error("Failed to init file actions: " +
-                                     std::string(strerror(errno)));
-        }
-        if (posix_spawnattr_init(&attr) != 0)
+        std::vector<char*> argv;
+        for (auto& arg : m_arguments)
         {
-            throw std::runtime_error("Failed to init spawn attr: " + std::string(strerror(errno)));
+            argv.push_back(const_cast<char*>(arg.c_str()));
         }
+        argv.push_back(nullptr);
 
-        if (posix_spawn_file_actions_adddup2(&file_actions, log_fd_, STDOUT_FILENO) != 0 ||
-            posix_spawn_file_actions_adddup2(&file_actions, log_fd_, STDERR_FILENO) != 0)
+        int pipeFds[2];
+        if (!ctrace::process::openOutputPipe(pipeFds))
         {
-            throw std::runtime_error("Failed to setup file redirection: " +
+            throw std::runtime_error("Failed to create output pipe: " +
                                      std::string(strerror(errno)));
         }
 
-        // Utiliser arguments (de la classe de base) au lieu de m_arguments
-        std::vector<char*> argv;
-        for (auto& arg : m_arguments)
+        const ctrace::process::ExecutionControl* control = ctrace::process::current_control;
+        // Controlled children get their own process group so a kill reaches their children.
+        own_group_ = control != nullptr && (!control->limits.empty() || control->cancellation);
+        cpu_limited_ = false;
+
+        int status = 0;
         {
-            argv.push_back(const_cast<char*>(arg.c_str()));
+            const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::Spawn, command_);
+            status = spawn(argv, pipeFds[1]);
+            if (status == ENOENT || status == EACCES)
+            {
+                // The cached executable went away (tool reinstalled); resolve it again once.
+                forgetResolvedPath(command_);
+                resolved_path_ = resolveCommandPath(command_);
+                status = spawn(argv, pipeFds[1]);
+            }
         }
-        argv.push_back(nullptr);
-
-        int status =
-            posix_spawn(&pid_, resolved_path_.c_str(), &file_actions, &attr, argv.data(), environ);
-
+        close(pipeFds[1]);
         if (status != 0)
         {
+            close(pipeFds[0]);
             throw std::runtime_error("posix_spawn failed: " + std::string(strerror(status)));
         }
 
-        posix_spawn_file_actions_destroy(&file_actions);
-        posix_spawnattr_destroy(&attr);
+        if (control != nullptr)
+        {
+            // posix_spawn has no pre-exec hook, so the limit is applied right after the spawn.
+            cpu_limited_ = ctrace::process::apply_cpu_limit(pid_, control->limits);
+        }
+
+        ctrace::process::ChildWatchdog watchdog(pid_, control);
+        const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::Capture, command_);
+        try
+        {
+            const bool finished = ctrace::process::drainOutputPipe(
+                pipeFds[0], [this](const char* data, std::size_t size)
+                { appendOutput(data, size); }, [&watchdog] { return watchdog.expired(); },
+                watchdog.active() ? static_cast<int>(ctrace::process::ChildWatchdog::kTick.count())
+                                  : -1);
+            if (!finished)
+            {
+                abort_reason_ = watchdog.reason();
+                killChild();
+            }
+        }
+        catch (...)
+        {
+            close(pipeFds[0]);
+            throw;
+        }
+        close(pipeFds[0]);
     }
 
     void cleanup() override
     {
         if (pid_ > 0)
         {
-            int status;
-            waitpid(pid_, &status, 0);
+            int status = 0;
+            rusage usage{};
+            while (wait4(pid_, &status, 0, &usage) == -1 && errno == EINTR)
+            {
+            }
+            exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            ctrace::process::process_groups::remove(pid_);
             pid_ = 0;
+            if (const auto* control = ctrace::process::current_control)
+            {
+                control->record_peak_rss(usage);
+            }
+            // Past the soft RLIMIT_CPU the kernel sends SIGXCPU, past the hard one SIGKILL.
+            if (abort_reason_.empty() && cpu_limited_ && WIFSIGNALED(status) &&
+                (WTERMSIG(status) == SIGXCPU || WTERMSIG(status) == SIGKILL))
+            {
+                abort_reason_ = "exceeded cpu_seconds";
+            }
         }
-        captureLogs();
-        if (log_fd_ != -1)
+        if (!abort_reason_.empty())
         {
-            close(log_fd_);
-            log_fd_ = -1;
+            const std::string reason = std::move(abort_reason_);
+            abort_reason_.clear();
+            throw std::runtime_error(command_ + " " + reason);
         }
     }
 
@@ -100,9 +157,9 @@ class UnixProcessWithPosixSpawn : public Process
     {
         m_arguments.clear();
 
-        // Le premier argument doit être le nom de la commande
-        std::string cmd_name = resolved_path_.substr(resolved_path_.find_last_of("/\\") + 1);
-        m_arguments.push_back(cmd_name);
+        // argv[0] is the command as given, like execvp(): some tools locate their data files
+        // relative to it.
+        m_arguments.push_back(command_);
 
         // Ajouter les arguments supplémentaires
         m_arguments.insert(m_arguments.end(), additional_args_.begin(), additional_args_.end());
@@ -110,109 +167,199 @@ class UnixProcessWithPosixSpawn : public Process
 
     void captureLogs() override
     {
-        if (log_fd_ == -1)
-        {
-            return;
-        }
+        // Output is streamed into logOutput while the child runs.
+    }
 
-        lseek(log_fd_, 0, SEEK_SET);
+  private:
+    struct ResolvedCommand
+    {
+        std::string path_env;
+        std::string resolved;
+    };
 
-        std::string buffer;
-        char chunk[1024];
-        ssize_t bytes_read;
+    static std::mutex& resolvedCommandsMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
 
-        while ((bytes_read = read(log_fd_, chunk, sizeof(chunk) - 1)) > 0)
-        {
-            chunk[bytes_read] = '\0';
-            buffer += chunk;
-        }
+    static std::unordered_map<std::string, ResolvedCommand>& resolvedCommands()
+    {
+        static std::unordered_map<std::string, ResolvedCommand> commands;
+        return commands;
+    }
 
-        logOutput = buffer;
+    static void forgetResolvedPath(const std::string& command)
+    {
+        std::lock_guard<std::mutex> lock(resolvedCommandsMutex());
+        resolvedCommands().erase(command);
     }
 
-  private:
-    void setupLogging()
+    /**
+     * @brief Returns the executable for @p command, walking PATH only on a cache miss.
+     *
+     * Entries are keyed by the command and the PATH value they were resolved against, so
+     * changing PATH invalidates them.
+     */
+    static std::string resolveCommandPath(const std::string& command)
     {
-        char temp_path[] = "/tmp/process_log_XXXXXX";
-        log_fd_ = mkstemp(temp_path);
-        if (log_fd_ == -1)
+        const char* pathEnv = getenv("PATH");
+        const std::string path = pathEnv ? pathEnv : "";
         {
-            throw std::runtime_error("Failed to create temp log file: " +
-                                     std::string(strerror(errno)));
+            std::lock_guard<std::mutex> lock(resolvedCommandsMutex());
+            const auto it = resolvedCommands().find(command);
+            if (it != resolvedCommands().end() && it->second.path_env == path)
+            {
+                return it->second.resolved;
+            }
         }
-        unlink(temp_path);
+
+        std::string resolved = searchCommandPath(command, pathEnv);
+        checkPermissions(resolved);
+
+        std::lock_guard<std::mutex> lock(resolvedCommandsMutex());
+        resolvedCommands()[command] = ResolvedCommand{path, resolved};
+        return resolved;
     }
 
-    void resolveCommandPath()
+    static std::string searchCommandPath(const std::string& command, const char* pathEnv)
     {
-        if (command_.find('/') != std::string::npos)
+        if (command.find('/') != std::string::npos)
         {
-            if (access(command_.c_str(), F_OK) == 0)
+            if (access(command.c_str(), F_OK) == 0)
             {
-                resolved_path_ = command_;
-                return;
+                return command;
             }
-            throw std::runtime_error("Command not found: " + command_);
+            throw std::runtime_error("Command not found: " + command);
         }
 
-        char* path_env = getenv("PATH");
-        if (!path_env)
+        if (!pathEnv)
         {
             throw std::runtime_error("PATH environment variable not set");
         }
 
-        std::string path(path_env);
+        std::string path(pathEnv);
         std::string::size_type start = 0;
-        std::string::size_type end;
-
-        while ((end = path.find(':', start)) != std::string::npos)
+        while (true)
         {
-            std::string dir = path.substr(start, end - start);
-            std::string full_path = dir + "/" + command_;
-
-            if (access(full_path.c_str(), F_OK) == 0)
+            const std::string::size_type end = path.find(':', start);
+            std::string dir = path.substr(start, end == std::string::npos ? end : end - start);
+            if (dir.empty())
+            {
+                dir = "."; // An empty PATH entry means the current directory.
+            }
+            const std::string full_path = dir + "/" + command;
+            if (access(full_path.c_str(), X_OK) == 0)
+            {
+                return full_path;
+            }
+            if (end == std::string::npos)
             {
-                resolved_path_ = full_path;
-                return;
+                break;
             }
             start = end + 1;
         }
 
-        std::string last_dir = path.substr(start);
-        std::string last_path = last_dir + "/" + command_;
-        if (access(last_path.c_str(), F_OK) == 0)
-        {
-            resolved_path_ = last_path;
-            return;
-        }
-
-        throw std::runtime_error("Command not found in PATH: " + command_);
+        throw std::runtime_error("Command not found in PATH: " + command);
     }
 
-    void checkPermissions()
+    static void checkPermissions(const std::string& resolved_path)
     {
-        if (access(resolved_path_.c_str(), X_OK) != 0)
+        if (access(resolved_path.c_str(), X_OK) != 0)
         {
-            throw std::runtime_error("Command not executable: " + resolved_path_ + ": " +
+            throw std::runtime_error("Command not executable: " + resolved_path + ": " +
                                      std::string(strerror(errno)));
         }
 
         struct stat st;
-        if (stat(resolved_path_.c_str(), &st) != 0)
+        if (stat(resolved_path.c_str(), &st) != 0)
         {
-            throw std::runtime_error("Cannot stat command: " + resolved_path_ + ": " +
+            throw std::runtime_error("Cannot stat command: " + resolved_path + ": " +
                                      std::string(strerror(errno)));
         }
 
         if (!S_ISREG(st.st_mode))
         {
-            throw std::runtime_error("Command is not a regular file: " + resolved_path_);
+            throw std::runtime_error("Command is not a regular file: " + resolved_path);
+        }
+    }
+
+    void killChild() const
+    {
+        if (pid_ > 0)
+        {
+            kill(own_group_ ? -pid_ : pid_, SIGKILL);
+        }
+    }
+
+    /**
+     * @brief Spawns the command with stdout/stderr on @p outputFd.
+     * @return 0 or the posix_spawn error code.
+     */
+    int spawn(std::vector<char*>& argv, int outputFd)
+    {
+        posix_spawn_file_actions_t file_actions;
+        posix_spawnattr_t attr;
+
+        // The posix_spawn family returns its error rather than setting errno.
+        if (const int rc = posix_spawn_file_actions_init(&file_actions); rc != 0)
+        {
+            throw std::runtime_error("Failed to init file actions: " + std::string(strerror(rc)));
+        }
+        if (const int rc = posix_spawnattr_init(&attr); rc != 0)
+        {
+            posix_spawn_file_actions_destroy(&file_actions);
+            throw std::runtime_error("Failed to init spawn attr: " + std::string(strerror(rc)));
+        }
+
+        // The child starts with default signal handling and an empty mask, whatever the
+        // calling worker thread had blocked.
+        sigset_t emptyMask;
+        sigset_t defaultSignals;
+        sigemptyset(&emptyMask);
+        sigemptyset(&defaultSignals);
+        sigaddset(&defaultSignals, SIGPIPE);
+        sigaddset(&defaultSignals, SIGINT);
+        sigaddset(&defaultSignals, SIGTERM);
+        posix_spawnattr_setsigmask(&attr, &emptyMask);
+        posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+        short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+        if (own_group_)
+        {
+            posix_spawnattr_setpgroup(&attr, 0);
+            flags |= POSIX_SPAWN_SETPGROUP;
+        }
+        posix_spawnattr_setflags(&attr, flags);
+
+        int status = posix_spawn_file_actions_adddup2(&file_actions, outputFd, STDOUT_FILENO);
+        if (status == 0 && capture_stderr_)
+        {
+            status = posix_spawn_file_actions_adddup2(&file_actions, outputFd, STDERR_FILENO);
+        }
+        if (status == 0)
+        {
+            status = posix_spawn(&pid_, resolved_path_.c_str(), &file_actions, &attr,
+                                 argv.data(), environ);
+        }
+
+        posix_spawn_file_actions_destroy(&file_actions);
+        posix_spawnattr_destroy(&attr);
+        if (status != 0)
+        {
+            pid_ = 0;
+        }
+        else if (own_group_)
+        {
+            ctrace::process::process_groups::add(pid_);
         }
+        return status;
     }
 
     std::string command_;
     std::string resolved_path_;
     pid_t pid_;
-    int log_fd_;
+    bool own_group_ = false;
+    bool cpu_limited_ = false;
+    std::string abort_reason_; ///< Why the watchdog killed the child, empty otherwise.
     std::vector<std::string> additional_args_; // Remplacer m_arguments par additional_args_
 };
@@ -3,6 +3,7 @@
 
 #ifdef _WIN32
 
+#include <cstring>
 #include <iostream>
 #include <windows.h>
 #include <stdexcept>
@@ -43,7 +44,7 @@ class WindowsProcess : public Process
         }
 
         si.hStdOutput = logFile;
-        si.hStdError = logFile;
+        si.hStdError = capture_stderr_ ? logFile : GetStdHandle(STD_ERROR_HANDLE);
         si.dwFlags |= STARTF_USESTDHANDLES;
 
         // Lancer le processus
@@ -56,6 +57,10 @@ class WindowsProcess : public Process
 
         // Attendre que le processus se termine
         WaitForSingleObject(pi.hProcess, INFINITE);
+        DWORD processExitCode = 0;
+        exitCode = GetExitCodeProcess(pi.hProcess, &processExitCode)
+                       ? static_cast<int>(processExitCode)
+                       : -1;
         CloseHandle(pi.hProcess);
         CloseHandle(pi.hThread);
         CloseHandle(logFile);
@@ -87,10 +92,9 @@ class WindowsProcess : public Process
         }
 
         char buffer[1024];
-        logOutput.clear();
         while (fgets(buffer, sizeof(buffer), logFile))
         {
-            logOutput += buffer;
+            appendOutput(buffer, strlen(buffer));
         }
         fclose(logFile);
 
@@ -1,4 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
+#ifndef MANGLE_HPP
+#define MANGLE_HPP
+
 #include <string>
 #include <vector>
 #include <sstream>
@@ -67,3 +70,5 @@ namespace ctrace_tools::mangle
                                              const std::string& functionName,
                                              const std::vector<std::string>& paramTypes);
 }; // namespace ctrace_tools::mangle
+
+#endif // MANGLE_HPP
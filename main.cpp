@@ -1,12 +1,28 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "App/Config.hpp"
 #include "App/Runner.hpp"
+#include "Process/Trace.hpp"
 
 #include <coretrace/logger.hpp>
 
+#include <optional>
+#include <string>
+
 int main(int argc, char* argv[])
 {
+    if (const auto workerExitCode = ctrace::run_worker_mode(argc, argv))
+    {
+        return *workerExitCode;
+    }
+
+    // Installed before the config is read so that loading it shows up in the trace.
+    ctrace::trace::Recorder recorder;
+    std::optional<ctrace::trace::ScopedRecorder> tracing(std::in_place, &recorder);
     ctrace::ProgramConfig config = ctrace::buildConfig(argc, argv);
+    if (config.global.trace_out.empty() || config.global.ipc == "serve")
+    {
+        tracing.reset();
+    }
 
     // std::cout << ctrace::Color::GREEN << "CoreTrace - Comprehensive Tracing and Analysis Tool"
     //           << ctrace::Color::RESET << std::endl;
@@ -23,5 +39,19 @@ int main(int argc, char* argv[])
         coretrace::set_timestamps(true);
         return ctrace::run_server(config);
     }
-    return ctrace::run_cli_analysis(config);
+
+    int exitCode = 0;
+    {
+        const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::Run, "ctrace");
+        exitCode = ctrace::run_cli_analysis(config);
+    }
+    if (tracing)
+    {
+        std::string error;
+        if (!recorder.write_chrome_trace(config.global.trace_out, error))
+        {
+            coretrace::log(coretrace::Level::Error, "{}\n", error);
+        }
+    }
+    return exitCode;
 }
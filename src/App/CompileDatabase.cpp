@@ -0,0 +1,386 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/CompileDatabase.hpp"
+
+#include "App/CompileDatabaseIndex.hpp"
+#include "App/Manifest.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+namespace ctrace
+{
+    namespace
+    {
+        [[nodiscard]] std::filesystem::path resolveAgainst(const std::filesystem::path& baseDir,
+                                                           const std::string& rawPath)
+        {
+            std::filesystem::path path(rawPath);
+            if (path.is_relative() && !baseDir.empty())
+            {
+                path = baseDir / path;
+            }
+            return path.lexically_normal();
+        }
+
+        [[nodiscard]] std::string outputFromArguments(const std::vector<std::string>& arguments)
+        {
+            for (std::size_t i = 0; i < arguments.size(); ++i)
+            {
+                const std::string& arg = arguments[i];
+                if (arg == "-o" && i + 1 < arguments.size())
+                {
+                    return arguments[i + 1];
+                }
+                if (arg.size() > 2 && arg.rfind("-o", 0) == 0)
+                {
+                    return arg.substr(2);
+                }
+            }
+            return {};
+        }
+
+        [[nodiscard]] bool readWholeFile(const std::filesystem::path& path, std::string& content)
+        {
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream.is_open())
+            {
+                return false;
+            }
+            std::ostringstream buffer;
+            buffer << stream.rdbuf();
+            content = buffer.str();
+            return true;
+        }
+    } // namespace
+
+    CT_NODISCARD std::optional<std::vector<CompileCommand>>
+    parseCompileDatabase(std::string_view content, const std::filesystem::path& compdbPath,
+                         std::string& error, bool& selfContained)
+    {
+        ManifestContents manifest;
+        if (!parseManifest(content, manifest, ManifestMode::CompileCommands) ||
+            !manifest.rootArray)
+        {
+            error = "Invalid compile database '" + compdbPath.string() + "': expected a JSON array";
+            return std::nullopt;
+        }
+
+        const std::filesystem::path manifestDir =
+            std::filesystem::path(normalizeSourcePath(compdbPath.string())).parent_path();
+
+        // Items without a "file" string were left out by the parser.
+        selfContained = manifest.skippedItems == 0;
+        std::vector<CompileCommand> commands;
+        commands.reserve(manifest.rootArray->size());
+        for (auto& item : *manifest.rootArray)
+        {
+            const std::string& rawFile = item.candidate;
+
+            CompileCommand command;
+            std::filesystem::path directory = manifestDir;
+            bool absoluteDirectory = false;
+            if (item.directory)
+            {
+                absoluteDirectory = std::filesystem::path(*item.directory).is_absolute();
+                directory = resolveAgainst(manifestDir, *item.directory);
+            }
+            command.directory = directory.string();
+            if (rawFile.empty() ||
+                (!absoluteDirectory && !std::filesystem::path(rawFile).is_absolute()))
+            {
+                selfContained = false;
+            }
+
+            if (item.arguments)
+            {
+                command.arguments = std::move(*item.arguments);
+            }
+            else if (item.command)
+            {
+                command.arguments = splitCommandLine(*item.command);
+            }
+
+            const std::string output =
+                item.output ? *item.output : outputFromArguments(command.arguments);
+            if (!output.empty())
+            {
+                command.output = resolveAgainst(directory, output).string();
+            }
+
+            command.file = normalizeSourcePath(resolveAgainst(directory, rawFile).string());
+            commands.push_back(std::move(command));
+        }
+
+        return commands;
+    }
+
+    CT_NODISCARD std::optional<CompileDatabase> CompileDatabase::load(const std::string& path,
+                                                                      std::string& error)
+    {
+        auto index = CompileDatabaseIndex::open(path, error);
+        if (!index)
+        {
+            return std::nullopt;
+        }
+
+        CompileDatabase database;
+        database.m_index = std::move(index);
+        database.m_indexByFile.reserve(database.m_index->size());
+        for (std::size_t i = 0; i < database.m_index->size(); ++i)
+        {
+            database.m_indexByFile.emplace(database.m_index->file(i), i);
+        }
+        return database;
+    }
+
+    CT_NODISCARD const CompileCommand* CompileDatabase::find(const std::string& file) const
+    {
+        const std::string normalized = normalizeSourcePath(file);
+        const auto it = m_indexByFile.find(normalized);
+        if (it == m_indexByFile.end())
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_materialized->mutex);
+        auto& command = m_materialized->commands[it->second];
+        if (!command)
+        {
+            command = std::make_unique<CompileCommand>(m_index->command(it->second));
+        }
+        return command.get();
+    }
+
+    CT_NODISCARD std::size_t CompileDatabase::size() const noexcept
+    {
+        return m_index ? m_index->size() : 0;
+    }
+
+    CT_NODISCARD std::string normalizeSourcePath(const std::string& path)
+    {
+        std::error_code ec;
+        auto absolute = std::filesystem::absolute(path, ec);
+        if (ec)
+        {
+            absolute = path;
+        }
+        return absolute.lexically_normal().string();
+    }
+
+    CT_NODISCARD std::vector<std::string> splitCommandLine(std::string_view command)
+    {
+        std::vector<std::string> arguments;
+        std::string current;
+        bool inToken = false;
+        char quote = '\0';
+
+        for (std::size_t i = 0; i < command.size(); ++i)
+        {
+            const char c = command[i];
+            if (quote == '\'')
+            {
+                if (c == '\'')
+                {
+                    quote = '\0';
+                }
+                else
+                {
+                    current.push_back(c);
+                }
+                continue;
+            }
+            if (quote == '"')
+            {
+                if (c == '"')
+                {
+                    quote = '\0';
+                }
+                else if (c == '\\' && i + 1 < command.size() &&
+                         (command[i + 1] == '"' || command[i + 1] == '\\' ||
+                          command[i + 1] == '$' || command[i + 1] == '`'))
+                {
+                    current.push_back(command[++i]);
+                }
+                else
+                {
+                    current.push_back(c);
+                }
+                continue;
+            }
+
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            {
+                if (inToken)
+                {
+                    arguments.push_back(std::move(current));
+                    current.clear();
+                    inToken = false;
+                }
+                continue;
+            }
+
+            inToken = true;
+            if (c == '\'' || c == '"')
+            {
+                quote = c;
+            }
+            else if (c == '\\' && i + 1 < command.size())
+            {
+                current.push_back(command[++i]);
+            }
+            else
+            {
+                current.push_back(c);
+            }
+        }
+
+        if (inToken)
+        {
+            arguments.push_back(std::move(current));
+        }
+        return arguments;
+    }
+
+    CT_NODISCARD std::vector<std::string> parseDepfile(std::string_view content,
+                                                       const std::filesystem::path& baseDir)
+    {
+        std::vector<std::string> dependencies;
+
+        // Skip the targets: they end at the first ':' followed by whitespace, which leaves
+        // Windows drive letters ("C:\...") alone.
+        std::size_t pos = 0;
+        bool foundRule = false;
+        for (; pos < content.size(); ++pos)
+        {
+            if (content[pos] == '\\')
+            {
+                ++pos;
+                continue;
+            }
+            if (content[pos] == ':' &&
+                (pos + 1 == content.size() || content[pos + 1] == ' ' ||
+                 content[pos + 1] == '\t' || content[pos + 1] == '\n' ||
+                 content[pos + 1] == '\r'))
+            {
+                ++pos;
+                foundRule = true;
+                break;
+            }
+        }
+        if (!foundRule)
+        {
+            return dependencies;
+        }
+
+        std::string current;
+        const auto flush = [&]
+        {
+            if (!current.empty())
+            {
+                dependencies.push_back(resolveAgainst(baseDir, current).string());
+                current.clear();
+            }
+        };
+
+        for (; pos < content.size(); ++pos)
+        {
+            const char c = content[pos];
+            if (c == '\\' && pos + 1 < content.size())
+            {
+                const char next = content[pos + 1];
+                if (next == '\n')
+                {
+                    flush();
+                    ++pos;
+                    continue;
+                }
+                if (next == '\r' && pos + 2 < content.size() && content[pos + 2] == '\n')
+                {
+                    flush();
+                    pos += 2;
+                    continue;
+                }
+                if (next == ' ' || next == '#')
+                {
+                    current.push_back(next);
+                    ++pos;
+                    continue;
+                }
+                current.push_back(c);
+                continue;
+            }
+            if (c == '$' && pos + 1 < content.size() && content[pos + 1] == '$')
+            {
+                current.push_back('$');
+                ++pos;
+                continue;
+            }
+            if (c == '\n')
+            {
+                // End of the first rule; later rules are -MP phony targets.
+                break;
+            }
+            if (c == ' ' || c == '\t' || c == '\r')
+            {
+                flush();
+                continue;
+            }
+            current.push_back(c);
+        }
+        flush();
+
+        return dependencies;
+    }
+
+    CT_NODISCARD std::optional<std::vector<std::string>>
+    readDepfileDependencies(const CompileCommand& command)
+    {
+        std::filesystem::path depfile;
+        bool generatesDepfile = false;
+        const auto& arguments = command.arguments;
+        for (std::size_t i = 0; i < arguments.size(); ++i)
+        {
+            const std::string& arg = arguments[i];
+            if (arg == "-MF" && i + 1 < arguments.size())
+            {
+                depfile = arguments[i + 1];
+            }
+            else if (arg.size() > 3 && arg.rfind("-MF", 0) == 0)
+            {
+                depfile = arg.substr(3);
+            }
+            else if (arg == "-MD" || arg == "-MMD")
+            {
+                generatesDepfile = true;
+            }
+        }
+
+        std::vector<std::filesystem::path> candidates;
+        if (!depfile.empty())
+        {
+            candidates.push_back(resolveAgainst(command.directory, depfile.string()));
+        }
+        else if (!command.output.empty())
+        {
+            // CMake (Ninja and Makefile generators) writes "<object>.d" without listing the
+            // depfile flags in the database; plain -MD writes "<object stem>.d".
+            candidates.emplace_back(command.output + ".d");
+            if (generatesDepfile)
+            {
+                candidates.push_back(std::filesystem::path(command.output).replace_extension(".d"));
+            }
+        }
+
+        for (const auto& candidate : candidates)
+        {
+            std::string content;
+            if (readWholeFile(candidate, content))
+            {
+                return parseDepfile(content, command.directory);
+            }
+        }
+        return std::nullopt;
+    }
+} // namespace ctrace
@@ -0,0 +1,500 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/CompileDatabaseIndex.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <coretrace/logger.hpp>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace ctrace
+{
+    struct CompileDatabaseIndex::Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t flags;
+        std::uint64_t databaseSize;
+        std::int64_t databaseMtime; ///< file_time_type ticks.
+        std::uint64_t databaseHash;
+        std::int64_t builtAt; ///< file_time_type ticks when the stamp was last confirmed.
+        std::uint64_t entryCount;
+        std::uint64_t argumentCount;
+        std::uint64_t stringBytes;
+    };
+
+    struct CompileDatabaseIndex::StringRef
+    {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct CompileDatabaseIndex::Entry
+    {
+        StringRef file;
+        StringRef directory;
+        StringRef output;
+        std::uint64_t firstArgument;
+        std::uint32_t argumentCount;
+        std::uint32_t flags;
+    };
+
+    namespace
+    {
+        constexpr std::string_view kCompileDatabaseModule = "compile_database";
+
+        // Layout: Header, Entry[entryCount], StringRef[argumentCount], char[stringBytes].
+        constexpr char kMagic[8] = {'C', 'T', 'C', 'D', 'B', 'I', 'X', '\0'};
+        /// Bumped whenever the layout or the meaning of a field changes.
+        constexpr std::uint32_t kVersion = 1;
+
+        constexpr std::uint32_t kSelfContainedFlag = 1U << 0; ///< Header flag.
+        constexpr std::uint32_t kDependencyFlag = 1U << 0;    ///< Entry flag.
+
+        /// A database written this close to its index build may change within the same mtime.
+        constexpr std::chrono::seconds kRacyWindow{2};
+
+        struct DatabaseStamp
+        {
+            std::uint64_t size = 0;
+            std::int64_t mtime = 0;
+        };
+
+        [[nodiscard]] std::optional<DatabaseStamp> stampOf(const std::filesystem::path& path)
+        {
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(path, ec);
+            if (ec)
+            {
+                return std::nullopt;
+            }
+            const auto mtime = std::filesystem::last_write_time(path, ec);
+            if (ec)
+            {
+                return std::nullopt;
+            }
+            return DatabaseStamp{static_cast<std::uint64_t>(size),
+                                 static_cast<std::int64_t>(mtime.time_since_epoch().count())};
+        }
+
+        [[nodiscard]] std::int64_t nowTicks()
+        {
+            return static_cast<std::int64_t>(
+                std::filesystem::file_time_type::clock::now().time_since_epoch().count());
+        }
+
+        [[nodiscard]] bool isRacy(std::int64_t databaseMtime, std::int64_t builtAt)
+        {
+            const auto window =
+                std::chrono::duration_cast<std::filesystem::file_time_type::duration>(kRacyWindow)
+                    .count();
+            return builtAt - databaseMtime <= window;
+        }
+
+        /// 64-bit FNV-1a; only used to tell whether a touched database really changed.
+        [[nodiscard]] std::uint64_t contentHash(std::string_view content)
+        {
+            std::uint64_t hash = 0xcbf29ce484222325ULL;
+            for (const char c : content)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+            }
+            return hash;
+        }
+
+        [[nodiscard]] bool hasDependencySegment(const std::string& path)
+        {
+            for (const auto& part : std::filesystem::path(path))
+            {
+                if (part == "_deps")
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] int currentProcessId()
+        {
+#if !defined(_WIN32)
+            return static_cast<int>(::getpid());
+#else
+            return _getpid();
+#endif
+        }
+
+        template <typename T> void appendPod(std::string& bytes, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        /**
+         * @brief Lays out @p commands in the index format; equal strings are stored once.
+         */
+        template <typename HeaderT, typename EntryT, typename StringRefT>
+        [[nodiscard]] std::string serialize(const std::vector<CompileCommand>& commands,
+                                            bool selfContained, const DatabaseStamp& stamp,
+                                            std::uint64_t hash)
+        {
+            std::string strings;
+            std::unordered_map<std::string_view, StringRefT> interned;
+            // Keys point into `commands`, which outlives the map.
+            const auto intern = [&](const std::string& value)
+            {
+                const auto [it, inserted] = interned.try_emplace(value);
+                if (inserted)
+                {
+                    it->second = StringRefT{strings.size(), value.size()};
+                    strings.append(value);
+                }
+                return it->second;
+            };
+
+            std::vector<EntryT> entries;
+            std::vector<StringRefT> arguments;
+            entries.reserve(commands.size());
+            for (const auto& command : commands)
+            {
+                EntryT entry{};
+                entry.file = intern(command.file);
+                entry.directory = intern(command.directory);
+                entry.output = intern(command.output);
+                entry.firstArgument = arguments.size();
+                entry.argumentCount = static_cast<std::uint32_t>(command.arguments.size());
+                entry.flags = hasDependencySegment(command.file) ? kDependencyFlag : 0;
+                for (const auto& argument : command.arguments)
+                {
+                    arguments.push_back(intern(argument));
+                }
+                entries.push_back(entry);
+            }
+
+            HeaderT header{};
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.flags = selfContained ? kSelfContainedFlag : 0;
+            header.databaseSize = stamp.size;
+            header.databaseMtime = stamp.mtime;
+            header.databaseHash = hash;
+            header.builtAt = nowTicks();
+            header.entryCount = entries.size();
+            header.argumentCount = arguments.size();
+            header.stringBytes = strings.size();
+
+            std::string bytes;
+            bytes.reserve(sizeof(HeaderT) + entries.size() * sizeof(EntryT) +
+                          arguments.size() * sizeof(StringRefT) + strings.size());
+            appendPod(bytes, header);
+            bytes.append(reinterpret_cast<const char*>(entries.data()),
+                         entries.size() * sizeof(EntryT));
+            bytes.append(reinterpret_cast<const char*>(arguments.data()),
+                         arguments.size() * sizeof(StringRefT));
+            bytes.append(strings);
+            return bytes;
+        }
+
+        /// Publishes @p bytes at @p path through a private name, so readers never map a
+        /// partial index.
+        [[nodiscard]] bool writeAtomically(const std::filesystem::path& path,
+                                           const std::string& bytes)
+        {
+            static std::atomic<std::uint64_t> counter{0};
+            auto temporary = path;
+            temporary += ".tmp-" + std::to_string(currentProcessId()) + "-" +
+                         std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+            std::error_code ec;
+            {
+                std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+                out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+                if (!out)
+                {
+                    out.close();
+                    std::filesystem::remove(temporary, ec);
+                    return false;
+                }
+            }
+            std::filesystem::rename(temporary, path, ec);
+            if (ec)
+            {
+                std::filesystem::remove(temporary, ec);
+                return false;
+            }
+            return true;
+        }
+
+        /// Records that the database was touched without changing.
+        template <typename HeaderT>
+        void refreshStamp(const std::filesystem::path& indexPath, const DatabaseStamp& stamp)
+        {
+            std::fstream file(indexPath, std::ios::in | std::ios::out | std::ios::binary);
+            if (!file)
+            {
+                return;
+            }
+            const std::int64_t builtAt = nowTicks();
+            file.seekp(static_cast<std::streamoff>(offsetof(HeaderT, databaseMtime)));
+            file.write(reinterpret_cast<const char*>(&stamp.mtime), sizeof(stamp.mtime));
+            file.seekp(static_cast<std::streamoff>(offsetof(HeaderT, builtAt)));
+            file.write(reinterpret_cast<const char*>(&builtAt), sizeof(builtAt));
+        }
+
+        struct CachedIndex
+        {
+            std::weak_ptr<const CompileDatabaseIndex> index;
+            DatabaseStamp stamp;
+            std::int64_t builtAt = 0;
+        };
+
+        /// Indexes opened by this process, so concurrent server requests share one mapping.
+        std::mutex& cacheMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_map<std::string, CachedIndex>& openIndexes()
+        {
+            static std::unordered_map<std::string, CachedIndex> indexes;
+            return indexes;
+        }
+    } // namespace
+
+    CT_NODISCARD std::shared_ptr<const CompileDatabaseIndex>
+    CompileDatabaseIndex::open(const std::string& path, std::string& error)
+    {
+        std::filesystem::path compdbPath(path);
+        std::error_code ec;
+        if (std::filesystem::is_directory(compdbPath, ec))
+        {
+            compdbPath /= "compile_commands.json";
+        }
+
+        const auto stamp = stampOf(compdbPath);
+        if (!stamp)
+        {
+            error = "Unable to open compile database '" + compdbPath.string() + "'";
+            return nullptr;
+        }
+
+        const std::string cacheKey = normalizeSourcePath(compdbPath.string());
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            const auto it = openIndexes().find(cacheKey);
+            if (it != openIndexes().end() && it->second.stamp.size == stamp->size &&
+                it->second.stamp.mtime == stamp->mtime &&
+                !isRacy(stamp->mtime, it->second.builtAt))
+            {
+                if (auto index = it->second.index.lock())
+                {
+                    return index;
+                }
+            }
+        }
+
+        const auto remember = [&](std::shared_ptr<const CompileDatabaseIndex> index)
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            openIndexes()[cacheKey] = CachedIndex{index, *stamp, index->m_header->builtAt};
+            return index;
+        };
+
+        auto indexPath = compdbPath;
+        indexPath += kFileSuffix;
+
+        std::shared_ptr<CompileDatabaseIndex> index(new CompileDatabaseIndex());
+        if (index->m_file.open(indexPath) && index->attach(index->m_file.contents()))
+        {
+            const Header& header = *index->m_header;
+            bool fresh = header.databaseSize == stamp->size &&
+                         header.databaseMtime == stamp->mtime &&
+                         !isRacy(header.databaseMtime, header.builtAt);
+            if (!fresh && header.databaseSize == stamp->size)
+            {
+                MappedFile database;
+                if (database.open(compdbPath) &&
+                    contentHash(database.contents()) == header.databaseHash)
+                {
+                    refreshStamp<Header>(indexPath, *stamp);
+                    fresh = true;
+                }
+            }
+            if (fresh)
+            {
+                return remember(std::move(index));
+            }
+        }
+
+        MappedFile database;
+        if (!database.open(compdbPath))
+        {
+            error = "Unable to open compile database '" + compdbPath.string() + "'";
+            return nullptr;
+        }
+        bool selfContained = true;
+        const auto commands =
+            parseCompileDatabase(database.contents(), compdbPath, error, selfContained);
+        if (!commands)
+        {
+            return nullptr;
+        }
+        std::string bytes = serialize<Header, Entry, StringRef>(
+            *commands, selfContained, *stamp, contentHash(database.contents()));
+
+        index.reset(new CompileDatabaseIndex());
+        if (!writeAtomically(indexPath, bytes) || !index->m_file.open(indexPath) ||
+            !index->attach(index->m_file.contents()))
+        {
+            coretrace::log(coretrace::Level::Debug, coretrace::Module(kCompileDatabaseModule),
+                           "Unable to write '{}'; using the index from memory\n",
+                           indexPath.string());
+            index.reset(new CompileDatabaseIndex());
+            index->m_buffer = std::move(bytes);
+            if (!index->attach(index->m_buffer))
+            {
+                error = "Unable to index compile database '" + compdbPath.string() + "'";
+                return nullptr;
+            }
+        }
+        return remember(std::move(index));
+    }
+
+    CT_NODISCARD bool CompileDatabaseIndex::attach(std::string_view bytes)
+    {
+        static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % 8 == 0);
+        static_assert(std::is_trivially_copyable_v<Entry> && sizeof(Entry) % 8 == 0);
+        static_assert(std::is_trivially_copyable_v<StringRef> && sizeof(StringRef) % 8 == 0);
+
+        if (bytes.size() < sizeof(Header))
+        {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const Header*>(bytes.data());
+        if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion)
+        {
+            return false;
+        }
+
+        // Every count and reference is checked once here, so accessors can trust them.
+        const std::uint64_t limit = bytes.size();
+        if (header->entryCount > limit / sizeof(Entry) ||
+            header->argumentCount > limit / sizeof(StringRef))
+        {
+            return false;
+        }
+        const std::uint64_t entriesBytes = header->entryCount * sizeof(Entry);
+        const std::uint64_t argumentsBytes = header->argumentCount * sizeof(StringRef);
+        if (sizeof(Header) + entriesBytes + argumentsBytes + header->stringBytes != limit)
+        {
+            return false;
+        }
+
+        const auto* entries = reinterpret_cast<const Entry*>(bytes.data() + sizeof(Header));
+        const auto* arguments =
+            reinterpret_cast<const StringRef*>(bytes.data() + sizeof(Header) + entriesBytes);
+        const auto validRef = [&](const StringRef& ref)
+        {
+            return ref.offset <= header->stringBytes &&
+                   ref.size <= header->stringBytes - ref.offset;
+        };
+        for (std::uint64_t i = 0; i < header->entryCount; ++i)
+        {
+            const Entry& e = entries[i];
+            if (!validRef(e.file) || !validRef(e.directory) || !validRef(e.output) ||
+                e.firstArgument > header->argumentCount ||
+                e.argumentCount > header->argumentCount - e.firstArgument)
+            {
+                return false;
+            }
+        }
+        for (std::uint64_t i = 0; i < header->argumentCount; ++i)
+        {
+            if (!validRef(arguments[i]))
+            {
+                return false;
+            }
+        }
+
+        m_header = header;
+        m_entries = entries;
+        m_arguments = arguments;
+        m_strings = bytes.data() + sizeof(Header) + entriesBytes + argumentsBytes;
+        m_entryCount = static_cast<std::size_t>(header->entryCount);
+        return true;
+    }
+
+    CT_NODISCARD std::string_view CompileDatabaseIndex::string(const StringRef& ref) const
+    {
+        return {m_strings + ref.offset, static_cast<std::size_t>(ref.size)};
+    }
+
+    CT_NODISCARD const CompileDatabaseIndex::Entry&
+    CompileDatabaseIndex::entry(std::size_t index) const
+    {
+        return m_entries[index];
+    }
+
+    CT_NODISCARD std::string_view CompileDatabaseIndex::file(std::size_t entry) const
+    {
+        return string(this->entry(entry).file);
+    }
+
+    CT_NODISCARD std::string_view CompileDatabaseIndex::directory(std::size_t entry) const
+    {
+        return string(this->entry(entry).directory);
+    }
+
+    CT_NODISCARD std::string_view CompileDatabaseIndex::output(std::size_t entry) const
+    {
+        return string(this->entry(entry).output);
+    }
+
+    CT_NODISCARD std::size_t CompileDatabaseIndex::argumentCount(std::size_t entry) const
+    {
+        return this->entry(entry).argumentCount;
+    }
+
+    CT_NODISCARD std::string_view CompileDatabaseIndex::argument(std::size_t entry,
+                                                                 std::size_t position) const
+    {
+        return string(m_arguments[this->entry(entry).firstArgument + position]);
+    }
+
+    CT_NODISCARD bool CompileDatabaseIndex::isDependency(std::size_t entry) const
+    {
+        return (this->entry(entry).flags & kDependencyFlag) != 0;
+    }
+
+    CT_NODISCARD bool CompileDatabaseIndex::selfContained() const noexcept
+    {
+        return (m_header->flags & kSelfContainedFlag) != 0;
+    }
+
+    CT_NODISCARD CompileCommand CompileDatabaseIndex::command(std::size_t entry) const
+    {
+        CompileCommand command;
+        command.file = std::string(file(entry));
+        command.directory = std::string(directory(entry));
+        command.output = std::string(output(entry));
+        command.arguments.reserve(argumentCount(entry));
+        for (std::size_t i = 0; i < argumentCount(entry); ++i)
+        {
+            command.arguments.emplace_back(argument(entry, i));
+        }
+        return command;
+    }
+} // namespace ctrace
@@ -46,13 +46,22 @@ namespace ctrace
         argManager.addOption("--demangle", false, 'g');
         argManager.addOption("--stack-limit", true, 'l');
         argManager.addOption("--report-file", true, 'r');
+        argManager.addOption("--sarif-baseline", true, 'b');
         argManager.addOption("--async", false, 'a');
         argManager.addOption("--ipc", true, 'p');
         argManager.addOption("--ipc-path", true, 't');
         argManager.addOption("--serve-host", true, 'z');
         argManager.addOption("--serve-port", true, 'y');
+        argManager.addOption("--serve-workers", true, 'w');
+        argManager.addOption("--serve-max-analyses", true, 'A');
+        argManager.addOption("--serve-max-queued", true, 'Q');
         argManager.addOption("--shutdown-token", true, 'k');
         argManager.addOption("--shutdown-timeout-ms", true, 'm');
+        argManager.addOption("--result-cache-dir", true, 'C');
+        argManager.addOption("--runtime-history", true, 'L');
+        argManager.addOption("--trace-out", true, 'O');
+        argManager.addOption("--changed-since", true, 'D');
+        argManager.addOption("--changed-files", true, 'F');
 
         // Parsing des arguments
         argManager.parse(argc, argv);
@@ -92,7 +101,10 @@ namespace ctrace
         // processor.execute(argManager);
 
         if (!(argManager.getOptionValue("--ipc") == "serve") &&
-            (argManager.hasOption("--serve-host") || argManager.hasOption("--serve-port")))
+            (argManager.hasOption("--serve-host") || argManager.hasOption("--serve-port") ||
+             argManager.hasOption("--serve-workers") ||
+             argManager.hasOption("--serve-max-analyses") ||
+             argManager.hasOption("--serve-max-queued")))
         {
             std::cout << "[INFO] UNCONSISTENT SERVER OPTIONS: --serve-host or --serve-port needed "
                          "--ipc=server."
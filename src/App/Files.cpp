@@ -1,11 +1,12 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "App/Files.hpp"
 
+#include "App/CompileDatabaseIndex.hpp"
+#include "App/Manifest.hpp"
+#include "App/MappedFile.hpp"
+#include "Process/Trace.hpp"
+
 #include <filesystem>
-#include <fstream>
-#include <nlohmann/json.hpp>
-#include <sstream>
-#include <string_view>
 #include <system_error>
 #include <unordered_set>
 
@@ -13,28 +14,20 @@ namespace ctrace
 {
     namespace
     {
-        [[nodiscard]] bool hasPathSegment(const std::filesystem::path& path,
-                                          std::string_view segment)
+        [[nodiscard]] bool readManifest(const std::string& entry, ManifestContents& contents)
         {
-            if (segment.empty())
+            MappedFile file;
+            if (!file.open(entry))
             {
                 return false;
             }
-            for (const auto& part : path)
-            {
-                if (part == std::filesystem::path(segment))
-                {
-                    return true;
-                }
-            }
-            return false;
+            return parseManifest(file.contents(), contents);
         }
     } // namespace
 
     CT_NODISCARD std::vector<std::string> resolveSourceFiles(const ProgramConfig& config)
     {
-        using json = nlohmann::json;
-
+        const trace::ScopedSpan span(trace::Phase::ResolveFiles, "resolve_files");
         std::vector<std::string> sourceFiles;
         std::unordered_set<std::string> seenPaths;
         seenPaths.reserve(config.files.size() + 1);
@@ -93,135 +86,88 @@ namespace ctrace
             const bool filterDependencyEntries =
                 isCompdbAutoDiscoveryEntry && !config.global.include_compdb_deps;
 
-            const auto shouldSkipDependencyEntry = [&](const std::string& candidate,
-                                                       const std::filesystem::path& baseDir) -> bool
-            {
-                if (!filterDependencyEntries || candidate.empty())
-                {
-                    return false;
-                }
-                std::filesystem::path resolved(candidate);
-                if (resolved.is_relative() && !baseDir.empty())
-                {
-                    resolved = baseDir / resolved;
-                }
-                return hasPathSegment(resolved.lexically_normal(), "_deps");
-            };
-
             bool expanded = false;
-            if (!entry.empty() && (entry.ends_with(".json") || entry.ends_with(".JSON")))
+            bool indexed = false;
+            if (isCompdbAutoDiscoveryEntry)
             {
-                std::ifstream manifestStream(entry);
-                if (manifestStream.is_open())
+                // The binary index lists the same files without parsing the JSON again;
+                // databases it cannot describe fully go through the manifest parser below.
+                std::string indexError;
+                const auto index = CompileDatabaseIndex::open(entry, indexError);
+                if (index && index->selfContained())
                 {
-                    std::ostringstream buffer;
-                    buffer << manifestStream.rdbuf();
-
-                    const auto manifest = json::parse(buffer.str(), nullptr, false);
-                    if (!manifest.is_discarded())
+                    indexed = true;
+                    sourceFiles.reserve(sourceFiles.size() + index->size());
+                    seenPaths.reserve(seenPaths.size() + index->size());
+                    for (std::size_t i = 0; i < index->size(); ++i)
                     {
-                        const std::filesystem::path manifestDir =
-                            std::filesystem::path(entry).parent_path();
-
-                        const auto appendFromArray = [&](const json& arr) -> bool
+                        if (filterDependencyEntries && index->isDependency(i))
                         {
-                            bool appended = false;
-                            for (const auto& item : arr)
-                            {
-                                if (item.is_string())
-                                {
-                                    const auto candidate = item.get<std::string>();
-                                    if (shouldSkipDependencyEntry(candidate, manifestDir))
-                                    {
-                                        continue;
-                                    }
-                                    appended |= appendResolved(candidate, manifestDir);
-                                }
-                                else if (item.is_object())
-                                {
-                                    if (const auto it = item.find("file");
-                                        it != item.end() && it->is_string())
-                                    {
-                                        std::filesystem::path entryBase = manifestDir;
-                                        if (const auto itDir = item.find("directory");
-                                            itDir != item.end() && itDir->is_string())
-                                        {
-                                            entryBase = itDir->get<std::string>();
-                                            if (entryBase.is_relative())
-                                            {
-                                                entryBase = manifestDir / entryBase;
-                                            }
-                                        }
-                                        const auto candidate = it->get<std::string>();
-                                        if (shouldSkipDependencyEntry(candidate, entryBase))
-                                        {
-                                            continue;
-                                        }
-                                        appended |= appendResolved(candidate, entryBase);
-                                    }
-                                    else if (const auto itSrc = item.find("src_file");
-                                             itSrc != item.end() && itSrc->is_string())
-                                    {
-                                        const auto candidate = itSrc->get<std::string>();
-                                        if (shouldSkipDependencyEntry(candidate, manifestDir))
-                                        {
-                                            continue;
-                                        }
-                                        appended |= appendResolved(candidate, manifestDir);
-                                    }
-                                    else if (const auto itPath = item.find("path");
-                                             itPath != item.end() && itPath->is_string())
-                                    {
-                                        const auto candidate = itPath->get<std::string>();
-                                        if (shouldSkipDependencyEntry(candidate, manifestDir))
-                                        {
-                                            continue;
-                                        }
-                                        appended |= appendResolved(candidate, manifestDir);
-                                    }
-                                }
-                            }
-                            return appended;
-                        };
-
-                        if (manifest.is_array())
+                            continue;
+                        }
+                        std::string path(index->file(i));
+                        if (seenPaths.insert(path).second)
                         {
-                            expanded = appendFromArray(manifest);
+                            sourceFiles.push_back(std::move(path));
+                            expanded = true;
                         }
-                        else if (manifest.is_object())
+                    }
+                }
+            }
+
+            ManifestContents manifest;
+            if (!indexed && !entry.empty() &&
+                (entry.ends_with(".json") || entry.ends_with(".JSON")) &&
+                readManifest(entry, manifest))
+            {
+                const std::filesystem::path manifestDir =
+                    std::filesystem::path(entry).parent_path();
+
+                const auto appendFromEntries = [&](const std::vector<ManifestEntry>& entries)
+                {
+                    const auto resolved =
+                        resolveManifestEntries(entries, manifestDir, filterDependencyEntries);
+                    sourceFiles.reserve(sourceFiles.size() + resolved.size());
+                    seenPaths.reserve(seenPaths.size() + resolved.size());
+                    bool appended = false;
+                    for (auto& path : resolved)
+                    {
+                        if (!path.empty() && seenPaths.insert(path).second)
                         {
-                            if (const auto it = manifest.find("files");
-                                it != manifest.end() && it->is_array())
-                            {
-                                expanded = appendFromArray(*it);
-                            }
-                            else if (const auto it = manifest.find("sources");
-                                     it != manifest.end() && it->is_array())
-                            {
-                                expanded = appendFromArray(*it);
-                            }
-                            else if (const auto it = manifest.find("compile_commands");
-                                     it != manifest.end() && it->is_array())
-                            {
-                                expanded = appendFromArray(*it);
-                            }
-                            else if (const auto itFile = manifest.find("file");
-                                     itFile != manifest.end() && itFile->is_string())
-                            {
-                                expanded = appendResolved(itFile->get<std::string>(), manifestDir);
-                            }
-                            else if (const auto itSrc = manifest.find("src_file");
-                                     itSrc != manifest.end() && itSrc->is_string())
-                            {
-                                expanded = appendResolved(itSrc->get<std::string>(), manifestDir);
-                            }
-                            else if (const auto itPath = manifest.find("path");
-                                     itPath != manifest.end() && itPath->is_string())
-                            {
-                                expanded = appendResolved(itPath->get<std::string>(), manifestDir);
-                            }
+                            sourceFiles.push_back(std::move(path));
+                            appended = true;
                         }
                     }
+                    return appended;
+                };
+
+                if (manifest.rootArray)
+                {
+                    expanded = appendFromEntries(*manifest.rootArray);
+                }
+                else if (manifest.files)
+                {
+                    expanded = appendFromEntries(*manifest.files);
+                }
+                else if (manifest.sources)
+                {
+                    expanded = appendFromEntries(*manifest.sources);
+                }
+                else if (manifest.compileCommands)
+                {
+                    expanded = appendFromEntries(*manifest.compileCommands);
+                }
+                else if (manifest.rootFile)
+                {
+                    expanded = appendResolved(*manifest.rootFile, manifestDir);
+                }
+                else if (manifest.rootSrcFile)
+                {
+                    expanded = appendResolved(*manifest.rootSrcFile, manifestDir);
+                }
+                else if (manifest.rootPath)
+                {
+                    expanded = appendResolved(*manifest.rootPath, manifestDir);
                 }
             }
 
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/Incremental.hpp"
+
+#include "App/CompileDatabase.hpp"
+#include "Process/ProcessFactory.hpp"
+
+#include <coretrace/logger.hpp>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+
+namespace ctrace
+{
+    namespace
+    {
+        constexpr std::string_view kIncrementalModule = "incremental";
+
+        constexpr std::array<std::string_view, 11> kHeaderExtensions = {
+            ".h", ".hh", ".hpp", ".hxx", ".h++", ".inc", ".inl", ".ipp", ".tpp", ".tcc", ".def"};
+
+        [[nodiscard]] bool hasHeaderExtension(const std::string& path)
+        {
+            const std::string extension = std::filesystem::path(path).extension().string();
+            return std::find(kHeaderExtensions.begin(), kHeaderExtensions.end(), extension) !=
+                   kHeaderExtensions.end();
+        }
+
+        /**
+         * @brief Runs git and returns its stdout split into lines.
+         *
+         * Git's stderr (warnings, and the reason of a failure) goes to ours.
+         */
+        [[nodiscard]] std::optional<std::vector<std::string>>
+        runGit(const std::vector<std::string>& args, std::string& error)
+        {
+            auto process = ProcessFactory::createProcess("git", args);
+            process->setCaptureStderr(false);
+            process->execute();
+            if (process->exitCode != 0)
+            {
+                std::string command = "git";
+                for (const auto& arg : args)
+                {
+                    command += " " + arg;
+                }
+                error = "'" + command + "' failed with exit code " +
+                        std::to_string(process->exitCode);
+                return std::nullopt;
+            }
+
+            std::vector<std::string> lines;
+            std::string_view output = process->logOutput;
+            while (!output.empty())
+            {
+                const auto end = output.find('\n');
+                std::string_view line = output.substr(0, end);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.remove_suffix(1);
+                }
+                if (!line.empty())
+                {
+                    lines.emplace_back(line);
+                }
+                if (end == std::string_view::npos)
+                {
+                    break;
+                }
+                output.remove_prefix(end + 1);
+            }
+            return lines;
+        }
+
+        void appendChangedFilesArgument(const std::string& entry,
+                                        std::unordered_set<std::string>& changed)
+        {
+            // "@list.txt" names a file holding one path per line.
+            if (entry.size() > 1 && entry.front() == '@')
+            {
+                std::ifstream list(entry.substr(1));
+                std::string line;
+                while (std::getline(list, line))
+                {
+                    if (!line.empty() && line.back() == '\r')
+                    {
+                        line.pop_back();
+                    }
+                    if (!line.empty())
+                    {
+                        changed.insert(normalizeSourcePath(line));
+                    }
+                }
+                return;
+            }
+            changed.insert(normalizeSourcePath(entry));
+        }
+    } // namespace
+
+    CT_NODISCARD bool isIncrementalRun(const ProgramConfig& config)
+    {
+        return !config.global.changed_since.empty() || !config.global.changed_files.empty();
+    }
+
+    CT_NODISCARD std::optional<std::vector<std::string>>
+    collectChangedPaths(const ProgramConfig& config, std::string& error)
+    {
+        std::unordered_set<std::string> changed;
+        for (const auto& entry : config.global.changed_files)
+        {
+            appendChangedFilesArgument(entry, changed);
+        }
+
+        const std::string& revision = config.global.changed_since;
+        if (!revision.empty())
+        {
+            if (revision.front() == '-')
+            {
+                error = "Invalid revision for --changed-since: '" + revision + "'";
+                return std::nullopt;
+            }
+
+            const auto topLevel = runGit({"rev-parse", "--show-toplevel"}, error);
+            if (!topLevel || topLevel->empty())
+            {
+                if (error.empty())
+                {
+                    error = "Unable to locate the git work tree";
+                }
+                return std::nullopt;
+            }
+            const std::filesystem::path root = topLevel->front();
+
+            // Work tree against <rev>, so uncommitted edits count, plus files git does not
+            // track yet.
+            const auto diff = runGit({"-c", "core.quotePath=false", "-C", root.string(), "diff",
+                                      "--name-only", "--no-ext-diff", revision, "--"},
+                                     error);
+            if (!diff)
+            {
+                return std::nullopt;
+            }
+            const auto untracked = runGit({"-c", "core.quotePath=false", "-C", root.string(),
+                                           "ls-files", "--others", "--exclude-standard"},
+                                          error);
+            if (!untracked)
+            {
+                return std::nullopt;
+            }
+
+            for (const auto* list : {&*diff, &*untracked})
+            {
+                for (const auto& path : *list)
+                {
+                    changed.insert((root / path).lexically_normal().string());
+                }
+            }
+        }
+
+        std::vector<std::string> paths(changed.begin(), changed.end());
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    CT_NODISCARD std::vector<std::string>
+    selectAffectedSources(const ProgramConfig& config, const std::vector<std::string>& sourceFiles,
+                          const std::vector<std::string>& changedPaths)
+    {
+        const std::unordered_set<std::string> changed(changedPaths.begin(), changedPaths.end());
+
+        std::optional<CompileDatabase> database;
+        if (!config.global.compile_commands.empty())
+        {
+            std::string error;
+            database = CompileDatabase::load(config.global.compile_commands, error);
+            if (!database)
+            {
+                coretrace::log(coretrace::Level::Warn, coretrace::Module(kIncrementalModule),
+                               "{}; header dependencies are unknown\n", error);
+            }
+        }
+
+        std::unordered_set<std::string> translationUnits;
+        translationUnits.reserve(sourceFiles.size());
+        for (const auto& file : sourceFiles)
+        {
+            translationUnits.insert(normalizeSourcePath(file));
+        }
+
+        // A changed header that no depfile can be checked against affects any file.
+        const bool headerChanged =
+            std::any_of(changedPaths.begin(), changedPaths.end(),
+                        [&](const std::string& path)
+                        {
+                            return hasHeaderExtension(path) && !translationUnits.count(path) &&
+                                   !(database && database->find(path));
+                        });
+
+        std::vector<std::string> selected;
+        std::size_t selectedWithoutDepfile = 0;
+        for (const auto& file : sourceFiles)
+        {
+            const std::string normalized = normalizeSourcePath(file);
+            if (changed.count(normalized))
+            {
+                selected.push_back(file);
+                continue;
+            }
+
+            const CompileCommand* command = database ? database->find(normalized) : nullptr;
+            std::optional<std::vector<std::string>> dependencies;
+            if (command != nullptr)
+            {
+                dependencies = readDepfileDependencies(*command);
+            }
+            if (!dependencies)
+            {
+                if (headerChanged)
+                {
+                    selected.push_back(file);
+                    ++selectedWithoutDepfile;
+                }
+                continue;
+            }
+
+            if (std::any_of(dependencies->begin(), dependencies->end(),
+                            [&](const std::string& dependency)
+                            { return changed.count(dependency) != 0; }))
+            {
+                selected.push_back(file);
+            }
+        }
+
+        if (selectedWithoutDepfile > 0)
+        {
+            coretrace::log(coretrace::Level::Warn, coretrace::Module(kIncrementalModule),
+                           "{} file(s) have no depfile and were kept because a header changed; "
+                           "build the project once to narrow the selection\n",
+                           selectedWithoutDepfile);
+        }
+        return selected;
+    }
+} // namespace ctrace
@@ -0,0 +1,750 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/Manifest.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace ctrace
+{
+    namespace
+    {
+        [[nodiscard]] bool hasPathSegment(const std::filesystem::path& path,
+                                          std::string_view segment)
+        {
+            if (segment.empty())
+            {
+                return false;
+            }
+            for (const auto& part : path)
+            {
+                if (part == std::filesystem::path(segment))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Receives manifest events and keeps only the fields of its ManifestMode.
+         *
+         * `wantsString()` tells the parser whether the next string value is needed, so
+         * compiler arguments and other values are skipped without being decoded when only
+         * source paths are wanted.
+         */
+        class ManifestCollector
+        {
+          public:
+            ManifestCollector(ManifestContents& contents, ManifestMode mode)
+                : m_contents(contents), m_compileCommands(mode == ManifestMode::CompileCommands)
+            {
+            }
+
+            [[nodiscard]] bool wantsString() const
+            {
+                if (m_frames.empty())
+                {
+                    return false;
+                }
+                switch (m_frames.back().kind)
+                {
+                case FrameKind::EntryArray:
+                    return !m_compileCommands;
+                case FrameKind::RootObject:
+                    return m_key == "file" || m_key == "src_file" || m_key == "path";
+                case FrameKind::EntryObject:
+                    if (m_key == "file" || m_key == "directory")
+                    {
+                        return true;
+                    }
+                    return m_compileCommands ? m_key == "command" || m_key == "output"
+                                             : m_key == "src_file" || m_key == "path";
+                case FrameKind::ArgumentArray:
+                    return true;
+                case FrameKind::Skip:
+                    break;
+                }
+                return false;
+            }
+
+            void string(std::string& value)
+            {
+                if (m_frames.empty())
+                {
+                    return;
+                }
+                Frame& top = m_frames.back();
+                switch (top.kind)
+                {
+                case FrameKind::EntryArray:
+                    top.entries->emplace_back().candidate = std::move(value);
+                    break;
+                case FrameKind::RootObject:
+                    if (m_key == "file")
+                    {
+                        m_contents.rootFile = std::move(value);
+                    }
+                    else if (m_key == "src_file")
+                    {
+                        m_contents.rootSrcFile = std::move(value);
+                    }
+                    else if (m_key == "path")
+                    {
+                        m_contents.rootPath = std::move(value);
+                    }
+                    break;
+                case FrameKind::EntryObject:
+                    if (m_key == "file")
+                    {
+                        m_entry.file = std::move(value);
+                    }
+                    else if (m_key == "directory")
+                    {
+                        m_entry.fields.directory = std::move(value);
+                    }
+                    else if (m_key == "src_file")
+                    {
+                        m_entry.srcFile = std::move(value);
+                    }
+                    else if (m_key == "path")
+                    {
+                        m_entry.path = std::move(value);
+                    }
+                    else if (m_key == "command")
+                    {
+                        m_entry.fields.command = std::move(value);
+                    }
+                    else if (m_key == "output")
+                    {
+                        m_entry.fields.output = std::move(value);
+                    }
+                    break;
+                case FrameKind::ArgumentArray:
+                    m_entry.fields.arguments->push_back(std::move(value));
+                    break;
+                case FrameKind::Skip:
+                    break;
+                }
+            }
+
+            /// Numbers, booleans, null and strings that were not wanted.
+            void scalar()
+            {
+                if (!m_frames.empty() && m_frames.back().kind == FrameKind::EntryArray)
+                {
+                    ++m_contents.skippedItems;
+                }
+            }
+
+            void startObject()
+            {
+                if (m_frames.empty())
+                {
+                    m_frames.push_back({FrameKind::RootObject, nullptr});
+                }
+                else if (m_frames.back().kind == FrameKind::EntryArray)
+                {
+                    m_entry = {};
+                    m_frames.push_back({FrameKind::EntryObject, m_frames.back().entries});
+                }
+                else
+                {
+                    m_frames.push_back({FrameKind::Skip, nullptr});
+                }
+            }
+
+            void key(std::string& key)
+            {
+                const FrameKind kind = m_frames.back().kind;
+                if (kind == FrameKind::RootObject || kind == FrameKind::EntryObject)
+                {
+                    std::swap(m_key, key);
+                }
+            }
+
+            void endObject()
+            {
+                const Frame frame = m_frames.back();
+                m_frames.pop_back();
+                if (frame.kind != FrameKind::EntryObject)
+                {
+                    return;
+                }
+                // Same precedence as the accepted item shapes: "file" (with its "directory"),
+                // then "src_file", then "path".
+                ManifestEntry& entry = m_entry.fields;
+                if (m_entry.file)
+                {
+                    entry.candidate = std::move(*m_entry.file);
+                }
+                else if (m_entry.srcFile)
+                {
+                    entry.candidate = std::move(*m_entry.srcFile);
+                    entry.directory.reset();
+                }
+                else if (m_entry.path)
+                {
+                    entry.candidate = std::move(*m_entry.path);
+                    entry.directory.reset();
+                }
+                else
+                {
+                    ++m_contents.skippedItems;
+                    return;
+                }
+                frame.entries->push_back(std::move(entry));
+            }
+
+            void startArray()
+            {
+                std::optional<std::vector<ManifestEntry>>* target = nullptr;
+                if (m_frames.empty())
+                {
+                    target = &m_contents.rootArray;
+                }
+                else if (m_frames.back().kind == FrameKind::RootObject && !m_compileCommands)
+                {
+                    if (m_key == "files")
+                    {
+                        target = &m_contents.files;
+                    }
+                    else if (m_key == "sources")
+                    {
+                        target = &m_contents.sources;
+                    }
+                    else if (m_key == "compile_commands")
+                    {
+                        target = &m_contents.compileCommands;
+                    }
+                }
+                else if (m_frames.back().kind == FrameKind::EntryObject && m_compileCommands &&
+                         m_key == "arguments")
+                {
+                    m_entry.fields.arguments.emplace();
+                    m_frames.push_back({FrameKind::ArgumentArray, nullptr});
+                    return;
+                }
+                else if (m_frames.back().kind == FrameKind::EntryArray)
+                {
+                    ++m_contents.skippedItems;
+                }
+
+                if (target == nullptr)
+                {
+                    m_frames.push_back({FrameKind::Skip, nullptr});
+                    return;
+                }
+                target->emplace(); // A repeated key replaces the earlier value.
+                m_frames.push_back({FrameKind::EntryArray, &**target});
+            }
+
+            void endArray()
+            {
+                m_frames.pop_back();
+            }
+
+          private:
+            enum class FrameKind
+            {
+                RootObject,
+                EntryArray,    ///< Elements are manifest entries.
+                EntryObject,   ///< One `{"file", "directory", ...}` entry.
+                ArgumentArray, ///< "arguments" of an entry, in compile-commands mode.
+                Skip           ///< Anything else, e.g. "arguments" when only sources are wanted.
+            };
+
+            struct Frame
+            {
+                FrameKind kind;
+                std::vector<ManifestEntry>* entries;
+            };
+
+            /// The entry object being read; `fields.candidate` is chosen when it ends.
+            struct PendingEntry
+            {
+                ManifestEntry fields;
+                std::optional<std::string> file;
+                std::optional<std::string> srcFile;
+                std::optional<std::string> path;
+            };
+
+            ManifestContents& m_contents;
+            bool m_compileCommands;
+            std::vector<Frame> m_frames;
+            std::string m_key;
+            PendingEntry m_entry;
+        };
+
+        /**
+         * @brief Strict, non-recursive JSON parser feeding a ManifestCollector.
+         *
+         * A general-purpose parser decodes every string, and compile databases are mostly
+         * compiler arguments that are never used. Strings the collector does not want are only
+         * validated and skipped. Input that is not valid JSON is rejected as a whole.
+         */
+        class ManifestParser
+        {
+          public:
+            ManifestParser(std::string_view text, ManifestCollector& collector)
+                : m_text(text), m_collector(collector)
+            {
+                if (m_text.starts_with("\xEF\xBB\xBF"))
+                {
+                    m_pos = 3;
+                }
+            }
+
+            [[nodiscard]] bool parse()
+            {
+                if (!parseValue())
+                {
+                    return false;
+                }
+                skipWhitespace();
+                return m_pos == m_text.size();
+            }
+
+          private:
+            enum class Container : char
+            {
+                Object,
+                Array
+            };
+
+            [[nodiscard]] bool parseValue()
+            {
+                std::vector<Container> stack;
+                while (true)
+                {
+                    skipWhitespace();
+                    if (m_pos == m_text.size())
+                    {
+                        return false;
+                    }
+
+                    const char c = m_text[m_pos];
+                    if (c == '{' || c == '[')
+                    {
+                        ++m_pos;
+                        const bool isObject = c == '{';
+                        isObject ? m_collector.startObject() : m_collector.startArray();
+                        skipWhitespace();
+                        if (consume(isObject ? '}' : ']'))
+                        {
+                            isObject ? m_collector.endObject() : m_collector.endArray();
+                        }
+                        else
+                        {
+                            stack.push_back(isObject ? Container::Object : Container::Array);
+                            if (isObject && !parseKey())
+                            {
+                                return false;
+                            }
+                            continue;
+                        }
+                    }
+                    else if (c == '"')
+                    {
+                        ++m_pos;
+                        if (m_collector.wantsString())
+                        {
+                            if (!decodeString(m_string))
+                            {
+                                return false;
+                            }
+                            m_collector.string(m_string);
+                        }
+                        else if (skipString())
+                        {
+                            m_collector.scalar();
+                        }
+                        else
+                        {
+                            return false;
+                        }
+                    }
+                    else if (!parseLiteral())
+                    {
+                        return false;
+                    }
+
+                    // A value is complete: close finished containers, then move to the next
+                    // element.
+                    while (true)
+                    {
+                        if (stack.empty())
+                        {
+                            return true;
+                        }
+                        skipWhitespace();
+                        if (consume(','))
+                        {
+                            if (stack.back() == Container::Object && !parseKey())
+                            {
+                                return false;
+                            }
+                            break;
+                        }
+                        if (consume(stack.back() == Container::Object ? '}' : ']'))
+                        {
+                            stack.back() == Container::Object ? m_collector.endObject()
+                                                              : m_collector.endArray();
+                            stack.pop_back();
+                            continue;
+                        }
+                        return false;
+                    }
+                }
+            }
+
+            [[nodiscard]] bool parseKey()
+            {
+                skipWhitespace();
+                if (!consume('"') || !decodeString(m_string))
+                {
+                    return false;
+                }
+                m_collector.key(m_string);
+                skipWhitespace();
+                return consume(':');
+            }
+
+            [[nodiscard]] bool skipString()
+            {
+                while (m_pos < m_text.size())
+                {
+                    const auto c = static_cast<unsigned char>(m_text[m_pos++]);
+                    if (c == '"')
+                    {
+                        return true;
+                    }
+                    if (c < 0x20)
+                    {
+                        return false;
+                    }
+                    if (c == '\\')
+                    {
+                        if (m_pos == m_text.size())
+                        {
+                            return false;
+                        }
+                        const char escaped = m_text[m_pos++];
+                        if (escaped == 'u')
+                        {
+                            unsigned ignored = 0;
+                            if (!readHex4(ignored))
+                            {
+                                return false;
+                            }
+                        }
+                        else if (!isSimpleEscape(escaped))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            [[nodiscard]] bool decodeString(std::string& out)
+            {
+                out.clear();
+                while (m_pos < m_text.size())
+                {
+                    // Copy the run up to the next quote or escape in one go.
+                    std::size_t end = m_pos;
+                    while (end < m_text.size() && m_text[end] != '"' && m_text[end] != '\\' &&
+                           static_cast<unsigned char>(m_text[end]) >= 0x20)
+                    {
+                        ++end;
+                    }
+                    out.append(m_text.data() + m_pos, end - m_pos);
+                    m_pos = end;
+                    if (m_pos == m_text.size())
+                    {
+                        return false;
+                    }
+
+                    const char c = m_text[m_pos++];
+                    if (c == '"')
+                    {
+                        return true;
+                    }
+                    if (c != '\\' || m_pos == m_text.size())
+                    {
+                        return false; // Raw control character, or a trailing backslash.
+                    }
+                    const char escaped = m_text[m_pos++];
+                    switch (escaped)
+                    {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        out.push_back(escaped);
+                        break;
+                    case 'b':
+                        out.push_back('\b');
+                        break;
+                    case 'f':
+                        out.push_back('\f');
+                        break;
+                    case 'n':
+                        out.push_back('\n');
+                        break;
+                    case 'r':
+                        out.push_back('\r');
+                        break;
+                    case 't':
+                        out.push_back('\t');
+                        break;
+                    case 'u':
+                        if (!decodeUnicodeEscape(out))
+                        {
+                            return false;
+                        }
+                        break;
+                    default:
+                        return false;
+                    }
+                }
+                return false;
+            }
+
+            [[nodiscard]] bool decodeUnicodeEscape(std::string& out)
+            {
+                unsigned codePoint = 0;
+                if (!readHex4(codePoint))
+                {
+                    return false;
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+                {
+                    unsigned low = 0;
+                    if (!m_text.substr(m_pos).starts_with("\\u"))
+                    {
+                        return false;
+                    }
+                    m_pos += 2;
+                    if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF)
+                    {
+                        return false;
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+                {
+                    return false;
+                }
+
+                if (codePoint < 0x80)
+                {
+                    out.push_back(static_cast<char>(codePoint));
+                }
+                else if (codePoint < 0x800)
+                {
+                    out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                }
+                return true;
+            }
+
+            [[nodiscard]] bool readHex4(unsigned& value)
+            {
+                if (m_text.size() - m_pos < 4)
+                {
+                    return false;
+                }
+                value = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    const char c = m_text[m_pos++];
+                    value <<= 4;
+                    if (c >= '0' && c <= '9')
+                    {
+                        value |= static_cast<unsigned>(c - '0');
+                    }
+                    else if (c >= 'a' && c <= 'f')
+                    {
+                        value |= static_cast<unsigned>(c - 'a' + 10);
+                    }
+                    else if (c >= 'A' && c <= 'F')
+                    {
+                        value |= static_cast<unsigned>(c - 'A' + 10);
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            [[nodiscard]] static bool isSimpleEscape(char c)
+            {
+                return c == '"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' ||
+                       c == 'r' || c == 't';
+            }
+
+            /// `true`, `false`, `null` or a number in JSON grammar.
+            [[nodiscard]] bool parseLiteral()
+            {
+                for (const std::string_view literal : {"true", "false", "null"})
+                {
+                    if (m_text.substr(m_pos).starts_with(literal))
+                    {
+                        m_pos += literal.size();
+                        m_collector.scalar();
+                        return true;
+                    }
+                }
+
+                consume('-');
+                if (consume('0'))
+                {
+                }
+                else if (!consumeDigits())
+                {
+                    return false;
+                }
+                if (consume('.') && !consumeDigits())
+                {
+                    return false;
+                }
+                if (consume('e') || consume('E'))
+                {
+                    if (!consume('+'))
+                    {
+                        consume('-');
+                    }
+                    if (!consumeDigits())
+                    {
+                        return false;
+                    }
+                }
+                m_collector.scalar();
+                return true;
+            }
+
+            bool consumeDigits()
+            {
+                const std::size_t start = m_pos;
+                while (m_pos < m_text.size() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9')
+                {
+                    ++m_pos;
+                }
+                return m_pos != start;
+            }
+
+            bool consume(char expected)
+            {
+                if (m_pos < m_text.size() && m_text[m_pos] == expected)
+                {
+                    ++m_pos;
+                    return true;
+                }
+                return false;
+            }
+
+            void skipWhitespace()
+            {
+                while (m_pos < m_text.size() &&
+                       (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r' ||
+                        m_text[m_pos] == '\t'))
+                {
+                    ++m_pos;
+                }
+            }
+
+            std::string_view m_text;
+            std::size_t m_pos = 0;
+            ManifestCollector& m_collector;
+            std::string m_string; ///< Reused buffer for decoded keys and wanted values.
+        };
+    } // namespace
+
+    CT_NODISCARD bool parseManifest(std::string_view text, ManifestContents& contents,
+                                    ManifestMode mode)
+    {
+        ManifestCollector collector(contents, mode);
+        return ManifestParser(text, collector).parse();
+    }
+
+    CT_NODISCARD std::vector<std::string>
+    resolveManifestEntries(const std::vector<ManifestEntry>& entries,
+                           const std::filesystem::path& manifestDir, bool skipDependencies,
+                           std::size_t maxWorkers)
+    {
+        std::vector<std::string> resolved(entries.size());
+        const auto resolveRange = [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const ManifestEntry& entry = entries[i];
+                if (entry.candidate.empty())
+                {
+                    continue;
+                }
+                std::filesystem::path baseDir = manifestDir;
+                if (entry.directory)
+                {
+                    baseDir = *entry.directory;
+                    if (baseDir.is_relative())
+                    {
+                        baseDir = manifestDir / baseDir;
+                    }
+                }
+                std::filesystem::path path(entry.candidate);
+                if (path.is_relative() && !baseDir.empty())
+                {
+                    path = baseDir / path;
+                }
+                path = path.lexically_normal();
+                if (skipDependencies && hasPathSegment(path, "_deps"))
+                {
+                    continue;
+                }
+                resolved[i] = path.string();
+            }
+        };
+
+        const std::size_t limit =
+            maxWorkers != 0 ? maxWorkers : std::max(1U, std::thread::hardware_concurrency());
+        const std::size_t workers =
+            std::clamp<std::size_t>(entries.size() / kMinManifestEntriesPerWorker, 1, limit);
+        if (workers == 1)
+        {
+            resolveRange(0, entries.size());
+            return resolved;
+        }
+
+        const std::size_t chunk = (entries.size() + workers - 1) / workers;
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (std::size_t w = 1; w < workers; ++w)
+        {
+            const std::size_t begin = std::min(entries.size(), w * chunk);
+            const std::size_t end = std::min(entries.size(), begin + chunk);
+            threads.emplace_back(resolveRange, begin, end);
+        }
+        resolveRange(0, std::min(entries.size(), chunk));
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return resolved;
+    }
+} // namespace ctrace
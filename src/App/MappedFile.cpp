@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/MappedFile.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ctrace
+{
+    MappedFile::~MappedFile()
+    {
+        reset();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_mapped = std::exchange(other.m_mapped, false);
+            m_fallback = std::move(other.m_fallback);
+            m_size = std::exchange(other.m_size, 0);
+            m_data = m_mapped ? std::exchange(other.m_data, nullptr) : m_fallback.data();
+            other.m_data = nullptr;
+        }
+        return *this;
+    }
+
+    CT_NODISCARD bool MappedFile::open(const std::filesystem::path& path)
+    {
+        reset();
+#if !defined(_WIN32)
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            if (st.st_size == 0)
+            {
+                close(fd);
+                m_data = m_fallback.data();
+                return true;
+            }
+            void* mapping =
+                mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                close(fd);
+                // Parsers read front to back.
+                (void)madvise(mapping, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(mapping);
+                m_size = static_cast<std::size_t>(st.st_size);
+                m_mapped = true;
+                return true;
+            }
+        }
+        close(fd);
+#endif
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+        m_fallback = buffer.str();
+        m_data = m_fallback.data();
+        m_size = m_fallback.size();
+        return true;
+    }
+
+    void MappedFile::reset() noexcept
+    {
+#if !defined(_WIN32)
+        if (m_mapped)
+        {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+        m_mapped = false;
+        m_data = nullptr;
+        m_size = 0;
+        m_fallback.clear();
+    }
+} // namespace ctrace
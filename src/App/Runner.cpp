@@ -2,22 +2,43 @@
 #include "App/Runner.hpp"
 
 #include "App/Files.hpp"
+#include "App/Incremental.hpp"
+#include "Process/ExecutionControl.hpp"
 #include "Process/Ipc/HttpServer.hpp"
 #include "Process/Tools/ToolsInvoker.hpp"
 
 #include <coretrace/logger.hpp>
 
 #include <cstdlib>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace ctrace
 {
+    CT_NODISCARD std::optional<int> run_worker_mode(int argc, char* argv[])
+    {
+        if (argc < 2 || StackAnalyzerToolImplementation::kWorkerFlag != argv[1])
+        {
+            return std::nullopt;
+        }
+        return StackAnalyzerToolImplementation::runWorker(
+            std::vector<std::string>(argv + 2, argv + argc));
+    }
+
     CT_NODISCARD int run_server(const ProgramConfig& config)
     {
         coretrace::log(coretrace::Level::Info, "Starting in server at {}:{}\n",
                        config.global.serverHost, std::to_string(config.global.serverPort));
+        // Requests run concurrently on the shared worker pool.
+        coretrace::set_thread_safe(true);
         ConsoleLogger logger;
-        ApiHandler apiHandler(logger);
+        AdmissionController::Limits admission;
+        admission.max_active = static_cast<std::size_t>(config.global.serverMaxConcurrentAnalyses);
+        admission.max_queued = static_cast<std::size_t>(config.global.serverMaxQueuedAnalyses);
+        ApiHandler apiHandler(logger, config.global.result_cache_dir, config.global.runtime_history,
+                              static_cast<std::size_t>(config.global.serverWorkerThreads),
+                              admission);
         HttpServer server(apiHandler, logger, config.global);
         server.run(config.global.serverHost, config.global.serverPort);
         return EXIT_SUCCESS;
@@ -28,6 +49,8 @@ namespace ctrace
         const auto availableThreads = std::thread::hardware_concurrency();
         const auto poolSize = (availableThreads == 0) ? 1U : availableThreads;
         ctrace::ToolInvoker invoker(config, poolSize, config.global.hasAsync);
+        // Limited tools run in their own process group, out of reach of the terminal's Ctrl-C.
+        ctrace::process::forward_interrupts();
 
         if (config.global.hasAsync == std::launch::async)
         {
@@ -69,6 +92,29 @@ namespace ctrace
             return EXIT_FAILURE;
         }
 
+        if (isIncrementalRun(config))
+        {
+            std::string error;
+            const auto changedPaths = collectChangedPaths(config, error);
+            if (!changedPaths)
+            {
+                coretrace::log(coretrace::Level::Error, "{}\n", error);
+                return EXIT_FAILURE;
+            }
+
+            auto affected = selectAffectedSources(config, sourceFiles, *changedPaths);
+            coretrace::log(coretrace::Level::Info,
+                           "Incremental run: {} changed path(s), {} of {} file(s) affected\n",
+                           changedPaths->size(), affected.size(), sourceFiles.size());
+            if (affected.empty())
+            {
+                invoker.publishEmptyReport();
+                return EXIT_SUCCESS;
+            }
+            invoker.setWholeProgramFiles(std::move(sourceFiles));
+            sourceFiles = std::move(affected);
+        }
+
         for (const auto& file : sourceFiles)
         {
             coretrace::log(coretrace::Level::Debug, "Processing file: {}\n", file);
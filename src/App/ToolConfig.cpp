@@ -2,6 +2,7 @@
 #include "App/ToolConfig.hpp"
 
 #include "App/SupportedTools.hpp"
+#include "Process/Trace.hpp"
 
 #include <algorithm>
 #include <cctype>
@@ -23,6 +24,7 @@ namespace ctrace
         using json = nlohmann::json;
 
         constexpr uint64_t kToolConfigSchemaVersion = 1;
+        constexpr uint64_t kMaxStackAnalyzerShards = 1024;
 
         [[nodiscard]] std::filesystem::path
         resolvePathFromBase(const std::filesystem::path& baseDir, std::string_view rawPath)
@@ -734,13 +736,15 @@ namespace ctrace
             return true;
         }
 
-        [[nodiscard]] bool applyOutputSection(const json& section, ProgramConfig& config,
-                                              std::string& errorMessage)
+        [[nodiscard]] bool applyOutputSection(const json& section,
+                                              const std::filesystem::path& configDir,
+                                              ProgramConfig& config, std::string& errorMessage)
         {
             if (!validateKnownKeys(section,
                                    {
                                        "sarif_format",
                                        "report_file",
+                                       "sarif_baseline",
                                        "output_file",
                                        "verbose",
                                        "quiet",
@@ -804,6 +808,18 @@ namespace ctrace
                 config.global.report_file = stringValue;
             }
 
+            if (!readOptionalStringAny(section, {"sarif_baseline"}, stringValue, errorMessage,
+                                       "output.sarif_baseline", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                config.global.sarif_baseline =
+                    stringValue.empty() ? std::string()
+                                        : resolvePathFromBase(configDir, stringValue).string();
+            }
+
             if (!readOptionalStringAny(section, {"output_file"}, stringValue, errorMessage,
                                        "output.output_file", hasValue))
             {
@@ -817,14 +833,18 @@ namespace ctrace
             return true;
         }
 
-        [[nodiscard]] bool applyRuntimeSection(const json& section, ProgramConfig& config,
-                                               std::string& errorMessage)
+        [[nodiscard]] bool applyRuntimeSection(const json& section,
+                                               const std::filesystem::path& configDir,
+                                               ProgramConfig& config, std::string& errorMessage)
         {
             if (!validateKnownKeys(section,
                                    {
                                        "async",
                                        "ipc",
                                        "ipc_path",
+                                       "result_cache_dir",
+                                       "runtime_history",
+                                       "trace_out",
                                    },
                                    "runtime", errorMessage))
             {
@@ -868,6 +888,42 @@ namespace ctrace
                 config.global.ipcPath = stringValue;
             }
 
+            if (!readOptionalStringAny(section, {"result_cache_dir"}, stringValue, errorMessage,
+                                       "runtime.result_cache_dir", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                config.global.result_cache_dir =
+                    stringValue.empty() ? std::string()
+                                        : resolvePathFromBase(configDir, stringValue).string();
+            }
+
+            if (!readOptionalStringAny(section, {"runtime_history"}, stringValue, errorMessage,
+                                       "runtime.runtime_history", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                config.global.runtime_history =
+                    stringValue.empty() ? std::string()
+                                        : resolvePathFromBase(configDir, stringValue).string();
+            }
+
+            if (!readOptionalStringAny(section, {"trace_out"}, stringValue, errorMessage,
+                                       "runtime.trace_out", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                config.global.trace_out =
+                    stringValue.empty() ? std::string()
+                                        : resolvePathFromBase(configDir, stringValue).string();
+            }
+
             return true;
         }
 
@@ -880,6 +936,9 @@ namespace ctrace
                                        "port",
                                        "shutdown_token",
                                        "shutdown_timeout_ms",
+                                       "worker_threads",
+                                       "max_concurrent_analyses",
+                                       "max_queued_analyses",
                                    },
                                    "server", errorMessage))
             {
@@ -940,6 +999,51 @@ namespace ctrace
                 config.global.shutdownTimeoutMs = static_cast<int>(uintValue);
             }
 
+            if (!readOptionalUint64Any(section, {"worker_threads"}, uintValue, errorMessage,
+                                       "server.worker_threads", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                if (uintValue > 1024U)
+                {
+                    errorMessage = "server.worker_threads must be between 0 and 1024.";
+                    return false;
+                }
+                config.global.serverWorkerThreads = static_cast<int>(uintValue);
+            }
+
+            if (!readOptionalUint64Any(section, {"max_concurrent_analyses"}, uintValue,
+                                       errorMessage, "server.max_concurrent_analyses", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                if (uintValue > 1024U)
+                {
+                    errorMessage = "server.max_concurrent_analyses must be between 0 and 1024.";
+                    return false;
+                }
+                config.global.serverMaxConcurrentAnalyses = static_cast<int>(uintValue);
+            }
+
+            if (!readOptionalUint64Any(section, {"max_queued_analyses"}, uintValue, errorMessage,
+                                       "server.max_queued_analyses", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                if (uintValue > 65536U)
+                {
+                    errorMessage = "server.max_queued_analyses must be between 0 and 65536.";
+                    return false;
+                }
+                config.global.serverMaxQueuedAnalyses = static_cast<int>(uintValue);
+            }
+
             return true;
         }
 
@@ -1023,6 +1127,7 @@ namespace ctrace
                                        "exclude_dir",
                                        "exclude-dir",
                                        "jobs",
+                                       "shards",
                                        "resource_cross_tu",
                                        "resource-cross-tu",
                                        "no_resource_cross_tu",
@@ -1296,6 +1401,23 @@ namespace ctrace
                 config.global.stack_analyzer_jobs = trimCopy(stringValue);
             }
 
+            if (!readOptionalUint64Any(section, {"shards"}, uintValue, errorMessage,
+                                       std::string(location) + ".shards", hasValue))
+            {
+                return false;
+            }
+            if (hasValue)
+            {
+                if (uintValue > kMaxStackAnalyzerShards)
+                {
+                    errorMessage = "Invalid value '" + std::to_string(uintValue) + "' for '" +
+                                   std::string(location) + ".shards'. Allowed values: [0.." +
+                                   std::to_string(kMaxStackAnalyzerShards) + "]";
+                    return false;
+                }
+                config.global.stack_analyzer_shards = static_cast<uint32_t>(uintValue);
+            }
+
             if (!readOptionalStringAny(section, {"analysis-profile", "analysis_profile"},
                                        stringValue, errorMessage,
                                        std::string(location) + ".analysis_profile", hasValue))
@@ -1705,6 +1827,80 @@ namespace ctrace
             return true;
         }
 
+        [[nodiscard]] bool parseToolLimits(const json& object, process::ResourceLimits& limits,
+                                           std::string& errorMessage,
+                                           const std::string& locationPath)
+        {
+            if (!validateKnownKeys(object, {"timeout_ms", "max_rss_mb", "cpu_seconds"},
+                                   locationPath, errorMessage))
+            {
+                return false;
+            }
+
+            struct LimitField
+            {
+                const char* key;
+                uint64_t* target;
+            };
+            for (const auto& field : {LimitField{"timeout_ms", &limits.timeout_ms},
+                                      LimitField{"max_rss_mb", &limits.max_rss_mb},
+                                      LimitField{"cpu_seconds", &limits.cpu_seconds}})
+            {
+                bool hasValue = false;
+                uint64_t value = 0;
+                if (!readOptionalUint64Any(object, {field.key}, value, errorMessage,
+                                           locationPath + "." + field.key, hasValue))
+                {
+                    return false;
+                }
+                if (hasValue)
+                {
+                    *field.target = value;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Reads `tool_limits`: a `default` entry plus per-tool entries that override
+         * individual fields of it.
+         */
+        [[nodiscard]] bool applyToolLimitsSection(const json& section, ProgramConfig& config,
+                                                  std::string& errorMessage)
+        {
+            if (!validateKnownKeys(section,
+                                   {"default", "flawfinder", "ikos", "cppcheck", "tscancode",
+                                    "ctrace_stack_analyzer"},
+                                   "tool_limits", errorMessage))
+            {
+                return false;
+            }
+
+            if (const auto it = section.find("default"); it != section.end() && !it->is_null())
+            {
+                if (!parseToolLimits(*it, config.global.default_tool_limits, errorMessage,
+                                     "tool_limits.default"))
+                {
+                    return false;
+                }
+            }
+
+            for (auto it = section.begin(); it != section.end(); ++it)
+            {
+                if (it.key() == "default" || it->is_null())
+                {
+                    continue;
+                }
+                process::ResourceLimits limits = config.global.default_tool_limits;
+                if (!parseToolLimits(*it, limits, errorMessage, "tool_limits." + it.key()))
+                {
+                    return false;
+                }
+                config.global.tool_limits[it.key()] = limits;
+            }
+            return true;
+        }
+
         [[nodiscard]] bool applyCanonicalSections(const json& root,
                                                   const std::filesystem::path& configDir,
                                                   ProgramConfig& config, std::string& errorMessage)
@@ -1742,7 +1938,7 @@ namespace ctrace
                     errorMessage = "Expected object for 'output'.";
                     return false;
                 }
-                if (!applyOutputSection(*it, config, errorMessage))
+                if (!applyOutputSection(*it, configDir, config, errorMessage))
                 {
                     return false;
                 }
@@ -1755,7 +1951,7 @@ namespace ctrace
                     errorMessage = "Expected object for 'runtime'.";
                     return false;
                 }
-                if (!applyRuntimeSection(*it, config, errorMessage))
+                if (!applyRuntimeSection(*it, configDir, config, errorMessage))
                 {
                     return false;
                 }
@@ -1774,6 +1970,19 @@ namespace ctrace
                 }
             }
 
+            if (const auto it = root.find("tool_limits"); it != root.end() && !it->is_null())
+            {
+                if (!it->is_object())
+                {
+                    errorMessage = "Expected object for 'tool_limits'.";
+                    return false;
+                }
+                if (!applyToolLimitsSection(*it, config, errorMessage))
+                {
+                    return false;
+                }
+            }
+
             return true;
         }
     } // namespace
@@ -1781,6 +1990,7 @@ namespace ctrace
     bool applyToolConfigFile(ProgramConfig& config, std::string_view configPath,
                              std::string& errorMessage)
     {
+        const trace::ScopedSpan span(trace::Phase::ConfigLoad, "config", configPath);
         errorMessage.clear();
         if (configPath.empty())
         {
@@ -1803,6 +2013,7 @@ namespace ctrace
                                    "output",
                                    "runtime",
                                    "server",
+                                   "tool_limits",
                                    "stack_analyzer",
                                    "stack-analyzer",
                                    "invoke",
@@ -0,0 +1,393 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Ipc/RequestParams.hpp"
+
+#include "App/ToolConfig.hpp"
+#include "ctrace_tools/strings.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+namespace ctrace::ipc
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        struct BoolField
+        {
+            const char* key;
+            bool* target;
+        };
+
+        struct StringField
+        {
+            const char* key;
+            std::string* target;
+        };
+
+        struct Uint64Field
+        {
+            const char* key;
+            uint64_t* target;
+        };
+
+        [[nodiscard]] bool readBool(const json& params, const char* key, bool& out,
+                                    ParseError& err)
+        {
+            const auto it = params.find(key);
+            if (it == params.end() || it->is_null())
+            {
+                return true;
+            }
+            if (!it->is_boolean())
+            {
+                err = {"InvalidParams", std::string("Expected boolean for '") + key + "'."};
+                return false;
+            }
+            out = it->get<bool>();
+            return true;
+        }
+
+        [[nodiscard]] bool readUint64(const json& params, const char* key, uint64_t& out,
+                                      ParseError& err)
+        {
+            const auto it = params.find(key);
+            if (it == params.end() || it->is_null())
+            {
+                return true;
+            }
+            if (!it->is_number_unsigned())
+            {
+                err = {"InvalidParams",
+                       std::string("Expected unsigned integer for '") + key + "'."};
+                return false;
+            }
+            out = it->get<uint64_t>();
+            return true;
+        }
+
+        [[nodiscard]] bool readStringList(const json& params, const char* key,
+                                          std::vector<std::string>& out, ParseError& err)
+        {
+            const auto it = params.find(key);
+            if (it == params.end() || it->is_null())
+            {
+                return true;
+            }
+
+            if (it->is_string())
+            {
+                const std::string raw = it->get<std::string>();
+                const auto parts = ctrace_tools::strings::splitByComma(raw);
+                for (const auto part : parts)
+                {
+                    if (!part.empty())
+                    {
+                        out.emplace_back(part);
+                    }
+                }
+                return true;
+            }
+
+            if (!it->is_array())
+            {
+                err = {"InvalidParams",
+                       std::string("Expected array or string for '") + key + "'."};
+                return false;
+            }
+
+            for (const auto& item : *it)
+            {
+                if (!item.is_string())
+                {
+                    err = {"InvalidParams",
+                           std::string("Expected string values in '") + key + "' array."};
+                    return false;
+                }
+                const std::string value = item.get<std::string>();
+                if (!value.empty())
+                {
+                    out.emplace_back(value);
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool applyBoolFields(const json& params, ParseError& err,
+                                           std::initializer_list<BoolField> fields)
+        {
+            for (const auto& field : fields)
+            {
+                if (!readBool(params, field.key, *field.target, err))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool applyStringFields(const json& params, ParseError& err,
+                                             std::initializer_list<StringField> fields)
+        {
+            for (const auto& field : fields)
+            {
+                if (!readStringParam(params, field.key, *field.target, err))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool applyUint64Fields(const json& params, ParseError& err,
+                                             std::initializer_list<Uint64Field> fields)
+        {
+            for (const auto& field : fields)
+            {
+                if (!readUint64(params, field.key, *field.target, err))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename ApplyFn>
+        [[nodiscard]] bool applyListParam(const json& params, const char* key, ParseError& err,
+                                          ApplyFn&& apply)
+        {
+            std::vector<std::string> values;
+            if (!readStringList(params, key, values, err))
+            {
+                return false;
+            }
+            if (!values.empty())
+            {
+                apply(values);
+            }
+            return true;
+        }
+
+        [[nodiscard]] std::string joinWithComma(const std::vector<std::string>& items)
+        {
+            std::string joined;
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                if (i > 0)
+                {
+                    joined.push_back(',');
+                }
+                joined.append(items[i]);
+            }
+            return joined;
+        }
+
+        [[nodiscard]] bool applyAsyncField(const json& params, ProgramConfig& config,
+                                           ParseError& err)
+        {
+            bool async_enabled = false;
+            if (!readBool(params, "async", async_enabled, err))
+            {
+                return false;
+            }
+            config.global.hasAsync = async_enabled ? std::launch::async : std::launch::deferred;
+            return true;
+        }
+
+        [[nodiscard]] bool applyIpcField(const json& params, ProgramConfig& config,
+                                         ParseError& err)
+        {
+            std::string ipc_value;
+
+            if (!readStringParam(params, "ipc", ipc_value, err))
+            {
+                return false;
+            }
+            if (ipc_value.empty())
+            {
+                return true;
+            }
+            if (ipc_value == "serv" || ipc_value == "server")
+            {
+                ipc_value = "serve";
+            }
+
+            const auto& ipc_list = ctrace_defs::IPC_TYPES;
+            if (std::find(ipc_list.begin(), ipc_list.end(), ipc_value) == ipc_list.end())
+            {
+                err = {"InvalidParams", "Invalid IPC type: '" + ipc_value +
+                                            "'. Available IPC types: [" +
+                                            joinWithComma(ipc_list) + "]"};
+                return false;
+            }
+            if (ipc_value == "serve")
+            {
+                config.global.ipc = "standardIO";
+                return true;
+            }
+
+            config.global.ipc = ipc_value;
+            return true;
+        }
+    } // namespace
+
+    CT_NODISCARD bool readStringParam(const json& params, const char* key, std::string& out,
+                                      ParseError& err)
+    {
+        const auto it = params.find(key);
+        if (it == params.end() || it->is_null())
+        {
+            return true;
+        }
+        if (!it->is_string())
+        {
+            err = {"InvalidParams", std::string("Expected string for '") + key + "'."};
+            return false;
+        }
+        out = it->get<std::string>();
+        return true;
+    }
+
+    CT_NODISCARD bool buildConfigFromParams(const json& params, ProgramConfig& config,
+                                            ParseError& err)
+    {
+        if (!params.is_object())
+        {
+            err = {"InvalidParams", "Params must be a JSON object."};
+            return false;
+        }
+
+        if (!applyBoolFields(params, err,
+                               {
+                                   {"verbose", &config.global.verbose},
+                                   {"quiet", &config.global.quiet},
+                                   {"demangle", &config.global.demangle},
+                                   {"sarif_format", &config.global.hasSarifFormat},
+                                   {"static_analysis", &config.global.hasStaticAnalysis},
+                                   {"dynamic_analysis", &config.global.hasDynamicAnalysis},
+                                   {"include_compdb_deps", &config.global.include_compdb_deps},
+                                   {"timing", &config.global.timing},
+                               }))
+        {
+            return false;
+        }
+        if (!applyAsyncField(params, config, err))
+        {
+            return false;
+        }
+        std::string configPath;
+        if (!readStringParam(params, "config", configPath, err))
+        {
+            return false;
+        }
+        if (!configPath.empty())
+        {
+            std::string toolConfigError;
+            if (!applyToolConfigFile(config, configPath, toolConfigError))
+            {
+                err = {"InvalidParams", "Failed to load config: " + toolConfigError};
+                return false;
+            }
+            config.global.config_file = configPath;
+        }
+        if (!applyStringFields(
+                params, err,
+                {
+                    {"report_file", &config.global.report_file},
+                    {"sarif_baseline", &config.global.sarif_baseline},
+                    {"output_file", &config.global.output_file},
+                    {"config", &config.global.config_file},
+                    {"compile_commands", &config.global.compile_commands},
+                    {"analysis_profile", &config.global.analysis_profile},
+                    {"smt", &config.global.smt},
+                    {"smt_backend", &config.global.smt_backend},
+                    {"smt_secondary_backend", &config.global.smt_secondary_backend},
+                    {"smt_mode", &config.global.smt_mode},
+                    {"resource_model", &config.global.resource_model},
+                    {"escape_model", &config.global.escape_model},
+                    {"buffer_model", &config.global.buffer_model},
+                    {"stack_analyzer_mode", &config.global.stack_analyzer_mode},
+                    {"stack_analyzer_output_format", &config.global.stack_analyzer_output_format},
+                    {"ipc_path", &config.global.ipcPath},
+                    {"changed_since", &config.global.changed_since},
+                }))
+        {
+            return false;
+        }
+        uint64_t smt_timeout = config.global.smt_timeout_ms;
+        uint64_t smt_budget = config.global.smt_budget_nodes;
+        uint64_t stack_limit = config.global.stack_limit;
+        if (!applyUint64Fields(params, err,
+                                 {
+                                     {"smt_timeout_ms", &smt_timeout},
+                                     {"smt_budget_nodes", &smt_budget},
+                                     {"stack_limit", &stack_limit},
+                                 }))
+        {
+            return false;
+        }
+        if (smt_timeout > std::numeric_limits<uint32_t>::max())
+        {
+            err = {"InvalidParams", "smt_timeout_ms is too large."};
+            return false;
+        }
+        config.global.smt_timeout_ms = static_cast<uint32_t>(smt_timeout);
+        config.global.smt_budget_nodes = smt_budget;
+        config.global.stack_limit = stack_limit;
+        if (!applyListParam(params, "entry_points", err,
+                              [&](const std::vector<std::string>& values)
+                              { config.global.entry_points = joinWithComma(values); }))
+        {
+            return false;
+        }
+        if (!applyListParam(params, "invoke", err,
+                              [&](const std::vector<std::string>& values)
+                              {
+                                  config.global.hasInvokedSpecificTools = true;
+                                  config.global.specificTools = values;
+                              }))
+        {
+            return false;
+        }
+        if (!applyListParam(params, "smt_rules", err, [&](const std::vector<std::string>& values)
+                              { config.global.smt_rules = values; }))
+        {
+            return false;
+        }
+        if (!applyListParam(params, "changed_files", err,
+                              [&](const std::vector<std::string>& values)
+                              { config.global.changed_files = values; }))
+        {
+            return false;
+        }
+        if (!applyListParam(params, "stack_analyzer_extra_args", err,
+                              [&](const std::vector<std::string>& values)
+                              { config.global.stack_analyzer_extra_args = values; }))
+        {
+            return false;
+        }
+        if (!applyListParam(params, "input", err,
+                              [&](const std::vector<std::string>& values)
+                              {
+                                  for (const auto& file : values)
+                                  {
+                                      if (!file.empty())
+                                      {
+                                          config.addFile(file);
+                                      }
+                                  }
+                              }))
+        {
+            return false;
+        }
+        if (!applyIpcField(params, config, err))
+        {
+            return false;
+        }
+
+        return true;
+    }
+} // namespace ctrace::ipc
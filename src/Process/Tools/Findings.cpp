@@ -0,0 +1,404 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/Findings.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace ctrace
+{
+    namespace
+    {
+        constexpr char toLower(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        constexpr bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        constexpr bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+        }
+
+        /// Feeds @p value to the hash byte by byte, independently of the host byte order.
+        std::uint64_t hashValue(std::uint64_t value, std::uint64_t seed)
+        {
+            char bytes[8];
+            for (int i = 0; i < 8; ++i)
+            {
+                bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+            return findings::hash(std::string_view(bytes, sizeof(bytes)), seed);
+        }
+
+        std::uint64_t hashField(std::string_view field, std::uint64_t seed)
+        {
+            // The terminator keeps ("ab", "c") and ("a", "bc") apart.
+            return findings::hash(std::string_view("\0", 1), findings::hash(field, seed));
+        }
+
+        /// Calls @p emit with each character of the normalized @p message.
+        template <typename Emit> void forEachNormalized(std::string_view message, Emit&& emit)
+        {
+            bool pendingSpace = false;
+            bool empty = true;
+            char last = '\0';
+            for (std::size_t i = 0; i < message.size(); ++i)
+            {
+                const char c = message[i];
+                if (isSpace(c))
+                {
+                    pendingSpace = !empty;
+                    continue;
+                }
+                if (pendingSpace)
+                {
+                    emit(' ');
+                    last = ' ';
+                    pendingSpace = false;
+                }
+                if (isDigit(c))
+                {
+                    if (last != '#')
+                    {
+                        emit('#');
+                        last = '#';
+                    }
+                    while (i + 1 < message.size() && isDigit(message[i + 1]))
+                    {
+                        ++i;
+                    }
+                }
+                else
+                {
+                    last = toLower(c);
+                    emit(last);
+                }
+                empty = false;
+            }
+        }
+
+        /// True when @p path needs no lexical normalization.
+        bool isNormal(std::string_view path)
+        {
+            if (path.empty() || path.back() == '/' || path == "." || path == "..")
+            {
+                return path.size() <= 1;
+            }
+            std::size_t start = 0;
+            while (start < path.size())
+            {
+                std::size_t end = path.find('/', start);
+                if (end == std::string_view::npos)
+                {
+                    end = path.size();
+                }
+                const std::string_view part = path.substr(start, end - start);
+                if ((part.empty() && start != 0) || part == "." || part == ".." ||
+                    part.find('\\') != std::string_view::npos)
+                {
+                    return false;
+                }
+                start = end + 1;
+            }
+            return true;
+        }
+    } // namespace
+
+    namespace findings
+    {
+        std::string normalizePath(std::string_view uri, std::string_view base)
+        {
+            if (uri.compare(0, 7, "file://") == 0)
+            {
+                uri.remove_prefix(7);
+            }
+            const bool absolute = !uri.empty() && (uri.front() == '/' || uri.front() == '\\');
+
+            std::string normalized;
+            if (isNormal(uri))
+            {
+                normalized.assign(uri);
+            }
+            else
+            {
+                // Lexical normalization on the string: std::filesystem::path costs
+                // microseconds per call, which shows on outputs with a million diagnostics.
+                std::vector<std::string_view> parts;
+                std::size_t start = 0;
+                while (start <= uri.size())
+                {
+                    std::size_t end = uri.find_first_of("/\\", start);
+                    if (end == std::string_view::npos)
+                    {
+                        end = uri.size();
+                    }
+                    const std::string_view part = uri.substr(start, end - start);
+                    if (part == "..")
+                    {
+                        if (!parts.empty() && parts.back() != "..")
+                        {
+                            parts.pop_back();
+                        }
+                        else if (!absolute)
+                        {
+                            parts.push_back(part);
+                        }
+                    }
+                    else if (!part.empty() && part != ".")
+                    {
+                        parts.push_back(part);
+                    }
+                    start = end + 1;
+                }
+
+                normalized.reserve(uri.size() + 1);
+                for (const std::string_view part : parts)
+                {
+                    if (absolute || !normalized.empty())
+                    {
+                        normalized.push_back('/');
+                    }
+                    normalized.append(part);
+                }
+                if (normalized.empty() && !uri.empty())
+                {
+                    normalized = absolute ? "/" : ".";
+                }
+            }
+
+            if (absolute && !base.empty())
+            {
+                if (base.size() > 1 && base.back() == '/')
+                {
+                    base.remove_suffix(1);
+                }
+                if (base == "/" && normalized.size() > 1)
+                {
+                    normalized.erase(0, 1);
+                }
+                else if (normalized.size() > base.size() + 1 && normalized[base.size()] == '/' &&
+                         normalized.compare(0, base.size(), base) == 0)
+                {
+                    normalized.erase(0, base.size() + 1);
+                }
+            }
+            return normalized;
+        }
+
+        std::string normalizeMessage(std::string_view message)
+        {
+            std::string out;
+            out.reserve(message.size());
+            forEachNormalized(message, [&out](char c) { out.push_back(c); });
+            return out;
+        }
+
+        std::uint64_t messageHash(std::string_view message)
+        {
+            std::uint64_t value = hash({});
+            forEachNormalized(message,
+                              [&value](char c)
+                              {
+                                  value ^= static_cast<unsigned char>(c);
+                                  value *= 1099511628211ULL;
+                              });
+            return value;
+        }
+
+        std::uint32_t extractCwe(std::string_view text)
+        {
+            for (std::size_t pos = 0; pos + 3 < text.size(); ++pos)
+            {
+                if (toLower(text[pos]) != 'c' || toLower(text[pos + 1]) != 'w' ||
+                    toLower(text[pos + 2]) != 'e')
+                {
+                    continue;
+                }
+                // Up to a few separators between the tag and the number: "-", "_", "\": ".
+                std::size_t digits = pos + 3;
+                while (digits < text.size() && digits - pos - 3 < 4 &&
+                       (text[digits] == '-' || text[digits] == '_' || text[digits] == ':' ||
+                        text[digits] == '"' || text[digits] == ' '))
+                {
+                    ++digits;
+                }
+                std::uint32_t id = 0;
+                std::size_t end = digits;
+                while (end < text.size() && isDigit(text[end]) && end - digits < 9)
+                {
+                    id = id * 10 + static_cast<std::uint32_t>(text[end] - '0');
+                    ++end;
+                }
+                if (end != digits && id != 0)
+                {
+                    return id;
+                }
+            }
+            return 0;
+        }
+
+        std::uint64_t ruleCategory(std::string_view rule)
+        {
+            if (const std::size_t dot = rule.rfind('.'); dot != std::string_view::npos)
+            {
+                rule.remove_prefix(dot + 1);
+            }
+            // Hashed as it is normalized; only short categories can be a severity.
+            std::uint64_t value = hash({});
+            char prefix[12];
+            std::size_t length = 0;
+            for (const char c : rule)
+            {
+                const char lower = toLower(c);
+                if (!isDigit(lower) && (lower < 'a' || lower > 'z'))
+                {
+                    continue;
+                }
+                if (length < sizeof(prefix))
+                {
+                    prefix[length] = lower;
+                }
+                ++length;
+                value ^= static_cast<unsigned char>(lower);
+                value *= 1099511628211ULL;
+            }
+
+            // Tools that only report a severity use it as the rule id.
+            static constexpr std::string_view kSeverities[] = {
+                "error", "warning", "note", "none", "info", "information", "style",
+                "performance", "portability"};
+            if (length == 0 ||
+                (length <= sizeof(prefix) &&
+                 std::find(std::begin(kSeverities), std::end(kSeverities),
+                           std::string_view(prefix, length)) != std::end(kSeverities)))
+            {
+                return 0;
+            }
+            return value;
+        }
+
+        std::uint64_t fingerprint(const Finding& finding)
+        {
+            std::uint64_t value = hashField(finding.file, hash({}));
+            value = hashField(finding.rule, value);
+            return hashValue(finding.message_hash, value);
+        }
+
+        std::string toHex(std::uint64_t fingerprint)
+        {
+            static constexpr char kDigits[] = "0123456789abcdef";
+            std::string out(16, '0');
+            for (int i = 15; i >= 0; --i)
+            {
+                out[static_cast<std::size_t>(i)] = kDigits[fingerprint & 0xf];
+                fingerprint >>= 4;
+            }
+            return out;
+        }
+    } // namespace findings
+
+    FindingIndex::Key FindingIndex::keyOf(const Finding& finding, std::uint32_t source)
+    {
+        Key key;
+        key.file = findings::hash(finding.file);
+        key.line = finding.line;
+        key.identity =
+            hashValue(finding.message_hash, hashField(finding.rule, findings::hash({})));
+        key.category = findings::ruleCategory(finding.rule);
+        key.cwe = finding.cwe;
+        key.source = source;
+        return key;
+    }
+
+    bool FindingIndex::compatible(const Group& group, const Key& key) const
+    {
+        const bool identical =
+            group.first.second == key.identity ||
+            std::any_of(group.more.begin(), group.more.end(),
+                        [&](const Member& member) { return member.second == key.identity; });
+        if (key.line == 0)
+        {
+            return group.cwe == key.cwe && identical;
+        }
+        if (group.cwe != 0 && key.cwe != 0)
+        {
+            if (group.cwe != key.cwe)
+            {
+                return false;
+            }
+        }
+        else if (!identical && (key.category == 0 || key.category != group.category))
+        {
+            return false;
+        }
+        const auto conflicts = [&](const Member& member)
+        { return member.first == key.source && member.second != key.identity; };
+        return !conflicts(group.first) &&
+               std::none_of(group.more.begin(), group.more.end(), conflicts);
+    }
+
+    void FindingIndex::reserve(std::size_t findings)
+    {
+        m_groups.reserve(findings);
+        m_buckets.reserve(findings);
+    }
+
+    std::size_t FindingIndex::add(const Key& key)
+    {
+        const Member member{key.source, key.identity};
+        const auto [bucket, inserted] =
+            m_buckets.try_emplace({key.file, key.line}, m_groups.size());
+        std::size_t last = kNone;
+        for (std::size_t index = inserted ? kNone : bucket->second; index != kNone;
+             index = m_groups[index].next)
+        {
+            last = index;
+            Group& group = m_groups[index];
+            if (!compatible(group, key))
+            {
+                continue;
+            }
+            if (group.cwe == 0)
+            {
+                group.cwe = key.cwe;
+            }
+            if (member != group.first &&
+                std::find(group.more.begin(), group.more.end(), member) == group.more.end())
+            {
+                // Every earlier member shares first's source unless the group is shared.
+                group.shared = group.shared || member.first != group.first.first;
+                group.more.push_back(member);
+            }
+            return index;
+        }
+
+        if (last != kNone)
+        {
+            m_groups[last].next = m_groups.size();
+        }
+        Group& group = m_groups.emplace_back();
+        group.category = key.category;
+        group.cwe = key.cwe;
+        group.first = member;
+        return m_groups.size() - 1;
+    }
+
+    std::vector<std::uint32_t> FindingIndex::sources(std::size_t group) const
+    {
+        const Group& target = m_groups[group];
+        std::vector<std::uint32_t> out{target.first.first};
+        for (const Member& member : target.more)
+        {
+            if (std::find(out.begin(), out.end(), member.first) == out.end())
+            {
+                out.push_back(member.first);
+            }
+        }
+        return out;
+    }
+} // namespace ctrace
@@ -0,0 +1,457 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/ResultCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include <coretrace/logger.hpp>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace ctrace
+{
+    namespace
+    {
+        constexpr std::string_view kResultCacheModule = "result_cache";
+        constexpr std::string_view kStackAnalyzerToolName = "ctrace_stack_analyzer";
+
+        /// Bumped whenever the key derivation or the entry layout changes.
+        constexpr int kResultCacheFormatVersion = 3;
+
+        /**
+         * @brief 128-bit streaming hash made of two independent 64-bit lanes.
+         *
+         * Every field is length-prefixed, so ("ab", "c") and ("a", "bc") hash differently.
+         */
+        class KeyHasher
+        {
+          public:
+            void update(std::string_view field)
+            {
+                const std::uint64_t size = field.size();
+                for (int shift = 0; shift < 64; shift += 8)
+                {
+                    mix(static_cast<unsigned char>(size >> shift));
+                }
+                for (const char c : field)
+                {
+                    mix(static_cast<unsigned char>(c));
+                }
+            }
+
+            void update(bool value)
+            {
+                update(std::string_view(value ? "1" : "0"));
+            }
+
+            void update(std::uint64_t value)
+            {
+                update(std::string_view(std::to_string(value)));
+            }
+
+            void update(const std::vector<std::string>& values)
+            {
+                update(static_cast<std::uint64_t>(values.size()));
+                for (const auto& value : values)
+                {
+                    update(std::string_view(value));
+                }
+            }
+
+            [[nodiscard]] std::string hex() const
+            {
+                static constexpr char kDigits[] = "0123456789abcdef";
+                std::string out;
+                out.reserve(32);
+                for (const std::uint64_t lane : {finalize(m_fnv), finalize(m_mul)})
+                {
+                    for (int shift = 60; shift >= 0; shift -= 4)
+                    {
+                        out.push_back(kDigits[(lane >> shift) & 0xF]);
+                    }
+                }
+                return out;
+            }
+
+          private:
+            void mix(unsigned char byte)
+            {
+                m_fnv = (m_fnv ^ byte) * 0x100000001b3ULL;
+                m_mul = ((m_mul ^ byte) << 5 | (m_mul ^ byte) >> 59) * 0x9e3779b97f4a7c15ULL;
+            }
+
+            [[nodiscard]] static std::uint64_t finalize(std::uint64_t x)
+            {
+                x ^= x >> 30;
+                x *= 0xbf58476d1ce4e5b9ULL;
+                x ^= x >> 27;
+                x *= 0x94d049bb133111ebULL;
+                x ^= x >> 31;
+                return x;
+            }
+
+            std::uint64_t m_fnv = 0xcbf29ce484222325ULL;
+            std::uint64_t m_mul = 0x84222325cbf29ce4ULL;
+        };
+
+        [[nodiscard]] std::vector<std::string> sorted(std::vector<std::string> values)
+        {
+            std::sort(values.begin(), values.end());
+            return values;
+        }
+
+        [[nodiscard]] std::string optionalBoolField(const std::optional<bool>& value)
+        {
+            if (!value.has_value())
+            {
+                return "default";
+            }
+            return *value ? "on" : "off";
+        }
+
+        /**
+         * @brief Fields that change the output of every tool.
+         */
+        [[nodiscard]] std::string commonConfigFingerprint(const GlobalConfig& global)
+        {
+            KeyHasher hasher;
+            hasher.update(global.hasSarifFormat);
+            hasher.update(global.verbose);
+            hasher.update(global.quiet);
+            hasher.update(global.demangle);
+            hasher.update(std::string_view(global.entry_points));
+            return hasher.hex();
+        }
+
+        [[nodiscard]] int currentProcessId()
+        {
+#if !defined(_WIN32)
+            return static_cast<int>(::getpid());
+#else
+            return _getpid();
+#endif
+        }
+    } // namespace
+
+    ResultCache::ResultCache(std::string directory, const ProgramConfig& config)
+        : m_directory(std::move(directory)), m_commonConfig(commonConfigFingerprint(config.global))
+    {
+        const GlobalConfig& global = config.global;
+
+        if (!global.compile_commands.empty())
+        {
+            std::string error;
+            m_compileDatabase = CompileDatabase::load(global.compile_commands, error);
+            if (!m_compileDatabase)
+            {
+                coretrace::log(coretrace::Level::Warn, coretrace::Module(kResultCacheModule),
+                               "{}; cache keys will not include compile flags\n", error);
+            }
+        }
+
+        // Side files cannot be replayed from the cache: a hit would leave them missing or
+        // stale. Without a merged SARIF report (see ToolInvoker), IKOS and the stack analyzer
+        // write report_file themselves.
+        if (!global.report_file.empty() && !global.hasSarifFormat)
+        {
+            m_uncacheableTools = {"ikos", std::string(kStackAnalyzerToolName)};
+        }
+        else if (!global.stack_analyzer_dump_ir.empty())
+        {
+            m_uncacheableTools = {std::string(kStackAnalyzerToolName)};
+        }
+
+        // Scheduling-only fields (jobs, shards, cache directories) are deliberately left out:
+        // they do not change what the analyzer reports.
+        KeyHasher hasher;
+        hasher.update(std::string_view(global.stack_analyzer_mode));
+        hasher.update(std::string_view(global.stack_analyzer_output_format));
+        hasher.update(std::string_view(global.analysis_profile));
+        hasher.update(std::string_view(global.smt));
+        hasher.update(std::string_view(global.smt_backend));
+        hasher.update(std::string_view(global.smt_secondary_backend));
+        hasher.update(std::string_view(global.smt_mode));
+        hasher.update(static_cast<std::uint64_t>(global.smt_timeout_ms));
+        hasher.update(static_cast<std::uint64_t>(global.smt_budget_nodes));
+        hasher.update(sorted(global.smt_rules));
+        for (const std::string* model : {&global.resource_model, &global.escape_model,
+                                         &global.buffer_model, &global.stack_analyzer_config})
+        {
+            hasher.update(std::string_view(*model));
+            if (!model->empty())
+            {
+                hasher.update(std::string_view(fileDigest(*model).value_or("missing")));
+            }
+        }
+        hasher.update(global.timing);
+        hasher.update(global.stack_analyzer_print_effective_config);
+        hasher.update(global.stack_analyzer_compdb_fast);
+        hasher.update(global.stack_analyzer_include_stl);
+        hasher.update(global.stack_analyzer_dump_filter);
+        hasher.update(global.stack_analyzer_warnings_only);
+        hasher.update(std::string_view(optionalBoolField(global.stack_analyzer_resource_cross_tu)));
+        hasher.update(
+            std::string_view(optionalBoolField(global.stack_analyzer_uninitialized_cross_tu)));
+        hasher.update(std::string_view(global.stack_analyzer_base_dir));
+        hasher.update(std::string_view(global.stack_analyzer_compile_ir_format));
+        hasher.update(std::string_view(global.compile_commands));
+        hasher.update(sorted(global.stack_analyzer_only_files));
+        hasher.update(sorted(global.stack_analyzer_only_dirs));
+        hasher.update(sorted(global.stack_analyzer_exclude_dirs));
+        hasher.update(sorted(global.stack_analyzer_only_functions));
+        hasher.update(global.stack_analyzer_include_dirs);
+        hasher.update(global.stack_analyzer_defines);
+        hasher.update(global.stack_analyzer_compile_args);
+        hasher.update(global.stack_analyzer_extra_args);
+        hasher.update(global.stack_limit);
+        m_stackAnalyzerConfig = hasher.hex();
+    }
+
+    CT_NODISCARD std::string ResultCache::key(const IAnalysisTool& tool,
+                                              const std::vector<std::string>& files) const
+    {
+        const std::string toolName = tool.name();
+        const std::string toolVersion = tool.version();
+        if (toolVersion.empty() || files.empty())
+        {
+            return {};
+        }
+
+        if (std::find(m_uncacheableTools.begin(), m_uncacheableTools.end(), toolName) !=
+            m_uncacheableTools.end())
+        {
+            return {};
+        }
+        const bool isStackAnalyzer = toolName == kStackAnalyzerToolName;
+
+        KeyHasher hasher;
+        hasher.update(static_cast<std::uint64_t>(kResultCacheFormatVersion));
+        hasher.update(std::string_view(toolName));
+        hasher.update(std::string_view(toolVersion));
+        hasher.update(std::string_view(m_commonConfig));
+        if (isStackAnalyzer)
+        {
+            hasher.update(std::string_view(m_stackAnalyzerConfig));
+        }
+
+        hasher.update(static_cast<std::uint64_t>(files.size()));
+        for (const auto& file : files)
+        {
+            const auto digest = fileDigest(file);
+            if (!digest)
+            {
+                return {};
+            }
+            // The path is part of the key: diagnostics quote it.
+            hasher.update(std::string_view(file));
+            hasher.update(std::string_view(*digest));
+
+            // Without a depfile the headers the file includes are unknown, and a key over
+            // the file alone would survive a header edit.
+            const CompileCommand* command =
+                m_compileDatabase ? m_compileDatabase->find(file) : nullptr;
+            const auto dependencies =
+                command != nullptr ? readDepfileDependencies(*command) : std::nullopt;
+            if (!dependencies)
+            {
+                if (!m_reportedMissingDepfile.exchange(true, std::memory_order_relaxed))
+                {
+                    coretrace::log(coretrace::Level::Info, coretrace::Module(kResultCacheModule),
+                                   "'{}' has no depfile; files whose headers are unknown are not "
+                                   "cached (build once with -MD to enable caching)\n",
+                                   file);
+                }
+                return {};
+            }
+            hasher.update(std::string_view(command->directory));
+            hasher.update(command->arguments);
+            hasher.update(static_cast<std::uint64_t>(dependencies->size()));
+            for (const auto& dependency : *dependencies)
+            {
+                hasher.update(std::string_view(dependency));
+                hasher.update(std::string_view(fileDigest(dependency).value_or("missing")));
+            }
+        }
+
+        return hasher.hex();
+    }
+
+    CT_NODISCARD std::optional<CachedToolResult> ResultCache::load(const std::string& key) const
+    {
+        using json = nlohmann::json;
+
+        std::ifstream stream(entryPath(key), std::ios::binary);
+        if (!stream.is_open())
+        {
+            return std::nullopt;
+        }
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+
+        const auto entry = json::parse(buffer.str(), nullptr, false);
+        if (entry.is_discarded() || !entry.is_object() ||
+            entry.value("format", 0) != kResultCacheFormatVersion)
+        {
+            return std::nullopt;
+        }
+
+        const auto summaryIt = entry.find("summary");
+        const auto linesIt = entry.find("lines");
+        if (summaryIt == entry.end() || !summaryIt->is_object() || linesIt == entry.end() ||
+            !linesIt->is_array())
+        {
+            return std::nullopt;
+        }
+
+        const auto reportIt = entry.find("report");
+        if (reportIt == entry.end() || !reportIt->is_object())
+        {
+            return std::nullopt;
+        }
+
+        CachedToolResult result;
+        result.summary.info = summaryIt->value("info", std::size_t{0});
+        result.summary.warning = summaryIt->value("warning", std::size_t{0});
+        result.summary.error = summaryIt->value("error", std::size_t{0});
+        result.lines.reserve(linesIt->size());
+        for (const auto& line : *linesIt)
+        {
+            if (!line.is_object())
+            {
+                return std::nullopt;
+            }
+            result.lines.push_back({line.value("stream", std::string("stdout")),
+                                    line.value("message", std::string()),
+                                    line.value("mirrored", true)});
+        }
+
+        // Results are kept serialized: they are copied into the report as-is.
+        const auto readStrings = [&reportIt](const char* field, std::vector<std::string>& out)
+        {
+            const auto it = reportIt->find(field);
+            if (it == reportIt->end() || !it->is_array())
+            {
+                return false;
+            }
+            out.reserve(it->size());
+            for (const auto& item : *it)
+            {
+                if (!item.is_string())
+                {
+                    return false;
+                }
+                out.push_back(item.get<std::string>());
+            }
+            return true;
+        };
+        result.report.driver = reportIt->value("driver", std::string());
+        if (!readStrings("rules", result.report.rules) ||
+            !readStrings("results", result.report.results))
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    void ResultCache::store(const std::string& key, const CachedToolResult& result) const
+    {
+        using json = nlohmann::json;
+
+        json lines = json::array();
+        for (const auto& line : result.lines)
+        {
+            lines.push_back(
+                {{"stream", line.stream}, {"message", line.message}, {"mirrored", line.mirrored}});
+        }
+        const json entry = {{"format", kResultCacheFormatVersion},
+                            {"summary",
+                             {{"info", result.summary.info},
+                              {"warning", result.summary.warning},
+                              {"error", result.summary.error}}},
+                            {"lines", std::move(lines)},
+                            {"report",
+                             {{"driver", result.report.driver},
+                              {"rules", result.report.rules},
+                              {"results", result.report.results}}}};
+
+        const auto path = entryPath(key);
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec)
+        {
+            coretrace::log(coretrace::Level::Warn, coretrace::Module(kResultCacheModule),
+                           "Unable to create '{}': {}\n", path.parent_path().string(),
+                           ec.message());
+            return;
+        }
+
+        // Write to a private name first so readers never see a partial entry.
+        static std::atomic<std::uint64_t> counter{0};
+        auto temporary = path;
+        temporary += ".tmp-" + std::to_string(currentProcessId()) + "-" +
+                      std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out << entry.dump();
+            if (!out)
+            {
+                coretrace::log(coretrace::Level::Warn, coretrace::Module(kResultCacheModule),
+                               "Unable to write cache entry '{}'\n", temporary.string());
+                out.close();
+                std::filesystem::remove(temporary, ec);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary, path, ec);
+        if (ec)
+        {
+            coretrace::log(coretrace::Level::Warn, coretrace::Module(kResultCacheModule),
+                           "Unable to publish cache entry '{}': {}\n", path.string(),
+                           ec.message());
+            std::filesystem::remove(temporary, ec);
+        }
+    }
+
+    CT_NODISCARD std::filesystem::path ResultCache::entryPath(const std::string& key) const
+    {
+        return m_directory / key.substr(0, 2) / (key + ".json");
+    }
+
+    CT_NODISCARD std::optional<std::string> ResultCache::fileDigest(const std::string& path) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_digestMutex);
+            if (const auto it = m_digests.find(path); it != m_digests.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::optional<std::string> digest;
+        std::ifstream stream(path, std::ios::binary);
+        if (stream.is_open())
+        {
+            KeyHasher hasher;
+            std::ostringstream buffer;
+            buffer << stream.rdbuf();
+            hasher.update(std::string_view(buffer.str()));
+            digest = hasher.hex();
+        }
+
+        std::lock_guard<std::mutex> lock(m_digestMutex);
+        return m_digests.emplace(path, std::move(digest)).first->second;
+    }
+} // namespace ctrace
@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/RuntimeHistory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <coretrace/logger.hpp>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace ctrace
+{
+    namespace
+    {
+        constexpr std::string_view kRuntimeHistoryModule = "runtime_history";
+        constexpr std::string_view kHeader = "ctrace-runtime-history 1";
+        constexpr std::string_view kDefaultFileName = "runtime-history";
+
+        /// Weight of a new sample against the stored one.
+        constexpr double kSmoothing = 0.5;
+
+        [[nodiscard]] int currentProcessId()
+        {
+#if !defined(_WIN32)
+            return static_cast<int>(::getpid());
+#else
+            return _getpid();
+#endif
+        }
+
+        [[nodiscard]] std::uint64_t fileSize(const std::string& file)
+        {
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(file, ec);
+            return ec ? 0 : static_cast<std::uint64_t>(size);
+        }
+
+        template <typename T> [[nodiscard]] bool parseField(std::string_view text, T& value)
+        {
+            const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return ec == std::errc() && end == text.data() + text.size();
+        }
+
+        /// std::from_chars has no floating-point overloads in Apple's libc++.
+        template <> [[nodiscard]] bool parseField(std::string_view text, double& value)
+        {
+            const std::string copy(text);
+            char* end = nullptr;
+            errno = 0;
+            value = std::strtod(copy.c_str(), &end);
+            return !copy.empty() && errno == 0 && end == copy.c_str() + copy.size();
+        }
+
+        /// Splits the next tab-separated field off @p line.
+        [[nodiscard]] std::string_view nextField(std::string_view& line)
+        {
+            const auto tab = line.find('\t');
+            const std::string_view field = line.substr(0, tab);
+            line.remove_prefix(tab == std::string_view::npos ? line.size() : tab + 1);
+            return field;
+        }
+    } // namespace
+
+    CT_NODISCARD std::shared_ptr<RuntimeHistory> RuntimeHistory::open(const std::string& path)
+    {
+        static std::mutex mutex;
+        static std::unordered_map<std::string, std::weak_ptr<RuntimeHistory>> histories;
+
+        const std::string key = std::filesystem::path(path).lexically_normal().string();
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& slot = histories[key];
+        if (auto history = slot.lock())
+        {
+            return history;
+        }
+        auto history = std::make_shared<RuntimeHistory>(key);
+        slot = history;
+        return history;
+    }
+
+    CT_NODISCARD std::shared_ptr<RuntimeHistory>
+    RuntimeHistory::forConfig(const ProgramConfig& config)
+    {
+        if (!config.global.runtime_history.empty())
+        {
+            return open(config.global.runtime_history);
+        }
+        if (!config.global.result_cache_dir.empty())
+        {
+            return open((std::filesystem::path(config.global.result_cache_dir) / kDefaultFileName)
+                            .string());
+        }
+        return nullptr;
+    }
+
+    RuntimeHistory::RuntimeHistory(std::filesystem::path path) : m_path(std::move(path))
+    {
+        load();
+    }
+
+    CT_NODISCARD std::optional<RuntimeSample> RuntimeHistory::lookup(const std::string& tool,
+                                                                     const std::string& file) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(entryKey(tool, file));
+        if (it == m_entries.end())
+        {
+            return std::nullopt;
+        }
+        return it->second.sample;
+    }
+
+    CT_NODISCARD double RuntimeHistory::estimate(const std::string& tool,
+                                                 const std::string& file) const
+    {
+        const auto size = static_cast<double>(std::max<std::uint64_t>(fileSize(file), 1));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (const auto it = m_entries.find(entryKey(tool, file)); it != m_entries.end())
+        {
+            return it->second.sample.wall_ms;
+        }
+        if (const auto it = m_totals.find(tool); it != m_totals.end() && it->second.size_bytes > 0)
+        {
+            return size * it->second.wall_ms / it->second.size_bytes;
+        }
+        return size;
+    }
+
+    void RuntimeHistory::record(const std::string& tool, const std::string& file,
+                                const RuntimeSample& sample)
+    {
+        Entry fresh{sample, fileSize(file)};
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto [it, inserted] = m_entries.try_emplace(entryKey(tool, file), fresh);
+        if (!inserted)
+        {
+            addTotals(tool, it->second, -1);
+            auto& stored = it->second.sample;
+            fresh.sample.wall_ms =
+                stored.wall_ms + kSmoothing * (sample.wall_ms - stored.wall_ms);
+            fresh.sample.peak_rss_kib = static_cast<std::uint64_t>(
+                static_cast<double>(stored.peak_rss_kib) +
+                kSmoothing * (static_cast<double>(sample.peak_rss_kib) -
+                              static_cast<double>(stored.peak_rss_kib)));
+            it->second = fresh;
+        }
+        addTotals(tool, it->second, 1);
+        m_dirty = true;
+    }
+
+    void RuntimeHistory::save()
+    {
+        std::string content;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_dirty)
+            {
+                return;
+            }
+            content.reserve(m_entries.size() * 96 + kHeader.size() + 1);
+            content.append(kHeader);
+            content.push_back('\n');
+            for (const auto& [key, entry] : m_entries)
+            {
+                const auto tab = key.find('\t');
+                content.append(key, 0, tab);
+                content.push_back('\t');
+                content.append(std::to_string(entry.size_bytes));
+                content.push_back('\t');
+                content.append(std::to_string(entry.sample.wall_ms));
+                content.push_back('\t');
+                content.append(std::to_string(entry.sample.peak_rss_kib));
+                content.push_back('\t');
+                content.append(key, tab + 1);
+                content.push_back('\n');
+            }
+            m_dirty = false;
+        }
+
+        std::error_code ec;
+        if (m_path.has_parent_path())
+        {
+            std::filesystem::create_directories(m_path.parent_path(), ec);
+        }
+
+        // Write to a private name first so readers never see a partial store.
+        static std::atomic<std::uint64_t> counter{0};
+        auto temporary = m_path;
+        temporary += ".tmp-" + std::to_string(currentProcessId()) + "-" +
+                     std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out << content;
+            if (!out)
+            {
+                coretrace::log(coretrace::Level::Warn, coretrace::Module(kRuntimeHistoryModule),
+                               "Unable to write runtime history '{}'\n", temporary.string());
+                out.close();
+                std::filesystem::remove(temporary, ec);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary, m_path, ec);
+        if (ec)
+        {
+            coretrace::log(coretrace::Level::Warn, coretrace::Module(kRuntimeHistoryModule),
+                           "Unable to publish runtime history '{}': {}\n", m_path.string(),
+                           ec.message());
+            std::filesystem::remove(temporary, ec);
+        }
+    }
+
+    std::string RuntimeHistory::entryKey(const std::string& tool, const std::string& file)
+    {
+        std::string key;
+        key.reserve(tool.size() + file.size() + 1);
+        key.append(tool);
+        key.push_back('\t');
+        key.append(file);
+        return key;
+    }
+
+    void RuntimeHistory::load()
+    {
+        std::ifstream in(m_path, std::ios::binary);
+        if (!in)
+        {
+            return;
+        }
+
+        std::string line;
+        if (!std::getline(in, line) || line != kHeader)
+        {
+            coretrace::log(coretrace::Level::Debug, coretrace::Module(kRuntimeHistoryModule),
+                           "Ignoring runtime history '{}' in an unknown format\n",
+                           m_path.string());
+            return;
+        }
+
+        // tool \t size_bytes \t wall_ms \t peak_rss_kib \t file
+        while (std::getline(in, line))
+        {
+            std::string_view rest(line);
+            const std::string_view tool = nextField(rest);
+            Entry entry;
+            if (tool.empty() || !parseField(nextField(rest), entry.size_bytes) ||
+                !parseField(nextField(rest), entry.sample.wall_ms) ||
+                !parseField(nextField(rest), entry.sample.peak_rss_kib) || rest.empty())
+            {
+                continue;
+            }
+            const std::string toolName(tool);
+            const auto [it, inserted] =
+                m_entries.try_emplace(entryKey(toolName, std::string(rest)), entry);
+            if (inserted)
+            {
+                addTotals(toolName, it->second, 1);
+            }
+        }
+    }
+
+    void RuntimeHistory::addTotals(const std::string& tool, const Entry& entry, double sign)
+    {
+        if (entry.size_bytes == 0)
+        {
+            return;
+        }
+        auto& totals = m_totals[tool];
+        totals.wall_ms += sign * entry.sample.wall_ms;
+        totals.size_bytes += sign * static_cast<double>(entry.size_bytes);
+    }
+} // namespace ctrace
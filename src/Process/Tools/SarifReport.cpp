@@ -0,0 +1,890 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/SarifReport.hpp"
+
+#include <coretrace/logger.hpp>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace ctrace
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        int currentProcessId()
+        {
+#if !defined(_WIN32)
+            return static_cast<int>(::getpid());
+#else
+            return _getpid();
+#endif
+        }
+
+        std::string uniqueSuffix()
+        {
+            static std::atomic<std::uint64_t> counter{0};
+            return std::to_string(currentProcessId()) + "-" +
+                   std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+        }
+
+        void appendJsonString(std::string& out, std::string_view value)
+        {
+            out.push_back('"');
+            std::size_t plain = 0; // Start of the run of characters copied as is.
+            for (std::size_t i = 0; i < value.size(); ++i)
+            {
+                const char c = value[i];
+                if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20)
+                {
+                    continue;
+                }
+                out.append(value.data() + plain, i - plain);
+                plain = i + 1;
+                switch (c)
+                {
+                case '"':
+                    out.append("\\\"");
+                    break;
+                case '\\':
+                    out.append("\\\\");
+                    break;
+                case '\n':
+                    out.append("\\n");
+                    break;
+                case '\r':
+                    out.append("\\r");
+                    break;
+                case '\t':
+                    out.append("\\t");
+                    break;
+                default:
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out.append(escaped);
+                }
+                }
+            }
+            out.append(value.data() + plain, value.size() - plain);
+            out.push_back('"');
+        }
+
+        /// Driver used until the tool provides its own.
+        std::string defaultDriver(const std::string& tool)
+        {
+            std::string driver = "{\"name\":";
+            appendJsonString(driver, tool);
+            driver.push_back('}');
+            return driver;
+        }
+
+        /// Callbacks receiving the parts of a tool's SARIF document, serialized.
+        struct DocumentVisitor
+        {
+            std::function<void(std::string)> driver;
+            std::function<void(std::string_view, std::string)> rule;
+            std::function<void(json&)> result;
+        };
+
+        /**
+         * @brief Parses @p document and hands each run's driver, rules and results to
+         * @p visitor.
+         *
+         * The parser callback drops every `runs[].results[]` element once it is forwarded, so
+         * only one result is materialized at a time.
+         */
+        bool visitDocument(std::string_view document, const DocumentVisitor& visitor,
+                           std::string& error)
+        {
+            std::string rootKey;
+            std::string runKey;
+            const auto callback = [&](int depth, json::parse_event_t event, json& parsed)
+            {
+                if (event == json::parse_event_t::key)
+                {
+                    if (depth == 1)
+                    {
+                        rootKey = parsed.get<std::string>();
+                    }
+                    else if (depth == 3)
+                    {
+                        runKey = parsed.get<std::string>();
+                    }
+                    return true;
+                }
+                if (rootKey != "runs" || event != json::parse_event_t::object_end)
+                {
+                    return true;
+                }
+
+                if (depth == 4 && runKey == "results")
+                {
+                    visitor.result(parsed);
+                    return false;
+                }
+                if (depth == 3 && runKey == "tool")
+                {
+                    const auto driverIt = parsed.find("driver");
+                    if (driverIt == parsed.end() || !driverIt->is_object())
+                    {
+                        return false;
+                    }
+                    if (const auto rulesIt = driverIt->find("rules");
+                        rulesIt != driverIt->end())
+                    {
+                        if (rulesIt->is_array())
+                        {
+                            for (const auto& rule : *rulesIt)
+                            {
+                                const auto idIt = rule.find("id");
+                                if (rule.is_object() && idIt != rule.end() && idIt->is_string())
+                                {
+                                    visitor.rule(idIt->get_ref<const std::string&>(), rule.dump());
+                                }
+                            }
+                        }
+                        driverIt->erase(rulesIt);
+                    }
+                    visitor.driver(driverIt->dump());
+                    return false;
+                }
+                if (depth == 2)
+                {
+                    runKey.clear();
+                    return false;
+                }
+                return true;
+            };
+
+            try
+            {
+                // Only the top-level fields outside of the runs are left in the returned value.
+                const json rest = json::parse(document.begin(), document.end(), callback);
+                (void)rest;
+            }
+            catch (const json::exception& e)
+            {
+                error = std::string("Invalid SARIF document: ") + e.what();
+                return false;
+            }
+            return true;
+        }
+
+        const json* member(const json& object, const char* key)
+        {
+            if (!object.is_object())
+            {
+                return nullptr;
+            }
+            const auto it = object.find(key);
+            return it != object.end() ? &*it : nullptr;
+        }
+
+        std::string_view stringMember(const json& object, const char* key)
+        {
+            const json* value = member(object, key);
+            return value != nullptr && value->is_string()
+                       ? std::string_view(value->get_ref<const std::string&>())
+                       : std::string_view();
+        }
+
+        std::uint64_t lineMember(const json& object, const char* key)
+        {
+            const json* value = member(object, key);
+            return value != nullptr && value->is_number_unsigned() ? value->get<std::uint64_t>()
+                                                                   : 0;
+        }
+
+        std::uint8_t levelRank(std::string_view level)
+        {
+            // SARIF defaults a missing level to warning.
+            if (level == "error")
+            {
+                return 3;
+            }
+            if (level == "note")
+            {
+                return 1;
+            }
+            if (level == "none")
+            {
+                return 0;
+            }
+            return 2;
+        }
+
+        std::uint32_t ruleCwe(const std::unordered_map<std::string, std::uint32_t>& ruleCwes,
+                              std::string_view rule)
+        {
+            if (ruleCwes.empty())
+            {
+                return 0;
+            }
+            const auto it = ruleCwes.find(std::string(rule));
+            return it != ruleCwes.end() ? it->second : 0;
+        }
+
+        /**
+         * @brief Normalized finding of a `result` object. The CWE comes from the result's
+         * properties or taxa, its message, its rule id, then its rule descriptor.
+         */
+        Finding findingOf(const json& result,
+                          const std::unordered_map<std::string, std::uint32_t>& ruleCwes,
+                          std::string_view base)
+        {
+            Finding finding;
+            finding.rule = std::string(stringMember(result, "ruleId"));
+            if (finding.rule.empty())
+            {
+                if (const json* rule = member(result, "rule"))
+                {
+                    finding.rule = std::string(stringMember(*rule, "id"));
+                }
+            }
+            finding.level = std::string(stringMember(result, "level"));
+
+            std::string_view message;
+            if (const json* text = member(result, "message"))
+            {
+                message = stringMember(*text, "text");
+            }
+            finding.message_hash = findings::messageHash(message);
+
+            const json* locations = member(result, "locations");
+            if (locations != nullptr && locations->is_array() && !locations->empty())
+            {
+                if (const json* physical = member(locations->front(), "physicalLocation"))
+                {
+                    if (const json* artifact = member(*physical, "artifactLocation"))
+                    {
+                        finding.file =
+                            findings::normalizePath(stringMember(*artifact, "uri"), base);
+                    }
+                    if (const json* region = member(*physical, "region"))
+                    {
+                        finding.line = lineMember(*region, "startLine");
+                        finding.column = lineMember(*region, "startColumn");
+                    }
+                }
+            }
+
+            for (const char* key : {"properties", "taxa"})
+            {
+                if (finding.cwe == 0)
+                {
+                    if (const json* value = member(result, key))
+                    {
+                        finding.cwe = findings::extractCwe(value->dump());
+                    }
+                }
+            }
+            if (finding.cwe == 0)
+            {
+                finding.cwe = findings::extractCwe(message);
+            }
+            if (finding.cwe == 0)
+            {
+                finding.cwe = findings::extractCwe(finding.rule);
+            }
+            if (finding.cwe == 0)
+            {
+                finding.cwe = ruleCwe(ruleCwes, finding.rule);
+            }
+            return finding;
+        }
+
+        /// Stamps @p result with @p fingerprint and serializes it on one line.
+        std::string stamp(json& result, std::uint64_t fingerprint)
+        {
+            json& fingerprints = result["partialFingerprints"];
+            if (!fingerprints.is_object())
+            {
+                fingerprints = json::object();
+            }
+            fingerprints[std::string(SarifReport::kFingerprintKey)] = findings::toHex(fingerprint);
+            return result.dump();
+        }
+
+        /**
+         * @brief Adds to the serialized @p result what the merged report knows about it: the
+         * other tools of its group and its baseline state.
+         */
+        void annotate(std::string& result, const FindingIndex& index, std::size_t group,
+                      std::size_t source, const std::vector<const std::string*>& tools,
+                      std::unordered_map<std::uint64_t, std::size_t>* baseline,
+                      std::uint64_t fingerprint, std::size_t& fresh)
+        {
+            const bool shared = index.shared(group);
+            if (!shared && baseline == nullptr)
+            {
+                return;
+            }
+            json parsed = json::parse(result, nullptr, false);
+            if (!parsed.is_object())
+            {
+                return;
+            }
+            if (shared)
+            {
+                json others = json::array();
+                for (const std::uint32_t other : index.sources(group))
+                {
+                    if (other != source)
+                    {
+                        others.push_back(*tools[other]);
+                    }
+                }
+                json& properties = parsed["properties"];
+                if (properties.is_null() || properties.is_object())
+                {
+                    properties["ctrace/alsoReportedBy"] = std::move(others);
+                }
+            }
+            if (baseline != nullptr)
+            {
+                const auto known = baseline->find(fingerprint);
+                const bool unchanged = known != baseline->end() && known->second != 0;
+                if (unchanged)
+                {
+                    --known->second;
+                }
+                else
+                {
+                    ++fresh;
+                }
+                parsed["baselineState"] = unchanged ? "unchanged" : "new";
+            }
+            result = parsed.dump();
+        }
+    } // namespace
+
+    SarifReport::SarifReport(std::filesystem::path path, std::filesystem::path base)
+        : m_path(std::move(path))
+    {
+        if (base.empty())
+        {
+            std::error_code ec;
+            base = std::filesystem::current_path(ec);
+        }
+        m_base = base.lexically_normal().generic_string();
+    }
+
+    SarifReport::~SarifReport()
+    {
+        for (auto& [_, run] : m_runs)
+        {
+            run->spool.close();
+            std::error_code ec;
+            std::filesystem::remove(run->spoolPath, ec);
+        }
+    }
+
+    SarifReport::Run& SarifReport::run(const std::string& tool)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& slot = m_runs[tool];
+        if (!slot)
+        {
+            slot = std::make_unique<Run>();
+            slot->driver = defaultDriver(tool);
+            slot->spoolPath = std::filesystem::temp_directory_path() /
+                              ("ctrace-sarif-" + uniqueSuffix() + ".spool");
+            slot->spool.open(slot->spoolPath, std::ios::binary | std::ios::trunc);
+        }
+        return *slot;
+    }
+
+    void SarifReport::addRun(const std::string& tool)
+    {
+        (void)run(tool);
+    }
+
+    void SarifReport::setDriver(const std::string& tool, std::string driver)
+    {
+        Run& target = run(tool);
+        std::lock_guard<std::mutex> lock(target.mutex);
+        if (!target.hasToolDriver)
+        {
+            target.driver = std::move(driver);
+            target.hasToolDriver = true;
+        }
+    }
+
+    void SarifReport::addRule(const std::string& tool, std::string_view id, std::string rule)
+    {
+        Run& target = run(tool);
+        std::lock_guard<std::mutex> lock(target.mutex);
+        if (target.ruleIds.emplace(id).second)
+        {
+            if (const std::uint32_t cwe = findings::extractCwe(rule); cwe != 0)
+            {
+                target.ruleCwes.emplace(id, cwe);
+            }
+            target.rules.push_back(std::move(rule));
+        }
+    }
+
+    void SarifReport::append(Run& target, std::string_view result, const Finding& finding,
+                             std::uint64_t fingerprint)
+    {
+        if (!target.entries.empty())
+        {
+            target.spool << ",\n";
+        }
+        target.spool << result;
+        Entry& entry = target.entries.emplace_back();
+        entry.key = FindingIndex::keyOf(finding, 0);
+        entry.fingerprint = fingerprint;
+        entry.level = levelRank(finding.level);
+    }
+
+    std::string SarifReport::addResult(const std::string& tool, std::string_view result)
+    {
+        json parsed = json::parse(result, nullptr, false);
+        if (!parsed.is_object())
+        {
+            // Spooled as is, it would make the whole report invalid SARIF.
+            coretrace::log(coretrace::Level::Warn,
+                           "Dropping a SARIF result of '{}' that is not a JSON object\n", tool);
+            return {};
+        }
+        Run& target = run(tool);
+        std::lock_guard<std::mutex> lock(target.mutex);
+        const Finding finding = findingOf(parsed, target.ruleCwes, m_base);
+        const std::uint64_t fingerprint = findings::fingerprint(finding);
+        std::string serialized = stamp(parsed, fingerprint);
+        append(target, serialized, finding, fingerprint);
+        return serialized;
+    }
+
+    std::string SarifReport::addResult(const std::string& tool, const SarifResult& result)
+    {
+        Finding finding;
+        finding.file = findings::normalizePath(result.uri, m_base);
+        finding.line = result.start_line;
+        finding.column = result.start_column;
+        finding.rule = std::string(result.rule_id);
+        finding.level = std::string(result.level);
+        finding.message_hash = findings::messageHash(result.message);
+        finding.cwe = findings::extractCwe(result.message);
+        if (finding.cwe == 0)
+        {
+            finding.cwe = findings::extractCwe(result.rule_id);
+        }
+
+        // Reopen the object to add the fingerprint.
+        std::string serialized = serializeResult(result);
+        serialized.pop_back();
+        serialized.append(",\"partialFingerprints\":{");
+        appendJsonString(serialized, kFingerprintKey);
+        serialized.push_back(':');
+
+        Run& target = run(tool);
+        std::lock_guard<std::mutex> lock(target.mutex);
+        if (finding.cwe == 0)
+        {
+            finding.cwe = ruleCwe(target.ruleCwes, finding.rule);
+        }
+        const std::uint64_t fingerprint = findings::fingerprint(finding);
+        appendJsonString(serialized, findings::toHex(fingerprint));
+        serialized.append("}}");
+        append(target, serialized, finding, fingerprint);
+        return serialized;
+    }
+
+    bool SarifReport::addDocument(const std::string& tool, std::string_view document,
+                                  std::string& error, SarifFragment* record)
+    {
+        const DocumentVisitor visitor{
+            [&](std::string driver)
+            {
+                if (record != nullptr && record->driver.empty())
+                {
+                    record->driver = driver;
+                }
+                setDriver(tool, std::move(driver));
+            },
+            [&](std::string_view id, std::string rule)
+            {
+                if (record != nullptr)
+                {
+                    record->rules.push_back(rule);
+                }
+                addRule(tool, id, std::move(rule));
+            },
+            [&](json& result)
+            {
+                Run& target = run(tool);
+                std::string serialized;
+                {
+                    std::lock_guard<std::mutex> lock(target.mutex);
+                    const Finding finding = findingOf(result, target.ruleCwes, m_base);
+                    const std::uint64_t fingerprint = findings::fingerprint(finding);
+                    serialized = stamp(result, fingerprint);
+                    append(target, serialized, finding, fingerprint);
+                }
+                if (record != nullptr)
+                {
+                    record->results.push_back(std::move(serialized));
+                }
+            }};
+        return visitDocument(document, visitor, error);
+    }
+
+    void SarifReport::replay(const std::string& tool, const SarifFragment& fragment)
+    {
+        addRun(tool);
+        if (!fragment.driver.empty())
+        {
+            setDriver(tool, fragment.driver);
+        }
+        for (const auto& rule : fragment.rules)
+        {
+            const auto parsed = json::parse(rule, nullptr, false);
+            if (parsed.is_object() && parsed.contains("id") && parsed["id"].is_string())
+            {
+                addRule(tool, parsed["id"].get_ref<const std::string&>(), rule);
+            }
+        }
+        for (const auto& result : fragment.results)
+        {
+            addResult(tool, result);
+        }
+    }
+
+    bool SarifReport::loadBaseline(const std::filesystem::path& path, std::string& error)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            error = "Unable to read SARIF baseline '" + path.string() + "'";
+            return false;
+        }
+        const std::string document((std::istreambuf_iterator<char>(in)),
+                                   std::istreambuf_iterator<char>());
+
+        std::unordered_map<std::uint64_t, std::size_t> baseline;
+        const auto onResult = [&baseline](json& result)
+        {
+            const json* fingerprints = member(result, "partialFingerprints");
+            if (fingerprints == nullptr)
+            {
+                return;
+            }
+            const std::string_view hex = stringMember(*fingerprints, kFingerprintKey.data());
+            std::uint64_t fingerprint = 0;
+            const auto [end, ec] =
+                std::from_chars(hex.data(), hex.data() + hex.size(), fingerprint, 16);
+            if (!hex.empty() && ec == std::errc() && end == hex.data() + hex.size())
+            {
+                ++baseline[fingerprint];
+            }
+        };
+        const DocumentVisitor visitor{[](std::string) {}, [](std::string_view, std::string) {},
+                                      onResult};
+        if (!visitDocument(document, visitor, error))
+        {
+            error = "SARIF baseline '" + path.string() + "': " + error;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_baseline = std::move(baseline);
+        m_hasBaseline = true;
+        return true;
+    }
+
+    std::size_t SarifReport::resultCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::size_t total = 0;
+        for (const auto& [_, run] : m_runs)
+        {
+            std::lock_guard<std::mutex> runLock(run->mutex);
+            total += run->entries.size();
+        }
+        return total;
+    }
+
+    std::size_t SarifReport::runCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_runs.size();
+    }
+
+    bool SarifReport::write(std::string& error, Summary* summary) const
+    {
+        std::error_code ec;
+        if (m_path.has_parent_path())
+        {
+            std::filesystem::create_directories(m_path.parent_path(), ec);
+        }
+
+        // Write to a private name first so readers never see a partial report.
+        auto temporary = m_path;
+        temporary += ".tmp-" + uniqueSuffix();
+        Summary totals;
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!write(out, error, &totals))
+            {
+                out.close();
+                std::filesystem::remove(temporary, ec);
+                return false;
+            }
+            out.flush();
+            if (!out)
+            {
+                error = "Unable to write SARIF report '" + temporary.string() + "'";
+                out.close();
+                std::filesystem::remove(temporary, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, m_path, ec);
+        if (ec)
+        {
+            error = "Unable to publish SARIF report '" + m_path.string() + "': " + ec.message();
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+        if (summary != nullptr)
+        {
+            *summary = totals;
+        }
+        return true;
+    }
+
+    bool SarifReport::write(std::ostream& out, std::string& error, Summary* summary) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<const std::string*> tools;
+        std::vector<Run*> runs;
+        for (const auto& [tool, run] : m_runs)
+        {
+            tools.push_back(&tool);
+            runs.push_back(run.get());
+        }
+
+        // Group the results of every run; the first result of a group is the one written.
+        constexpr std::size_t kDropped = std::numeric_limits<std::size_t>::max();
+        std::vector<std::vector<std::size_t>> groupOf(runs.size());
+        std::size_t expected = 0;
+        for (const Run* run : runs)
+        {
+            std::lock_guard<std::mutex> runLock(run->mutex);
+            expected += run->entries.size();
+        }
+        FindingIndex index;
+        index.reserve(expected);
+        Summary totals;
+        for (std::size_t r = 0; r < runs.size(); ++r)
+        {
+            std::lock_guard<std::mutex> runLock(runs[r]->mutex);
+            const auto& entries = runs[r]->entries;
+            groupOf[r].reserve(entries.size());
+            for (const Entry& entry : entries)
+            {
+                FindingIndex::Key key = entry.key;
+                key.source = static_cast<std::uint32_t>(r);
+                const std::size_t group = index.add(key);
+                const bool owner = group == totals.unique;
+                totals.unique += owner ? 1 : 0;
+                groupOf[r].push_back(owner ? group : kDropped);
+            }
+            totals.results += entries.size();
+        }
+        auto baseline = m_baseline;
+
+        out << "{\n\"version\": \"2.1.0\",\n\"$schema\": \"" << kSchemaUri << "\",\n\"runs\": [";
+
+        for (std::size_t r = 0; r < runs.size(); ++r)
+        {
+            Run& run = *runs[r];
+            std::lock_guard<std::mutex> runLock(run.mutex);
+            out << (r == 0 ? "\n" : ",\n");
+
+            // The driver is an object without rules: reopen it to append them.
+            std::string_view driver = run.driver;
+            driver.remove_suffix(1);
+            out << "{\"tool\":{\"driver\":" << driver
+                << (driver.size() > 1 ? ",\"rules\":[" : "\"rules\":[");
+            for (std::size_t i = 0; i < run.rules.size(); ++i)
+            {
+                out << (i == 0 ? "" : ",") << run.rules[i];
+            }
+            out << "]}},\n\"results\": [";
+
+            // Results added since the grouping above are left for the next write.
+            const std::vector<std::size_t>& groups = groupOf[r];
+            bool rewrite = m_hasBaseline || groups.size() != run.entries.size();
+            for (std::size_t i = 0; i < groups.size(); ++i)
+            {
+                const std::size_t group = groups[i];
+                rewrite = rewrite || group == kDropped || index.shared(group);
+                if (group != kDropped)
+                {
+                    const std::uint8_t level = run.entries[i].level;
+                    totals.errors += level == 3 ? 1 : 0;
+                    totals.warnings += level == 2 ? 1 : 0;
+                    totals.notes += level < 2 ? 1 : 0;
+                }
+            }
+
+            if (!groups.empty())
+            {
+                run.spool.flush();
+                std::ifstream spool(run.spoolPath, std::ios::binary);
+                if (!rewrite)
+                {
+                    // Nothing merged into or out of this run: copy the spool as is.
+                    out << '\n' << spool.rdbuf() << '\n';
+                }
+                else
+                {
+                    std::string line;
+                    bool firstResult = true;
+                    for (std::size_t i = 0; i < groups.size() && std::getline(spool, line); ++i)
+                    {
+                        if (groups[i] == kDropped)
+                        {
+                            continue;
+                        }
+                        if (!line.empty() && line.back() == ',')
+                        {
+                            line.pop_back();
+                        }
+                        annotate(line, index, groups[i], r, tools,
+                                 m_hasBaseline ? &baseline : nullptr, run.entries[i].fingerprint,
+                                 totals.fresh);
+                        out << (firstResult ? "\n" : ",\n") << line;
+                        firstResult = false;
+                    }
+                    if (!firstResult)
+                    {
+                        out << '\n';
+                    }
+                }
+                if (!run.spool || !spool)
+                {
+                    error = "Unable to read the spooled SARIF results of '" + *tools[r] + "'";
+                    return false;
+                }
+            }
+            out << "]}";
+        }
+        out << "\n]\n}\n";
+
+        if (!out)
+        {
+            error = "Unable to write SARIF report '" + m_path.string() + "'";
+            return false;
+        }
+        if (summary != nullptr)
+        {
+            *summary = totals;
+        }
+        return true;
+    }
+
+    std::string SarifReport::serializeResult(const SarifResult& result)
+    {
+        std::string out;
+        out.reserve(160 + result.rule_id.size() + result.message.size() + result.uri.size());
+        out.append("{\"ruleId\":");
+        appendJsonString(out, result.rule_id);
+        out.append(",\"level\":");
+        appendJsonString(out, result.level.empty() ? std::string_view("warning") : result.level);
+        out.append(",\"message\":{\"text\":");
+        appendJsonString(out, result.message);
+        out.push_back('}');
+        if (!result.uri.empty())
+        {
+            out.append(",\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+            appendJsonString(out, result.uri);
+            out.push_back('}');
+            if (result.start_line != 0)
+            {
+                out.append(",\"region\":{\"startLine\":");
+                out.append(std::to_string(result.start_line));
+                if (result.start_column != 0)
+                {
+                    out.append(",\"startColumn\":");
+                    out.append(std::to_string(result.start_column));
+                }
+                out.push_back('}');
+            }
+            out.append("}}]");
+        }
+        out.push_back('}');
+        return out;
+    }
+
+    std::string SarifReport::serializeRule(std::string_view id, std::string_view name,
+                                           std::string_view description)
+    {
+        std::string out = "{\"id\":";
+        appendJsonString(out, id);
+        out.append(",\"name\":");
+        appendJsonString(out, name);
+        out.append(",\"shortDescription\":{\"text\":");
+        appendJsonString(out, description);
+        out.append("}}");
+        return out;
+    }
+
+    namespace report
+    {
+        void add_rule(std::string_view id, std::string_view name, std::string_view description)
+        {
+            if (!active())
+            {
+                return;
+            }
+            std::string rule = SarifReport::serializeRule(id, name, description);
+            if (current_context->record != nullptr)
+            {
+                current_context->record->rules.push_back(rule);
+            }
+            current_context->report->addRule(current_context->tool, id, std::move(rule));
+        }
+
+        void add_result(const SarifResult& result)
+        {
+            if (!active())
+            {
+                return;
+            }
+            std::string serialized =
+                current_context->report->addResult(current_context->tool, result);
+            if (current_context->record != nullptr)
+            {
+                current_context->record->results.push_back(std::move(serialized));
+            }
+        }
+
+        bool add_document(std::string_view document, std::string& error)
+        {
+            if (!active())
+            {
+                return true;
+            }
+            return current_context->report->addDocument(current_context->tool, document, error,
+                                                        current_context->record);
+        }
+    } // namespace report
+} // namespace ctrace
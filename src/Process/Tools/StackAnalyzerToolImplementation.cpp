@@ -1,17 +1,25 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "Process/Tools/AnalysisTools.hpp"
+#include "Process/Tools/RuntimeHistory.hpp"
+#include "Process/Trace.hpp"
 #include "app/AnalyzerApp.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
 #include <optional>
-#include <regex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 
 #include <nlohmann/json.hpp>
@@ -20,12 +28,24 @@
 
 #if !defined(_WIN32)
 #include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 #include <unistd.h>
+
+extern char** environ;
+#endif
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
 #endif
 
 namespace
 {
     constexpr std::string_view kStackAnalyzerModule = "stack_analyzer";
+    constexpr std::string_view kStackAnalyzerToolName = "ctrace_stack_analyzer";
     using Json = nlohmann::json;
 
     struct AnalyzerArgBuildResult
@@ -143,7 +163,7 @@ namespace
         }
         else
         {
-            appendFlagOption(args, report, "--format=json", config.global.hasSarifFormat,
+            appendFlagOption(args, report, "--format=sarif", config.global.hasSarifFormat,
                              "derived from coretrace --sarif-format",
                              "empty stack_analyzer.output_format and sarif disabled");
         }
@@ -430,66 +450,114 @@ namespace
         return result;
     }
 
-    [[nodiscard]] std::optional<ctrace::DiagnosticSummary>
-    parseDiagnosticsSummaryFromText(std::string_view text)
+    [[nodiscard]] bool consumeLiteral(std::string_view& text, std::string_view literal)
     {
-        static const std::regex kTotalSummaryPattern(
-            R"(Total diagnostics summary:\s*info=(\d+),\s*warning=(\d+),\s*error=(\d+))");
-        static const std::regex kSummaryPattern(
-            R"(Diagnostics summary:\s*info=(\d+),\s*warning=(\d+),\s*error=(\d+))");
+        if (text.substr(0, literal.size()) != literal)
+        {
+            return false;
+        }
+        text.remove_prefix(literal.size());
+        return true;
+    }
 
-        std::string captured(text);
-        auto parseSummary = [](const std::smatch& match) -> std::optional<ctrace::DiagnosticSummary>
+    void skipWhitespace(std::string_view& text)
+    {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
         {
-            ctrace::DiagnosticSummary current{};
-            try
-            {
-                current.info = static_cast<std::size_t>(std::stoull(match[1].str()));
-                current.warning = static_cast<std::size_t>(std::stoull(match[2].str()));
-                current.error = static_cast<std::size_t>(std::stoull(match[3].str()));
-            }
-            catch (const std::exception&)
-            {
-                return std::nullopt;
-            }
-            return current;
-        };
+            text.remove_prefix(1);
+        }
+    }
 
-        std::optional<ctrace::DiagnosticSummary> totalSummary;
-        for (std::sregex_iterator it(captured.begin(), captured.end(), kTotalSummaryPattern), end;
-             it != end; ++it)
+    [[nodiscard]] bool consumeCount(std::string_view& text, std::size_t& value)
+    {
+        const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc{})
         {
-            if (const auto parsed = parseSummary(*it); parsed.has_value())
-            {
-                totalSummary = parsed;
-            }
+            return false;
         }
-        if (totalSummary.has_value())
+        text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+        return true;
+    }
+
+    /**
+     * @brief Parses `info=<n>, warning=<n>, error=<n>` at the start of @p text.
+     */
+    [[nodiscard]] std::optional<ctrace::DiagnosticSummary> parseSummaryCounts(std::string_view text)
+    {
+        ctrace::DiagnosticSummary summary{};
+        skipWhitespace(text);
+        if (!consumeLiteral(text, "info=") || !consumeCount(text, summary.info) ||
+            !consumeLiteral(text, ","))
         {
-            return totalSummary;
+            return std::nullopt;
         }
+        skipWhitespace(text);
+        if (!consumeLiteral(text, "warning=") || !consumeCount(text, summary.warning) ||
+            !consumeLiteral(text, ","))
+        {
+            return std::nullopt;
+        }
+        skipWhitespace(text);
+        if (!consumeLiteral(text, "error=") || !consumeCount(text, summary.error))
+        {
+            return std::nullopt;
+        }
+        return summary;
+    }
+
+    /**
+     * @brief Extracts the summary from human-readable analyzer output in one pass.
+     *
+     * The last `Total diagnostics summary:` line wins; otherwise every per-input
+     * `Diagnostics summary:` line is summed.
+     */
+    [[nodiscard]] std::optional<ctrace::DiagnosticSummary>
+    parseDiagnosticsSummaryFromText(std::string_view text)
+    {
+        static constexpr std::string_view kTotalMarker = "Total diagnostics summary:";
+        static constexpr std::string_view kMarker = "Diagnostics summary:";
 
+        std::optional<ctrace::DiagnosticSummary> totalSummary;
         std::optional<ctrace::DiagnosticSummary> summary;
-        for (std::sregex_iterator it(captured.begin(), captured.end(), kSummaryPattern), end;
-             it != end; ++it)
+
+        std::size_t start = 0;
+        while (start < text.size())
         {
-            const auto parsed = parseSummary(*it);
-            if (!parsed.has_value())
+            auto end = text.find('\n', start);
+            if (end == std::string_view::npos)
             {
-                continue;
+                end = text.size();
             }
-            if (!summary.has_value())
+            const std::string_view line = text.substr(start, end - start);
+            start = end + 1;
+
+            if (const auto pos = line.find(kTotalMarker); pos != std::string_view::npos)
             {
-                summary = *parsed;
+                if (const auto parsed = parseSummaryCounts(line.substr(pos + kTotalMarker.size())))
+                {
+                    totalSummary = parsed;
+                }
                 continue;
             }
-
-            summary->info += parsed->info;
-            summary->warning += parsed->warning;
-            summary->error += parsed->error;
+            if (const auto pos = line.find(kMarker); pos != std::string_view::npos)
+            {
+                const auto parsed = parseSummaryCounts(line.substr(pos + kMarker.size()));
+                if (!parsed.has_value())
+                {
+                    continue;
+                }
+                if (!summary.has_value())
+                {
+                    summary = *parsed;
+                    continue;
+                }
+                summary->info += parsed->info;
+                summary->warning += parsed->warning;
+                summary->error += parsed->error;
+            }
         }
 
-        return summary;
+        return totalSummary.has_value() ? totalSummary : summary;
     }
 
     [[nodiscard]] std::string toLowerAscii(std::string_view input)
@@ -523,10 +591,9 @@ namespace
     }
 
     [[nodiscard]] std::optional<ctrace::DiagnosticSummary>
-    parseDiagnosticsSummaryFromStructuredOutput(std::string_view text)
+    parseDiagnosticsSummaryFromStructuredOutput(const Json& root)
     {
-        Json root = Json::parse(text, nullptr, false);
-        if (root.is_discarded() || !root.is_object())
+        if (!root.is_object())
         {
             return std::nullopt;
         }
@@ -594,16 +661,6 @@ namespace
         return std::nullopt;
     }
 
-    void captureToolOutputOnly(const std::string& stream, const std::string& message)
-    {
-        const auto* ctx = ctrace::Thread::Output::capture_context;
-        if (!ctx || !ctx->buffer || message.empty())
-        {
-            return;
-        }
-        ctx->buffer->append(ctx->tool, stream, message);
-    }
-
     void logMultiline(coretrace::Level level, std::string_view module, std::string_view message,
                       std::string_view prefix = {})
     {
@@ -711,183 +768,747 @@ namespace
         }
     }
 
-#if !defined(_WIN32)
-    struct CapturedStreams
+    /**
+     * @brief Output of one analyzer run (in-process or merged from shards).
+     */
+    struct AnalyzerRunOutput
     {
         std::string stdoutText;
         std::string stderrText;
+        std::optional<ctrace::DiagnosticSummary> summary;
+        /// [begin, end) of each shard's document in stdoutText when they are not merged.
+        std::vector<std::pair<std::size_t, std::size_t>> documents;
+        bool ok = true;
+        std::string error;
     };
 
-    [[nodiscard]] std::string readFdFully(int fd)
+    /**
+     * @brief Format the analyzer prints, lowercased; empty for its default human output.
+     */
+    [[nodiscard]] std::string effectiveOutputFormat(const ctrace::ProgramConfig& config)
     {
-        if (fd < 0)
+        const std::string format = toLowerAscii(config.global.stack_analyzer_output_format);
+        if (format.empty() && config.global.hasSarifFormat)
         {
-            return {};
+            // buildAnalyzerArgs forwards --format=sarif when SARIF output is requested.
+            return "sarif";
         }
+        return format;
+    }
 
-        if (lseek(fd, 0, SEEK_SET) == -1)
-        {
-            return {};
-        }
+    [[nodiscard]] bool isStructuredOutputFormat(const ctrace::ProgramConfig& config)
+    {
+        const std::string format = effectiveOutputFormat(config);
+        return format == "json" || format == "sarif";
+    }
 
-        std::string content;
-        std::array<char, 4096> buffer{};
-        for (;;)
+    /**
+     * @brief Diagnostics summary of an analyzer run, from its output.
+     *
+     * Only the representation the analyzer actually produced is inspected: the already parsed
+     * JSON/SARIF document, or the human-readable text.
+     */
+    [[nodiscard]] std::optional<ctrace::DiagnosticSummary>
+    summarizeUnstructuredOutput(std::string_view stdoutText, std::string_view stderrText,
+                                const Json* document)
+    {
+        if (document != nullptr)
         {
-            const auto bytes = read(fd, buffer.data(), buffer.size());
-            if (bytes <= 0)
+            if (auto summary = parseDiagnosticsSummaryFromStructuredOutput(*document))
             {
-                break;
+                return summary;
             }
-            content.append(buffer.data(), static_cast<std::size_t>(bytes));
         }
-        return content;
+        else if (auto summary = parseDiagnosticsSummaryFromText(stdoutText))
+        {
+            return summary;
+        }
+        return parseDiagnosticsSummaryFromText(stderrText);
+    }
+
+    [[nodiscard]] bool crossTuEnabled(const ctrace::ProgramConfig& config)
+    {
+        return config.global.stack_analyzer_resource_cross_tu.value_or(false) ||
+               config.global.stack_analyzer_uninitialized_cross_tu.value_or(false);
+    }
+
+    [[nodiscard]] std::size_t effectiveShardCount(const ctrace::ProgramConfig& config,
+                                                  std::size_t inputCount)
+    {
+        std::size_t shards = config.global.stack_analyzer_shards;
+        if (shards == 1 || inputCount < 2)
+        {
+            return 1;
+        }
+        if (shards == 0)
+        {
+            shards = std::max(1U, std::thread::hardware_concurrency());
+        }
+
+        if (crossTuEnabled(config) && shards > 1)
+        {
+            coretrace::log(coretrace::Level::Info, coretrace::Module(kStackAnalyzerModule),
+                           "Cross-TU analysis enabled; running a single analyzer shard\n");
+            return 1;
+        }
+
+        return std::min(shards, inputCount);
     }
 
-    class ScopedFdCapture
+    /**
+     * @brief Splits inputs into @p shardCount shards of similar expected runtime.
+     *
+     * Files are weighted by their recorded runtime when @p history has one, by their size
+     * otherwise. Heaviest files are placed first, each on the least loaded shard (LPT). Files
+     * keep their original relative order inside a shard.
+     */
+    [[nodiscard]] std::vector<std::vector<std::string>>
+    planShards(const std::vector<std::string>& inputFiles, std::size_t shardCount,
+               const ctrace::RuntimeHistory* history)
     {
-      public:
-        ScopedFdCapture()
+        const std::string toolName(kStackAnalyzerToolName);
+        std::vector<std::pair<double, std::size_t>> weighted;
+        weighted.reserve(inputFiles.size());
+        for (std::size_t i = 0; i < inputFiles.size(); ++i)
+        {
+            if (history != nullptr)
+            {
+                weighted.emplace_back(history->estimate(toolName, inputFiles[i]), i);
+                continue;
+            }
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(inputFiles[i], ec);
+            weighted.emplace_back(ec ? 1.0 : static_cast<double>(std::max<std::uintmax_t>(size, 1)),
+                                  i);
+        }
+        std::stable_sort(weighted.begin(), weighted.end(),
+                         [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+        std::vector<double> load(shardCount, 0);
+        std::vector<std::vector<std::size_t>> assigned(shardCount);
+        for (const auto& [weight, index] : weighted)
         {
-            enabled_ = initialize();
+            const auto lightest =
+                static_cast<std::size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+            load[lightest] += weight;
+            assigned[lightest].push_back(index);
         }
 
-        ~ScopedFdCapture()
+        std::vector<std::vector<std::string>> shards;
+        shards.reserve(shardCount);
+        for (auto& indices : assigned)
         {
-            if (!released_)
+            if (indices.empty())
             {
-                (void)release();
+                continue;
+            }
+            std::sort(indices.begin(), indices.end());
+            auto& shard = shards.emplace_back();
+            shard.reserve(indices.size());
+            for (const auto index : indices)
+            {
+                shard.push_back(inputFiles[index]);
             }
         }
+        return shards;
+    }
 
-        [[nodiscard]] bool enabled() const
+    /**
+     * @brief Merges shard JSON/SARIF documents into the first one.
+     *
+     * Top-level arrays (`diagnostics`, `runs`, ...) are concatenated; other top-level fields
+     * come from the first shard.
+     */
+    [[nodiscard]] Json mergeStructuredDocuments(std::vector<Json>& documents)
+    {
+        Json merged = std::move(documents.front());
+        for (std::size_t i = 1; i < documents.size(); ++i)
         {
-            return enabled_;
+            for (auto it = documents[i].begin(); it != documents[i].end(); ++it)
+            {
+                auto target = merged.find(it.key());
+                if (target == merged.end())
+                {
+                    merged[it.key()] = std::move(it.value());
+                }
+                else if (target->is_array() && it->is_array())
+                {
+                    for (auto& element : *it)
+                    {
+                        target->push_back(std::move(element));
+                    }
+                }
+            }
         }
+        return merged;
+    }
 
-        CapturedStreams release()
+    /// Joins the shard outputs, one per line; @p ranges receives where each one landed.
+    [[nodiscard]] std::string
+    concatenateShardText(const std::vector<std::string>& shardStdout,
+                         std::vector<std::pair<std::size_t, std::size_t>>* ranges = nullptr)
+    {
+        std::size_t size = 0;
+        for (const auto& text : shardStdout)
         {
-            if (released_)
+            size += text.size() + 1;
+        }
+        std::string concatenated;
+        concatenated.reserve(size);
+        for (const auto& text : shardStdout)
+        {
+            if (ranges != nullptr)
             {
-                return {};
+                ranges->emplace_back(concatenated.size(), concatenated.size() + text.size());
             }
+            concatenated += text;
+            if (!text.empty() && text.back() != '\n')
+            {
+                concatenated.push_back('\n');
+            }
+        }
+        return concatenated;
+    }
+
+#if !defined(_WIN32)
+    [[nodiscard]] std::string currentExecutablePath()
+    {
+#if defined(__linux__)
+        std::error_code ec;
+        const auto path = std::filesystem::read_symlink("/proc/self/exe", ec);
+        return ec ? std::string{} : path.string();
+#elif defined(__APPLE__)
+        std::uint32_t size = 0;
+        (void)_NSGetExecutablePath(nullptr, &size);
+        std::string path(size, '\0');
+        if (_NSGetExecutablePath(path.data(), &size) != 0)
+        {
+            return {};
+        }
+        path.resize(std::strlen(path.c_str()));
+        return path;
+#else
+        return {};
+#endif
+    }
 
-            flushStreams();
+    [[nodiscard]] bool openCloexecPipe(int fds[2])
+    {
+#if defined(__linux__)
+        return pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (pipe(fds) != 0)
+        {
+            return false;
+        }
+        (void)fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        (void)fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    }
+
+    struct WorkerProcess
+    {
+        pid_t pid = -1;
+        int stdoutFd = -1;
+        int stderrFd = -1;
+        std::string stdoutText;
+        std::string stderrText;
+        int exitCode = -1;
+        std::string spawnError;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point finished; ///< When its last pipe closed.
+        std::uint64_t peakRssKib = 0;
+        bool ownGroup = false;   ///< Leads its own process group, killed as a whole.
+        bool cpuLimited = false; ///< RLIMIT_CPU was applied.
+        std::string abortReason; ///< Why the worker was killed, empty otherwise.
+    };
 
-            CapturedStreams captured{
-                readFdFully(capturedStdoutFd_),
-                readFdFully(capturedStderrFd_),
-            };
+    /**
+     * @brief Spawns @p executable with stdout and stderr on the given fds.
+     * @return 0 or the posix_spawn error code.
+     */
+    [[nodiscard]] int spawnWithOutputs(const std::string& executable, std::vector<char*>& argv,
+                                       int stdoutFd, int stderrFd, bool ownGroup, pid_t& pid)
+    {
+        posix_spawn_file_actions_t fileActions;
+        posix_spawnattr_t attr;
+        if (int status = posix_spawn_file_actions_init(&fileActions); status != 0)
+        {
+            return status;
+        }
+        if (int status = posix_spawnattr_init(&attr); status != 0)
+        {
+            posix_spawn_file_actions_destroy(&fileActions);
+            return status;
+        }
 
-            restoreDescriptors();
-            closeTempFiles();
-            released_ = true;
-            return captured;
+        // Like UnixProcessWithPosixSpawn: default signal handling and an empty mask, whatever
+        // the calling worker thread had blocked.
+        sigset_t emptyMask;
+        sigset_t defaultSignals;
+        sigemptyset(&emptyMask);
+        sigemptyset(&defaultSignals);
+        sigaddset(&defaultSignals, SIGPIPE);
+        sigaddset(&defaultSignals, SIGINT);
+        sigaddset(&defaultSignals, SIGTERM);
+        posix_spawnattr_setsigmask(&attr, &emptyMask);
+        posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+        short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+        if (ownGroup)
+        {
+            posix_spawnattr_setpgroup(&attr, 0);
+            flags |= POSIX_SPAWN_SETPGROUP;
         }
+        posix_spawnattr_setflags(&attr, flags);
 
-      private:
-        static int createTempFile(char* templ)
+        // Applied in order, so a pipe end that landed on fd 1-2 is duplicated before it is
+        // overwritten.
+        int status = posix_spawn_file_actions_adddup2(&fileActions, stdoutFd, STDOUT_FILENO);
+        if (status == 0)
         {
-            const int fd = mkstemp(templ);
-            if (fd >= 0)
+            status = posix_spawn_file_actions_adddup2(&fileActions, stderrFd, STDERR_FILENO);
+        }
+        if (status == 0)
+        {
+            status = posix_spawn(&pid, executable.c_str(), &fileActions, &attr, argv.data(),
+                                 environ);
+        }
+
+        posix_spawn_file_actions_destroy(&fileActions);
+        posix_spawnattr_destroy(&attr);
+        return status;
+    }
+
+    void spawnWorker(const std::string& executable, const std::vector<std::string>& args,
+                     const ctrace::process::ExecutionControl* control, WorkerProcess& worker)
+    {
+        std::vector<char*> argv;
+        argv.reserve(args.size() + 3);
+        argv.push_back(const_cast<char*>(executable.c_str()));
+        argv.push_back(const_cast<char*>(
+            ctrace::StackAnalyzerToolImplementation::kWorkerFlag.data()));
+        for (const auto& arg : args)
+        {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        int outPipe[2] = {-1, -1};
+        int errPipe[2] = {-1, -1};
+        if (!openCloexecPipe(outPipe) || !openCloexecPipe(errPipe))
+        {
+            worker.spawnError = std::string("pipe failed: ") + std::strerror(errno);
+            for (const int fd : {outPipe[0], outPipe[1], errPipe[0], errPipe[1]})
             {
-                unlink(templ);
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
             }
-            return fd;
+            return;
         }
 
-        static void flushStreams()
+        // posix_spawn rather than fork(): this process may hold a large LLVM heap, and the
+        // clone(CLONE_VFORK) glibc uses does not copy its page tables.
+        // Like UnixProcessWithPosixSpawn, controlled workers lead their own process group.
+        worker.ownGroup =
+            control != nullptr && (!control->limits.empty() || control->cancellation);
+        pid_t pid = -1;
+        const int status =
+            spawnWithOutputs(executable, argv, outPipe[1], errPipe[1], worker.ownGroup, pid);
+
+        close(outPipe[1]);
+        close(errPipe[1]);
+        if (status != 0)
+        {
+            worker.spawnError = std::string("posix_spawn failed: ") + std::strerror(status);
+            close(outPipe[0]);
+            close(errPipe[0]);
+            return;
+        }
+
+        worker.pid = pid;
+        if (worker.ownGroup)
         {
-            std::fflush(stdout);
-            std::fflush(stderr);
-            std::cout.flush();
-            std::cerr.flush();
-            llvm::outs().flush();
-            llvm::errs().flush();
+            ctrace::process::process_groups::add(pid);
         }
+        if (control != nullptr)
+        {
+            worker.cpuLimited = ctrace::process::apply_cpu_limit(pid, control->limits);
+        }
+        worker.stdoutFd = outPipe[0];
+        worker.stderrFd = errPipe[0];
+    }
 
-        bool initialize()
+    void killWorker(WorkerProcess& worker, std::string reason)
+    {
+        if (worker.abortReason.empty())
         {
-            flushStreams();
+            worker.abortReason = std::move(reason);
+        }
+        kill(worker.ownGroup ? -worker.pid : worker.pid, SIGKILL);
+    }
 
-            originalStdoutFd_ = dup(STDOUT_FILENO);
-            originalStderrFd_ = dup(STDERR_FILENO);
-            if (originalStdoutFd_ < 0 || originalStderrFd_ < 0)
+    /**
+     * @brief Runs one worker process per shard and collects their output.
+     *
+     * All pipes are drained from the calling thread with a single poll() loop, so shards run
+     * in parallel without a thread per shard. The tool's ExecutionControl applies to every
+     * worker: each one has its own ChildWatchdog, checked every ChildWatchdog::kTick, and its
+     * RLIMIT_CPU.
+     */
+    [[nodiscard]] std::vector<WorkerProcess>
+    runWorkerProcesses(const std::string& executable,
+                       const std::vector<std::vector<std::string>>& shardArgs)
+    {
+        const ctrace::process::ExecutionControl* control = ctrace::process::current_control;
+        std::vector<WorkerProcess> workers(shardArgs.size());
+        std::vector<ctrace::process::ChildWatchdog> watchdogs;
+        watchdogs.reserve(shardArgs.size());
+        for (std::size_t i = 0; i < shardArgs.size(); ++i)
+        {
+            const ctrace::trace::ScopedSpan span(ctrace::trace::Phase::Spawn,
+                                                 kStackAnalyzerToolName);
+            workers[i].started = std::chrono::steady_clock::now();
+            spawnWorker(executable, shardArgs[i], control, workers[i]);
+            watchdogs.emplace_back(workers[i].pid, control);
+        }
+        const ctrace::trace::ScopedSpan captureSpan(ctrace::trace::Phase::Capture,
+                                                    kStackAnalyzerToolName);
+
+        std::vector<pollfd> fds;
+        std::vector<std::string*> sinks;
+        std::vector<std::size_t> owners;
+        std::vector<int> openPerWorker(workers.size(), 0);
+        for (std::size_t w = 0; w < workers.size(); ++w)
+        {
+            auto& worker = workers[w];
+            if (worker.pid < 0)
             {
-                return false;
+                continue;
             }
+            fds.push_back(pollfd{worker.stdoutFd, POLLIN, 0});
+            sinks.push_back(&worker.stdoutText);
+            fds.push_back(pollfd{worker.stderrFd, POLLIN, 0});
+            sinks.push_back(&worker.stderrText);
+            owners.insert(owners.end(), 2, w);
+            openPerWorker[w] = 2;
+        }
 
-            char stdoutTemplate[] = "/tmp/ctrace-stack-stdout-XXXXXX";
-            char stderrTemplate[] = "/tmp/ctrace-stack-stderr-XXXXXX";
+        const bool watched = control != nullptr && !watchdogs.empty() && watchdogs.front().active();
+        const auto tick = ctrace::process::ChildWatchdog::kTick;
+        const int timeoutMs = watched ? static_cast<int>(tick.count()) : -1;
+        auto nextCheck = std::chrono::steady_clock::now() + tick;
 
-            capturedStdoutFd_ = createTempFile(stdoutTemplate);
-            capturedStderrFd_ = createTempFile(stderrTemplate);
-            if (capturedStdoutFd_ < 0 || capturedStderrFd_ < 0)
+        const auto closeFd = [&](std::size_t i)
+        {
+            close(fds[i].fd);
+            fds[i].fd = -1;
+            const std::size_t w = owners[i];
+            if (--openPerWorker[w] == 0)
             {
-                return false;
+                workers[w].finished = std::chrono::steady_clock::now();
             }
+        };
 
-            if (dup2(capturedStdoutFd_, STDOUT_FILENO) == -1)
+        std::size_t open = fds.size();
+        std::array<char, 65536> buffer{};
+        while (open > 0)
+        {
+            const int ready = poll(fds.data(), static_cast<nfds_t>(fds.size()), timeoutMs);
+            if (ready < 0 && errno != EINTR)
             {
-                return false;
+                // Output can no longer be collected: stop every worker rather than truncate.
+                const std::string reason =
+                    std::string("failed to poll its output: ") + std::strerror(errno);
+                for (std::size_t i = 0; i < fds.size(); ++i)
+                {
+                    if (fds[i].fd >= 0)
+                    {
+                        killWorker(workers[owners[i]], reason);
+                        closeFd(i);
+                    }
+                }
+                break;
             }
-            if (dup2(capturedStderrFd_, STDERR_FILENO) == -1)
+
+            // Limits and cancellation are checked on a schedule, like drainOutputPipe().
+            if (watched && std::chrono::steady_clock::now() >= nextCheck)
             {
-                return false;
+                for (std::size_t w = 0; w < workers.size(); ++w)
+                {
+                    if (openPerWorker[w] > 0 && workers[w].abortReason.empty() &&
+                        watchdogs[w].expired())
+                    {
+                        killWorker(workers[w], watchdogs[w].reason());
+                    }
+                }
+                nextCheck = std::chrono::steady_clock::now() + tick;
+            }
+            if (ready <= 0)
+            {
+                continue;
             }
 
-            return true;
+            for (std::size_t i = 0; i < fds.size(); ++i)
+            {
+                if (fds[i].fd < 0 || fds[i].revents == 0)
+                {
+                    continue;
+                }
+                const auto bytes = read(fds[i].fd, buffer.data(), buffer.size());
+                if (bytes > 0)
+                {
+                    sinks[i]->append(buffer.data(), static_cast<std::size_t>(bytes));
+                    continue;
+                }
+                if (bytes < 0 && (errno == EINTR || errno == EAGAIN))
+                {
+                    continue;
+                }
+                if (bytes < 0)
+                {
+                    killWorker(workers[owners[i]],
+                               std::string("failed to read its output: ") + std::strerror(errno));
+                }
+                closeFd(i);
+                --open;
+            }
         }
 
-        void restoreDescriptors()
+        for (auto& worker : workers)
         {
-            if (!enabled_)
+            if (worker.pid < 0)
+            {
+                continue;
+            }
+            int status = 0;
+            rusage usage{};
+            while (wait4(worker.pid, &status, 0, &usage) < 0 && errno == EINTR)
             {
-                return;
             }
-
-            if (originalStdoutFd_ >= 0)
+            ctrace::process::process_groups::remove(worker.pid);
+            if (control != nullptr)
+            {
+                control->record_peak_rss(usage);
+            }
+#if defined(__APPLE__)
+            worker.peakRssKib = static_cast<std::uint64_t>(usage.ru_maxrss) / 1024;
+#else
+            worker.peakRssKib = static_cast<std::uint64_t>(usage.ru_maxrss);
+#endif
+            if (WIFEXITED(status))
             {
-                (void)dup2(originalStdoutFd_, STDOUT_FILENO);
+                worker.exitCode = WEXITSTATUS(status);
             }
-            if (originalStderrFd_ >= 0)
+            else if (WIFSIGNALED(status))
             {
-                (void)dup2(originalStderrFd_, STDERR_FILENO);
+                worker.exitCode = 128 + WTERMSIG(status);
+                // Past the soft RLIMIT_CPU the kernel sends SIGXCPU, past the hard one SIGKILL.
+                if (worker.abortReason.empty() && worker.cpuLimited &&
+                    (WTERMSIG(status) == SIGXCPU || WTERMSIG(status) == SIGKILL))
+                {
+                    worker.abortReason = "exceeded cpu_seconds";
+                }
             }
+        }
+        return workers;
+    }
+
+    /**
+     * @brief Splits each shard's wall time over its files, in proportion to their estimates.
+     *
+     * A shard reports one time and one peak RSS; every file of the shard is charged that peak.
+     * Failed shards are not recorded.
+     */
+    void recordShardRuntimes(ctrace::RuntimeHistory& history,
+                             const std::vector<std::vector<std::string>>& shards,
+                             const std::vector<WorkerProcess>& workers)
+    {
+        const std::string toolName(kStackAnalyzerToolName);
+        // Estimates are all taken before recording, which changes them.
+        std::vector<std::vector<double>> weights(shards.size());
+        for (std::size_t i = 0; i < shards.size() && i < workers.size(); ++i)
+        {
+            for (const auto& file : shards[i])
+            {
+                weights[i].push_back(history.estimate(toolName, file));
+            }
+        }
 
-            if (originalStdoutFd_ >= 0)
+        for (std::size_t i = 0; i < shards.size() && i < workers.size(); ++i)
+        {
+            const auto& worker = workers[i];
+            if (worker.pid < 0 || worker.exitCode != 0 || worker.finished < worker.started)
+            {
+                continue;
+            }
+            const double wallMs =
+                std::chrono::duration<double, std::milli>(worker.finished - worker.started).count();
+            double total = 0;
+            for (const double weight : weights[i])
             {
-                close(originalStdoutFd_);
-                originalStdoutFd_ = -1;
+                total += weight;
             }
-            if (originalStderrFd_ >= 0)
+            for (std::size_t f = 0; f < shards[i].size(); ++f)
             {
-                close(originalStderrFd_);
-                originalStderrFd_ = -1;
+                const double share = total > 0 ? weights[i][f] / total
+                                                : 1.0 / static_cast<double>(shards[i].size());
+                history.record(toolName, shards[i][f],
+                               ctrace::RuntimeSample{wallMs * share, worker.peakRssKib});
             }
         }
+    }
+#endif
 
-        void closeTempFiles()
+    /**
+     * @brief Runs the analyzer inside this process.
+     *
+     * Only used where no worker process can be spawned: the analyzer then writes straight to
+     * the console and its output is not captured.
+     */
+    [[nodiscard]] AnalyzerRunOutput runInProcess(auto parsedArguments)
+    {
+        AnalyzerRunOutput output;
+        const ctrace::stack::app::RunResult runResult =
+            ctrace::stack::app::runAnalyzerApp(std::move(parsedArguments));
+
+        if (!runResult.isOk())
         {
-            if (capturedStdoutFd_ >= 0)
+            output.ok = false;
+            output.error = runResult.error;
+        }
+        else if (runResult.exitCode != 0)
+        {
+            output.ok = false;
+            output.error = "Stack analyzer exited with code " + std::to_string(runResult.exitCode);
+        }
+        return output;
+    }
+
+#if !defined(_WIN32)
+    /**
+     * @param separateDocuments Keeps the shards' JSON/SARIF documents apart, as
+     *        AnalyzerRunOutput::documents, instead of merging them into one: the merged SARIF
+     *        report takes them one by one.
+     */
+    [[nodiscard]] AnalyzerRunOutput runShards(const std::string& executable,
+                                              const std::vector<std::string>& inputFiles,
+                                              std::size_t shardCount,
+                                              const ctrace::ProgramConfig& config,
+                                              bool separateDocuments)
+    {
+        const auto history = ctrace::RuntimeHistory::forConfig(config);
+        const auto shards = planShards(inputFiles, shardCount, history.get());
+        ctrace::ProgramConfig shardConfig = config;
+        if (shards.size() > 1)
+        {
+            coretrace::log(coretrace::Level::Info, coretrace::Module(kStackAnalyzerModule),
+                           "Running {} analyzer shards in parallel\n", shards.size());
+
+            // Shards already run in parallel; keep each one single-threaded unless configured.
+            if (shardConfig.global.stack_analyzer_jobs.empty())
+            {
+                shardConfig.global.stack_analyzer_jobs = "1";
+            }
+        }
+
+        std::vector<std::vector<std::string>> shardArgs;
+        shardArgs.reserve(shards.size());
+        for (const auto& shard : shards)
+        {
+            shardArgs.push_back(buildAnalyzerArgs(shard, shardConfig).args);
+        }
+
+        auto workers = runWorkerProcesses(executable, shardArgs);
+        if (history)
+        {
+            recordShardRuntimes(*history, shards, workers);
+        }
+        const ctrace::trace::ScopedSpan parseSpan(ctrace::trace::Phase::Parse,
+                                                  kStackAnalyzerToolName);
+
+        // JSON/SARIF reports are parsed once per shard, for the summary; the parsed documents
+        // are merged only when a single document has to be printed.
+        const bool structured = isStructuredOutputFormat(config);
+        const bool mergeDocuments = structured && !separateDocuments && workers.size() > 1;
+
+        AnalyzerRunOutput output;
+        std::vector<std::string> shardStdout;
+        std::vector<Json> shardDocuments;
+        shardStdout.reserve(workers.size());
+        for (std::size_t i = 0; i < workers.size(); ++i)
+        {
+            auto& worker = workers[i];
+
+            std::optional<Json> document;
+            if (structured)
             {
-                close(capturedStdoutFd_);
-                capturedStdoutFd_ = -1;
+                document = Json::parse(worker.stdoutText, nullptr, false);
             }
-            if (capturedStderrFd_ >= 0)
+            const auto summary = summarizeUnstructuredOutput(worker.stdoutText, worker.stderrText,
+                                                             document ? &*document : nullptr);
+            if (summary.has_value())
             {
-                close(capturedStderrFd_);
-                capturedStderrFd_ = -1;
+                if (!output.summary.has_value())
+                {
+                    output.summary.emplace();
+                }
+                output.summary->info += summary->info;
+                output.summary->warning += summary->warning;
+                output.summary->error += summary->error;
+            }
+
+            output.stderrText += worker.stderrText;
+            if (mergeDocuments && document && document->is_object())
+            {
+                shardDocuments.push_back(std::move(*document));
+            }
+            shardStdout.push_back(std::move(worker.stdoutText));
+
+            if (!output.ok)
+            {
+                continue;
+            }
+            const std::string shardLabel = "Stack analyzer shard " + std::to_string(i + 1) + "/" +
+                                           std::to_string(workers.size());
+            if (!worker.spawnError.empty())
+            {
+                output.ok = false;
+                output.error = shardLabel + " failed to start: " + worker.spawnError;
+            }
+            else if (!worker.abortReason.empty())
+            {
+                output.ok = false;
+                output.error = shardLabel + " " + worker.abortReason;
+            }
+            else if (worker.exitCode != 0)
+            {
+                output.ok = false;
+                output.error = shardLabel + " exited with code " + std::to_string(worker.exitCode);
             }
         }
 
-        bool enabled_ = false;
-        bool released_ = false;
-        int originalStdoutFd_ = -1;
-        int originalStderrFd_ = -1;
-        int capturedStdoutFd_ = -1;
-        int capturedStderrFd_ = -1;
-    };
+        if (shardStdout.size() == 1)
+        {
+            output.stdoutText = std::move(shardStdout.front());
+        }
+        else if (separateDocuments)
+        {
+            output.stdoutText = concatenateShardText(shardStdout, &output.documents);
+        }
+        else if (mergeDocuments && !shardDocuments.empty() &&
+                 shardDocuments.size() == workers.size())
+        {
+            output.stdoutText = mergeStructuredDocuments(shardDocuments).dump(2) + "\n";
+        }
+        else
+        {
+            output.stdoutText = concatenateShardText(shardStdout);
+        }
+        return output;
+    }
 #endif
 } // namespace
 
@@ -973,81 +1594,88 @@ namespace ctrace
             return;
         }
 
+        // The analyzer writes to the process's stdout/stderr, so every run happens in a worker
+        // process whose pipes belong to this invocation alone. Nothing is redirected in this
+        // process and other tools keep running while the analyzer works.
+        AnalyzerRunOutput output;
 #if !defined(_WIN32)
-        ScopedFdCapture processOutputCapture;
+        const std::string executable = currentExecutablePath();
+        if (!executable.empty())
+        {
+            const bool sarifToReport =
+                report::active() && effectiveOutputFormat(config) == "sarif";
+            output = runShards(executable, inputFiles,
+                               effectiveShardCount(config, inputFiles.size()), config,
+                               sarifToReport);
+        }
+        else
 #endif
+        {
+            coretrace::log(coretrace::Level::Warn, coretrace::Module(kStackAnalyzerModule),
+                           "Cannot spawn analyzer worker; running in-process without output "
+                           "capture\n");
+            output = runInProcess(std::move(parseResult.parsed));
+        }
 
-        const ctrace::stack::app::RunResult runResult =
-            ctrace::stack::app::runAnalyzerApp(std::move(parseResult.parsed));
-
-        std::string capturedStdout;
-        std::string capturedStderr;
-#if !defined(_WIN32)
-        if (processOutputCapture.enabled())
+        if (!output.stdoutText.empty())
         {
-            const auto captured = processOutputCapture.release();
-            if (!captured.stdoutText.empty())
+            ctrace::Thread::Output::tool_capture_only("stdout", output.stdoutText);
+            if (config.global.ipc == "standardIO")
             {
-                capturedStdout = captured.stdoutText;
-                captureToolOutputOnly("stdout", captured.stdoutText);
-                if (config.global.ipc == "standardIO")
-                {
-                    ctrace::Thread::Output::tool_out(captured.stdoutText);
-                }
-                else if (config.global.ipc == "socket" && ipc)
-                {
-                    ipc->write(captured.stdoutText);
-                }
+                ctrace::Thread::Output::tool_out(output.stdoutText);
             }
-            if (!captured.stderrText.empty())
+            else if (config.global.ipc == "socket" && ipc)
             {
-                capturedStderr = captured.stderrText;
-                captureToolOutputOnly("stderr", captured.stderrText);
-                logMultiline(coretrace::Level::Warn, kStackAnalyzerModule, captured.stderrText);
+                ipc->write(output.stdoutText);
             }
         }
-#endif
-
-        if (const auto parsedSummary = parseDiagnosticsSummaryFromText(capturedStdout);
-            parsedSummary.has_value())
-        {
-            m_lastDiagnosticsSummary = *parsedSummary;
-        }
-        else if (const auto parsedSummary =
-                     parseDiagnosticsSummaryFromStructuredOutput(capturedStdout);
-                 parsedSummary.has_value())
+        if (!output.stderrText.empty())
         {
-            m_lastDiagnosticsSummary = *parsedSummary;
+            ctrace::Thread::Output::tool_capture_only("stderr", output.stderrText);
+            logMultiline(coretrace::Level::Warn, kStackAnalyzerModule, output.stderrText);
         }
-        else if (const auto parsedSummary = parseDiagnosticsSummaryFromText(capturedStderr);
-                 parsedSummary.has_value())
-        {
-            m_lastDiagnosticsSummary = *parsedSummary;
-        }
-        else if (const auto parsedSummary =
-                     parseDiagnosticsSummaryFromStructuredOutput(capturedStderr);
-                 parsedSummary.has_value())
+
+        if (output.summary.has_value())
         {
-            m_lastDiagnosticsSummary = *parsedSummary;
+            m_lastDiagnosticsSummary = *output.summary;
         }
 
-        if (!runResult.isOk())
+        if (!output.ok)
         {
-            ctrace::Thread::Output::tool_err(runResult.error);
+            ctrace::Thread::Output::tool_err(output.error);
             return;
         }
 
-        if (runResult.exitCode != 0)
+        if (report::active())
         {
-            ctrace::Thread::Output::tool_err("Stack analyzer exited with code " +
-                                             std::to_string(runResult.exitCode));
-            return;
+            // report_file belongs to the merged SARIF report of the run.
+            if (effectiveOutputFormat(config) == "sarif")
+            {
+                // Shard documents are streamed into the report one by one, never merged.
+                const std::string_view text = output.stdoutText;
+                if (output.documents.empty())
+                {
+                    reportSarifDocument(text);
+                }
+                for (const auto& [begin, end] : output.documents)
+                {
+                    reportSarifDocument(text.substr(begin, end - begin));
+                }
+            }
+            else
+            {
+                coretrace::log(coretrace::Level::Warn, coretrace::Module(kStackAnalyzerModule),
+                               "Output format '{}' is not SARIF; diagnostics are left out of the "
+                               "merged report\n",
+                               config.global.stack_analyzer_output_format);
+            }
         }
-
-        if (!stableReportPath.empty())
+        else if (!stableReportPath.empty())
         {
+            const trace::ScopedSpan span(trace::Phase::ReportWrite, kStackAnalyzerToolName,
+                                         stableReportPath);
             std::string writeError;
-            if (!writeReportToFile(stableReportPath, capturedStdout, writeError))
+            if (!writeReportToFile(stableReportPath, output.stdoutText, writeError))
             {
                 coretrace::log(coretrace::Level::Warn, coretrace::Module(kStackAnalyzerModule),
                                "Unable to persist stack analyzer report to '{}': {}\n",
@@ -1057,16 +1685,66 @@ namespace ctrace
             {
                 coretrace::log(coretrace::Level::Debug, coretrace::Module(kStackAnalyzerModule),
                                "Stack analyzer report persisted to '{}' ({} bytes)\n",
-                               stableReportPath, capturedStdout.size());
+                               stableReportPath, output.stdoutText.size());
             }
         }
     }
 
+    int StackAnalyzerToolImplementation::runWorker(const std::vector<std::string>& analyzerArgs)
+    {
+        auto parseResult = ctrace::stack::cli::parseArguments(analyzerArgs);
+        if (parseResult.status == ctrace::stack::cli::ParseStatus::Error)
+        {
+            std::cerr << (parseResult.error.empty() ? "Failed to parse stack analyzer arguments."
+                                                    : parseResult.error)
+                      << std::endl;
+            return 2;
+        }
+        if (parseResult.status == ctrace::stack::cli::ParseStatus::Help)
+        {
+            return 0;
+        }
+
+        const ctrace::stack::app::RunResult runResult =
+            ctrace::stack::app::runAnalyzerApp(std::move(parseResult.parsed));
+        llvm::outs().flush();
+        llvm::errs().flush();
+        std::cout.flush();
+        std::fflush(stdout);
+
+        if (!runResult.isOk())
+        {
+            std::cerr << runResult.error << std::endl;
+            return runResult.exitCode != 0 ? runResult.exitCode : 1;
+        }
+        return runResult.exitCode;
+    }
+
     std::string StackAnalyzerToolImplementation::name() const
     {
         return "ctrace_stack_analyzer";
     }
 
+    bool
+    StackAnalyzerToolImplementation::needsWholeProgram(const ctrace::ProgramConfig& config) const
+    {
+        // Cross-TU summaries of unchanged files feed the diagnostics of changed ones.
+        return crossTuEnabled(config);
+    }
+
+    std::string StackAnalyzerToolImplementation::version() const
+    {
+#if !defined(_WIN32)
+        // The analyzer is linked into ctrace and every shard runs this same executable.
+        static const std::string fingerprint = executableFingerprint(currentExecutablePath());
+        if (!fingerprint.empty())
+        {
+            return std::string(ctrace::build::version()) + "/" + fingerprint;
+        }
+#endif
+        return {};
+    }
+
     DiagnosticSummary StackAnalyzerToolImplementation::lastDiagnosticsSummary() const
     {
         return m_lastDiagnosticsSummary;
@@ -1,11 +1,19 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "Process/Tools/AnalysisTools.hpp"
+#include "Process/Tools/TscancodeParser.hpp"
+#include "Process/Trace.hpp"
 
-#include <unordered_map>
+#include <algorithm>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace ctrace
 {
+    namespace
+    {
+        constexpr const char* kTscancodeExecutable = "./tscancode/src/tscancode/trunk/tscancode";
+    } // namespace
 
     void TscancodeToolImplementation::execute(const std::string& file, ProgramConfig config) const
     {
@@ -20,16 +28,16 @@ namespace ctrace
             argsProcess.push_back("--enable=all");
             argsProcess.push_back(src_file);
 
-            auto process = ProcessFactory::createProcess(
-                "./tscancode/src/tscancode/trunk/tscancode", argsProcess);
+            auto process = ProcessFactory::createProcess(kTscancodeExecutable, argsProcess);
+            streamToolOutput(*process);
             process->execute();
-            ctrace::Thread::Output::tool_out(process->logOutput);
             ctrace::Thread::Output::cout("Finished tscancode on " + file);
 
-            if (has_sarif_format)
+            if (has_sarif_format && report::active())
             {
-                ctrace::Thread::Output::tool_out(
-                    sarifFormat(process->logOutput, "ccoretrace-sarif-tscancode.json").dump());
+                const std::size_t count = sarifFormat(process->logOutput);
+                ctrace::Thread::Output::cout("tscancode reported " + std::to_string(count) +
+                                             " diagnostic(s) on " + file);
             }
             // if (has_json_format)
             // {
@@ -48,7 +56,12 @@ namespace ctrace
         return "tscancode";
     }
 
-    std::string_view TscancodeToolImplementation::severityToLevel(const std::string& severity) const
+    std::string TscancodeToolImplementation::version() const
+    {
+        return executableFingerprint(kTscancodeExecutable);
+    }
+
+    std::string_view TscancodeToolImplementation::severityToLevel(std::string_view severity) const
     {
         static constexpr std::pair<std::string_view, std::string_view> mappings[] = {
             {"Warning", "warning"}, {"Information", "note"}, {"Error", "error"}};
@@ -79,67 +92,37 @@ namespace ctrace
         return j;
     }
 
-    json TscancodeToolImplementation::sarifFormat(const std::string& buffer,
-                                                  const std::string& outputFile) const
+    std::size_t TscancodeToolImplementation::sarifFormat(const std::string& buffer) const
     {
-        std::regex diagnostic_regex(R"(\[(.*):(\d+)\]: \((\w+)\) (.*))");
-
-        json sarif;
-        sarif["version"] = "2.1.0";
-        sarif["$schema"] = "https://json.schemastore.org/sarif-2.1.0.json";
-        sarif["runs"] = json::array();
-
-        json run;
-        run["tool"]["driver"]["name"] = "coretrace";
-        run["tool"]["driver"]["version"] = "1.0.0";
-        run["tool"]["driver"]["informationUri"] = "https://coretrace.fr/";
-        run["tool"]["driver"]["rules"] = json::array();
-        run["results"] = json::array();
+        const trace::ScopedSpan span(trace::Phase::Parse, "tscancode", "sarif");
 
-        std::map<std::string, int> ruleMap;
-        int ruleCounter = 0;
-
-        std::istringstream stream(buffer);
-        std::string line;
-
-        while (std::getline(stream, line))
+        // tscancode only has a handful of severities: intern their rule ids and levels once.
+        struct InternedRule
         {
-            std::smatch match;
-            if (std::regex_match(line, match, diagnostic_regex))
+            std::string severity;
+            std::string id;
+            std::string_view level;
+        };
+        std::vector<InternedRule> rules;
+
+        return tscancode::for_each_diagnostic(
+            buffer,
+            [&](const tscancode::Diagnostic& diagnostic)
             {
-                std::string filePath = match[1];
-                int lineNumber = std::stoi(match[2]);
-                std::string severity = match[3];
-                std::string message = match[4];
-
-                std::string ruleId = "coretrace." + severity;
-
-                if (ruleMap.find(ruleId) == ruleMap.end())
+                auto rule = std::find_if(rules.begin(), rules.end(),
+                                         [&](const InternedRule& interned)
+                                         { return interned.severity == diagnostic.severity; });
+                if (rule == rules.end())
                 {
-                    json rule;
-                    rule["id"] = ruleId;
-                    rule["name"] = severity;
-                    rule["shortDescription"]["text"] = severity + " reported by coretrace";
-                    run["tool"]["driver"]["rules"].push_back(rule);
-                    ruleMap[ruleId] = ruleCounter++;
+                    const std::string severity(diagnostic.severity);
+                    rule = rules.insert(rules.end(), InternedRule{severity, "coretrace." + severity,
+                                                                  severityToLevel(severity)});
+                    report::add_rule(rule->id, severity, severity + " reported by coretrace");
                 }
 
-                json result;
-                result["ruleId"] = ruleId;
-                result["level"] = severityToLevel(severity);
-                result["message"]["text"] = message;
-                result["locations"] = {{{"physicalLocation",
-                                         {{"artifactLocation", {{"uri", filePath}}},
-                                          {"region", {{"startLine", lineNumber}}}}}}};
-                run["results"].push_back(result);
-            }
-        }
-
-        sarif["runs"].push_back(run);
-
-        std::ofstream out(outputFile);
-        out << sarif.dump(4);
-        return sarif;
+                report::add_result(SarifResult{rule->id, rule->level, diagnostic.message,
+                                               diagnostic.file, diagnostic.line});
+            });
     }
 
 } // namespace ctrace
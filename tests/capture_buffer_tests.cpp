@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/ThreadProcess.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using ctrace::Thread::Output::CaptureBuffer;
+    using ctrace::Thread::Output::CapturedLine;
+
+    void testSnapshotKeepsAppendOrderPerTool()
+    {
+        CaptureBuffer buffer;
+        for (int i = 0; i < 1000; ++i)
+        {
+            buffer.append(i % 2 == 0 ? "cppcheck" : "flawfinder", "stdout", std::to_string(i));
+        }
+
+        const auto lines = buffer.snapshot();
+        assert(lines.size() == 2);
+        const auto& cppcheck = lines.at("cppcheck");
+        assert(cppcheck.size() == 500);
+        for (std::size_t i = 0; i < cppcheck.size(); ++i)
+        {
+            assert(cppcheck[i]->message == std::to_string(i * 2));
+            assert(cppcheck[i]->stream == "stdout");
+        }
+
+        // Snapshots point at the stored lines rather than copying them.
+        const auto again = buffer.snapshot();
+        assert(again.at("cppcheck").front() == cppcheck.front());
+    }
+
+    void testConcurrentAppendAndSnapshot()
+    {
+        CaptureBuffer buffer;
+        constexpr int kThreads = 4;
+        constexpr int kLinesPerThread = 5000;
+        std::atomic<int> listened{0};
+        buffer.setListener([&listened](const std::string&, const CapturedLine&)
+                           { listened.fetch_add(1, std::memory_order_relaxed); });
+
+        std::atomic<bool> done{false};
+        std::thread reader(
+            [&]
+            {
+                std::size_t previous = 0;
+                while (!done.load(std::memory_order_acquire))
+                {
+                    std::size_t total = 0;
+                    for (const auto& [_, lines] : buffer.snapshot())
+                    {
+                        total += lines.size();
+                    }
+                    assert(total >= previous);
+                    previous = total;
+                }
+            });
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            writers.emplace_back(
+                [&buffer, t]
+                {
+                    const std::string tool = "tool" + std::to_string(t);
+                    for (int i = 0; i < kLinesPerThread; ++i)
+                    {
+                        buffer.append(tool, "stderr", std::to_string(i));
+                    }
+                });
+        }
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+        done.store(true, std::memory_order_release);
+        reader.join();
+
+        const auto lines = buffer.snapshot();
+        assert(lines.size() == kThreads);
+        for (const auto& [tool, toolLines] : lines)
+        {
+            assert(toolLines.size() == kLinesPerThread);
+            for (std::size_t i = 0; i < toolLines.size(); ++i)
+            {
+                assert(toolLines[i]->message == std::to_string(i));
+            }
+        }
+        assert(listened.load() == kThreads * kLinesPerThread);
+    }
+
+    void testThreadWritingToSeveralBuffers()
+    {
+        // A pool worker alternates between the buffers of concurrent requests.
+        CaptureBuffer first;
+        CaptureBuffer second;
+        for (int i = 0; i < 10; ++i)
+        {
+            first.append("ikos", "stdout", "a" + std::to_string(i));
+            second.append("ikos", "stdout", "b" + std::to_string(i));
+        }
+        assert(first.snapshot().at("ikos").size() == 10);
+        assert(second.snapshot().at("ikos").back()->message == "b9");
+    }
+} // namespace
+
+int main()
+{
+    testSnapshotKeepsAppendOrderPerTool();
+    testConcurrentAppendAndSnapshot();
+    testThreadWritingToSeveralBuffers();
+    std::cout << "capture_buffer_tests: all checks passed" << std::endl;
+    return 0;
+}
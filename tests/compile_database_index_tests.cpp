@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/CompileDatabaseIndex.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    using ctrace::CompileDatabaseIndex;
+    using namespace std::chrono_literals;
+
+    // Index layout offsets pinned by these tests; see CompileDatabaseIndex::Header.
+    constexpr std::size_t kVersionOffset = 8;
+    constexpr std::size_t kHeaderSize = 72;
+
+    std::filesystem::path makeTempDir()
+    {
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ctrace-compdb-index-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    std::string readFile(const std::filesystem::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    ino_t inodeOf(const std::filesystem::path& path)
+    {
+        struct stat info{};
+        const int status = ::stat(path.c_str(), &info);
+        assert(status == 0);
+        return status == 0 ? info.st_ino : 0;
+    }
+
+    /// A two-entry database; write() replaces "a.c" by a name of the same length.
+    struct Database
+    {
+        std::filesystem::path dir;
+        std::filesystem::path path;
+        std::filesystem::path index;
+
+        explicit Database(std::filesystem::path root) : dir(std::move(root))
+        {
+            std::filesystem::create_directories(dir);
+            path = dir / "compile_commands.json";
+            index = path;
+            index += CompileDatabaseIndex::kFileSuffix;
+            write("a.c");
+        }
+
+        void write(const std::string& first) const
+        {
+            writeFile(path, R"([{"directory": ")" + dir.string() + R"(", "file": ")" + first +
+                                R"(", "arguments": ["cc", "-c", "a.c", "-o", "a.o"]},
+                                {"directory": ")" + dir.string() +
+                                R"(", "file": "b.c", "command": "cc -c b.c"}])");
+        }
+
+        /// Same size, same mtime, different content.
+        void rewriteKeepingStamp(const std::string& first) const
+        {
+            const auto mtime = std::filesystem::last_write_time(path);
+            write(first);
+            std::filesystem::last_write_time(path, mtime);
+        }
+
+        void age(std::chrono::minutes by) const
+        {
+            std::filesystem::last_write_time(
+                path, std::filesystem::file_time_type::clock::now() - by);
+        }
+
+        [[nodiscard]] std::string firstFile() const
+        {
+            std::string error;
+            const auto opened = CompileDatabaseIndex::open(path.string(), error);
+            assert(opened && error.empty() && opened->size() == 2);
+            return std::string(opened->file(0));
+        }
+
+        [[nodiscard]] std::string source(const std::string& name) const
+        {
+            return (dir / name).string();
+        }
+    };
+
+    void testParse()
+    {
+        const std::filesystem::path compdb = "/db/compile_commands.json";
+        std::string error;
+        bool selfContained = false;
+        const auto commands = ctrace::parseCompileDatabase(
+            R"([{"directory": "/src", "file": "a.c", "arguments": ["cc", 1, ["x"], "-oa.o"],
+                 "command": "ignored", "extra": {"file": "nested.c", "arguments": []}},
+                {"directory": "/src", "file": "b.c", "command": "cc 'b c.c' -o b.o",
+                 "output": "out/b.o"},
+                {"file": "/abs/c.c", "arguments": "not an array", "command": "cc -c c.c"}])",
+            compdb, error, selfContained);
+        assert(commands && error.empty() && selfContained && commands->size() == 3);
+        assert((*commands)[0].file == "/src/a.c" && (*commands)[0].directory == "/src");
+        assert(((*commands)[0].arguments == std::vector<std::string>{"cc", "-oa.o"}));
+        assert((*commands)[0].output == "/src/a.o");
+        assert(((*commands)[1].arguments == std::vector<std::string>{"cc", "b c.c", "-o", "b.o"}));
+        assert((*commands)[1].output == "/src/out/b.o");
+        assert((*commands)[2].file == "/abs/c.c" && (*commands)[2].directory == "/db");
+        assert((*commands)[2].arguments.size() == 3 && (*commands)[2].output.empty());
+
+        // Items that are not {"file": "..."} objects are skipped, and the database is then
+        // not self-contained; so is one with paths relative to its own location.
+        for (const char* text : {R"([{"file": "/a.c"}, "b.c"])", R"([{"file": "/a.c"}, 3])",
+                                 R"([{"file": "/a.c"}, {"path": "/b.c"}])",
+                                 R"([{"file": "/a.c"}, {"file": 1}])",
+                                 R"([{"file": "/a.c"}, ["/b.c"]])", R"([{"file": "a.c"}])",
+                                 R"([{"directory": "src", "file": "a.c"}])"})
+        {
+            selfContained = true;
+            const auto partial = ctrace::parseCompileDatabase(text, compdb, error, selfContained);
+            assert(partial && partial->size() == 1 && !selfContained);
+        }
+
+        for (const char* text : {R"({"file": "/a.c"})", R"([{"file": "/a.c"},])", ""})
+        {
+            error.clear();
+            assert(!ctrace::parseCompileDatabase(text, compdb, error, selfContained));
+            assert(!error.empty());
+        }
+    }
+
+    void testContents(const std::filesystem::path& dir)
+    {
+        const Database database(dir / "contents");
+        database.age(60min);
+        std::string error;
+        const auto index = CompileDatabaseIndex::open(database.dir.string(), error);
+        assert(index && index->size() == 2 && index->selfContained());
+        assert(index->file(0) == database.source("a.c"));
+        assert(index->directory(0) == database.dir.string());
+        assert(index->output(0) == database.source("a.o"));
+        assert(index->argumentCount(0) == 5 && index->argument(0, 4) == "a.o");
+        assert(index->argumentCount(1) == 3 && index->argument(1, 2) == "b.c");
+        assert(index->output(1).empty() && !index->isDependency(0));
+        assert(std::filesystem::is_regular_file(database.index));
+
+        // Opening again in this process shares the mapping.
+        assert(CompileDatabaseIndex::open(database.path.string(), error) == index);
+    }
+
+    void testStampFastPath(const std::filesystem::path& dir)
+    {
+        const Database database(dir / "fast-path");
+        database.age(60min);
+        assert(database.firstFile() == database.source("a.c"));
+        const std::string built = readFile(database.index);
+
+        // Size and mtime match outside the racy window: the index is trusted as is, without
+        // reading the database.
+        database.rewriteKeepingStamp("x.c");
+        assert(database.firstFile() == database.source("a.c"));
+        assert(readFile(database.index) == built);
+
+        // Any stamp change is noticed.
+        database.age(30min);
+        assert(database.firstFile() == database.source("x.c"));
+    }
+
+    void testRacyWindowChecksContent(const std::filesystem::path& dir)
+    {
+        // Built right after the database was written: a rewrite within the same mtime tick
+        // must not be missed, so the content hash is checked.
+        const Database database(dir / "racy");
+        assert(database.firstFile() == database.source("a.c"));
+        database.rewriteKeepingStamp("x.c");
+        assert(database.firstFile() == database.source("x.c"));
+    }
+
+    void testTouchRefreshesStampInPlace(const std::filesystem::path& dir)
+    {
+        const Database database(dir / "touch");
+        database.age(60min);
+        assert(database.firstFile() == database.source("a.c"));
+        const std::string built = readFile(database.index);
+        const ino_t inode = inodeOf(database.index);
+
+        // Touched without changing: the hash matches and only the stamp is rewritten.
+        database.age(30min);
+        assert(database.firstFile() == database.source("a.c"));
+        const std::string refreshed = readFile(database.index);
+        assert(inodeOf(database.index) == inode);
+        assert(refreshed.size() == built.size() && refreshed != built);
+        assert(refreshed.substr(kHeaderSize) == built.substr(kHeaderSize));
+
+        // The refreshed stamp takes the fast path from now on.
+        database.rewriteKeepingStamp("x.c");
+        assert(database.firstFile() == database.source("a.c"));
+    }
+
+    void testUnwritableIndexFallsBackToMemory(const std::filesystem::path& dir)
+    {
+        // A directory in the way of the index fails the write even when running as root.
+        const Database blocked(dir / "blocked");
+        std::filesystem::create_directories(blocked.index);
+        assert(blocked.firstFile() == blocked.source("a.c"));
+        assert(std::filesystem::is_directory(blocked.index));
+        assert(std::filesystem::is_empty(blocked.index));
+        // No temporary file is left behind.
+        assert(std::distance(std::filesystem::directory_iterator(blocked.dir),
+                             std::filesystem::directory_iterator()) == 2);
+
+        if (::geteuid() != 0)
+        {
+            const Database readOnly(dir / "read-only");
+            std::filesystem::permissions(readOnly.dir, std::filesystem::perms::owner_read |
+                                                           std::filesystem::perms::owner_exec);
+            assert(readOnly.firstFile() == readOnly.source("a.c"));
+            assert(!std::filesystem::exists(readOnly.index));
+            std::filesystem::permissions(readOnly.dir, std::filesystem::perms::owner_all);
+        }
+    }
+
+    void testDamagedIndexIsRebuilt(const std::filesystem::path& dir)
+    {
+        const Database database(dir / "damaged");
+        database.age(60min);
+        assert(database.firstFile() == database.source("a.c"));
+        const std::string built = readFile(database.index);
+        assert(built.size() > kHeaderSize);
+
+        const auto damage = [&](std::string bytes)
+        {
+            writeFile(database.index, bytes);
+            assert(database.firstFile() == database.source("a.c"));
+            const std::string rebuilt = readFile(database.index);
+            assert(rebuilt.size() == built.size());
+            assert(rebuilt.substr(kHeaderSize) == built.substr(kHeaderSize));
+        };
+
+        damage("");
+        damage(built.substr(0, kHeaderSize - 1));
+        damage(built.substr(0, built.size() - 1));
+        damage(built + "x");
+
+        std::string magic = built;
+        magic[0] = 'X';
+        damage(magic);
+
+        std::string version = built;
+        version[kVersionOffset] = static_cast<char>(version[kVersionOffset] + 1);
+        damage(version);
+
+        // A string reference past the end of the string table: the first entry's file offset.
+        std::string reference = built;
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            reference[kHeaderSize + i] = '\xff';
+        }
+        damage(reference);
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = makeTempDir();
+    testParse();
+    testContents(dir);
+    testStampFastPath(dir);
+    testRacyWindowChecksContent(dir);
+    testTouchRefreshesStampInPlace(dir);
+    testUnwritableIndexFallsBackToMemory(dir);
+    testDamagedIndexIsRebuilt(dir);
+    std::filesystem::remove_all(dir);
+    std::cout << "compile_database_index_tests: all checks passed" << std::endl;
+    return 0;
+}
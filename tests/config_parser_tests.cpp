@@ -50,6 +50,7 @@ namespace
   "output": {
     "sarif_format": true,
     "report_file": "cfg-report.txt",
+    "sarif_baseline": "baseline.sarif",
     "output_file": "cfg-output.txt",
     "verbose": false,
     "quiet": true,
@@ -58,13 +59,24 @@ namespace
   "runtime": {
     "async": false,
     "ipc": "standardIO",
-    "ipc_path": "/tmp/coretrace-test-ipc"
+    "ipc_path": "/tmp/coretrace-test-ipc",
+    "result_cache_dir": "cache",
+    "runtime_history": "history/runtimes",
+    "trace_out": "trace.json"
   },
   "server": {
     "host": "127.0.0.1",
     "port": 8081,
     "shutdown_token": "token",
-    "shutdown_timeout_ms": 500
+    "shutdown_timeout_ms": 500,
+    "worker_threads": 3,
+    "max_concurrent_analyses": 2,
+    "max_queued_analyses": 5
+  },
+  "tool_limits": {
+    "default": {"timeout_ms": 60000, "max_rss_mb": 2048},
+    "ikos": {"timeout_ms": 600000, "cpu_seconds": 300},
+    "ctrace_stack_analyzer": {"max_rss_mb": 8192}
   },
   "stack_analyzer": {
     "mode": "ir",
@@ -79,6 +91,7 @@ namespace
     "smt_budget_nodes": 1024,
     "smt_rules": ["stack-buffer"],
     "stack_limit": 4096,
+    "shards": 4,
     "resource_model": "./resource.txt",
     "escape_model": "./escape.txt",
     "buffer_model": "./buffer.txt",
@@ -99,6 +112,8 @@ namespace
         assert(cfg.global.specificTools.front() == "ctrace_stack_analyzer");
         assert(cfg.global.hasSarifFormat);
         assert(cfg.global.report_file == "cfg-report.txt");
+        assert(std::filesystem::path(cfg.global.sarif_baseline) ==
+               path.parent_path() / "baseline.sarif");
         assert(cfg.global.output_file == "cfg-output.txt");
         assert(cfg.global.quiet);
         assert(cfg.global.demangle);
@@ -112,6 +127,21 @@ namespace
         assert(cfg.global.smt_timeout_ms == 80U);
         assert(cfg.global.smt_budget_nodes == 1024U);
         assert(cfg.global.stack_limit == 4096U);
+        assert(cfg.global.stack_analyzer_shards == 4U);
+        assert(std::filesystem::path(cfg.global.result_cache_dir) == path.parent_path() / "cache");
+        assert(std::filesystem::path(cfg.global.runtime_history) ==
+               path.parent_path() / "history/runtimes");
+        assert(std::filesystem::path(cfg.global.trace_out) == path.parent_path() / "trace.json");
+        assert(cfg.global.serverWorkerThreads == 3);
+        assert(cfg.global.serverMaxConcurrentAnalyses == 2);
+        assert(cfg.global.serverMaxQueuedAnalyses == 5);
+        assert(cfg.global.default_tool_limits.timeout_ms == 60000U);
+        assert(cfg.global.default_tool_limits.max_rss_mb == 2048U);
+        assert(cfg.global.tool_limits.at("ikos").timeout_ms == 600000U);
+        assert(cfg.global.tool_limits.at("ikos").max_rss_mb == 2048U);
+        assert(cfg.global.tool_limits.at("ikos").cpu_seconds == 300U);
+        assert(cfg.global.tool_limits.at("ctrace_stack_analyzer").max_rss_mb == 8192U);
+        assert(cfg.global.tool_limits.at("ctrace_stack_analyzer").timeout_ms == 60000U);
         assert(cfg.global.stack_analyzer_extra_args.size() == 2);
         assert(!cfg.files.empty());
     }
@@ -152,6 +182,25 @@ namespace
         assert(err.find("smt_mode") != std::string::npos);
     }
 
+    void testRejectsInvalidStackAnalyzerShards()
+    {
+        const auto path = makeTempConfigPath("invalid-shards.json");
+        writeTextFile(path, R"json(
+{
+  "schema_version": 1,
+  "stack_analyzer": {
+    "shards": 100000
+  }
+}
+)json");
+
+        ctrace::ProgramConfig cfg;
+        std::string err;
+        const bool ok = ctrace::applyToolConfigFile(cfg, path.string(), err);
+        assert(!ok);
+        assert(err.find("shards") != std::string::npos);
+    }
+
     void testLegacyConfigCompatibility()
     {
         const auto path = makeTempConfigPath("legacy.json");
@@ -219,6 +268,7 @@ int main()
     testCanonicalConfigParsing();
     testRejectsUnknownRootKey();
     testRejectsInvalidStackAnalyzerMode();
+    testRejectsInvalidStackAnalyzerShards();
     testLegacyConfigCompatibility();
     testCliOverridesConfig();
     std::cout << "config_parser_tests: all checks passed" << std::endl;
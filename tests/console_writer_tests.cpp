@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/ConsoleWriter.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using ctrace::Thread::Output::ConsoleWriter;
+
+    /// Redirects std::cout and std::cerr into one buffer for the lifetime of the object.
+    class CapturedConsole
+    {
+      public:
+        CapturedConsole()
+            : out_(std::cout.rdbuf(captured_.rdbuf())), err_(std::cerr.rdbuf(captured_.rdbuf()))
+        {
+        }
+
+        ~CapturedConsole()
+        {
+            std::cout.rdbuf(out_);
+            std::cerr.rdbuf(err_);
+        }
+
+        std::vector<std::string> lines() const
+        {
+            std::vector<std::string> result;
+            std::istringstream input(captured_.str());
+            for (std::string line; std::getline(input, line);)
+            {
+                result.push_back(line);
+            }
+            return result;
+        }
+
+      private:
+        std::ostringstream captured_;
+        std::streambuf* out_;
+        std::streambuf* err_;
+    };
+
+    void testFlushWritesEverythingQueued()
+    {
+        CapturedConsole console;
+        auto& writer = ConsoleWriter::instance();
+        writer.write(ConsoleWriter::Target::Stdout, "first");
+        writer.write(ConsoleWriter::Target::Stderr, "second");
+        writer.write(ConsoleWriter::Target::Stdout, "third");
+        writer.flush();
+
+        const auto lines = console.lines();
+        assert((lines == std::vector<std::string>{"first", "second", "third"}));
+    }
+
+    void testPerThreadOrderUnderContention()
+    {
+        constexpr int kThreads = 4;
+        // More lines than ring slots, so producers also go through the full-ring path.
+        constexpr int kLinesPerThread = 5000;
+
+        CapturedConsole console;
+        std::vector<std::thread> producers;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            producers.emplace_back(
+                [t]
+                {
+                    for (int i = 0; i < kLinesPerThread; ++i)
+                    {
+                        ConsoleWriter::instance().write(t % 2 == 0 ? ConsoleWriter::Target::Stdout
+                                                                   : ConsoleWriter::Target::Stderr,
+                                                        std::to_string(t) + ":" +
+                                                            std::to_string(i));
+                    }
+                });
+        }
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+        ConsoleWriter::instance().flush();
+
+        const auto lines = console.lines();
+        assert(lines.size() == static_cast<std::size_t>(kThreads * kLinesPerThread));
+        std::vector<int> next(kThreads, 0);
+        for (const auto& line : lines)
+        {
+            const auto colon = line.find(':');
+            const int thread = std::stoi(line.substr(0, colon));
+            assert(std::stoi(line.substr(colon + 1)) == next[thread]);
+            ++next[thread];
+        }
+    }
+} // namespace
+
+int main()
+{
+    testFlushWritesEverythingQueued();
+    testPerThreadOrderUnderContention();
+    std::cout << "console_writer_tests: all checks passed" << std::endl;
+    return 0;
+}
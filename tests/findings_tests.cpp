@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/Findings.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    using ctrace::Finding;
+    using ctrace::FindingIndex;
+    namespace findings = ctrace::findings;
+
+    Finding makeFinding(std::string file, std::uint64_t line, std::string rule,
+                        std::string_view message, std::uint32_t cwe = 0)
+    {
+        Finding finding;
+        finding.file = std::move(file);
+        finding.line = line;
+        finding.rule = std::move(rule);
+        finding.message_hash = findings::hash(findings::normalizeMessage(message));
+        finding.cwe = cwe;
+        return finding;
+    }
+
+    void testNormalization()
+    {
+        constexpr std::string_view base = "/work/project";
+        assert(findings::normalizePath("file:///work/project/src/./a.c", base) == "src/a.c");
+        assert(findings::normalizePath("/work/project/src/../b.c", base) == "b.c");
+        assert(findings::normalizePath("/elsewhere/c.c", base) == "/elsewhere/c.c");
+        assert(findings::normalizePath("src\\win\\d.c", base) == "src/win/d.c");
+        assert(findings::normalizePath("a/../../b//c/.", base) == "../b/c");
+        assert(findings::normalizePath("/../x.c", "/") == "x.c");
+        assert(findings::normalizePath("./", base) == ".");
+        assert(findings::normalizePath("/work/project", base) == "/work/project");
+        assert(findings::normalizePath("/work/projectile/a.c", base) == "/work/projectile/a.c");
+        assert(findings::normalizePath("", base).empty());
+
+        assert(findings::normalizeMessage("  Buffer of 16 bytes\n  overflows  ") ==
+               "buffer of # bytes overflows");
+        assert(findings::normalizeMessage("Index 3 out of 12") ==
+               findings::normalizeMessage("index 7 out of 4096"));
+        assert(findings::normalizeMessage("#1 2  x") == "# # x");
+        assert(findings::messageHash(" Buffer  of 16 ") == findings::hash("buffer of #"));
+
+        assert(findings::extractCwe("Does not check for buffer overflows (CWE-120).") == 120);
+        assert(findings::extractCwe("external/cwe/cwe-476") == 476);
+        assert(findings::extractCwe(R"({"cwe": 787})") == 787);
+        assert(findings::extractCwe("CWE_190") == 190);
+        assert(findings::extractCwe("cwe") == 0);
+        assert(findings::extractCwe("no weakness here") == 0);
+
+        assert(findings::ruleCategory("nullPointer") == findings::ruleCategory("tsc.null_pointer"));
+        assert(findings::ruleCategory("nullPointer") != findings::ruleCategory("uninitvar"));
+        assert(findings::ruleCategory("coretrace.Warning") == 0);
+        assert(findings::ruleCategory("STYLE") == 0 && findings::ruleCategory("a.-") == 0);
+        assert(findings::ruleCategory("warnings") == findings::hash("warnings"));
+    }
+
+    void testFingerprints()
+    {
+        const Finding finding = makeFinding("src/a.c", 10, "nullPointer", "p is null");
+        Finding moved = finding;
+        moved.line = 42;
+        moved.column = 3;
+        moved.message_hash = findings::hash(findings::normalizeMessage("P  is NULL"));
+        assert(findings::fingerprint(finding) == findings::fingerprint(moved));
+
+        assert(findings::fingerprint(finding) !=
+               findings::fingerprint(makeFinding("src/b.c", 10, "nullPointer", "p is null")));
+        assert(findings::fingerprint(finding) !=
+               findings::fingerprint(makeFinding("src/a.c", 10, "uninitvar", "p is null")));
+
+        // Baselines written by earlier releases depend on this exact value.
+        assert(findings::toHex(findings::fingerprint(finding)) == "48529027da83d94c");
+        assert(findings::toHex(0x1f) == "000000000000001f");
+    }
+
+    void testIndexMerging()
+    {
+        FindingIndex index;
+        const auto add = [&index](const Finding& finding, std::uint32_t source)
+        { return index.add(FindingIndex::keyOf(finding, source)); };
+
+        // Three tools on one line: they join through the rule category or the CWE.
+        const std::size_t group = add(makeFinding("a.c", 10, "nullPointer", "p is null", 476), 1);
+        assert(add(makeFinding("a.c", 10, "tsc.null_pointer", "null deref"), 0) == group);
+        assert(add(makeFinding("a.c", 10, "NullDeref", "null pointer", 476), 2) == group);
+        assert(index.sources(group).size() == 3);
+
+        // Without a CWE, a severity is no category: the finding stays apart.
+        const std::size_t generic = add(makeFinding("a.c", 10, "coretrace.Warning", "p?"), 4);
+        assert(generic != group);
+        assert(add(makeFinding("a.c", 10, "coretrace.Warning", "p?"), 4) == generic);
+
+        // One tool's distinct diagnostics on one line stay apart; exact copies merge.
+        const std::size_t other = add(makeFinding("a.c", 10, "tsc.null_pointer", "leak"), 0);
+        assert(other != group);
+        assert(add(makeFinding("a.c", 10, "tsc.null_pointer", "null deref"), 0) == group);
+
+        // A different CWE is another problem. A CWE-less group only takes findings of its
+        // category, whatever their CWE.
+        const std::size_t overflow = add(makeFinding("a.c", 10, "strcpy", "overflow", 120), 3);
+        assert(overflow != group && overflow != other && overflow != generic);
+        assert(add(makeFinding("a.c", 10, "FF.strcpy", "strcpy copy"), 5) == overflow);
+        assert(add(makeFinding("a.c", 10, "leak", "lost", 401), 1) != other);
+
+        // Other lines and files, and findings without a line, do not merge.
+        assert(add(makeFinding("a.c", 11, "nullPointer", "p is null", 476), 1) != group);
+        assert(add(makeFinding("b.c", 10, "nullPointer", "p is null", 476), 1) != group);
+        const std::size_t unlocated = add(makeFinding("a.c", 0, "r", "m"), 0);
+        assert(add(makeFinding("a.c", 0, "s", "m"), 1) != unlocated);
+        assert(add(makeFinding("a.c", 0, "r", "m"), 1) == unlocated);
+        assert(index.groupCount() == 9);
+    }
+
+    void testIndexScales()
+    {
+        // Two tools reporting the same 50k findings: the hashed buckets keep this linear.
+        constexpr std::uint64_t kFindings = 50000;
+        FindingIndex index;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::uint32_t source = 0; source < 2; ++source)
+        {
+            for (std::uint64_t i = 0; i < kFindings; ++i)
+            {
+                const Finding finding =
+                    makeFinding("src/file" + std::to_string(i % 500) + ".c", i / 500 + 1,
+                                source == 0 ? "nullPointer" : "tsc.NullPointer", "message");
+                (void)index.add(FindingIndex::keyOf(finding, source));
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        assert(index.groupCount() == kFindings);
+        assert(elapsed < std::chrono::seconds(5));
+    }
+} // namespace
+
+int main()
+{
+    testNormalization();
+    testFingerprints();
+    testIndexMerging();
+    testIndexScales();
+    std::cout << "findings_tests: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/Incremental.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+    using ctrace::ProgramConfig;
+
+    std::filesystem::path makeTempDir()
+    {
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ctrace-incremental-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    /**
+     * @brief a.c includes a.h and b.c includes b.h, both with depfiles; c.c was never built.
+     */
+    struct Project
+    {
+        std::filesystem::path dir;
+        std::vector<std::string> sources;
+        ProgramConfig config;
+
+        explicit Project(std::filesystem::path root) : dir(std::move(root))
+        {
+            std::string entries;
+            for (const char* name : {"a", "b", "c"})
+            {
+                const std::string stem(name);
+                writeFile(dir / (stem + ".c"), "#include \"" + stem + ".h\"\n");
+                writeFile(dir / (stem + ".h"), "\n");
+                sources.push_back(path(stem + ".c"));
+                if (stem != "c")
+                {
+                    writeFile(dir / (stem + ".d"), stem + ".o: " + path(stem + ".c") + " " +
+                                                       path(stem + ".h") + "\n");
+                }
+                entries += std::string(entries.empty() ? "" : ",") + "{\"directory\": \"" +
+                           dir.string() + "\", \"file\": \"" + stem +
+                           ".c\", \"arguments\": [\"cc\", \"-MD\", \"-MF\", \"" + stem +
+                           ".d\", \"-c\", \"" + stem + ".c\"]}";
+            }
+            writeFile(dir / "compile_commands.json", "[" + entries + "]");
+            config.global.compile_commands = path("compile_commands.json");
+        }
+
+        [[nodiscard]] std::string path(const std::string& name) const
+        {
+            return (dir / name).string();
+        }
+
+        [[nodiscard]] std::vector<std::string> select(const std::vector<std::string>& changed)
+        {
+            std::vector<std::string> absolute;
+            for (const auto& name : changed)
+            {
+                absolute.push_back(path(name));
+            }
+            return ctrace::selectAffectedSources(config, sources, absolute);
+        }
+    };
+
+    void testSelection(const std::filesystem::path& dir)
+    {
+        Project project(dir);
+        const auto a = project.path("a.c");
+        const auto b = project.path("b.c");
+        const auto c = project.path("c.c");
+
+        assert(project.select({}).empty());
+        assert(project.select({"README.md"}).empty());
+        assert(project.select({"a.c"}) == std::vector<std::string>{a});
+        assert((project.select({"c.c", "a.c"}) == std::vector<std::string>{a, c}));
+
+        // A header reaches the files whose depfile lists it, and every file without one.
+        assert((project.select({"a.h"}) == std::vector<std::string>{a, c}));
+        assert((project.select({"b.h"}) == std::vector<std::string>{b, c}));
+        assert(project.select({"unused.h"}) == std::vector<std::string>{c});
+
+        // Without a compile database no include is known.
+        project.config.global.compile_commands.clear();
+        assert((project.select({"a.h"}) == std::vector<std::string>{a, b, c}));
+        assert(project.select({"b.c"}) == std::vector<std::string>{b});
+    }
+
+    void testChangedFilesList(const std::filesystem::path& dir)
+    {
+        ProgramConfig config;
+        assert(!ctrace::isIncrementalRun(config));
+
+        const auto list = dir / "changed.txt";
+        writeFile(list, (dir / "x.c").string() + "\r\n\n" + (dir / "y.h").string() + "\n");
+        config.global.changed_files = {"@" + list.string(), (dir / "sub/../z.c").string()};
+        assert(ctrace::isIncrementalRun(config));
+
+        std::string error;
+        const auto paths = ctrace::collectChangedPaths(config, error);
+        assert(paths.has_value() && error.empty());
+        const std::vector<std::string> expected = {
+            (dir / "x.c").string(), (dir / "y.h").string(), (dir / "z.c").string()};
+        assert(*paths == expected);
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = makeTempDir();
+    testSelection(dir);
+    testChangedFilesList(dir);
+    std::filesystem::remove_all(dir);
+    std::cout << "incremental_tests: all checks passed" << std::endl;
+    return 0;
+}
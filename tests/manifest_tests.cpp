@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "App/Files.hpp"
+#include "App/Manifest.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    using ctrace::ManifestContents;
+    using ctrace::ManifestEntry;
+    using ctrace::ProgramConfig;
+
+    std::filesystem::path makeTempDir()
+    {
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ctrace-manifest-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    ManifestEntry entry(std::string candidate, std::optional<std::string> directory = {})
+    {
+        ManifestEntry out;
+        out.candidate = std::move(candidate);
+        out.directory = std::move(directory);
+        return out;
+    }
+
+    bool parses(const std::string& text)
+    {
+        ManifestContents contents;
+        return ctrace::parseManifest(text, contents);
+    }
+
+    /// Sources listed by the manifest @p text, written as @p dir / @p name.
+    std::vector<std::string> resolve(const std::filesystem::path& dir, const std::string& name,
+                                     const std::string& text)
+    {
+        const auto path = dir / name;
+        writeFile(path, text);
+        ProgramConfig config;
+        config.files.emplace_back(path.string());
+        return ctrace::resolveSourceFiles(config);
+    }
+
+    std::vector<std::string> paths(const std::filesystem::path& dir,
+                                   const std::vector<std::string>& names)
+    {
+        std::vector<std::string> out;
+        for (const auto& name : names)
+        {
+            out.push_back((dir / name).lexically_normal().string());
+        }
+        return out;
+    }
+
+    void testShapes()
+    {
+        ManifestContents root;
+        assert(ctrace::parseManifest(
+            R"([ "a.c", {"file": "b.c", "directory": "d"}, {"src_file": "c.c"},
+                 {"path": "e.c"}, {"arguments": ["x.c"]}, 3, null, ["f.c"] ])",
+            root));
+        assert(root.rootArray && root.rootArray->size() == 4);
+        assert((*root.rootArray)[0].candidate == "a.c" && !(*root.rootArray)[0].directory);
+        assert((*root.rootArray)[1].candidate == "b.c" && (*root.rootArray)[1].directory == "d");
+        assert((*root.rootArray)[2].candidate == "c.c");
+        assert((*root.rootArray)[3].candidate == "e.c");
+
+        ManifestContents object;
+        assert(ctrace::parseManifest(R"({"files": ["a.c"], "sources": [{"path": "b.c"}],
+            "compile_commands": [], "file": "c.c", "src_file": "d.c", "path": "e.c",
+            "other": {"files": ["nested.c"], "file": "nested.c"}})",
+                                     object));
+        assert(!object.rootArray);
+        assert(object.files && object.files->size() == 1);
+        assert(object.sources && object.sources->front().candidate == "b.c");
+        assert(object.compileCommands && object.compileCommands->empty());
+        assert(object.rootFile == "c.c" && object.rootSrcFile == "d.c" && object.rootPath == "e.c");
+
+        // A repeated key replaces the earlier value, like a DOM parser would.
+        ManifestContents repeated;
+        assert(ctrace::parseManifest(R"({"files": ["a.c"], "files": ["b.c", "c.c"]})",
+                                     repeated));
+        assert(repeated.files->size() == 2 && repeated.files->front().candidate == "b.c");
+    }
+
+    void testPrecedence(const std::filesystem::path& dir)
+    {
+        // Root shapes: root array, then files, sources, compile_commands, file, src_file, path.
+        assert(resolve(dir, "array.json", R"(["a.c"])") == paths(dir, {"a.c"}));
+        assert(resolve(dir, "files.json",
+                       R"({"path": "p.c", "compile_commands": [{"file": "c.c"}],
+                           "sources": ["s.c"], "files": ["f.c"]})") == paths(dir, {"f.c"}));
+        assert(resolve(dir, "sources.json",
+                       R"({"file": "r.c", "compile_commands": [{"file": "c.c"}],
+                           "sources": ["s.c"]})") == paths(dir, {"s.c"}));
+        assert(resolve(dir, "compdb.json", R"({"file": "r.c", "compile_commands": ["c.c"]})") ==
+               paths(dir, {"c.c"}));
+        assert(resolve(dir, "file.json", R"({"path": "p.c", "src_file": "s.c", "file": "f.c"})") ==
+               paths(dir, {"f.c"}));
+        assert(resolve(dir, "src_file.json", R"({"path": "p.c", "src_file": "s.c"})") ==
+               paths(dir, {"s.c"}));
+        assert(resolve(dir, "path.json", R"({"path": "p.c"})") == paths(dir, {"p.c"}));
+
+        // Item fields: file (with its directory), then src_file, then path.
+        assert(resolve(dir, "items.json",
+                       R"([{"path": "p.c", "src_file": "s.c", "file": "f.c", "directory": "d"},
+                           {"path": "p.c", "src_file": "s.c", "directory": "d"},
+                           {"path": "p.c"}, {"file": "/abs/x.c", "directory": "d"},
+                           {"file": "y.c", "directory": "/abs"}, "./q/../q.c", "a.c", ""])") ==
+               std::vector<std::string>({(dir / "d/f.c").string(), (dir / "s.c").string(),
+                                         (dir / "p.c").string(), "/abs/x.c", "/abs/y.c",
+                                         (dir / "q.c").string(), (dir / "a.c").string()}));
+
+        // Manifests listing nothing, and invalid ones, add nothing; other inputs pass through.
+        ProgramConfig config;
+        writeFile(dir / "empty.json", R"({"unrelated": 1})");
+        writeFile(dir / "broken.json", R"(["a.c",])");
+        config.files.emplace_back((dir / "empty.json").string());
+        config.files.emplace_back((dir / "broken.json").string());
+        config.files.emplace_back(std::string("plain.c"));
+        config.files.emplace_back(std::string("plain.c"));
+        assert(ctrace::resolveSourceFiles(config) == std::vector<std::string>({"plain.c"}));
+    }
+
+    void testDependencyFiltering(const std::filesystem::path& dir)
+    {
+        // A relative directory keeps the database out of the binary index: this exercises the
+        // manifest path. The absolute one is listed from the index.
+        for (const std::string& directory : {std::string("."), dir.string()})
+        {
+            const auto project = dir / ("deps-" + std::to_string(directory.size()));
+            std::filesystem::create_directories(project);
+            writeFile(project / "compile_commands.json",
+                      R"([{"directory": ")" + directory + R"(", "file": "src/a.c"},
+                          {"directory": ")" + directory + R"(", "file": "build/_deps/z/z.c"},
+                          {"directory": ")" + directory + R"(", "file": "src/_depsfile.c"}])");
+            const auto base = directory == "." ? project : dir;
+
+            ProgramConfig config;
+            config.global.compile_commands = project.string();
+            assert(ctrace::resolveSourceFiles(config) ==
+                   paths(base, {"src/a.c", "src/_depsfile.c"}));
+
+            config.global.include_compdb_deps = true;
+            assert(ctrace::resolveSourceFiles(config) ==
+                   paths(base, {"src/a.c", "build/_deps/z/z.c", "src/_depsfile.c"}));
+
+            // Explicitly listed databases are never filtered.
+            ProgramConfig explicitList;
+            explicitList.files.emplace_back((project / "compile_commands.json").string());
+            assert(ctrace::resolveSourceFiles(explicitList).size() == 3);
+        }
+
+        const std::vector<ManifestEntry> entries{entry("x/_deps/a.c"), entry("a.c", "_deps"),
+                                                 entry("b.c")};
+        assert(ctrace::resolveManifestEntries(entries, "/m", true) ==
+               std::vector<std::string>({"", "", "/m/b.c"}));
+        assert(ctrace::resolveManifestEntries(entries, "/m", false) ==
+               std::vector<std::string>({"/m/x/_deps/a.c", "/m/_deps/a.c", "/m/b.c"}));
+    }
+
+    void testInvalidJson()
+    {
+        for (const char* text :
+             {"", "   ", "[", "]", "[\"a.c\",]", "[\"a.c\" \"b.c\"]", "{\"files\" [\"a.c\"]}",
+              "{\"files\": [\"a.c\"],}", "{files: []}", "['a.c']", "[\"a.c\"] x", "[] []",
+              "[\"unterminated]", "[\"tab\there\"]", "[\"bad \\x escape\"]", "[\"\\u12G4\"]",
+              "[tru]", "[nul]", "[01]", "[1.]", "[-]", "[1e]", "{\"a\": 1 \"b\": 2}",
+              "{\"a\"}", "[\"a.c\"]]", "\xEF\xBB"})
+        {
+            assert(!parses(text));
+        }
+        // Skipped strings are validated too.
+        assert(!parses(R"({"arguments": ["bad \q"]})"));
+        assert(!parses("{\"arguments\": [\"raw\nnewline\"]}"));
+
+        for (const char* text : {"[]", "{}", " [ ] ", "[true, false, null, -0, 1.5e-3, 2E+8]",
+                                 "\"a.c\"", "42", "{\"a\": {\"b\": [{}, []]}}"})
+        {
+            assert(parses(text));
+        }
+    }
+
+    void testEncoding()
+    {
+        ManifestContents bom;
+        assert(ctrace::parseManifest("\xEF\xBB\xBF[\"a.c\"]", bom));
+        assert(bom.rootArray && bom.rootArray->front().candidate == "a.c");
+        assert(!parses("[\"a.c\"]\xEF\xBB\xBF"));
+
+        ManifestContents escapes;
+        assert(ctrace::parseManifest(
+            R"(["\ud83d\ude00.c", "\u00e9\u4e2d/\"q\"\\\/\b\f\n\r\t", "\u0041"])", escapes));
+        assert((*escapes.rootArray)[0].candidate == "\xF0\x9F\x98\x80.c");
+        assert((*escapes.rootArray)[1].candidate == "\xC3\xA9\xE4\xB8\xAD/\"q\"\\/\b\f\n\r\t");
+        assert((*escapes.rootArray)[2].candidate == "A");
+
+        // Unpaired or misordered surrogates, decoded or skipped.
+        assert(!parses(R"(["\ud83d"])"));
+        assert(!parses(R"(["\ud83d.c"])"));
+        assert(!parses(R"(["\ud83d\u0041"])"));
+        assert(!parses(R"(["\ude00\ud83d"])"));
+        assert(!parses(R"({"files": ["a.c"], "\ude00": 1})"));
+    }
+
+    void testDeepNesting()
+    {
+        // The parser keeps its own stack: nesting depth is bounded by memory, not recursion.
+        constexpr std::size_t kDepth = 500000;
+        const std::string nested =
+            "{\"files\": [\"a.c\"], \"x\": " + std::string(kDepth, '[') + std::string(kDepth, ']') +
+            "}";
+        ManifestContents contents;
+        assert(ctrace::parseManifest(nested, contents));
+        assert(contents.files && contents.files->size() == 1);
+
+        std::string objects;
+        for (std::size_t i = 0; i < kDepth; ++i)
+        {
+            objects += "{\"a\":";
+        }
+        objects += "1" + std::string(kDepth, '}');
+        assert(parses(objects));
+
+        assert(!parses(std::string(kDepth, '[') + std::string(kDepth - 1, ']')));
+        assert(!parses(std::string(kDepth, '[') + std::string(kDepth, '}')));
+    }
+
+    void testParallelMatchesSerial()
+    {
+        std::vector<ManifestEntry> entries;
+        const std::size_t count = 4 * ctrace::kMinManifestEntriesPerWorker + 17;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const std::string n = std::to_string(i);
+            switch (i % 5)
+            {
+            case 0:
+                entries.push_back(entry("src/./f" + n + ".c"));
+                break;
+            case 1:
+                entries.push_back(entry("../f" + n + ".c", "build/sub"));
+                break;
+            case 2:
+                entries.push_back(entry("/abs/_deps/f" + n + ".c"));
+                break;
+            case 3:
+                entries.push_back(entry("f" + n + ".c", "/other//dir"));
+                break;
+            default:
+                entries.push_back(entry(""));
+                break;
+            }
+        }
+
+        for (const bool skipDependencies : {false, true})
+        {
+            const auto serial = ctrace::resolveManifestEntries(entries, "/m", skipDependencies, 1);
+            assert(serial.size() == count);
+            assert(serial[0] == "/m/src/f0.c" && serial[1] == "/m/build/f1.c");
+            assert(serial[2].empty() == skipDependencies);
+            assert(serial[3] == "/other/dir/f3.c" && serial[4].empty());
+            for (const std::size_t workers : {2, 3, 4, 8})
+            {
+                assert(ctrace::resolveManifestEntries(entries, "/m", skipDependencies,
+                                                      workers) == serial);
+            }
+            assert(ctrace::resolveManifestEntries(entries, "/m", skipDependencies) == serial);
+        }
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = makeTempDir();
+    testShapes();
+    testPrecedence(dir);
+    testDependencyFiltering(dir);
+    testInvalidJson();
+    testEncoding();
+    testDeepNesting();
+    testParallelMatchesSerial();
+    std::filesystem::remove_all(dir);
+    std::cout << "manifest_tests: all checks passed" << std::endl;
+    return 0;
+}
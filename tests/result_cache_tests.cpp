@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/ResultCache.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+    using ctrace::ProgramConfig;
+    using ctrace::ResultCache;
+
+    class FakeTool : public ctrace::IAnalysisTool
+    {
+      public:
+        FakeTool(std::string name, std::string version)
+            : m_name(std::move(name)), m_version(std::move(version))
+        {
+        }
+
+        void execute(const std::string&, ctrace::ProgramConfig) const override {}
+
+        std::string name() const override
+        {
+            return m_name;
+        }
+
+        [[nodiscard]] std::string version() const override
+        {
+            return m_version;
+        }
+
+        void setIpcStrategy(std::shared_ptr<IpcStrategy>) override {}
+
+      private:
+        std::string m_name;
+        std::string m_version;
+    };
+
+    std::filesystem::path makeTempDir()
+    {
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ctrace-result-cache-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    /// A project of one source including one header, built once with -MD.
+    struct Project
+    {
+        std::filesystem::path dir;
+        std::string source;
+        std::string header;
+        std::string depfile;
+        std::string database;
+
+        explicit Project(std::filesystem::path root) : dir(std::move(root))
+        {
+            std::filesystem::create_directories(dir);
+            source = (dir / "a.c").string();
+            header = (dir / "a.h").string();
+            depfile = (dir / "a.d").string();
+            database = (dir / "compile_commands.json").string();
+            writeFile(source, "#include \"a.h\"\nint main(void) { return A; }\n");
+            writeFile(header, "#define A 0\n");
+            writeFile(depfile, "a.o: " + source + " \\\n " + header + "\n");
+            writeFlags("");
+        }
+
+        void writeFlags(const std::string& extra) const
+        {
+            writeFile(database, "[{\"directory\": \"" + dir.string() +
+                                    "\", \"file\": \"a.c\", \"arguments\": [\"cc\"" + extra +
+                                    ", \"-MD\", \"-MF\", \"a.d\", \"-c\", \"a.c\", \"-o\", "
+                                    "\"a.o\"]}]");
+        }
+
+        [[nodiscard]] ProgramConfig config() const
+        {
+            ProgramConfig config;
+            config.global.compile_commands = database;
+            config.global.hasSarifFormat = true;
+            return config;
+        }
+    };
+
+    /// Keys are computed by a fresh cache each time: digests are memoized per instance.
+    std::string keyOf(const ProgramConfig& config, const FakeTool& tool, const std::string& file,
+                      const std::filesystem::path& cacheDir)
+    {
+        const ResultCache cache(cacheDir.string(), config);
+        return cache.key(tool, {file});
+    }
+
+    void testKeyInvalidation(const std::filesystem::path& dir)
+    {
+        const Project project(dir / "project");
+        const auto cacheDir = dir / "cache";
+        const FakeTool tool("cppcheck", "1");
+
+        const std::string original = keyOf(project.config(), tool, project.source, cacheDir);
+        assert(original.size() == 32);
+        assert(keyOf(project.config(), tool, project.source, cacheDir) == original);
+
+        // Source edit.
+        writeFile(project.source, "#include \"a.h\"\nint main(void) { return A + 1; }\n");
+        const std::string sourceEdited = keyOf(project.config(), tool, project.source, cacheDir);
+        assert(!sourceEdited.empty() && sourceEdited != original);
+
+        // Header edit, found through the depfile.
+        writeFile(project.header, "#define A 1\n");
+        const std::string headerEdited = keyOf(project.config(), tool, project.source, cacheDir);
+        assert(!headerEdited.empty() && headerEdited != sourceEdited);
+
+        // Changed flags.
+        project.writeFlags(", \"-DNDEBUG\"");
+        const std::string flagsChanged = keyOf(project.config(), tool, project.source, cacheDir);
+        assert(!flagsChanged.empty() && flagsChanged != headerEdited);
+
+        // Tool version bump; unversioned tools are never cached.
+        const std::string bumped =
+            keyOf(project.config(), FakeTool("cppcheck", "2"), project.source, cacheDir);
+        assert(!bumped.empty() && bumped != flagsChanged);
+        assert(keyOf(project.config(), FakeTool("cppcheck", ""), project.source, cacheDir)
+                   .empty());
+
+        // Settings every tool reads.
+        ProgramConfig demangled = project.config();
+        demangled.global.demangle = !demangled.global.demangle;
+        assert(keyOf(demangled, tool, project.source, cacheDir) != flagsChanged);
+    }
+
+    void testNoDepfileIsUncacheable(const std::filesystem::path& dir)
+    {
+        const Project project(dir / "no-depfile");
+        const auto cacheDir = dir / "cache";
+        const FakeTool tool("cppcheck", "1");
+        assert(!keyOf(project.config(), tool, project.source, cacheDir).empty());
+
+        // Without the depfile a header edit could not change the key.
+        std::filesystem::remove(project.depfile);
+        assert(keyOf(project.config(), tool, project.source, cacheDir).empty());
+        writeFile(project.header, "#define A 2\n");
+        assert(keyOf(project.config(), tool, project.source, cacheDir).empty());
+
+        // Same without a compile database, as with plain --input runs.
+        ProgramConfig noDatabase = project.config();
+        noDatabase.global.compile_commands.clear();
+        assert(keyOf(noDatabase, tool, project.source, cacheDir).empty());
+    }
+
+    void testReportFileWritersAreUncacheable(const std::filesystem::path& dir)
+    {
+        const Project project(dir / "report-file");
+        const auto cacheDir = dir / "cache";
+
+        // With a merged SARIF report the invoker owns report_file: every tool is cacheable.
+        for (const char* name : {"ikos", "ctrace_stack_analyzer", "cppcheck"})
+        {
+            assert(!keyOf(project.config(), FakeTool(name, "1"), project.source, cacheDir)
+                        .empty());
+        }
+
+        // Without SARIF, IKOS and the stack analyzer write report_file themselves.
+        ProgramConfig text = project.config();
+        text.global.hasSarifFormat = false;
+        assert(keyOf(text, FakeTool("ikos", "1"), project.source, cacheDir).empty());
+        assert(
+            keyOf(text, FakeTool("ctrace_stack_analyzer", "1"), project.source, cacheDir).empty());
+        assert(!keyOf(text, FakeTool("cppcheck", "1"), project.source, cacheDir).empty());
+        text.global.report_file.clear();
+        assert(!keyOf(text, FakeTool("ikos", "1"), project.source, cacheDir).empty());
+
+        ProgramConfig dumpIr = project.config();
+        dumpIr.global.stack_analyzer_dump_ir = (dir / "ir").string();
+        assert(keyOf(dumpIr, FakeTool("ctrace_stack_analyzer", "1"), project.source, cacheDir)
+                   .empty());
+        assert(!keyOf(dumpIr, FakeTool("ikos", "1"), project.source, cacheDir).empty());
+    }
+
+    void testStoreAndLoad(const std::filesystem::path& dir)
+    {
+        const Project project(dir / "store");
+        const ResultCache cache((dir / "cache").string(), project.config());
+        const std::string key = cache.key(FakeTool("cppcheck", "1"), {project.source});
+        assert(!key.empty());
+        assert(!cache.load(key).has_value());
+
+        ctrace::CachedToolResult result;
+        result.lines.push_back({"stdout", "a.c:1: warning", true});
+        result.summary.warning = 1;
+        result.report.driver = "cppcheck";
+        result.report.results.push_back(R"({"ruleId":"x"})");
+        cache.store(key, result);
+
+        const auto loaded = cache.load(key);
+        assert(loaded.has_value());
+        assert(loaded->lines.size() == 1 && loaded->lines.front().message == "a.c:1: warning");
+        assert(loaded->summary.warning == 1);
+        assert(loaded->report.driver == "cppcheck");
+        assert(loaded->report.results == result.report.results);
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = makeTempDir();
+    testKeyInvalidation(dir);
+    testNoDepfileIsUncacheable(dir);
+    testReportFileWritersAreUncacheable(dir);
+    testStoreAndLoad(dir);
+    std::filesystem::remove_all(dir);
+    std::cout << "result_cache_tests: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/RuntimeHistory.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+    using ctrace::RuntimeHistory;
+    using ctrace::RuntimeSample;
+
+    std::filesystem::path makeTempDir()
+    {
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ctrace-runtime-history-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    std::string writeSource(const std::filesystem::path& dir, const std::string& name,
+                            std::size_t bytes)
+    {
+        const auto path = dir / name;
+        std::ofstream(path) << std::string(bytes, 'x');
+        return path.string();
+    }
+
+    void testEstimatesFromSizeThenHistory(const std::filesystem::path& dir)
+    {
+        const auto small = writeSource(dir, "small.c", 100);
+        const auto large = writeSource(dir, "large.c", 10000);
+        RuntimeHistory history(dir / "estimates");
+
+        // No history: estimates follow file sizes.
+        assert(history.estimate("cppcheck", large) > history.estimate("cppcheck", small));
+
+        // A recorded time wins over the size.
+        history.record("cppcheck", small, RuntimeSample{500.0, 2048});
+        assert(history.estimate("cppcheck", small) == 500.0);
+        // Unknown files scale the tool's milliseconds per byte: 500 ms / 100 B.
+        assert(history.estimate("cppcheck", large) == 50000.0);
+        // Other tools are not affected.
+        assert(history.estimate("flawfinder", small) == 100.0);
+
+        // New samples are smoothed against the stored one.
+        history.record("cppcheck", small, RuntimeSample{100.0, 1024});
+        const auto sample = history.lookup("cppcheck", small);
+        assert(sample && sample->wall_ms == 300.0 && sample->peak_rss_kib == 1536);
+    }
+
+    void testSaveAndReload(const std::filesystem::path& dir)
+    {
+        const auto file = writeSource(dir, "with\ttab and space.c", 10);
+        const auto store = dir / "nested" / "history";
+        {
+            RuntimeHistory history(store);
+            history.record("ikos", file, RuntimeSample{1234.5, 4096});
+            history.save();
+        }
+        assert(std::filesystem::exists(store));
+
+        RuntimeHistory reloaded(store);
+        const auto sample = reloaded.lookup("ikos", file);
+        assert(sample && sample->wall_ms == 1234.5 && sample->peak_rss_kib == 4096);
+    }
+
+    void testCorruptStoreIsIgnored(const std::filesystem::path& dir)
+    {
+        const auto store = dir / "corrupt";
+        std::ofstream(store) << "not a history\ncppcheck\t1\t2\t3\t/x.c\n";
+        RuntimeHistory history(store);
+        assert(!history.lookup("cppcheck", "/x.c"));
+
+        std::ofstream(store) << "ctrace-runtime-history 1\nbroken line\ncppcheck\t1\t2\t3\t/x.c\n";
+        RuntimeHistory partial(store);
+        assert(partial.lookup("cppcheck", "/x.c"));
+    }
+
+    void testOpenSharesInstances(const std::filesystem::path& dir)
+    {
+        const auto path = (dir / "shared").string();
+        const auto first = RuntimeHistory::open(path);
+        const auto second = RuntimeHistory::open(path);
+        assert(first == second);
+
+        ctrace::ProgramConfig config;
+        assert(!RuntimeHistory::forConfig(config));
+        config.global.result_cache_dir = dir.string();
+        const auto fromCache = RuntimeHistory::forConfig(config);
+        assert(fromCache && fromCache != first);
+        config.global.runtime_history = path;
+        assert(RuntimeHistory::forConfig(config) == first);
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = makeTempDir();
+    testEstimatesFromSizeThenHistory(dir);
+    testSaveAndReload(dir);
+    testCorruptStoreIsIgnored(dir);
+    testOpenSharesInstances(dir);
+    std::filesystem::remove_all(dir);
+    std::cout << "runtime_history_tests: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/SarifReport.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+    using ctrace::SarifFragment;
+    using ctrace::SarifReport;
+    using ctrace::SarifResult;
+    using json = nlohmann::json;
+
+    std::filesystem::path makeTempDir()
+    {
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ctrace-sarif-report-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    json readReport(const std::filesystem::path& path)
+    {
+        std::ifstream in(path);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        return json::parse(buffer.str());
+    }
+
+    void testEmptyReport(const std::filesystem::path& dir)
+    {
+        SarifReport report(dir / "nested" / "empty.sarif");
+        std::string error;
+        assert(report.write(error));
+        const json document = readReport(report.path());
+        assert(document["version"] == "2.1.0");
+        assert(document["runs"].is_array() && document["runs"].empty());
+    }
+
+    void testResultsFromSeveralThreads(const std::filesystem::path& dir)
+    {
+        SarifReport report(dir / "threads.sarif");
+        report.addRun("flawfinder"); // Reported without results.
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back(
+                [&report, t]
+                {
+                    const std::string file = "src/file\"" + std::to_string(t) + ".c";
+                    ctrace::report::Context ctx{&report, t % 2 == 0 ? "tscancode" : "cppcheck"};
+                    ctrace::report::ScopedContext scoped(&ctx);
+                    for (int i = 0; i < 250; ++i)
+                    {
+                        ctrace::report::add_rule("coretrace.Warning", "Warning",
+                                                 "Warning reported by coretrace");
+                        ctrace::report::add_result(SarifResult{"coretrace.Warning", "warning",
+                                                               "line\nbreak", file,
+                                                               static_cast<std::uint64_t>(i + 1)});
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        assert(report.resultCount() == 1000);
+        assert(report.runCount() == 3);
+
+        std::string error;
+        assert(report.write(error));
+        const json document = readReport(report.path());
+        const auto& runs = document["runs"];
+        assert(runs.size() == 3);
+        // Runs are ordered by tool name.
+        assert(runs[0]["tool"]["driver"]["name"] == "cppcheck");
+        assert(runs[1]["tool"]["driver"]["name"] == "flawfinder");
+        assert(runs[1]["results"].empty());
+        assert(runs[2]["tool"]["driver"]["rules"].size() == 1);
+        assert(runs[2]["results"].size() == 500);
+        const auto& result = runs[2]["results"][0];
+        assert(result["message"]["text"] == "line\nbreak");
+        const auto& location = result["locations"][0]["physicalLocation"];
+        assert(location["artifactLocation"]["uri"].get<std::string>().find('"') !=
+               std::string::npos);
+        assert(location["region"]["startLine"].get<int>() >= 1);
+
+        // The report keeps growing after a write.
+        report.addResult("flawfinder", SarifReport::serializeResult({"r", "note", "m", "src/r.c"}));
+        assert(report.write(error));
+        assert(readReport(report.path())["runs"][1]["results"].size() == 1);
+
+        // A result that is not a JSON object is dropped, not spooled into the report.
+        assert(report.addResult("flawfinder", std::string_view("not json")).empty());
+        assert(report.write(error));
+        assert(readReport(report.path())["runs"][1]["results"].size() == 1);
+    }
+
+    void testToolDocumentsAndReplay(const std::filesystem::path& dir)
+    {
+        const std::string document = R"({
+          "version": "2.1.0",
+          "runs": [
+            {"tool": {"driver": {"name": "Cppcheck", "version": "2.13",
+                                 "rules": [{"id": "nullPointer"}, {"id": "uninitvar"}]}},
+             "artifacts": [{"location": {"uri": "a.c"}}],
+             "results": [{"ruleId": "nullPointer", "message": {"text": "p is null"}},
+                         {"ruleId": "uninitvar", "message": {"text": "x"}}]},
+            {"tool": {"driver": {"name": "Cppcheck"}},
+             "results": [{"ruleId": "nullPointer", "message": {"text": "q is null"}}]}
+          ]
+        })";
+
+        SarifReport report(dir / "documents.sarif");
+        SarifFragment recorded;
+        {
+            ctrace::report::Context ctx{&report, "cppcheck", &recorded};
+            ctrace::report::ScopedContext scoped(&ctx);
+            std::string error;
+            assert(ctrace::report::add_document(document, error));
+            assert(!ctrace::report::add_document("{\"runs\": [", error));
+            assert(!error.empty());
+        }
+        assert(recorded.results.size() == 3);
+        assert(recorded.rules.size() == 2);
+
+        // Without a context, nothing is reported.
+        assert(!ctrace::report::active());
+        SarifResult ignored;
+        ignored.rule_id = "ignored";
+        ctrace::report::add_result(ignored);
+        assert(report.resultCount() == 3);
+
+        SarifReport replayed(dir / "replayed.sarif");
+        replayed.replay("cppcheck", recorded);
+
+        std::string error;
+        for (auto* target : {&report, &replayed})
+        {
+            assert(target->write(error));
+            const json output = readReport(target->path());
+            assert(output["runs"].size() == 1);
+            const auto& driver = output["runs"][0]["tool"]["driver"];
+            assert(driver["name"] == "Cppcheck" && driver["version"] == "2.13");
+            assert(driver["rules"].size() == 2);
+            assert(output["runs"][0]["results"].size() == 3);
+            assert(output["runs"][0]["results"][2]["message"]["text"] == "q is null");
+        }
+    }
+
+    void testCrossToolMerge(const std::filesystem::path& dir)
+    {
+        const std::string cppcheck = R"({"runs": [{
+          "tool": {"driver": {"name": "Cppcheck",
+                              "rules": [{"id": "nullPointer",
+                                         "properties": {"tags": ["external/cwe/cwe-476"]}}]}},
+          "results": [{"ruleId": "nullPointer", "level": "error",
+                       "message": {"text": "Null pointer dereference: p"},
+                       "locations": [{"physicalLocation": {
+                           "artifactLocation": {"uri": "src/a.c"},
+                           "region": {"startLine": 10, "startColumn": 5}}}]}]}]})";
+        const auto populate = [&](SarifReport& report, bool extra)
+        {
+            std::string error;
+            assert(report.addDocument("cppcheck", cppcheck, error));
+            // Same line through an absolute path, without a CWE but of the same rule
+            // category: merged.
+            (void)report.addResult("ctrace_stack_analyzer",
+                                   SarifResult{"NullPointer", "warning", "p may be null",
+                                               (dir / "src/a.c").string(), 10});
+            // Same line, but only a severity as the rule: kept.
+            (void)report.addResult("tscancode", SarifResult{"coretrace.Warning", "warning",
+                                                             "p may be null", "src/a.c", 10});
+            // Same line but another CWE: kept.
+            (void)report.addResult("flawfinder",
+                                   SarifResult{"FF1001", "warning", "strcpy overflow (CWE-120)",
+                                               "src/a.c", 10});
+            if (extra)
+            {
+                (void)report.addResult("flawfinder", SarifResult{"FF1001", "note", "gets",
+                                                                 "src/b.c", 3});
+            }
+        };
+
+        SarifReport report(dir / "merged.sarif", dir);
+        populate(report, false);
+        SarifReport::Summary summary;
+        std::string error;
+        assert(report.write(error, &summary));
+        assert(summary.results == 4 && summary.unique == 3);
+        assert(summary.errors == 1 && summary.warnings == 2 && summary.fresh == 0);
+
+        const json document = readReport(report.path());
+
+        // Written to a stream instead (a server keeps it in memory), the document is the same.
+        std::ostringstream stream;
+        SarifReport::Summary streamed;
+        assert(report.write(stream, error, &streamed));
+        assert(json::parse(stream.str()) == document && streamed.unique == summary.unique);
+
+        const auto& runs = document["runs"];
+        assert(runs.size() == 4);
+        const auto& kept = runs[0]["results"];
+        assert(kept.size() == 1);
+        assert(kept[0]["properties"]["ctrace/alsoReportedBy"] ==
+               json::array({"ctrace_stack_analyzer"}));
+        assert(kept[0]["partialFingerprints"]["ctrace/v1"].get<std::string>().size() == 16);
+        assert(!kept[0].contains("baselineState"));
+        assert(runs[1]["results"].empty());
+        for (std::size_t r = 2; r < runs.size(); ++r)
+        {
+            assert(runs[r]["results"].size() == 1);
+            assert(!runs[r]["results"][0].contains("properties"));
+        }
+
+        // Against that report as a baseline, only the extra finding is new.
+        SarifReport next(dir / "next.sarif", dir);
+        assert(next.loadBaseline(report.path(), error));
+        populate(next, true);
+        assert(next.write(error, &summary));
+        assert(summary.unique == 4 && summary.fresh == 1 && summary.notes == 1);
+        const json nextDocument = readReport(next.path());
+        for (const auto& run : nextDocument["runs"])
+        {
+            for (const auto& result : run["results"])
+            {
+                const bool isNew = result["message"]["text"] == "gets";
+                assert(result["baselineState"] == (isNew ? "new" : "unchanged"));
+            }
+        }
+        assert(!next.loadBaseline(dir / "missing.sarif", error));
+    }
+} // namespace
+
+int main()
+{
+    const auto dir = makeTempDir();
+    testEmptyReport(dir);
+    testResultsFromSeveralThreads(dir);
+    testToolDocumentsAndReplay(dir);
+    testCrossToolMerge(dir);
+    std::filesystem::remove_all(dir);
+    std::cout << "sarif_report_tests: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/ThreadPool.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    void testDequeOwnerAndThief()
+    {
+        ctrace::detail::WorkStealingDeque<int> deque(2);
+        std::vector<int> values(1000);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = static_cast<int>(i);
+            deque.push(&values[i]);
+        }
+
+        // Owner pops LIFO, thief steals FIFO.
+        assert(deque.pop() == &values.back());
+        assert(deque.steal() == &values.front());
+
+        std::atomic<std::size_t> stolen{0};
+        std::thread thief(
+            [&]
+            {
+                while (deque.steal() != nullptr)
+                {
+                    stolen.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+        std::size_t popped = 0;
+        while (deque.pop() != nullptr)
+        {
+            ++popped;
+        }
+        thief.join();
+
+        assert(popped + stolen.load() == values.size() - 2);
+        assert(deque.empty());
+    }
+
+    void testEnqueueReturnsValues()
+    {
+        ThreadPool pool(4);
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 2000; ++i)
+        {
+            results.push_back(pool.enqueue([i] { return i * 2; }));
+        }
+
+        long long sum = 0;
+        for (auto& result : results)
+        {
+            sum += result.get();
+        }
+        assert(sum == 2LL * (1999LL * 2000LL / 2));
+    }
+
+    void testNestedEnqueueUsesLocalDeque()
+    {
+        ThreadPool pool(3);
+        std::atomic<int> counter{0};
+
+        auto outer = pool.enqueue(
+            [&pool, &counter]
+            {
+                std::vector<std::future<void>> inner;
+                for (int i = 0; i < 64; ++i)
+                {
+                    inner.push_back(pool.enqueue([&counter] { counter.fetch_add(1); }));
+                }
+                return inner;
+            });
+
+        for (auto& future : outer.get())
+        {
+            future.get();
+        }
+        assert(counter.load() == 64);
+    }
+
+    void testExceptionsPropagateThroughFuture()
+    {
+        ThreadPool pool(2);
+        auto failing = pool.enqueue([]() -> int { throw std::runtime_error("boom"); });
+
+        bool caught = false;
+        try
+        {
+            (void)failing.get();
+        }
+        catch (const std::runtime_error& e)
+        {
+            caught = std::string(e.what()) == "boom";
+        }
+        assert(caught);
+    }
+
+    void testDestructorDrainsPendingTasks()
+    {
+        std::atomic<int> counter{0};
+        {
+            ThreadPool pool(2);
+            for (int i = 0; i < 500; ++i)
+            {
+                (void)pool.enqueue([&counter] { counter.fetch_add(1); });
+            }
+        }
+        assert(counter.load() == 500);
+    }
+} // namespace
+
+int main()
+{
+    testDequeOwnerAndThief();
+    testEnqueueReturnsValues();
+    testNestedEnqueueUsesLocalDeque();
+    testExceptionsPropagateThroughFuture();
+    testDestructorDrainsPendingTasks();
+    std::cout << "thread_pool_tests: all checks passed" << std::endl;
+    return 0;
+}
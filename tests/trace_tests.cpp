@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Trace.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    using ctrace::trace::Phase;
+    using ctrace::trace::Recorder;
+    using ctrace::trace::ScopedRecorder;
+    using ctrace::trace::ScopedSpan;
+
+    std::size_t countOf(const std::string& text, const std::string& needle)
+    {
+        std::size_t count = 0;
+        for (auto pos = text.find(needle); pos != std::string::npos;
+             pos = text.find(needle, pos + needle.size()))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    void testSpansWithoutRecorderAreDropped()
+    {
+        assert(ctrace::trace::current() == nullptr);
+        {
+            const ScopedSpan span(Phase::Tool, "cppcheck", "main.c");
+        }
+        Recorder recorder;
+        assert(recorder.spans().empty());
+    }
+
+    void testTotalsAndNesting()
+    {
+        Recorder recorder;
+        {
+            const ScopedRecorder tracing(&recorder);
+            const ScopedSpan run(Phase::Run, "run");
+            for (int i = 0; i < 3; ++i)
+            {
+                const ScopedSpan tool(Phase::Tool, "flawfinder", "a.c");
+            }
+            {
+                // A nested recorder takes over, then the outer one is restored.
+                Recorder inner;
+                const ScopedRecorder nested(&inner);
+                const ScopedSpan spawn(Phase::Spawn, "cppcheck");
+                assert(ctrace::trace::current() == &inner);
+            }
+            assert(ctrace::trace::current() == &recorder);
+        }
+        assert(ctrace::trace::current() == nullptr);
+
+        const auto totals = recorder.totals();
+        assert(totals[static_cast<std::size_t>(Phase::Run)].count == 1);
+        assert(totals[static_cast<std::size_t>(Phase::Tool)].count == 3);
+        assert(totals[static_cast<std::size_t>(Phase::Spawn)].count == 0);
+        assert(totals[static_cast<std::size_t>(Phase::Run)].total_ns >=
+               totals[static_cast<std::size_t>(Phase::Tool)].total_ns);
+        assert(recorder.spans().size() == 4);
+    }
+
+    void testThreadsGetDistinctIds()
+    {
+        Recorder recorder;
+        std::thread worker(
+            [&recorder]
+            {
+                const ScopedRecorder tracing(&recorder);
+                const ScopedSpan span(Phase::QueueWait, "worker");
+            });
+        worker.join();
+        {
+            const ScopedRecorder tracing(&recorder);
+            const ScopedSpan span(Phase::QueueWait, "main");
+        }
+        const auto spans = recorder.spans();
+        assert(spans.size() == 2);
+        assert(spans[0].thread != spans[1].thread);
+    }
+
+    void testChromeTraceExport()
+    {
+        Recorder recorder;
+        {
+            const ScopedRecorder tracing(&recorder);
+            const ScopedSpan span(Phase::Parse, "tool \"quoted\"", "line\nbreak\\");
+            const ScopedSpan unnamed(Phase::ReportWrite);
+        }
+
+        const auto path = std::filesystem::temp_directory_path() /
+                          ("ctrace-trace-" + std::to_string(::getpid()) + ".json");
+        std::string error;
+        assert(recorder.write_chrome_trace(path.string(), error));
+        std::stringstream content;
+        content << std::ifstream(path).rdbuf();
+        std::filesystem::remove(path);
+
+        const std::string text = content.str();
+        assert(countOf(text, "\"ph\":\"X\"") == 2);
+        assert(text.find("\"cat\":\"parse\"") != std::string::npos);
+        assert(text.find("\"name\":\"tool \\\"quoted\\\"\"") != std::string::npos);
+        assert(text.find("\"detail\":\"line\\nbreak\\\\\"") != std::string::npos);
+        assert(text.find("\"name\":\"report_write\"") != std::string::npos);
+        assert(text.find("\"dropped_spans\":0") != std::string::npos);
+
+        assert(!recorder.write_chrome_trace("/nonexistent-dir/trace.json", error));
+        assert(!error.empty());
+    }
+} // namespace
+
+int main()
+{
+    testSpansWithoutRecorderAreDropped();
+    testTotalsAndNesting();
+    testThreadsGetDistinctIds();
+    testChromeTraceExport();
+    std::cout << "trace_tests: all checks passed" << std::endl;
+    return 0;
+}
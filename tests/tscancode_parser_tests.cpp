@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+#include "Process/Tools/TscancodeParser.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using ctrace::tscancode::Diagnostic;
+    using ctrace::tscancode::for_each_diagnostic;
+    using ctrace::tscancode::parse_line;
+
+    /// The expression the parser replaces; it defines the accepted lines.
+    const std::regex& referenceRegex()
+    {
+        static const std::regex regex(R"(\[(.*):(\d+)\]: \((\w+)\) (.*))");
+        return regex;
+    }
+
+    void checkAgainstRegex(const std::string& line)
+    {
+        std::smatch match;
+        const bool matched = std::regex_match(line, match, referenceRegex());
+        const auto parsed = parse_line(line);
+        // Line numbers that overflow are rejected by the parser only.
+        if (matched && match[2].length() > 18)
+        {
+            return;
+        }
+        assert(matched == parsed.has_value());
+        if (!matched)
+        {
+            return;
+        }
+        assert(parsed->file == match[1].str());
+        assert(parsed->line == std::stoull(match[2].str()));
+        assert(parsed->severity == match[3].str());
+        assert(parsed->message == match[4].str());
+    }
+
+    void testDiagnosticLines()
+    {
+        const auto parsed = parse_line("[src/main.c:42]: (Warning) Possible null pointer: p");
+        assert(parsed);
+        assert(parsed->file == "src/main.c");
+        assert(parsed->line == 42);
+        assert(parsed->severity == "Warning");
+        assert(parsed->message == "Possible null pointer: p");
+
+        // The file is greedy: a separator inside the message does not end it early.
+        const auto nested = parse_line("[a.c:1]: (Error) see [b.c:2]: (Warning) x");
+        assert(nested && nested->file == "a.c:1]: (Error) see [b.c" && nested->line == 2);
+        // ... unless only the first separator forms a diagnostic.
+        const auto fallback = parse_line("[a.c:1]: (Error) see [b.c:x]: (Warning) x");
+        assert(fallback && fallback->file == "a.c");
+        assert(fallback->message == "see [b.c:x]: (Warning) x");
+
+        assert(!parse_line(""));
+        assert(!parse_line("Checking src/main.c..."));
+        assert(!parse_line("[src/main.c:]: (Warning) m"));
+        assert(!parse_line("[src/main.c:12]: (Warning)"));
+        assert(!parse_line("[src/main.c:12]: () m"));
+        assert(!parse_line("[src/main.c:12]: (Warn ing) m"));
+        assert(!parse_line("[src/main.c:12]: (Warning) m\r"));
+        assert(!parse_line("[src/main.c:99999999999999999999999]: (Warning) m"));
+    }
+
+    void testMatchesRegex()
+    {
+        const std::vector<std::string> fixed = {
+            "[:1]: (a) ",          "[x:1]: (a) ",        "[x:01]: (_9) tail",
+            "[x:1]: (a)  ",        "[x:1]:  (a) m",      "[[x:1]: (a) m",
+            "[x:1:2]: (a) m",      "[x:-1]: (a) m",      "[x:+1]: (a) m",
+            "[x:1]: (a) m]: (b) ", "[x:1]: (a) m]: (b)", "[x:1]: (a-b) m",
+            "x[x:1]: (a) m",       "[x:1]: (a) m\tn",    "[C:\\dir\\f.c:7]: (Style) m"};
+        for (const auto& line : fixed)
+        {
+            checkAgainstRegex(line);
+        }
+
+        // Random lines assembled from near-valid parts, with nested separators.
+        static constexpr const char* kFree[] = {"",  ":",  "]",    "(",          ")",  " ",  "a",
+                                                "1", "[",  "]: (", ":12]: (W) ", "\r", "\t"};
+        static constexpr const char* kOpen[] = {"[", "[", "[", "", " ["};
+        static constexpr const char* kDigits[] = {"1", "42", "007", "", "1a", "-1"};
+        static constexpr const char* kSeparator[] = {"]: (", "]: (", "]:(", "] (", "]: ( "};
+        static constexpr const char* kSeverity[] = {"Warning", "a_1", "9", "", "a-b", "W "};
+        static constexpr const char* kClose[] = {") ", ") ", ")", " ) ", ")  "};
+        std::mt19937 random(1234);
+        const auto pick = [&random](const auto& pieces)
+        { return std::string(pieces[random() % std::size(pieces)]); };
+        const auto text = [&]
+        {
+            std::string out;
+            for (std::size_t i = random() % 4; i > 0; --i)
+            {
+                out += pick(kFree);
+            }
+            return out;
+        };
+        std::size_t accepted = 0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            const std::string line = pick(kOpen) + text() + ":" + pick(kDigits) +
+                                     pick(kSeparator) + pick(kSeverity) + pick(kClose) + text();
+            checkAgainstRegex(line);
+            accepted += parse_line(line).has_value() ? 1 : 0;
+        }
+        // Both outcomes are exercised.
+        assert(accepted > 10000 && accepted < 90000);
+    }
+
+    void testOutputSplitting()
+    {
+        const std::string output = "Checking a.c...\n"
+                                   "[a.c:1]: (Error) first\r\n"
+                                   "\n"
+                                   "[b.c:2]: (Warning) second\n"
+                                   "[c.c:3]: (Information) last, no newline";
+        std::vector<Diagnostic> diagnostics;
+        const std::size_t count = for_each_diagnostic(
+            output, [&](const Diagnostic& diagnostic) { diagnostics.push_back(diagnostic); });
+        assert(count == 3 && diagnostics.size() == 3);
+        assert(diagnostics[0].message == "first");
+        assert(diagnostics[1].file == "b.c" && diagnostics[1].line == 2);
+        assert(diagnostics[2].severity == "Information");
+        assert(diagnostics[2].message == "last, no newline");
+
+        assert(for_each_diagnostic("", [](const Diagnostic&) {}) == 0);
+    }
+} // namespace
+
+int main()
+{
+    testDiagnosticLines();
+    testMatchesRegex();
+    testOutputSplitting();
+    std::cout << "tscancode_parser_tests: all checks passed" << std::endl;
+    return 0;
+}